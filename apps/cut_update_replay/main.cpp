@@ -0,0 +1,734 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+// headless replay of the cut update: drives a cut_update_pool against
+// .bvh/.lod models without a render context, either along a recorded
+// camera session (one view matrix per line, as written by the rendering app)
+// or along an orbit around the model, and reports per-frame statistics.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <limits>
+
+#include <lamure/types.h>
+#include <lamure/ren/config.h>
+#include <lamure/ren/policy.h>
+#include <lamure/ren/model_database.h>
+#include <lamure/ren/cut_database.h>
+#include <lamure/ren/cut_update_pool.h>
+#include <lamure/ren/ooc_cache.h>
+#include <lamure/ren/camera.h>
+#include <lamure/ren/bvh.h>
+#include <lamure/ren/node_batch_evaluator.h>
+#include <lamure/ren/ray.h>
+#include <lamure/ren/ray_query_service.h>
+
+#include <scm/core/math.h>
+
+char* get_cmd_option(char** begin, char** end, const std::string & option) {
+    char** it = std::find(begin, end, option);
+    if (it != end && ++it != end)
+        return *it;
+    return 0;
+}
+
+bool cmd_option_exists(char** begin, char** end, const std::string& option) {
+    return std::find(begin, end, option) != end;
+}
+
+std::vector<scm::math::mat4f> parse_camera_session_file(const std::string& session_file_path) {
+
+    std::ifstream camera_session_file(session_file_path);
+    std::string view_matrix_as_string;
+    std::vector<scm::math::mat4f> view_matrices;
+
+    while (std::getline(camera_session_file, view_matrix_as_string)) {
+        scm::math::mat4d view_matrix;
+        std::istringstream view_matrix_as_strstream(view_matrix_as_string);
+
+        for (int element_idx = 0; element_idx < 16; ++element_idx) {
+            view_matrix_as_strstream >> view_matrix[element_idx];
+        }
+
+        view_matrices.push_back(scm::math::mat4f(view_matrix));
+    }
+
+    return view_matrices;
+}
+
+scm::math::mat4f orbit_view_matrix(const scm::gl::boxf& box, const uint32_t frame, const uint32_t num_frames, const uint32_t num_laps = 1) {
+
+    scm::math::vec3f center = (box.min_vertex() + box.max_vertex()) * 0.5f;
+    float radius = scm::math::length(box.max_vertex() - box.min_vertex());
+    float angle = 2.f * 3.14159265f * (float)num_laps * (float)frame / (float)std::max(1u, num_frames);
+
+    // fly towards the model during the first half of the orbit and back out again
+    float distance = radius * (0.25f + 0.75f * std::abs(std::cos(angle * 0.5f)));
+
+    scm::math::vec3f eye = center + scm::math::vec3f(std::sin(angle), 0.25f, std::cos(angle)) * distance;
+
+    return scm::math::make_look_at_matrix(eye, center, scm::math::vec3f(0.f, 1.f, 0.f));
+}
+
+// number of cut nodes inside the frustum whose error is still above the threshold
+// and which could be refined further. a frame is at full quality when this is 0
+size_t count_unrefined_nodes(lamure::ren::node_batch_evaluator& evaluator, const lamure::ren::bvh* bvh,
+                             const lamure::view_t view_id, const lamure::model_t model_id,
+                             std::vector<lamure::ren::cut::node_slot_aggregate>& cut, const float error_threshold) {
+
+    std::vector<lamure::node_t> node_ids;
+    node_ids.reserve(cut.size());
+    for (const auto& aggregate : cut) {
+        node_ids.push_back(aggregate.node_id_);
+    }
+
+    std::vector<float> errors(node_ids.size());
+    std::vector<uint8_t> classifications(node_ids.size());
+    evaluator.evaluate(view_id, model_id, node_ids.data(), node_ids.size(), nullptr, errors.data(), classifications.data());
+
+    const uint32_t fan_factor = bvh->get_fan_factor();
+
+    std::vector<lamure::node_t> child_ids;
+    for (size_t i = 0; i < node_ids.size(); ++i) {
+        bool is_leaf = node_ids[i] * fan_factor + 1 >= bvh->get_num_nodes();
+        if (!is_leaf && classifications[i] != lamure::ren::node_batch_evaluator::OUTSIDE && errors[i] > error_threshold + 0.1f) {
+            for (uint32_t c = 0; c < fan_factor; ++c) {
+                child_ids.push_back(node_ids[i] * fan_factor + 1 + c);
+            }
+        }
+    }
+
+    std::vector<float> child_errors(child_ids.size());
+    evaluator.evaluate(view_id, model_id, child_ids.data(), child_ids.size(), nullptr, child_errors.data(), nullptr);
+
+    // the cut update does not split nodes whose children would have to collapse again
+    size_t num_unrefined = 0;
+    for (size_t group = 0; group < child_ids.size(); group += fan_factor) {
+        bool split = true;
+        for (size_t c = group; c < group + fan_factor; ++c) {
+            if (child_errors[c] < error_threshold - 0.1f) {
+                split = false;
+                break;
+            }
+        }
+
+        if (split) {
+            ++num_unrefined;
+        }
+    }
+
+    return num_unrefined;
+}
+
+void run_evaluator_benchmark(const lamure::ren::bvh* bvh, const lamure::model_t model_id, const lamure::ren::camera& cam,
+                             const int32_t window_height, const uint32_t num_iterations) {
+
+    const lamure::view_t view_id = cam.view_id();
+    const scm::math::mat4f model_matrix = scm::math::mat4f::identity();
+
+    std::vector<scm::math::vec3d> corner_values = cam.get_frustum_corners();
+    float height_divided_by_top_minus_bottom = window_height / scm::math::length((corner_values[2]) - (corner_values[0]));
+
+    lamure::ren::node_batch_evaluator evaluator;
+    evaluator.update_model(model_id, bvh);
+    evaluator.update_view_model(view_id, model_id, cam, model_matrix, height_divided_by_top_minus_bottom);
+
+    // a cut front is a sorted but sparse set of node ids, take every third node
+    std::vector<lamure::node_t> node_ids;
+    for (lamure::node_t node_id = 0; node_id < bvh->get_num_nodes(); node_id += 3) {
+        node_ids.push_back(node_id);
+    }
+
+    std::vector<float> errors(node_ids.size());
+    std::vector<uint8_t> classifications(node_ids.size());
+
+    auto batched_start = std::chrono::high_resolution_clock::now();
+    for (uint32_t iteration = 0; iteration < num_iterations; ++iteration) {
+        evaluator.evaluate(view_id, model_id, node_ids.data(), node_ids.size(), nullptr, errors.data(), classifications.data());
+    }
+    double batched_us = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - batched_start).count();
+
+    // reference: per node evaluation as done by cut_update_pool::calculate_node_error and is_node_in_frustum
+    scm::gl::frustum frustum = cam.get_frustum_by_model(model_matrix);
+    size_t num_mismatches = 0;
+
+    auto scalar_start = std::chrono::high_resolution_clock::now();
+    for (uint32_t iteration = 0; iteration < num_iterations; ++iteration) {
+        for (size_t i = 0; i < node_ids.size(); ++i) {
+            lamure::node_t node_id = node_ids[i];
+
+            float radius_scaling = scm::math::length(model_matrix * scm::math::vec4f(1.0f, 0.f, 0.f, 0.f));
+            float representative_radius = bvh->get_avg_primitive_extent(node_id) * radius_scaling;
+            scm::math::vec3f view_position = cam.get_view_matrix() * model_matrix * bvh->get_centroids()[node_id];
+            float error = std::abs(2.0f * representative_radius * (cam.near_plane_value() / -view_position.z) * height_divided_by_top_minus_bottom);
+            bool outside = 1 == cam.cull_against_frustum(frustum, bvh->get_bounding_boxes()[node_id]);
+
+            if (iteration == 0) {
+                bool batched_outside = classifications[i] == lamure::ren::node_batch_evaluator::OUTSIDE;
+                if (outside != batched_outside || std::abs(error - errors[i]) > 1e-3f * std::max(1.f, error)) {
+                    ++num_mismatches;
+                }
+            }
+        }
+    }
+    double scalar_us = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - scalar_start).count();
+
+    double num_evaluated = (double)node_ids.size() * num_iterations;
+
+    std::cout << "batch width: " << lamure::ren::node_batch_evaluator::batch_width() << std::endl;
+    std::cout << "nodes per iteration: " << node_ids.size() << std::endl;
+    std::cout << "batched: " << num_evaluated / batched_us << " nodes/us" << std::endl;
+    std::cout << "scalar:  " << num_evaluated / scalar_us << " nodes/us" << std::endl;
+    std::cout << "mismatches: " << num_mismatches << std::endl;
+}
+
+// writes the model in the columnar .bvh v2 layout and compares open time and
+// cut analysis throughput (column setup and node evaluation) of both layouts
+void run_bvh_layout_benchmark(const std::string& bvh_filename, const std::string& columns_filename, const lamure::ren::camera& cam,
+                              const int32_t window_height) {
+
+    {
+        lamure::ren::bvh source(bvh_filename);
+        source.write_bvh_file(columns_filename, 2);
+    }
+
+    const uint32_t num_opens = 3;
+    const lamure::view_t view_id = cam.view_id();
+    const lamure::model_t model_id = 0;
+    const scm::math::mat4f model_matrix = scm::math::mat4f::identity();
+
+    std::vector<scm::math::vec3d> corner_values = cam.get_frustum_corners();
+    float height_divided_by_top_minus_bottom = window_height / scm::math::length((corner_values[2]) - (corner_values[0]));
+
+    std::vector<float> reference_errors;
+    std::vector<uint8_t> reference_classifications;
+
+    for (const std::string& filename : {bvh_filename, columns_filename}) {
+        double open_ms = std::numeric_limits<double>::max();
+        lamure::ren::bvh* bvh = nullptr;
+
+        for (uint32_t i = 0; i < num_opens; ++i) {
+            delete bvh;
+            auto start = std::chrono::high_resolution_clock::now();
+            bvh = new lamure::ren::bvh(filename);
+            open_ms = std::min(open_ms, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+        }
+
+        std::vector<lamure::node_t> node_ids(bvh->get_num_nodes());
+        for (lamure::node_t node_id = 0; node_id < bvh->get_num_nodes(); ++node_id) {
+            node_ids[node_id] = node_id;
+        }
+        std::vector<float> errors(node_ids.size());
+        std::vector<uint8_t> classifications(node_ids.size());
+
+        auto start = std::chrono::high_resolution_clock::now();
+        lamure::ren::node_batch_evaluator evaluator;
+        evaluator.update_model(model_id, bvh);
+        evaluator.update_view_model(view_id, model_id, cam, model_matrix, height_divided_by_top_minus_bottom);
+        evaluator.evaluate(view_id, model_id, node_ids.data(), node_ids.size(), nullptr, errors.data(), classifications.data());
+        double analysis_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        size_t num_mismatches = 0;
+        if (reference_errors.empty()) {
+            reference_errors = errors;
+            reference_classifications = classifications;
+        }
+        else {
+            for (size_t i = 0; i < errors.size() && i < reference_errors.size(); ++i) {
+                if (errors[i] != reference_errors[i] || classifications[i] != reference_classifications[i]) {
+                    ++num_mismatches;
+                }
+            }
+            num_mismatches += std::max(errors.size(), reference_errors.size()) - std::min(errors.size(), reference_errors.size());
+        }
+
+        std::cout << filename << ": open " << open_ms << " ms, first cut analysis " << analysis_ms << " ms ("
+                  << (double)node_ids.size() / (analysis_ms * 1000.0) << " nodes/us), mismatches " << num_mismatches << std::endl;
+
+        delete bvh;
+    }
+}
+
+// registers the given model and the models listed in the model file and reports the time
+// until the first model can be rendered and until all models are available
+void run_model_registration_benchmark(const std::string& bvh_filename, const std::string& models_filename, const bool register_async) {
+
+    std::vector<std::string> model_filenames(1, bvh_filename);
+
+    std::ifstream models_file(models_filename);
+    std::string line;
+    while (std::getline(models_file, line)) {
+        if (!line.empty() && line[0] != '#') {
+            model_filenames.push_back(line);
+        }
+    }
+
+    lamure::ren::model_database* database = lamure::ren::model_database::get_instance();
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (size_t i = 0; i < model_filenames.size(); ++i) {
+        if (register_async) {
+            database->add_model_async(model_filenames[i], std::to_string(i));
+        }
+        else {
+            database->add_model(model_filenames[i], std::to_string(i));
+        }
+    }
+
+    double registration_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    // the renderer publishes models with each system reset, poll instead
+    while (!database->is_model_ready(0)) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        database->apply();
+    }
+
+    double first_model_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    try {
+        database->wait_for_models();
+    }
+    catch (const std::runtime_error& e) {
+        std::cout << e.what() << std::endl;
+    }
+    database->apply();
+
+    double all_models_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    std::cout << (register_async ? "asynchronous" : "synchronous") << " registration of " << model_filenames.size() << " models" << std::endl;
+    std::cout << "registration: " << registration_ms << " ms" << std::endl;
+    std::cout << "first model available (time-to-first-frame): " << first_model_ms << " ms" << std::endl;
+    std::cout << "all models available: " << all_models_ms << " ms (" << database->num_models() << " published)" << std::endl;
+}
+
+// picks against the resident cut from the eye of the given view towards random points of the model
+void run_ray_query_benchmark(const scm::gl::boxf& box, const scm::math::mat4f& view_matrix, const uint32_t num_rays_per_batch_size) {
+
+    scm::math::vec3f eye = scm::math::vec3f(scm::math::inverse(view_matrix) * scm::math::vec4f(0.f, 0.f, 0.f, 1.f));
+    float max_distance = scm::math::length(box.max_vertex() - box.min_vertex()) + scm::math::length((box.min_vertex() + box.max_vertex()) * 0.5f - eye);
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distribution(0.f, 1.f);
+
+    std::vector<lamure::ren::ray> rays;
+    for (uint32_t i = 0; i < num_rays_per_batch_size; ++i) {
+        scm::math::vec3f target = box.min_vertex() + (box.max_vertex() - box.min_vertex())
+            * scm::math::vec3f(distribution(generator), distribution(generator), distribution(generator));
+        rays.push_back(lamure::ren::ray(eye, scm::math::normalize(target - eye), max_distance));
+    }
+
+    lamure::ren::ray_query_service* service = lamure::ren::ray_query_service::get_instance();
+    lamure::ren::ray_query_service::query_parameters parameters;
+
+    std::cout << std::endl;
+    std::cout << "ray query threads: " << service->num_threads() << std::endl;
+
+    std::vector<lamure::ren::ray::intersection> intersections;
+    size_t num_hits = 0;
+
+    for (size_t batch_size : {(size_t)1, (size_t)64, (size_t)4096}) {
+        size_t num_batches = std::max((size_t)1, rays.size() / batch_size);
+        std::vector<lamure::ren::ray> batch(batch_size);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        num_hits = 0;
+        for (size_t b = 0; b < num_batches; ++b) {
+            for (size_t i = 0; i < batch_size; ++i) {
+                batch[i] = rays[(b * batch_size + i) % rays.size()];
+            }
+            num_hits += service->intersect(batch, parameters, intersections);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+        std::cout << "batch size " << batch_size << ": " << (double)(num_batches * batch_size) / seconds << " rays/s ("
+                  << num_hits << " hits)" << std::endl;
+    }
+
+    // reference: one locked traversal per ray and model, as done by ray::intersect_model
+    service->intersect(rays, parameters, intersections);
+
+    lamure::ren::model_database* database = lamure::ren::model_database::get_instance();
+    size_t num_mismatches = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < rays.size(); ++i) {
+        lamure::ren::ray::intersection best;
+        for (lamure::model_t model_id = 0; model_id < database->num_models(); ++model_id) {
+            lamure::ren::ray::intersection temp = best;
+            if (rays[i].intersect_model(model_id, database->get_model(model_id)->transform(), parameters.aabb_scale_,
+                                        parameters.max_depth_, parameters.surfel_skip_, false, temp)) {
+                best = temp;
+            }
+        }
+
+        if (std::abs(best.error_ - intersections[i].error_) > 1e-4f * std::max(1.f, std::abs(best.error_))
+            && (best.error_ < std::numeric_limits<float>::max() || intersections[i].error_ < std::numeric_limits<float>::max())) {
+            ++num_mismatches;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    std::cout << "per ray intersect_model: " << (double)rays.size() / seconds << " rays/s" << std::endl;
+    std::cout << "mismatches: " << num_mismatches << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+
+    if (argc == 1 ||
+        cmd_option_exists(argv, argv+argc, "-h") ||
+        !cmd_option_exists(argv, argv+argc, "-f")) {
+
+        std::cout << "Usage: " << argv[0] << " <flags> -f <input_file>" << std::endl <<
+            "INFO: cut_update_replay " << std::endl <<
+            "\t-f: selects .bvh input file" << std::endl <<
+            "\t    (-f flag is required) " << std::endl <<
+            "\t-c: camera session file (one view matrix per line)" << std::endl <<
+            "\t    (default: orbit around the model)" << std::endl <<
+            "\t-n: number of frames (default: 1000)" << std::endl <<
+            "\t-l: number of laps of the orbit, more laps revisit" << std::endl <<
+            "\t    the same views more often (default: 1)" << std::endl <<
+            "\t-t: number of cut analysis threads (default: " << LAMURE_CUT_UPDATE_NUM_CUT_UPDATE_THREADS << ")" << std::endl <<
+            "\t-e: error threshold (default: " << LAMURE_DEFAULT_THRESHOLD << ")" << std::endl <<
+            "\t-m: main memory budget in MB (default: " << LAMURE_DEFAULT_MAIN_MEMORY_BUDGET << ")" << std::endl <<
+            "\t-k: compressed victim cache budget in MB, 0 disables it (default: " << LAMURE_DEFAULT_VICTIM_CACHE_BUDGET << ")" << std::endl <<
+            "\t-v: video memory budget in MB (default: " << LAMURE_DEFAULT_VIDEO_MEMORY_BUDGET << ")" << std::endl <<
+            "\t-u: upload budget in MB (default: " << LAMURE_DEFAULT_UPLOAD_BUDGET << ")" << std::endl <<
+            "\t-w: window width (default: 1920)" << std::endl <<
+            "\t-x: window height (default: 1080)" << std::endl <<
+            "\t-b: run the batched node evaluation microbenchmark" << std::endl <<
+            "\t    with the given number of iterations and exit" << std::endl <<
+            "\t-p: enable predictive prefetching" << std::endl <<
+            "\t-q: prefetch budget in MB (default: " << LAMURE_CUT_UPDATE_DEFAULT_PREFETCH_BUDGET << ")" << std::endl <<
+            "\t-r: frames per second the session is replayed at, 0 replays" << std::endl <<
+            "\t    as fast as possible (default: 60)" << std::endl <<
+            "\t-s: time in ms the last view is held to measure" << std::endl <<
+            "\t    time-to-full-quality (default: 5000)" << std::endl <<
+            "\t-y: after the session, pick the given number of rays from the" << std::endl <<
+            "\t    last view in batches of 1, 64 and 4096 and report rays/s" << std::endl <<
+            "\t-j: write the model to the given file in the columnar .bvh v2" << std::endl <<
+            "\t    layout, compare open time and cut analysis of both layouts and exit" << std::endl <<
+            "\t-i: file listing further .bvh files, one per line, register them after" << std::endl <<
+            "\t    the model of -f, report the time until the models are available and exit" << std::endl <<
+            "\t-a: register the models of -i asynchronously" << std::endl <<
+            std::endl;
+        return 0;
+    }
+
+    std::string bvh_filename = std::string(get_cmd_option(argv, argv + argc, "-f"));
+
+    uint32_t num_frames = 1000;
+    if (cmd_option_exists(argv, argv+argc, "-n")) {
+        num_frames = atoi(get_cmd_option(argv, argv+argc, "-n"));
+    }
+
+    uint32_t num_laps = 1;
+    if (cmd_option_exists(argv, argv+argc, "-l")) {
+        num_laps = std::max(1, atoi(get_cmd_option(argv, argv+argc, "-l")));
+    }
+
+    uint32_t num_threads = LAMURE_CUT_UPDATE_NUM_CUT_UPDATE_THREADS;
+    if (cmd_option_exists(argv, argv+argc, "-t")) {
+        num_threads = atoi(get_cmd_option(argv, argv+argc, "-t"));
+    }
+
+    float error_threshold = LAMURE_DEFAULT_THRESHOLD;
+    if (cmd_option_exists(argv, argv+argc, "-e")) {
+        error_threshold = atof(get_cmd_option(argv, argv+argc, "-e"));
+    }
+
+    size_t main_memory_budget = LAMURE_DEFAULT_MAIN_MEMORY_BUDGET;
+    if (cmd_option_exists(argv, argv+argc, "-m")) {
+        main_memory_budget = atoi(get_cmd_option(argv, argv+argc, "-m"));
+    }
+
+    size_t victim_cache_budget = LAMURE_DEFAULT_VICTIM_CACHE_BUDGET;
+    if (cmd_option_exists(argv, argv+argc, "-k")) {
+        victim_cache_budget = atoi(get_cmd_option(argv, argv+argc, "-k"));
+    }
+
+    size_t video_memory_budget = LAMURE_DEFAULT_VIDEO_MEMORY_BUDGET;
+    if (cmd_option_exists(argv, argv+argc, "-v")) {
+        video_memory_budget = atoi(get_cmd_option(argv, argv+argc, "-v"));
+    }
+
+    size_t upload_budget = LAMURE_DEFAULT_UPLOAD_BUDGET;
+    if (cmd_option_exists(argv, argv+argc, "-u")) {
+        upload_budget = atoi(get_cmd_option(argv, argv+argc, "-u"));
+    }
+
+    int32_t window_width = 1920;
+    if (cmd_option_exists(argv, argv+argc, "-w")) {
+        window_width = atoi(get_cmd_option(argv, argv+argc, "-w"));
+    }
+
+    int32_t window_height = 1080;
+    if (cmd_option_exists(argv, argv+argc, "-x")) {
+        window_height = atoi(get_cmd_option(argv, argv+argc, "-x"));
+    }
+
+    bool enable_prefetching = cmd_option_exists(argv, argv+argc, "-p");
+
+    size_t prefetch_budget = LAMURE_CUT_UPDATE_DEFAULT_PREFETCH_BUDGET;
+    if (cmd_option_exists(argv, argv+argc, "-q")) {
+        prefetch_budget = atoi(get_cmd_option(argv, argv+argc, "-q"));
+    }
+
+    float frames_per_second = 60.f;
+    if (cmd_option_exists(argv, argv+argc, "-r")) {
+        frames_per_second = atof(get_cmd_option(argv, argv+argc, "-r"));
+    }
+
+    double settle_time_in_ms = 5000.0;
+    if (cmd_option_exists(argv, argv+argc, "-s")) {
+        settle_time_in_ms = atof(get_cmd_option(argv, argv+argc, "-s"));
+    }
+
+    std::vector<scm::math::mat4f> session_views;
+    if (cmd_option_exists(argv, argv+argc, "-c")) {
+        session_views = parse_camera_session_file(get_cmd_option(argv, argv+argc, "-c"));
+        if (session_views.empty()) {
+            std::cout << "camera session file is empty" << std::endl;
+            return 0;
+        }
+        num_frames = session_views.size();
+    }
+
+    lamure::ren::policy* policy = lamure::ren::policy::get_instance();
+    policy->set_max_upload_budget_in_mb(upload_budget);
+    policy->set_render_budget_in_mb(video_memory_budget);
+    policy->set_out_of_core_budget_in_mb(main_memory_budget);
+    policy->set_victim_cache_budget_in_mb(victim_cache_budget);
+    policy->set_window_width(window_width);
+    policy->set_window_height(window_height);
+    policy->set_num_cut_update_threads(num_threads);
+    policy->set_enable_predictive_prefetching(enable_prefetching);
+    policy->set_prefetch_budget_in_mb(prefetch_budget);
+
+    lamure::ren::model_database* database = lamure::ren::model_database::get_instance();
+    lamure::ren::cut_database* cuts = lamure::ren::cut_database::get_instance();
+
+    if (cmd_option_exists(argv, argv+argc, "-i")) {
+        run_model_registration_benchmark(bvh_filename, get_cmd_option(argv, argv+argc, "-i"), cmd_option_exists(argv, argv+argc, "-a"));
+        return 0;
+    }
+
+    lamure::model_t model_id = database->add_model(bvh_filename, "0");
+    database->apply();
+
+    const lamure::ren::bvh* bvh = database->get_model(model_id)->get_bvh();
+    const scm::gl::boxf root_box = bvh->get_bounding_boxes()[0];
+
+    std::cout << "model: " << bvh_filename << " (" << bvh->get_num_nodes() << " nodes, depth " << bvh->get_depth() << ")" << std::endl;
+
+    const lamure::context_t context_id = 0;
+    const lamure::view_t view_id = 0;
+
+    size_t slot_size = database->get_slot_size();
+    lamure::node_t upload_budget_in_nodes = (upload_budget * 1024u * 1024u) / slot_size;
+    lamure::node_t render_budget_in_nodes = (video_memory_budget * 1024u * 1024u) / slot_size;
+
+    // stand-ins for the mapped gpu staging buffers
+    std::vector<char> storage_a(upload_budget_in_nodes * slot_size);
+    std::vector<char> storage_b(upload_budget_in_nodes * slot_size);
+
+    float near_plane = 0.01f;
+    float far_plane = 1000.f;
+    scm::math::mat4f proj_matrix;
+    scm::math::perspective_matrix(proj_matrix, 60.f, float(window_width) / float(window_height), near_plane, far_plane);
+
+    if (cmd_option_exists(argv, argv+argc, "-b")) {
+        uint32_t num_iterations = std::max(1, atoi(get_cmd_option(argv, argv+argc, "-b")));
+        run_evaluator_benchmark(bvh, model_id, lamure::ren::camera(view_id, near_plane, orbit_view_matrix(root_box, 0, num_frames), proj_matrix),
+                                window_height, num_iterations);
+        return 0;
+    }
+
+    if (cmd_option_exists(argv, argv+argc, "-j")) {
+        run_bvh_layout_benchmark(bvh_filename, get_cmd_option(argv, argv+argc, "-j"),
+                                 lamure::ren::camera(view_id, near_plane, orbit_view_matrix(root_box, 0, num_frames), proj_matrix), window_height);
+        return 0;
+    }
+
+    lamure::ren::cut_update_pool* pool = new lamure::ren::cut_update_pool(context_id, upload_budget_in_nodes, render_budget_in_nodes);
+
+    // evaluates the published cut against the view it was computed for
+    lamure::ren::node_batch_evaluator quality_evaluator;
+    quality_evaluator.update_model(model_id, bvh);
+
+    double total_analysis_ms = 0.0;
+    double total_frame_ms = 0.0;
+    double max_analysis_ms = 0.0;
+    size_t total_unrefined = 0;
+    uint32_t num_full_quality_frames = 0;
+    lamure::ren::cut_update_pool::stage_timings total_stage_timings;
+
+    auto run_frame = [&](const scm::math::mat4f& view_matrix, double& analysis_ms, double& frame_ms, size_t& cut_size, size_t& num_unrefined) {
+
+        auto pacing_start = std::chrono::high_resolution_clock::now();
+
+        lamure::ren::camera cam(view_id, near_plane, view_matrix, proj_matrix);
+
+        std::vector<scm::math::vec3d> corner_values = cam.get_frustum_corners();
+        double top_minus_bottom = scm::math::length((corner_values[2]) - (corner_values[0]));
+        float height_divided_by_top_minus_bottom = window_height / top_minus_bottom;
+
+        cuts->send_transform(context_id, model_id, scm::math::mat4f::identity());
+        cuts->send_threshold(context_id, model_id, error_threshold);
+        cuts->send_rendered(context_id, model_id);
+        cuts->send_camera(context_id, view_id, cam);
+        cuts->send_height_divided_by_top_minus_bottom(context_id, view_id, height_divided_by_top_minus_bottom);
+
+        auto frame_start = std::chrono::high_resolution_clock::now();
+
+        cuts->swap(context_id);
+        pool->dispatch_cut_update(storage_a.data(), storage_b.data(), nullptr, nullptr);
+
+        while (pool->is_running()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+
+        if (cuts->is_front_modified(context_id)) {
+            cuts->signal_upload_complete(context_id);
+        }
+
+        frame_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - frame_start).count();
+        analysis_ms = pool->analysis_time_in_ms();
+
+        std::vector<lamure::ren::cut::node_slot_aggregate>& cut = cuts->get_cut(context_id, view_id, model_id).complete_set();
+        cut_size = cut.size();
+
+        quality_evaluator.update_view_model(view_id, model_id, cam, scm::math::mat4f::identity(), height_divided_by_top_minus_bottom);
+        num_unrefined = count_unrefined_nodes(quality_evaluator, bvh, view_id, model_id, cut, error_threshold);
+
+        // loading threads run in real time, so replay at the recorded frame rate
+        if (frames_per_second > 0.f) {
+            std::this_thread::sleep_until(pacing_start + std::chrono::microseconds((int64_t)(1000000.0 / frames_per_second)));
+        }
+    };
+
+    std::cout << "frame\tanalysis_ms\tframe_ms\tcut_size\tunrefined" << std::endl;
+
+    scm::math::mat4f last_view_matrix;
+
+    for (uint32_t frame = 0; frame < num_frames; ++frame) {
+
+        scm::math::mat4f view_matrix = session_views.empty() ? orbit_view_matrix(root_box, frame, num_frames, num_laps) : session_views[frame];
+        last_view_matrix = view_matrix;
+
+        double analysis_ms = 0.0;
+        double frame_ms = 0.0;
+        size_t cut_size = 0;
+        size_t num_unrefined = 0;
+        run_frame(view_matrix, analysis_ms, frame_ms, cut_size, num_unrefined);
+
+        total_analysis_ms += analysis_ms;
+        total_frame_ms += frame_ms;
+        max_analysis_ms = std::max(max_analysis_ms, analysis_ms);
+        total_unrefined += num_unrefined;
+
+        lamure::ren::cut_update_pool::stage_timings stage_timings = pool->last_stage_timings();
+        total_stage_timings.prepare_in_ms_ += stage_timings.prepare_in_ms_;
+        total_stage_timings.analysis_in_ms_ += stage_timings.analysis_in_ms_;
+        total_stage_timings.sort_in_ms_ += stage_timings.sort_in_ms_;
+        total_stage_timings.update_in_ms_ += stage_timings.update_in_ms_;
+        total_stage_timings.transfer_in_ms_ += stage_timings.transfer_in_ms_;
+        total_stage_timings.publish_in_ms_ += stage_timings.publish_in_ms_;
+        total_stage_timings.num_rounds_ += stage_timings.num_rounds_;
+
+        if (num_unrefined == 0) {
+            ++num_full_quality_frames;
+        }
+
+        std::cout << frame << "\t" << analysis_ms << "\t" << frame_ms << "\t" << cut_size << "\t" << num_unrefined << std::endl;
+    }
+
+    // hold the last view until the cut has caught up
+    double time_to_full_quality_ms = -1.0;
+    auto settle_start = std::chrono::high_resolution_clock::now();
+
+    while (num_frames > 0) {
+        double analysis_ms = 0.0;
+        double frame_ms = 0.0;
+        size_t cut_size = 0;
+        size_t num_unrefined = 0;
+        run_frame(last_view_matrix, analysis_ms, frame_ms, cut_size, num_unrefined);
+
+        double settle_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - settle_start).count();
+
+        if (num_unrefined == 0) {
+            time_to_full_quality_ms = settle_ms;
+            break;
+        }
+
+        if (settle_ms > settle_time_in_ms) {
+            break;
+        }
+    }
+
+    lamure::ren::cache_index::prefetch_statistics prefetch_stats = lamure::ren::ooc_cache::get_instance()->get_prefetch_statistics();
+
+    std::cout << std::endl;
+    std::cout << "analysis threads: " << num_threads << std::endl;
+    std::cout << "avg analysis time per frame (ms): " << total_analysis_ms / std::max(1u, num_frames) << std::endl;
+    std::cout << "max analysis time per frame (ms): " << max_analysis_ms << std::endl;
+    std::cout << "avg cut update time per frame (ms): " << total_frame_ms / std::max(1u, num_frames) << std::endl;
+    std::cout << "avg stage times per frame (ms): prepare " << total_stage_timings.prepare_in_ms_ / std::max(1u, num_frames)
+              << ", analysis " << total_stage_timings.analysis_in_ms_ / std::max(1u, num_frames)
+              << ", sort " << total_stage_timings.sort_in_ms_ / std::max(1u, num_frames)
+              << ", update " << total_stage_timings.update_in_ms_ / std::max(1u, num_frames)
+              << ", transfer " << total_stage_timings.transfer_in_ms_ / std::max(1u, num_frames)
+              << ", publish " << total_stage_timings.publish_in_ms_ / std::max(1u, num_frames) << std::endl;
+    std::cout << "avg update rounds per frame: " << (double)total_stage_timings.num_rounds_ / std::max(1u, num_frames) << std::endl;
+    std::cout << std::endl;
+    std::cout << "predictive prefetching: " << (enable_prefetching ? "on" : "off") << std::endl;
+    std::cout << "frames at full quality: " << num_full_quality_frames << " / " << num_frames << std::endl;
+    std::cout << "avg unrefined nodes per frame: " << (double)total_unrefined / std::max(1u, num_frames) << std::endl;
+    if (time_to_full_quality_ms >= 0.0) {
+        std::cout << "time to full quality after last frame (ms): " << time_to_full_quality_ms << std::endl;
+    }
+    else {
+        std::cout << "time to full quality after last frame (ms): not reached within " << settle_time_in_ms << std::endl;
+    }
+    std::cout << "prefetch requests: " << prefetch_stats.num_requested_ << std::endl;
+    std::cout << "prefetched nodes loaded: " << prefetch_stats.num_loaded_ << std::endl;
+    std::cout << "prefetched nodes used: " << prefetch_stats.num_used_ << std::endl;
+    // loaded but evicted before use, or still unused at the end of the session
+    std::cout << "prefetched nodes evicted unused: " << prefetch_stats.num_wasted_ << std::endl;
+    std::cout << "wasted bytes: " << (prefetch_stats.num_loaded_ - prefetch_stats.num_used_) * slot_size << std::endl;
+
+    lamure::ren::ooc_cache::tier_statistics tier_stats = lamure::ren::ooc_cache::get_instance()->get_tier_statistics();
+    size_t num_loads = tier_stats.loads_.num_disk_loads_ + tier_stats.loads_.num_victim_cache_loads_;
+
+    std::cout << std::endl;
+    std::cout << "ooc-cache hit rate: " << (double)tier_stats.num_lookup_hits_ / std::max((size_t)1, tier_stats.num_lookups_)
+              << " (" << tier_stats.num_lookup_hits_ << " / " << tier_stats.num_lookups_ << " lookups)" << std::endl;
+    std::cout << "victim cache budget (MB): " << victim_cache_budget << std::endl;
+    std::cout << "victim cache hit rate: " << (double)tier_stats.loads_.num_victim_cache_loads_ / std::max((size_t)1, num_loads)
+              << " (" << tier_stats.loads_.num_victim_cache_loads_ << " / " << num_loads << " loads)" << std::endl;
+    std::cout << "disk loads: " << tier_stats.loads_.num_disk_loads_ << std::endl;
+    std::cout << "bytes read from disk: " << tier_stats.loads_.bytes_read_from_disk_ << std::endl;
+    std::cout << "disk bytes saved by victim cache: " << tier_stats.loads_.bytes_read_from_victim_cache_ << std::endl;
+    std::cout << "victim cache entries: " << tier_stats.victim_cache_.num_entries_ << std::endl;
+    std::cout << "victim cache bytes held (uncompressed / stored): " << tier_stats.victim_cache_.uncompressed_bytes_
+              << " / " << tier_stats.victim_cache_.stored_bytes_ << std::endl;
+
+    if (cmd_option_exists(argv, argv+argc, "-y")) {
+        run_ray_query_benchmark(root_box, last_view_matrix, std::max(1, atoi(get_cmd_option(argv, argv+argc, "-y"))));
+    }
+
+    delete pool;
+
+    return 0;
+}
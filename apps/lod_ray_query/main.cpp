@@ -0,0 +1,190 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+
+#include <lamure/types.h>
+#include <lamure/ren/ray.h>
+#include <lamure/ren/ooc_ray_query.h>
+
+#define DEFAULT_PRECISION 15
+
+char* get_cmd_option(char** begin, char** end, const std::string & option) {
+    char** it = std::find(begin, end, option);
+    if (it != end && ++it != end)
+        return *it;
+    return 0;
+}
+
+bool cmd_option_exists(char** begin, char** end, const std::string& option) {
+    return std::find(begin, end, option) != end;
+}
+
+int main(int argc, char *argv[]) {
+
+    if (argc == 1 ||
+      cmd_option_exists(argv, argv+argc, "-h") ||
+      !cmd_option_exists(argv, argv+argc, "-f") ||
+      !cmd_option_exists(argv, argv+argc, "-r")) {
+
+      std::cout << "Usage: " << argv[0] << "<flags> -f <input_file> -r <ray_file>" << std::endl <<
+         "INFO: lod_ray_query " << std::endl <<
+         "\t-f: selects .bvh input file, the .lod file is expected next to it" << std::endl <<
+         "\t    (-f flag is required) " << std::endl <<
+         "\t-r: selects ray file, one ray per line:" << std::endl <<
+         "\t    \"ox oy oz dx dy dz [max_distance]\"" << std::endl <<
+         "\t    (-r flag is required) " << std::endl <<
+         "\t-d: select depth to intersect (optional)" << std::endl <<
+         "\t    (default: leaf level)" << std::endl <<
+         "\t-o: select output file (optional)" << std::endl <<
+         "\t    (default: <ray_file>.hits)" << std::endl <<
+         "\t-b: select number of nodes kept in memory (optional)" << std::endl <<
+         "\t    (default: 1024)" << std::endl <<
+         std::endl;
+      return 0;
+    }
+
+    std::string bvh_filename = std::string(get_cmd_option(argv, argv + argc, "-f"));
+
+    std::string ext = bvh_filename.substr(bvh_filename.size()-3);
+    if (ext.compare("bvh") != 0) {
+        std::cout << "please specify a .bvh file as input" << std::endl;
+        return 0;
+    }
+
+    std::string ray_filename = std::string(get_cmd_option(argv, argv + argc, "-r"));
+    std::string out_filename = ray_filename + ".hits";
+    if (cmd_option_exists(argv, argv+argc, "-o")) {
+        out_filename = std::string(get_cmd_option(argv, argv + argc, "-o"));
+    }
+
+    uint32_t depth = 0;
+    if (cmd_option_exists(argv, argv+argc, "-d")) {
+        depth = atoi(get_cmd_option(argv, argv+argc, "-d"));
+    }
+
+    struct ray_input_t {
+      scm::math::vec3f origin_;
+      scm::math::vec3f direction_;
+      float max_distance_;
+      bool valid_;
+    };
+    std::vector<ray_input_t> ray_inputs;
+
+    std::ifstream ray_file(ray_filename);
+    if (!ray_file.is_open()) {
+        std::cout << "unable to open ray file: " << ray_filename << std::endl;
+        return 1;
+    }
+
+    std::string line;
+    while (std::getline(ray_file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream line_ss(line);
+        float ox, oy, oz, dx, dy, dz;
+        if (!(line_ss >> ox >> oy >> oz >> dx >> dy >> dz)) {
+            std::cout << "skipping invalid ray: " << line << std::endl;
+            ray_inputs.push_back({scm::math::vec3f(0.f, 0.f, 0.f), scm::math::vec3f(0.f, 0.f, 0.f), 0.f, false});
+            continue;
+        }
+        // resolved against the bounding box of the model if not given
+        float max_distance = -1.f;
+        line_ss >> max_distance;
+
+        scm::math::vec3f direction(dx, dy, dz);
+        if (scm::math::length(direction) <= 0.f) {
+            std::cout << "skipping ray without direction: " << line << std::endl;
+            ray_inputs.push_back({scm::math::vec3f(0.f, 0.f, 0.f), scm::math::vec3f(0.f, 0.f, 0.f), 0.f, false});
+            continue;
+        }
+
+        ray_inputs.push_back({scm::math::vec3f(ox, oy, oz), scm::math::normalize(direction), max_distance, true});
+    }
+    ray_file.close();
+
+    std::cout << "rays: " << ray_inputs.size() << std::endl;
+
+    std::vector<lamure::ren::ray> rays;
+    std::vector<lamure::ren::ray::intersection> intersections;
+    size_t num_hits = 0;
+    double elapsed_ms = 0.0;
+
+    try {
+        lamure::ren::ooc_ray_query query(bvh_filename);
+
+        if (cmd_option_exists(argv, argv+argc, "-b")) {
+            query.set_node_budget(atoi(get_cmd_option(argv, argv+argc, "-b")));
+        }
+
+        const scm::gl::boxf& root_box = query.get_bvh()->get_bounding_boxes()[0];
+        scm::math::vec3f root_center = (root_box.min_vertex() + root_box.max_vertex()) * 0.5f;
+        float root_diagonal = scm::math::length(root_box.max_vertex() - root_box.min_vertex());
+
+        for (const auto& input : ray_inputs) {
+            if (!input.valid_) {
+                continue;
+            }
+            float max_distance = input.max_distance_;
+            if (max_distance <= 0.f) {
+                max_distance = scm::math::length(input.origin_ - root_center) + root_diagonal;
+            }
+            rays.push_back(lamure::ren::ray(input.origin_, input.direction_, max_distance));
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        num_hits = query.intersect(rays, scm::math::mat4f::identity(), depth, intersections);
+        elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        const auto& stats = query.get_statistics();
+        std::cout << "depth: " << (depth == 0 ? query.get_bvh()->get_depth() : std::min(depth, query.get_bvh()->get_depth())) << std::endl;
+        std::cout << "hits: " << num_hits << " / " << rays.size() << std::endl;
+        std::cout << "time: " << elapsed_ms << " ms" << std::endl;
+        std::cout << "nodes tested: " << stats.num_nodes_tested_ << std::endl;
+        std::cout << "nodes read: " << stats.num_nodes_read_ << std::endl;
+        std::cout << "bytes read: " << stats.bytes_read_ << std::endl;
+    }
+    catch (const std::runtime_error& e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+
+    std::ofstream out_file(out_filename);
+    out_file.precision(DEFAULT_PRECISION);
+
+    // one line per input ray: hit px py pz nx ny nz distance error, skipped rays are misses
+    size_t ray_id = 0;
+    for (const auto& input : ray_inputs) {
+        if (!input.valid_) {
+            out_file << "0" << std::endl;
+            continue;
+        }
+        const auto& intersection = intersections[ray_id++];
+        if (intersection.error_ == std::numeric_limits<float>::max()) {
+            out_file << "0" << std::endl;
+            continue;
+        }
+        out_file << "1 "
+                 << intersection.position_.x << " " << intersection.position_.y << " " << intersection.position_.z << " "
+                 << intersection.normal_.x << " " << intersection.normal_.y << " " << intersection.normal_.z << " "
+                 << intersection.distance_ << " " << intersection.error_ << std::endl;
+    }
+    out_file.close();
+
+    std::cout << "written to " << out_filename << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,155 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+
+#include <lamure/types.h>
+#include <lamure/ren/dataset.h>
+#include <lamure/ren/spatial_query.h>
+
+char* get_cmd_option(char** begin, char** end, const std::string & option) {
+    char** it = std::find(begin, end, option);
+    if (it != end && ++it != end)
+        return *it;
+    return 0;
+}
+
+bool cmd_option_exists(char** begin, char** end, const std::string& option) {
+    return std::find(begin, end, option) != end;
+}
+
+template<typename query_function_t>
+void run_benchmark(const std::string& name, lamure::ren::spatial_query& query, uint32_t num_queries, query_function_t query_function) {
+    query.reset_statistics();
+
+    std::vector<lamure::ren::dataset::serialized_surfel> surfels;
+    size_t num_surfels = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < num_queries; ++i) {
+        num_surfels += query_function(i, surfels);
+    }
+    double elapsed_s = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    const auto& stats = query.get_statistics();
+    std::cout << name << ": " << num_queries / elapsed_s << " queries/s"
+              << ", " << (double)num_surfels / num_queries << " surfels/query"
+              << ", " << (double)stats.num_nodes_read_ / num_queries << " nodes read/query"
+              << ", " << (double)stats.bytes_read_ / (elapsed_s * 1024.0 * 1024.0) << " MiB/s" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+
+    if (argc == 1 ||
+      cmd_option_exists(argv, argv+argc, "-h") ||
+      !cmd_option_exists(argv, argv+argc, "-f")) {
+
+      std::cout << "Usage: " << argv[0] << "<flags> -f <input_file>" << std::endl <<
+         "INFO: lod_spatial_query " << std::endl <<
+         "\t-f: selects .bvh input file, the .lod file is expected next to it" << std::endl <<
+         "\t    (-f flag is required) " << std::endl <<
+         "\t-n: number of queries per query type (optional)" << std::endl <<
+         "\t    (default: 1000)" << std::endl <<
+         "\t-s: query size relative to the model extent (optional)" << std::endl <<
+         "\t    (default: 0.05)" << std::endl <<
+         "\t-e: max error selecting the cut, 0 uses the leaves (optional)" << std::endl <<
+         "\t    (default: 0)" << std::endl <<
+         "\t-k: number of neighbours of the k-nn queries (optional)" << std::endl <<
+         "\t    (default: 16)" << std::endl <<
+         "\t-t: number of threads, 0 uses one per core (optional)" << std::endl <<
+         "\t    (default: 0)" << std::endl <<
+         std::endl;
+      return 0;
+    }
+
+    std::string bvh_filename = std::string(get_cmd_option(argv, argv + argc, "-f"));
+
+    std::string ext = bvh_filename.substr(bvh_filename.size()-3);
+    if (ext.compare("bvh") != 0) {
+        std::cout << "please specify a .bvh file as input" << std::endl;
+        return 0;
+    }
+
+    uint32_t num_queries = 1000;
+    if (cmd_option_exists(argv, argv+argc, "-n")) {
+        num_queries = std::max(1, atoi(get_cmd_option(argv, argv+argc, "-n")));
+    }
+    float relative_size = 0.05f;
+    if (cmd_option_exists(argv, argv+argc, "-s")) {
+        relative_size = atof(get_cmd_option(argv, argv+argc, "-s"));
+    }
+    float max_error = 0.f;
+    if (cmd_option_exists(argv, argv+argc, "-e")) {
+        max_error = atof(get_cmd_option(argv, argv+argc, "-e"));
+    }
+    uint32_t k = 16;
+    if (cmd_option_exists(argv, argv+argc, "-k")) {
+        k = atoi(get_cmd_option(argv, argv+argc, "-k"));
+    }
+    uint32_t num_threads = 0;
+    if (cmd_option_exists(argv, argv+argc, "-t")) {
+        num_threads = atoi(get_cmd_option(argv, argv+argc, "-t"));
+    }
+
+    try {
+        lamure::ren::spatial_query query(bvh_filename, num_threads);
+
+        const lamure::ren::bvh* bvh = query.get_bvh();
+        const scm::gl::boxf& root_box = bvh->get_bounding_boxes()[0];
+        scm::math::vec3f root_min = root_box.min_vertex();
+        scm::math::vec3f root_extent = root_box.max_vertex() - root_box.min_vertex();
+        float query_size = relative_size * std::max(root_extent.x, std::max(root_extent.y, root_extent.z));
+
+        std::cout << "nodes: " << bvh->get_num_nodes() << ", depth: " << bvh->get_depth()
+                  << ", surfels per node: " << bvh->get_primitives_per_node()
+                  << ", threads: " << query.num_threads() << std::endl;
+        std::cout << "query size: " << query_size << ", max error: " << max_error << std::endl;
+
+        // the same query centers for every query type
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<float> distribution(0.f, 1.f);
+        std::vector<scm::math::vec3f> centers(num_queries);
+        for (auto& center : centers) {
+            center = root_min + scm::math::vec3f(distribution(generator) * root_extent.x,
+                                                 distribution(generator) * root_extent.y,
+                                                 distribution(generator) * root_extent.z);
+        }
+
+        scm::math::vec3f half_size(0.5f * query_size);
+        run_benchmark("box", query, num_queries, [&](uint32_t i, std::vector<lamure::ren::dataset::serialized_surfel>& surfels) {
+            return query.query_box(scm::gl::boxf(centers[i] - half_size, centers[i] + half_size), max_error, surfels);
+        });
+
+        run_benchmark("sphere", query, num_queries, [&](uint32_t i, std::vector<lamure::ren::dataset::serialized_surfel>& surfels) {
+            return query.query_sphere(centers[i], 0.5f * query_size, max_error, surfels);
+        });
+
+        // narrow frusta looking from outside the query region at its center
+        scm::math::mat4f projection = scm::math::make_perspective_matrix(10.f, 1.f, 0.5f * query_size, 4.f * query_size);
+        run_benchmark("frustum", query, num_queries, [&](uint32_t i, std::vector<lamure::ren::dataset::serialized_surfel>& surfels) {
+            scm::math::vec3f eye = centers[i] + scm::math::vec3f(0.f, 0.f, 2.f * query_size);
+            scm::math::mat4f view = scm::math::make_look_at_matrix(eye, centers[i], scm::math::vec3f(0.f, 1.f, 0.f));
+            return query.query_frustum(projection * view, max_error, surfels);
+        });
+
+        run_benchmark("k-nn", query, num_queries, [&](uint32_t i, std::vector<lamure::ren::dataset::serialized_surfel>& surfels) {
+            return query.query_nearest(centers[i], k, max_error, surfels);
+        });
+    }
+    catch (const std::runtime_error& e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -15,6 +15,7 @@
 #include <lamure/pvs/visibility_test_id_histogram_renderer.h>
 #include <lamure/pvs/visibility_test_id_histogram_renderer_corners.h>
 #include <lamure/pvs/visibility_test_simple_randomized_id_histogram_renderer.h>
+#include <lamure/pvs/visibility_test_cpu_splat_renderer.h>
 
 #include <lamure/pvs/grid.h>
 #include <lamure/pvs/grid_octree.h>
@@ -55,6 +56,7 @@ int main(int argc, char** argv)
     unsigned int num_steps = 11;
     double oversize_factor = 1.5;
     float optimization_threshold = 1.0f;
+    std::string reference_pvs_file_path = "";
 
     namespace po = boost::program_options;
     namespace fs = boost::filesystem;
@@ -70,12 +72,13 @@ int main(int argc, char** argv)
                                "Allowed Options");
     desc.add_options()
       ("pvs-file,p", po::value<std::string>(&pvs_output_file_path), "specify output file of calculated pvs data (.pvs)")
-      ("vistest", po::value<std::string>(&visibility_test_type)->default_value("hrc"), "specify type of visibility test to be used. Default is histogram renderer with corners. (histogram renderer 'hr', histogram renderer with corners 'hrc', simple randomized histogram renderer 'srhr')")
-      ("gridtype", po::value<std::string>(&grid_type)->default_value("irregular_compressed"), "specify type of grid to store visibility data. Default is irregular compressed grid. ('regular', 'regular_compressed', 'irregular', 'irregular_compressed', octree', 'octree_compressed', octree_hierarchical', 'octree_hierarchical_v2', 'octree_hierarchical_v3')")
+      ("vistest", po::value<std::string>(&visibility_test_type)->default_value("hrc"), "specify type of visibility test to be used. Default is histogram renderer with corners. (histogram renderer 'hr', histogram renderer with corners 'hrc', simple randomized histogram renderer 'srhr', cpu splat renderer without OpenGL 'cpu')")
+      ("gridtype", po::value<std::string>(&grid_type)->default_value("irregular_compressed"), "specify type of grid to store visibility data. Default is irregular compressed grid. ('regular', 'regular_compressed', 'regular_run_length', 'irregular', 'irregular_compressed', octree', 'octree_compressed', octree_hierarchical', 'octree_hierarchical_v2', 'octree_hierarchical_v3')")
       ("gridsize", po::value<unsigned int>(&grid_size)->default_value(1), "specify size/depth of the grid used for the visibility test (depends on chosen grid type)")
       ("oversize", po::value<double>(&oversize_factor)->default_value(1.5), "factor the grid bounds will be scaled by. Default is 1.5 (so grid bounds will exceed scene bounds by factor of 1.5)")
       ("optithresh", po::value<float>(&optimization_threshold)->default_value(-1.0f), "specify the threshold at which common data are converged (percent value between 0 and 1). Negative values will deactivate optimization process. Default value is -1.0, so grid optimization is deactivated.")
-      ("numsteps,n", po::value<unsigned int>(&num_steps)->default_value(11), "specify the number of intervals the occlusion values will be split into (visibility analysis only). Default value is 11.");
+      ("numsteps,n", po::value<unsigned int>(&num_steps)->default_value(11), "specify the number of intervals the occlusion values will be split into (visibility analysis only). Default value is 11.")
+      ("reference", po::value<std::string>(&reference_pvs_file_path), "specify a pvs file (e.g. created by another visibility test) the result will be compared against. The grid file is expected next to it.");
       ;
 
     // Parse additonal passed parameters.
@@ -106,6 +109,10 @@ int main(int argc, char** argv)
     {
         vt = new lamure::pvs::visibility_test_simple_randomized_id_histogram_renderer();
     }
+    else if(visibility_test_type == "cpu")
+    {
+        vt = new lamure::pvs::visibility_test_cpu_splat_renderer();
+    }
     else
     {
         std::cout << "Invalid visibility test: " << visibility_test_type << ".\n" << desc;
@@ -275,6 +282,32 @@ int main(int argc, char** argv)
     bounding_grid->save_visibility_to_file(bounding_pvs_output_file_path);
     std::cout << "Finished saving bounding visibility data." << std::endl;
 
+    if(reference_pvs_file_path != "")
+    {
+        // Compare against visibility data of another run, e.g. a GPU visibility test on the same scene.
+        std::string reference_grid_file_path = reference_pvs_file_path;
+        reference_grid_file_path.resize(reference_grid_file_path.length() - 3);
+        reference_grid_file_path = reference_grid_file_path + "grid";
+
+        lamure::pvs::grid* reference_grid = lamure::pvs::pvs_database::get_instance()->load_grid_from_file(reference_grid_file_path, reference_pvs_file_path);
+
+        if(reference_grid != nullptr)
+        {
+            std::string comparison_file_path = pvs_output_file_path;
+            comparison_file_path.resize(comparison_file_path.size() - 4);
+            comparison_file_path += "_comparison.txt";
+
+            lamure::pvs::compare_grid_visibility(test_grid, reference_grid, comparison_file_path);
+            std::cout << "Finished comparison against reference pvs: " << comparison_file_path << std::endl;
+
+            delete reference_grid;
+        }
+        else
+        {
+            std::cout << "Could not load reference pvs: " << reference_pvs_file_path << std::endl;
+        }
+    }
+
 #ifdef PVS_MAIN_MEASURE_PERFORMANCE
     end_time = std::chrono::system_clock::now();
     elapsed_seconds = end_time - start_time;
@@ -9,12 +9,15 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include <chrono>
+#include <random>
 
 #include <lamure/pvs/pvs_database.h>
 #include <lamure/pvs/pvs_utils.h>
 
 #include <lamure/pvs/grid_regular.h>
 #include <lamure/pvs/grid_regular_compressed.h>
+#include <lamure/pvs/grid_regular_run_length.h>
 #include <lamure/pvs/grid_octree.h>
 #include <lamure/pvs/grid_octree_compressed.h>
 #include <lamure/pvs/grid_octree_hierarchical.h>
@@ -30,6 +33,8 @@
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
 
+void benchmark_visibility_queries(const std::string& pvs_file_path, const unsigned int& num_queries_per_cell);
+
 int main(int argc, char** argv)
 {
     // Read additional data from input parameters.
@@ -38,6 +43,7 @@ int main(int argc, char** argv)
     std::string pvs_output_file_path = "";
     std::string output_grid_type = "";
     float optimization_threshold = 1.0f;
+    unsigned int num_benchmark_queries = 0;
 
     namespace po = boost::program_options;
     namespace fs = boost::filesystem;
@@ -54,8 +60,9 @@ int main(int argc, char** argv)
       ("pvs-file", po::value<std::string>(&pvs_input_file_path), "specify input file of calculated pvs data (.pvs)")
       ("2nd-pvs-file", po::value<std::string>(&second_pvs_input_file_path), "(optional) specify second input file of calculated pvs data (.pvs) to join visibility with first pvs file")
       ("output-file", po::value<std::string>(&pvs_output_file_path), "specify output file of converted visibility data (.pvs)")
-      ("gridtype", po::value<std::string>(&output_grid_type), "specify type of grid to store visibility data. If no grid type is given, the input grid type will be used. ('regular', 'regular_compressed', 'irregular', 'irregular_compressed', octree', 'octree_compressed', octree_hierarchical', 'octree_hierarchical_v2', 'octree_hierarchical_v3')")
-      ("optithresh", po::value<float>(&optimization_threshold)->default_value(-1.0f), "specify the threshold at which common data are converged (percent value between 0 and 1). Negative values will deactivate optimization process. Default value is -1.0, so grid optimization is deactivated.");
+      ("gridtype", po::value<std::string>(&output_grid_type), "specify type of grid to store visibility data. If no grid type is given, the input grid type will be used. ('regular', 'regular_compressed', 'regular_run_length', 'irregular', 'irregular_compressed', octree', 'octree_compressed', octree_hierarchical', 'octree_hierarchical_v2', 'octree_hierarchical_v3')")
+      ("optithresh", po::value<float>(&optimization_threshold)->default_value(-1.0f), "specify the threshold at which common data are converged (percent value between 0 and 1). Negative values will deactivate optimization process. Default value is -1.0, so grid optimization is deactivated.")
+      ("benchmark", po::value<unsigned int>(&num_benchmark_queries)->default_value(0), "after conversion, compare file size, cell load time and visibility query time of input and output grid using the given number of random queries per view cell");
       ;
 
     po::variables_map vm;
@@ -103,6 +110,7 @@ int main(int argc, char** argv)
 
     if(input_grid->get_grid_type() != lamure::pvs::grid_regular::get_grid_identifier() && 
         input_grid->get_grid_type() != lamure::pvs::grid_regular_compressed::get_grid_identifier() && 
+        input_grid->get_grid_type() != lamure::pvs::grid_regular_run_length::get_grid_identifier() && 
         input_grid->get_grid_type() != lamure::pvs::grid_octree_hierarchical_v3::get_grid_identifier() &&
         input_grid->get_grid_type() != lamure::pvs::grid_irregular::get_grid_identifier() &&
         input_grid->get_grid_type() != lamure::pvs::grid_irregular_compressed::get_grid_identifier())
@@ -140,6 +148,7 @@ int main(int argc, char** argv)
 
         if(second_input_grid->get_grid_type() != lamure::pvs::grid_regular::get_grid_identifier() && 
             second_input_grid->get_grid_type() != lamure::pvs::grid_regular_compressed::get_grid_identifier() && 
+            second_input_grid->get_grid_type() != lamure::pvs::grid_regular_run_length::get_grid_identifier() && 
             second_input_grid->get_grid_type() != lamure::pvs::grid_octree_hierarchical_v3::get_grid_identifier() &&
             second_input_grid->get_grid_type() != lamure::pvs::grid_irregular::get_grid_identifier() &&
             second_input_grid->get_grid_type() != lamure::pvs::grid_irregular_compressed::get_grid_identifier())
@@ -209,7 +218,8 @@ int main(int argc, char** argv)
 
         size_t num_cells = depth;
         if(output_grid_type == lamure::pvs::grid_regular::get_grid_identifier() || 
-            output_grid_type == lamure::pvs::grid_regular_compressed::get_grid_identifier())
+            output_grid_type == lamure::pvs::grid_regular_compressed::get_grid_identifier() ||
+            output_grid_type == lamure::pvs::grid_regular_run_length::get_grid_identifier())
         {
             num_cells = cells_per_axis;
         }
@@ -318,5 +328,75 @@ int main(int argc, char** argv)
 
     std::cout << "\nConversion successful!" << std::endl;
 
+    if(num_benchmark_queries > 0)
+    {
+        delete input_grid;
+        delete output_grid;
+
+        benchmark_visibility_queries(pvs_input_file_path, num_benchmark_queries);
+        benchmark_visibility_queries(pvs_output_file_path, num_benchmark_queries);
+    }
+
     return 0;
 }
+
+void benchmark_visibility_queries(const std::string& pvs_file_path, const unsigned int& num_queries_per_cell)
+{
+    std::string grid_file_path = pvs_file_path;
+    grid_file_path.resize(grid_file_path.length() - 3);
+    grid_file_path += "grid";
+
+    lamure::pvs::grid* benchmark_grid = lamure::pvs::pvs_database::get_instance()->load_grid_from_file(grid_file_path);
+
+    if(benchmark_grid == nullptr || benchmark_grid->get_num_models() == 0)
+    {
+        std::cout << "Error loading grid for benchmark: " << grid_file_path << std::endl;
+        delete benchmark_grid;
+        return;
+    }
+
+    // Queries are generated up front, so only the visibility lookups are measured.
+    std::mt19937 generator(0);
+    std::vector<std::pair<lamure::model_t, lamure::node_t>> queries(num_queries_per_cell);
+
+    for(size_t query_index = 0; query_index < queries.size(); ++query_index)
+    {
+        lamure::model_t model_id = generator() % benchmark_grid->get_num_models();
+        lamure::node_t node_id = generator() % std::max(benchmark_grid->get_num_nodes(model_id), (lamure::node_t)1);
+        queries[query_index] = std::make_pair(model_id, node_id);
+    }
+
+    double load_time_in_ms = 0.0;
+    double query_time_in_ms = 0.0;
+    size_t num_visible = 0;
+
+    for(size_t cell_index = 0; cell_index < benchmark_grid->get_cell_count(); ++cell_index)
+    {
+        std::chrono::time_point<std::chrono::system_clock> start_time = std::chrono::system_clock::now();
+        benchmark_grid->load_cell_visibility_from_file(pvs_file_path, cell_index);
+        std::chrono::duration<double> load_duration = std::chrono::system_clock::now() - start_time;
+        load_time_in_ms += load_duration.count() * 1000.0;
+
+        const lamure::pvs::view_cell* current_cell = benchmark_grid->get_cell_at_index(cell_index);
+
+        start_time = std::chrono::system_clock::now();
+        for(const auto& query : queries)
+        {
+            num_visible += current_cell->get_visibility(query.first, query.second) ? 1 : 0;
+        }
+        std::chrono::duration<double> query_duration = std::chrono::system_clock::now() - start_time;
+        query_time_in_ms += query_duration.count() * 1000.0;
+
+        benchmark_grid->clear_cell_visibility(cell_index);
+    }
+
+    size_t num_cells = std::max(benchmark_grid->get_cell_count(), (size_t)1);
+    double num_queries = (double)num_cells * (double)queries.size();
+
+    std::cout << "\n" << pvs_file_path << " (" << benchmark_grid->get_grid_type() << ")" << std::endl;
+    std::cout << "file size: " << boost::filesystem::file_size(pvs_file_path) << " bytes" << std::endl;
+    std::cout << "cell load: " << load_time_in_ms / (double)num_cells << " ms" << std::endl;
+    std::cout << "query: " << (query_time_in_ms * 1000000.0) / num_queries << " ns/op (" << num_visible << " visible)" << std::endl;
+
+    delete benchmark_grid;
+}
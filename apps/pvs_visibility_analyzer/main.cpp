@@ -10,7 +10,11 @@
 #include <vector>
 #include <iostream>
 #include <fstream>
+#include <chrono>
+#include <map>
+#include <random>
 
+#include <lamure/pvs/id_histogram.h>
 #include <lamure/pvs/pvs_database.h>
 #include <lamure/pvs/pvs_utils.h>
 #include <lamure/pvs/view_cell_regular.h>
@@ -19,6 +23,8 @@
 #include <boost/filesystem.hpp>
 
 void compare_grid_visibility(std::string visibility_path_one, std::string visibility_path_two, unsigned int num_steps);
+void benchmark_visibility_loading(std::string visibility_path, unsigned int num_repetitions);
+void benchmark_id_histogram(unsigned int num_repetitions, unsigned int num_threads);
 
 int main(int argc, char** argv)
 {
@@ -26,6 +32,9 @@ int main(int argc, char** argv)
     std::string pvs_input_file_path = "";
     std::string second_pvs_input_file_path = "";
     unsigned int num_steps = 11;
+    unsigned int num_benchmark_repetitions = 0;
+    unsigned int num_histogram_repetitions = 0;
+    unsigned int num_histogram_threads = 0;
 
     namespace po = boost::program_options;
     namespace fs = boost::filesystem;
@@ -41,7 +50,10 @@ int main(int argc, char** argv)
     desc.add_options()
       ("pvs-file,p", po::value<std::string>(&pvs_input_file_path), "specify input file of calculated pvs data (.pvs)")
       ("2nd-pvs-file", po::value<std::string>(&second_pvs_input_file_path), "specify input file of calculated pvs data (.pvs)")
-      ("numsteps,n", po::value<unsigned int>(&num_steps)->default_value(11), "specify the number of intervals the occlusion values will be split into");
+      ("numsteps,n", po::value<unsigned int>(&num_steps)->default_value(11), "specify the number of intervals the occlusion values will be split into")
+      ("benchmark-loading", po::value<unsigned int>(&num_benchmark_repetitions)->default_value(0), "measure the time to load the visibility data of the pvs file (complete and per cell), repeated the given number of times")
+      ("benchmark-histogram", po::value<unsigned int>(&num_histogram_repetitions)->default_value(0), "measure the id histogram evaluation of six synthetic 4K (3840x2160) cube faces, repeated the given number of times (needs no pvs file)")
+      ("histogram-threads", po::value<unsigned int>(&num_histogram_threads)->default_value(0), "specify number of threads used by the histogram benchmark (default=number of cores)");
       ;
 
     po::variables_map vm;
@@ -49,14 +61,24 @@ int main(int argc, char** argv)
     po::store(parsed_options, vm);
     po::notify(vm);
 
+    if(num_histogram_repetitions > 0)
+    {
+        benchmark_id_histogram(num_histogram_repetitions, num_histogram_threads);
+        return 0;
+    }
+
     if(pvs_input_file_path == "")
     {
         std::cout << "Please specifiy PVS input file path.\n" << desc;
         return 0;
     }
 
+    if(num_benchmark_repetitions > 0)
+    {
+        benchmark_visibility_loading(pvs_input_file_path, num_benchmark_repetitions);
+    }
     // First case: only one data set given, so analyze visibility of the given data set.
-    if(second_pvs_input_file_path == "")
+    else if(second_pvs_input_file_path == "")
     {
         // Load pvs and grid data.
         std::string pvs_grid_input_file_path = pvs_input_file_path;
@@ -239,3 +261,157 @@ void compare_grid_visibility(std::string visibility_path_one, std::string visibi
 
     std::cout << "Results written to " << output_file_name << std::endl;
 }
+
+void benchmark_visibility_loading(std::string visibility_path, unsigned int num_repetitions)
+{
+    std::string pvs_grid_input_file_path = visibility_path;
+    pvs_grid_input_file_path.resize(pvs_grid_input_file_path.length() - 3);
+    pvs_grid_input_file_path += "grid";
+
+    double complete_load_time_in_ms = 0.0;
+    double cell_load_time_in_ms = 0.0;
+    double max_cell_load_time_in_ms = 0.0;
+    size_t num_cells = 0;
+
+    for(unsigned int repetition = 0; repetition < num_repetitions; ++repetition)
+    {
+        // Grid structure only, visibility data is loaded separately to measure it alone.
+        lamure::pvs::grid* benchmark_grid = lamure::pvs::pvs_database::get_instance()->load_grid_from_file(pvs_grid_input_file_path);
+
+        if(benchmark_grid == nullptr)
+        {
+            std::cout << "Not able to load grid file: " << pvs_grid_input_file_path << std::endl;
+            return;
+        }
+
+        std::chrono::time_point<std::chrono::system_clock> start_time = std::chrono::system_clock::now();
+
+        if(!benchmark_grid->load_visibility_from_file(visibility_path))
+        {
+            std::cout << "Not able to load visibility file: " << visibility_path << std::endl;
+            delete benchmark_grid;
+            return;
+        }
+
+        std::chrono::duration<double> load_duration = std::chrono::system_clock::now() - start_time;
+        complete_load_time_in_ms += load_duration.count() * 1000.0;
+
+        // Load single cells the way the pvs_database does it whenever the viewer enters a new cell.
+        num_cells = benchmark_grid->get_cell_count();
+
+        for(size_t cell_index = 0; cell_index < num_cells; ++cell_index)
+        {
+            benchmark_grid->clear_cell_visibility(cell_index);
+        }
+
+        for(size_t cell_index = 0; cell_index < num_cells; ++cell_index)
+        {
+            start_time = std::chrono::system_clock::now();
+            benchmark_grid->load_cell_visibility_from_file(visibility_path, cell_index);
+            load_duration = std::chrono::system_clock::now() - start_time;
+
+            double load_time_in_ms = load_duration.count() * 1000.0;
+            cell_load_time_in_ms += load_time_in_ms;
+            max_cell_load_time_in_ms = std::max(max_cell_load_time_in_ms, load_time_in_ms);
+
+            benchmark_grid->clear_cell_visibility(cell_index);
+        }
+
+        delete benchmark_grid;
+    }
+
+    std::cout << "visibility loading of " << visibility_path << " (" << num_cells << " cells, " << num_repetitions << " repetitions)" << std::endl;
+    std::cout << "complete load: " << complete_load_time_in_ms / (double)num_repetitions << " ms" << std::endl;
+    std::cout << "cell load: " << cell_load_time_in_ms / (double)(num_repetitions * std::max(num_cells, (size_t)1)) << " ms (average), " << max_cell_load_time_in_ms << " ms (max)" << std::endl;
+}
+
+void benchmark_id_histogram(unsigned int num_repetitions, unsigned int num_threads)
+{
+    const size_t width = 3840;
+    const size_t height = 2160;
+    const size_t num_faces = 6;
+    const size_t num_pixels = width * height;
+    const float visibility_threshold = 0.0001f;
+
+    // Fill the faces with rectangular splats of random nodes of two models, leaving some background.
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<uint32_t> node_distribution(0, 200000);
+    std::uniform_int_distribution<uint32_t> model_distribution(0, 1);
+    std::uniform_int_distribution<size_t> size_distribution(2, 24);
+    std::uniform_int_distribution<size_t> x_distribution(0, width - 1);
+    std::uniform_int_distribution<size_t> y_distribution(0, height - 1);
+
+    std::vector<std::vector<uint32_t>> faces(num_faces, std::vector<uint32_t>(num_pixels, 0));
+
+    for(std::vector<uint32_t>& face : faces)
+    {
+        for(size_t splat_index = 0; splat_index < 200000; ++splat_index)
+        {
+            // Same encoding as the id buffers, model ID is stored inverted in the alpha channel.
+            uint32_t pixel_value = ((255 - model_distribution(generator)) << 24) | node_distribution(generator);
+            size_t splat_x = x_distribution(generator);
+            size_t splat_y = y_distribution(generator);
+            size_t splat_size = size_distribution(generator);
+
+            for(size_t y = splat_y; y < std::min(height, splat_y + splat_size); ++y)
+            {
+                std::fill(face.begin() + y * width + splat_x, face.begin() + y * width + std::min(width, splat_x + splat_size), pixel_value);
+            }
+        }
+    }
+
+    double map_time_in_ms = 0.0;
+    double histogram_time_in_ms = 0.0;
+    bool results_equal = true;
+
+    for(unsigned int repetition = 0; repetition < num_repetitions; ++repetition)
+    {
+        for(const std::vector<uint32_t>& face : faces)
+        {
+            // Reference: tree map accumulation as done before the id_histogram used hash tables.
+            std::chrono::time_point<std::chrono::system_clock> start_time = std::chrono::system_clock::now();
+
+            std::map<lamure::model_t, std::map<lamure::node_t, size_t>> map_histogram;
+            for(size_t pixel_index = 0; pixel_index < num_pixels; ++pixel_index)
+            {
+                lamure::model_t model_id = 255 - ((face[pixel_index] >> 24) & 0xFF);
+
+                if(model_id != 255)
+                {
+                    map_histogram[model_id][face[pixel_index] & 0xFFFFFF]++;
+                }
+            }
+
+            std::map<lamure::model_t, std::vector<lamure::node_t>> map_visible_nodes;
+            for(const auto& model_histogram : map_histogram)
+            {
+                for(const auto& node_count : model_histogram.second)
+                {
+                    if(((float)node_count.second / (float)num_pixels) * 100.0f >= visibility_threshold)
+                    {
+                        map_visible_nodes[model_histogram.first].push_back(node_count.first);
+                    }
+                }
+            }
+
+            std::chrono::duration<double> duration = std::chrono::system_clock::now() - start_time;
+            map_time_in_ms += duration.count() * 1000.0;
+
+            start_time = std::chrono::system_clock::now();
+
+            lamure::pvs::id_histogram hist;
+            hist.create(face.data(), num_pixels, num_threads);
+            std::map<lamure::model_t, std::vector<lamure::node_t>> visible_nodes = hist.get_visible_nodes(num_pixels, visibility_threshold);
+
+            duration = std::chrono::system_clock::now() - start_time;
+            histogram_time_in_ms += duration.count() * 1000.0;
+
+            results_equal = results_equal && (visible_nodes == map_visible_nodes);
+        }
+    }
+
+    std::cout << "id histogram of " << num_faces << " faces with " << width << "x" << height << " pixels (" << num_repetitions << " repetitions)" << std::endl;
+    std::cout << "tree map: " << map_time_in_ms / (double)num_repetitions << " ms per cell" << std::endl;
+    std::cout << "id_histogram: " << histogram_time_in_ms / (double)num_repetitions << " ms per cell" << std::endl;
+    std::cout << "results " << (results_equal ? "equal" : "DIFFER") << std::endl;
+}
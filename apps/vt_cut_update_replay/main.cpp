@@ -0,0 +1,720 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+// headless replay of the virtual texture cut update: emulates the feedback pass of the
+// renderers on the cpu and drives CutUpdate and the TileProvider against an .atlas file,
+// either along a camera path over a plane or a sphere (as in vt_planets) or along a
+// recorded feedback session, and reports per-frame streaming statistics.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <cstring>
+
+#include <lamure/vt/VTConfig.h>
+#include <lamure/vt/ren/CutDatabase.h>
+#include <lamure/vt/ren/CutUpdate.h>
+
+char* get_cmd_option(char** begin, char** end, const std::string & option) {
+    char** it = std::find(begin, end, option);
+    if (it != end && ++it != end)
+        return *it;
+    return 0;
+}
+
+bool cmd_option_exists(char** begin, char** end, const std::string& option) {
+    return std::find(begin, end, option) != end;
+}
+
+struct vec3 {
+    double x_, y_, z_;
+};
+
+vec3 operator+(const vec3& a, const vec3& b) { return vec3{a.x_ + b.x_, a.y_ + b.y_, a.z_ + b.z_}; }
+vec3 operator-(const vec3& a, const vec3& b) { return vec3{a.x_ - b.x_, a.y_ - b.y_, a.z_ - b.z_}; }
+vec3 operator*(const vec3& a, const double s) { return vec3{a.x_ * s, a.y_ * s, a.z_ * s}; }
+double dot(const vec3& a, const vec3& b) { return a.x_ * b.x_ + a.y_ * b.y_ + a.z_ * b.z_; }
+vec3 cross(const vec3& a, const vec3& b) { return vec3{a.y_ * b.z_ - a.z_ * b.y_, a.z_ * b.x_ - a.x_ * b.z_, a.x_ * b.y_ - a.y_ * b.x_}; }
+vec3 normalize(const vec3& a) { return a * (1.0 / std::sqrt(dot(a, a))); }
+
+struct camera_view {
+    vec3 eye_;
+    vec3 target_;
+    vec3 up_;
+};
+
+// one sampled fragment of the feedback pass: texture coordinates in the quad tree of the atlas
+// and the level of detail the fragment asks for
+struct feedback_sample {
+    float u_;
+    float v_;
+    int32_t level_;
+};
+
+enum class layout_type {
+    PLANE,
+    SPHERE
+};
+
+// per-frame counters, tile counters are deltas of TileProvider::getStatistics()
+struct frame_statistics {
+    float dispatch_ms_ = 0.f;
+    double converge_ms_ = -1.0;
+    size_t cut_size_ = 0;
+    size_t num_samples_ = 0;
+    size_t num_unsatisfied_ = 0;
+    size_t num_uploaded_ = 0;
+    size_t num_allocated_slots_ = 0;
+    vt::ooc::TileStatistics tiles_;
+};
+
+std::vector<camera_view> parse_camera_path_file(const std::string& camera_path_file_path) {
+
+    std::ifstream camera_path_file(camera_path_file_path);
+    std::string line;
+    std::vector<camera_view> views;
+
+    while (std::getline(camera_path_file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream line_stream(line);
+        camera_view view{{0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}, {0.0, 1.0, 0.0}};
+        line_stream >> view.eye_.x_ >> view.eye_.y_ >> view.eye_.z_ >> view.target_.x_ >> view.target_.y_ >> view.target_.z_;
+
+        if (!line_stream) {
+            continue;
+        }
+
+        // the up vector is optional
+        vec3 up;
+        if (line_stream >> up.x_ >> up.y_ >> up.z_) {
+            view.up_ = up;
+        }
+
+        views.push_back(view);
+    }
+
+    return views;
+}
+
+// one frame per line, written as "u v level" triples
+std::vector<std::vector<feedback_sample>> parse_feedback_session_file(const std::string& session_file_path) {
+
+    std::ifstream session_file(session_file_path);
+    std::string line;
+    std::vector<std::vector<feedback_sample>> frames;
+
+    while (std::getline(session_file, line)) {
+        std::istringstream line_stream(line);
+        std::vector<feedback_sample> samples;
+        feedback_sample sample;
+
+        while (line_stream >> sample.u_ >> sample.v_ >> sample.level_) {
+            samples.push_back(sample);
+        }
+
+        frames.push_back(samples);
+    }
+
+    return frames;
+}
+
+void write_feedback_session_frame(std::ofstream& session_file, const std::vector<feedback_sample>& samples) {
+    for (size_t i = 0; i < samples.size(); ++i) {
+        session_file << (i == 0 ? "" : " ") << samples[i].u_ << " " << samples[i].v_ << " " << samples[i].level_;
+    }
+    session_file << "\n";
+}
+
+// the plane spans [0, 1] in x and y at z = 0, the sphere is a unit sphere around the origin
+camera_view default_camera_view(const layout_type layout, const uint32_t frame, const uint32_t num_frames, const uint32_t num_laps) {
+
+    const double pi = 3.14159265358979323846;
+    double t = (double)frame / (double)std::max(1u, num_frames);
+    double angle = 2.0 * pi * (double)num_laps * t;
+
+    if (layout == layout_type::PLANE) {
+        // pan across the plane and zoom from an overview down to texel level and back out once per lap
+        double zoom = 0.5 - 0.5 * std::cos(angle);
+        double height = std::exp(std::log(1.5) + (std::log(0.002) - std::log(1.5)) * zoom);
+
+        vec3 target{0.5 + 0.35 * std::sin(2.0 * pi * t), 0.5 + 0.35 * std::sin(4.0 * pi * t), 0.0};
+        return camera_view{target + vec3{0.0, -0.5 * height, height}, target, {0.0, 1.0, 0.0}};
+    }
+
+    // fly towards the sphere during the first half of the orbit and back out again
+    double distance = 1.02 + 2.0 * std::abs(std::cos(angle * 0.5));
+    vec3 direction = normalize(vec3{std::sin(angle), 0.3, std::cos(angle)});
+
+    return camera_view{direction * distance, {0.0, 0.0, 0.0}, {0.0, 1.0, 0.0}};
+}
+
+// texture coordinates of the layout under the given ray, in [0, 1] over the image
+bool intersect_layout(const layout_type layout, const vec3& origin, const vec3& direction, double& u, double& v) {
+
+    const double pi = 3.14159265358979323846;
+
+    if (layout == layout_type::PLANE) {
+        if (std::abs(direction.z_) < 1e-12) {
+            return false;
+        }
+
+        double t = -origin.z_ / direction.z_;
+        if (t <= 0.0) {
+            return false;
+        }
+
+        vec3 hit = origin + direction * t;
+        if (hit.x_ < 0.0 || hit.x_ >= 1.0 || hit.y_ < 0.0 || hit.y_ >= 1.0) {
+            return false;
+        }
+
+        u = hit.x_;
+        v = 1.0 - hit.y_;
+        return true;
+    }
+
+    double b = dot(origin, direction);
+    double c = dot(origin, origin) - 1.0;
+    double discriminant = b * b - c;
+    if (discriminant < 0.0) {
+        return false;
+    }
+
+    double t = -b - std::sqrt(discriminant);
+    if (t <= 0.0) {
+        return false;
+    }
+
+    vec3 hit = normalize(origin + direction * t);
+
+    // equirectangular, as the planet atlases
+    u = std::min(std::max(0.5 + std::atan2(hit.x_, hit.z_) / (2.0 * pi), 0.0), std::nextafter(1.0, 0.0));
+    v = std::min(std::max(std::acos(std::max(-1.0, std::min(1.0, hit.y_))) / pi, 0.0), std::nextafter(1.0, 0.0));
+    return true;
+}
+
+// cpu version of the feedback pass: every sample_distance-th fragment in x and y derives the level of detail
+// from the screen space derivatives of its texture coordinates, as dxdy() of the virtual texturing shaders
+std::vector<feedback_sample> generate_feedback_samples(const layout_type layout, const camera_view& view,
+                                                       const int32_t width, const int32_t height, const double fov_y,
+                                                       const int32_t sample_distance, const double uv_scale_x, const double uv_scale_y,
+                                                       const uint32_t tile_size, const int32_t max_level) {
+
+    std::vector<feedback_sample> samples;
+
+    vec3 forward = normalize(view.target_ - view.eye_);
+    vec3 right = normalize(cross(forward, view.up_));
+    vec3 up = cross(right, forward);
+
+    double tan_half_fov = std::tan(fov_y * 0.5);
+    double aspect = (double)width / (double)height;
+
+    auto ray_direction = [&](double px, double py) {
+        double x = (2.0 * px / width - 1.0) * tan_half_fov * aspect;
+        double y = (1.0 - 2.0 * py / height) * tan_half_fov;
+        return normalize(forward + right * x + up * y);
+    };
+
+    for (int32_t py = 0; py < height; py += sample_distance) {
+        for (int32_t px = 0; px < width; px += sample_distance) {
+            double u, v, u_dx, v_dx, u_dy, v_dy;
+
+            if (!intersect_layout(layout, view.eye_, ray_direction(px + 0.5, py + 0.5), u, v) ||
+                !intersect_layout(layout, view.eye_, ray_direction(px + 1.5, py + 0.5), u_dx, v_dx) ||
+                !intersect_layout(layout, view.eye_, ray_direction(px + 0.5, py + 1.5), u_dy, v_dy)) {
+                continue;
+            }
+
+            // the sphere wraps around in u
+            double du_dx = u_dx - u;
+            double du_dy = u_dy - u;
+            if (layout == layout_type::SPHERE) {
+                du_dx -= std::round(du_dx);
+                du_dy -= std::round(du_dy);
+            }
+
+            du_dx *= uv_scale_x;
+            du_dy *= uv_scale_x;
+            double dv_dx = (v_dx - v) * uv_scale_y;
+            double dv_dy = (v_dy - v) * uv_scale_y;
+
+            double dx_sq_norm = du_dx * du_dx + dv_dx * dv_dx;
+            double dy_sq_norm = du_dy * du_dy + dv_dy * dv_dy;
+            double min_sq_norm = std::min(dx_sq_norm, dy_sq_norm);
+
+            double lambda = min_sq_norm > 0.0 ? -0.5 * std::log2((double)tile_size * tile_size * min_sq_norm) : (double)max_level;
+            int32_t level = std::max(0, std::min((int32_t)std::ceil(lambda), max_level));
+
+            samples.push_back(feedback_sample{(float)(u * uv_scale_x), (float)(v * uv_scale_y), level});
+        }
+    }
+
+    return samples;
+}
+
+// looks every sample up in the index of the drawn cut, as the shaders do, and writes the maximum
+// requested level per memory slot at the compact position of the slot. returns the number of samples
+// drawn with a coarser tile than requested
+size_t resolve_feedback_samples(const std::vector<feedback_sample>& samples, vt::CutState* cut_state, vt::ContextFeedback* context_feedback,
+                                const size_t size_mem_x, const size_t size_mem_y, std::vector<int32_t>& feedback_lod) {
+
+    std::fill(feedback_lod.begin(), feedback_lod.end(), 0);
+
+    size_t num_unsatisfied = 0;
+
+    for (const feedback_sample& sample : samples) {
+        bool found = false;
+
+        for (int32_t level = sample.level_; level >= 0 && !found; --level) {
+            size_t tiles_per_row = (size_t)1 << level;
+            size_t x = std::min((size_t)(sample.u_ * tiles_per_row), tiles_per_row - 1);
+            size_t y = std::min((size_t)(sample.v_ * tiles_per_row), tiles_per_row - 1);
+
+            const uint8_t* index_entry = &cut_state->get_index((uint16_t)level)[(y * tiles_per_row + x) * 4];
+
+            if (index_entry[3] != 1) {
+                continue;
+            }
+
+            size_t position = index_entry[0] + index_entry[1] * size_mem_x + index_entry[2] * size_mem_x * size_mem_y;
+            uint32_t compact_position = context_feedback->get_compact_position((uint32_t)position);
+
+            feedback_lod[compact_position] = std::max(feedback_lod[compact_position], sample.level_);
+
+            if (level < sample.level_) {
+                ++num_unsatisfied;
+            }
+
+            found = true;
+        }
+
+        if (!found) {
+            ++num_unsatisfied;
+        }
+    }
+
+    return num_unsatisfied;
+}
+
+vt::ooc::TileStatistics difference(const vt::ooc::TileStatistics& current, const vt::ooc::TileStatistics& previous) {
+    vt::ooc::TileStatistics delta = current;
+    delta.hits -= previous.hits;
+    delta.misses -= previous.misses;
+    delta.requested -= previous.requested;
+    delta.loaded -= previous.loaded;
+    delta.evicted -= previous.evicted;
+    delta.depletions -= previous.depletions;
+    return delta;
+}
+
+const char* cache_policy_name(vt::VTConfig::CACHE_POLICY cache_policy) {
+    switch (cache_policy) {
+        case vt::VTConfig::CACHE_POLICY::FIFO: return "FIFO";
+        case vt::VTConfig::CACHE_POLICY::CLOCK_PRO: return "CLOCK_PRO";
+        case vt::VTConfig::CACHE_POLICY::LEVEL: return "LEVEL";
+    }
+    return "";
+}
+
+double hit_rate(const vt::ooc::TileStatistics& statistics) {
+    uint64_t lookups = statistics.hits + statistics.misses;
+    return lookups == 0 ? 0.0 : (double)statistics.hits / lookups;
+}
+
+int main(int argc, char *argv[]) {
+
+    if (argc == 1 ||
+        cmd_option_exists(argv, argv+argc, "-h") ||
+        !cmd_option_exists(argv, argv+argc, "-f") ||
+        !cmd_option_exists(argv, argv+argc, "-c")) {
+
+        std::cout << "Usage: " << argv[0] << " <flags> -f <input_file> -c <config_file>" << std::endl <<
+            "INFO: vt_cut_update_replay " << std::endl <<
+            "\t-f: selects .atlas input file" << std::endl <<
+            "\t    (-f flag is required) " << std::endl <<
+            "\t-c: selects virtual texturing .ini configuration file" << std::endl <<
+            "\t    (-c flag is required) " << std::endl <<
+            "\t-g: layout the atlas is mapped onto, plane or sphere (default: plane)" << std::endl <<
+            "\t-p: camera path file, one view per line as eye and target position," << std::endl <<
+            "\t    optionally followed by the up vector (default: fly over the layout)" << std::endl <<
+            "\t-i: replay a feedback session file instead of a camera path" << std::endl <<
+            "\t-o: write the feedback samples of each frame to the given session file" << std::endl <<
+            "\t-n: number of frames (default: 1000)" << std::endl <<
+            "\t-l: number of laps of the default camera path (default: 1)" << std::endl <<
+            "\t-w: window width (default: 1920)" << std::endl <<
+            "\t-x: window height (default: 1080)" << std::endl <<
+            "\t-d: distance in pixels between feedback samples (default: 64)" << std::endl <<
+            "\t-m: RAM cache size in MB (default: from the configuration file)" << std::endl <<
+            "\t-v: physical texture size in MB (default: from the configuration file)" << std::endl <<
+            "\t-u: physical texture update throughput in MB (default: from the configuration file)" << std::endl <<
+            "\t-t: number of loader threads (default: from the configuration file)" << std::endl <<
+            "\t-e: RAM cache replacement policy, FIFO, CLOCK_PRO or LEVEL" << std::endl <<
+            "\t    (default: from the configuration file)" << std::endl <<
+            "\t-r: frames per second the session is replayed at, 0 replays" << std::endl <<
+            "\t    as fast as possible (default: 60)" << std::endl <<
+            "\t-a: hold every frame until its cut converged or the given time" << std::endl <<
+            "\t    in ms passed, and report the time to converge per frame" << std::endl <<
+            "\t-s: time in ms the last view is held to measure" << std::endl <<
+            "\t    the time to converge (default: 5000)" << std::endl <<
+            std::endl;
+        return 0;
+    }
+
+    std::string atlas_filename = std::string(get_cmd_option(argv, argv + argc, "-f"));
+
+    layout_type layout = layout_type::PLANE;
+    if (cmd_option_exists(argv, argv+argc, "-g")) {
+        std::string layout_name = get_cmd_option(argv, argv+argc, "-g");
+        if (layout_name == "sphere") {
+            layout = layout_type::SPHERE;
+        }
+        else if (layout_name != "plane") {
+            std::cout << "unknown layout: " << layout_name << std::endl;
+            return 0;
+        }
+    }
+
+    uint32_t num_frames = 1000;
+    if (cmd_option_exists(argv, argv+argc, "-n")) {
+        num_frames = atoi(get_cmd_option(argv, argv+argc, "-n"));
+    }
+
+    uint32_t num_laps = 1;
+    if (cmd_option_exists(argv, argv+argc, "-l")) {
+        num_laps = std::max(1, atoi(get_cmd_option(argv, argv+argc, "-l")));
+    }
+
+    int32_t window_width = 1920;
+    if (cmd_option_exists(argv, argv+argc, "-w")) {
+        window_width = std::max(1, atoi(get_cmd_option(argv, argv+argc, "-w")));
+    }
+
+    int32_t window_height = 1080;
+    if (cmd_option_exists(argv, argv+argc, "-x")) {
+        window_height = std::max(1, atoi(get_cmd_option(argv, argv+argc, "-x")));
+    }
+
+    // the feedback pass of the renderers writes every 64th fragment in x and y
+    int32_t sample_distance = 64;
+    if (cmd_option_exists(argv, argv+argc, "-d")) {
+        sample_distance = std::max(1, atoi(get_cmd_option(argv, argv+argc, "-d")));
+    }
+
+    float frames_per_second = 60.f;
+    if (cmd_option_exists(argv, argv+argc, "-r")) {
+        frames_per_second = atof(get_cmd_option(argv, argv+argc, "-r"));
+    }
+
+    bool await_convergence = cmd_option_exists(argv, argv+argc, "-a");
+    double max_converge_time_in_ms = 0.0;
+    if (await_convergence) {
+        max_converge_time_in_ms = atof(get_cmd_option(argv, argv+argc, "-a"));
+    }
+
+    double settle_time_in_ms = 5000.0;
+    if (cmd_option_exists(argv, argv+argc, "-s")) {
+        settle_time_in_ms = atof(get_cmd_option(argv, argv+argc, "-s"));
+    }
+
+    std::vector<camera_view> camera_path;
+    if (cmd_option_exists(argv, argv+argc, "-p")) {
+        camera_path = parse_camera_path_file(get_cmd_option(argv, argv+argc, "-p"));
+        if (camera_path.empty()) {
+            std::cout << "camera path file is empty" << std::endl;
+            return 0;
+        }
+        num_frames = camera_path.size();
+    }
+
+    std::vector<std::vector<feedback_sample>> session_frames;
+    if (cmd_option_exists(argv, argv+argc, "-i")) {
+        session_frames = parse_feedback_session_file(get_cmd_option(argv, argv+argc, "-i"));
+        if (session_frames.empty()) {
+            std::cout << "feedback session file is empty" << std::endl;
+            return 0;
+        }
+        num_frames = session_frames.size();
+    }
+
+    std::ofstream session_output_file;
+    if (cmd_option_exists(argv, argv+argc, "-o")) {
+        session_output_file.open(get_cmd_option(argv, argv+argc, "-o"), std::ios::trunc);
+        if (!session_output_file.is_open()) {
+            std::cout << "could not open feedback session file for writing" << std::endl;
+            return 0;
+        }
+    }
+
+    vt::VTConfig::CONFIG_PATH = get_cmd_option(argv, argv+argc, "-c");
+    vt::VTConfig* config = &vt::VTConfig::get_instance();
+
+    if (cmd_option_exists(argv, argv+argc, "-m")) {
+        config->set_size_ram_cache(atoi(get_cmd_option(argv, argv+argc, "-m")));
+    }
+    if (cmd_option_exists(argv, argv+argc, "-v")) {
+        config->set_size_physical_texture(atoi(get_cmd_option(argv, argv+argc, "-v")));
+    }
+    if (cmd_option_exists(argv, argv+argc, "-u")) {
+        config->set_size_physical_update_throughput(atoi(get_cmd_option(argv, argv+argc, "-u")));
+    }
+    if (cmd_option_exists(argv, argv+argc, "-t")) {
+        config->set_num_loader_threads(atoi(get_cmd_option(argv, argv+argc, "-t")));
+    }
+    if (cmd_option_exists(argv, argv+argc, "-e")) {
+        std::string cache_policy = get_cmd_option(argv, argv+argc, "-e");
+        try {
+            config->set_cache_policy(vt::VTConfig::which_cache_policy(cache_policy.c_str()));
+        }
+        catch (const std::runtime_error&) {
+            std::cout << "unknown cache policy: " << cache_policy << std::endl;
+            return 0;
+        }
+    }
+
+    // limits of the gl implementation the renderers query, as passed by vt_planets
+    config->define_size_physical_texture(64, 8192);
+
+    vt::CutDatabase* cut_db = &vt::CutDatabase::get_instance();
+
+    uint32_t dataset_id = cut_db->register_dataset(atlas_filename);
+    uint16_t view_id = cut_db->register_view();
+    uint16_t context_id = cut_db->register_context();
+    uint64_t cut_id = cut_db->register_cut(dataset_id, view_id, context_id);
+
+    vt::pre::AtlasFile* atlas = (*cut_db->get_cut_map())[cut_id]->get_atlas();
+
+    if (atlas->getTileWidth() != config->get_size_tile()) {
+        std::cout << "tile size of the atlas (" << atlas->getTileWidth() << ") does not match the configuration (" << config->get_size_tile() << ")" << std::endl;
+        return 0;
+    }
+
+    const int32_t max_level = (int32_t)atlas->getDepth() - 1;
+    const double uv_scale_x = ((double)atlas->getImageWidth() / atlas->getInnerTileWidth()) / (double)((size_t)1 << max_level);
+    const double uv_scale_y = ((double)atlas->getImageHeight() / atlas->getInnerTileHeight()) / (double)((size_t)1 << max_level);
+    const double fov_y = 60.0 * 3.14159265358979323846 / 180.0;
+
+    const size_t size_mem_x = cut_db->get_size_mem_x();
+    const size_t size_mem_y = cut_db->get_size_mem_y();
+    const size_t size_feedback = cut_db->get_size_mem_interleaved();
+    const size_t slot_byte_size = (size_t)config->get_size_tile() * config->get_size_tile() * config->get_byte_stride();
+
+    std::cout << "atlas: " << atlas_filename << " (" << atlas->getImageWidth() << "x" << atlas->getImageHeight() << ", depth " << atlas->getDepth() << ")" << std::endl;
+    std::cout << "physical texture: " << size_feedback << " slots (" << config->get_phys_tex_layers() << " layers of "
+              << size_mem_x << "x" << size_mem_y << " tiles)" << std::endl;
+    std::cout << "RAM cache: " << config->get_size_ram_cache() << " MB, " << cache_policy_name(config->get_cache_policy()) << std::endl;
+
+    vt::CutUpdate* cut_update = &vt::CutUpdate::get_instance();
+
+    // warms up the cache with the upper levels of the atlas, which is not part of the replay
+    cut_update->start();
+
+    vt::ContextFeedback* context_feedback = cut_update->get_context_feedback(context_id);
+    vt::ooc::TileProvider* tile_provider = cut_db->get_tile_provider();
+
+    std::vector<int32_t> feedback_lod(size_feedback, 0);
+    std::vector<uint32_t> feedback_count(size_feedback, 0);
+
+    vt::ooc::TileStatistics last_tile_statistics = tile_provider->getStatistics();
+    bool dispatched = false;
+
+    // reads the cut as drawn by the renderer, and hands the feedback for it to the cut update if the cut update
+    // is idle, as the renderers do. returns false if the previous feedback is still being processed
+    auto run_feedback = [&](const std::vector<feedback_sample>& samples, frame_statistics& statistics) {
+
+        if (!cut_update->can_accept_feedback(context_id)) {
+            return false;
+        }
+
+        vt::Cut* cut = cut_db->start_reading_cut(cut_id);
+
+        statistics.cut_size_ = cut->get_front()->get_cut().size();
+        statistics.num_samples_ = samples.size();
+        statistics.num_unsatisfied_ = resolve_feedback_samples(samples, cut->get_front(), context_feedback, size_mem_x, size_mem_y, feedback_lod);
+        statistics.num_allocated_slots_ = context_feedback->get_allocated_slot_index().size();
+
+        // slots written by the last dispatch, the renderer uploads them to the physical texture
+        if (dispatched) {
+            statistics.num_uploaded_ += cut->get_front()->get_mem_slots_updated().size();
+            dispatched = false;
+        }
+
+        cut_db->stop_reading_cut(cut_id);
+
+        // the feedback is dropped while the dispatch thread holds its lock
+        dispatched = cut_update->feedback(context_id, feedback_lod.data(), feedback_count.data());
+
+        return true;
+    };
+
+    auto wait_for_dispatch = [&]() {
+        while (!cut_update->can_accept_feedback(context_id)) {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    };
+
+    // repeats the feedback of one view until every sample is drawn at the requested level
+    auto converge = [&](const std::vector<feedback_sample>& samples, const double max_time_in_ms, frame_statistics& statistics) {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        while (true) {
+            wait_for_dispatch();
+
+            double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+            run_feedback(samples, statistics);
+
+            if (statistics.num_unsatisfied_ == 0) {
+                statistics.converge_ms_ = elapsed_ms;
+                return;
+            }
+
+            if (elapsed_ms > max_time_in_ms) {
+                return;
+            }
+
+            // leave the loaders some time between the dispatches
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+    };
+
+    std::cout << "frame\tdispatch_ms\tconverge_ms\tcut_size\tsamples\tunsatisfied\tuploaded\tslots_used"
+              << "\thit_rate\trequested\tloaded\tevicted\tdepletions\tram_cache_mb" << std::endl;
+
+    double total_dispatch_ms = 0.0;
+    float max_dispatch_ms = 0.f;
+    double total_converge_ms = 0.0;
+    double max_converge_ms = 0.0;
+    uint32_t num_converged_frames = 0;
+    uint32_t num_satisfied_frames = 0;
+    uint32_t num_depletion_frames = 0;
+    size_t total_uploaded = 0;
+    size_t max_allocated_slots = 0;
+    uint64_t max_resident_tiles = 0;
+
+    std::vector<feedback_sample> samples;
+    frame_statistics last_statistics;
+
+    for (uint32_t frame = 0; frame < num_frames; ++frame) {
+
+        auto pacing_start = std::chrono::high_resolution_clock::now();
+
+        if (!session_frames.empty()) {
+            samples = session_frames[frame];
+        }
+        else {
+            camera_view view = camera_path.empty() ? default_camera_view(layout, frame, num_frames, num_laps) : camera_path[frame];
+            samples = generate_feedback_samples(layout, view, window_width, window_height, fov_y, sample_distance,
+                                                uv_scale_x, uv_scale_y, config->get_size_tile(), max_level);
+        }
+
+        if (session_output_file.is_open()) {
+            write_feedback_session_frame(session_output_file, samples);
+        }
+
+        frame_statistics statistics;
+
+        if (await_convergence) {
+            converge(samples, max_converge_time_in_ms, statistics);
+        }
+        else {
+            // frames without feedback keep the statistics of the last resolved frame
+            if (!run_feedback(samples, statistics)) {
+                statistics = last_statistics;
+                statistics.num_uploaded_ = 0;
+            }
+            last_statistics = statistics;
+        }
+
+        statistics.dispatch_ms_ = cut_update->get_dispatch_time();
+
+        vt::ooc::TileStatistics tile_statistics = tile_provider->getStatistics();
+        statistics.tiles_ = difference(tile_statistics, last_tile_statistics);
+        last_tile_statistics = tile_statistics;
+
+        total_dispatch_ms += statistics.dispatch_ms_;
+        max_dispatch_ms = std::max(max_dispatch_ms, statistics.dispatch_ms_);
+        total_uploaded += statistics.num_uploaded_;
+        max_allocated_slots = std::max(max_allocated_slots, statistics.num_allocated_slots_);
+        max_resident_tiles = std::max(max_resident_tiles, statistics.tiles_.residentTiles);
+
+        if (statistics.converge_ms_ >= 0.0) {
+            ++num_converged_frames;
+            total_converge_ms += statistics.converge_ms_;
+            max_converge_ms = std::max(max_converge_ms, statistics.converge_ms_);
+        }
+
+        if (statistics.num_unsatisfied_ == 0) {
+            ++num_satisfied_frames;
+        }
+
+        if (statistics.tiles_.depletions > 0) {
+            ++num_depletion_frames;
+        }
+
+        std::cout << frame << "\t" << statistics.dispatch_ms_ << "\t" << statistics.converge_ms_ << "\t" << statistics.cut_size_
+                  << "\t" << statistics.num_samples_ << "\t" << statistics.num_unsatisfied_ << "\t" << statistics.num_uploaded_
+                  << "\t" << statistics.num_allocated_slots_ << "\t" << hit_rate(statistics.tiles_) << "\t" << statistics.tiles_.requested << "\t" << statistics.tiles_.loaded
+                  << "\t" << statistics.tiles_.evicted << "\t" << statistics.tiles_.depletions
+                  << "\t" << (double)(statistics.tiles_.residentTiles * statistics.tiles_.tileByteSize) / (1024.0 * 1024.0) << std::endl;
+
+        // loading threads run in real time, so replay at the recorded frame rate
+        if (!await_convergence && frames_per_second > 0.f) {
+            std::this_thread::sleep_until(pacing_start + std::chrono::microseconds((int64_t)(1000000.0 / frames_per_second)));
+        }
+    }
+
+    // hold the last view until the cut has caught up
+    frame_statistics settle_statistics;
+    if (num_frames > 0 && !await_convergence) {
+        converge(samples, settle_time_in_ms, settle_statistics);
+    }
+
+    cut_update->stop();
+
+    vt::ooc::TileStatistics tile_statistics = tile_provider->getStatistics();
+
+    std::cout << std::endl;
+    std::cout << "avg dispatch time per frame (ms): " << total_dispatch_ms / std::max(1u, num_frames) << std::endl;
+    std::cout << "max dispatch time per frame (ms): " << max_dispatch_ms << std::endl;
+    if (await_convergence) {
+        std::cout << "frames converged: " << num_converged_frames << " / " << num_frames << std::endl;
+        std::cout << "avg time to converge per frame (ms): " << total_converge_ms / std::max(1u, num_converged_frames) << std::endl;
+        std::cout << "max time to converge per frame (ms): " << max_converge_ms << std::endl;
+    }
+    else {
+        std::cout << "frames at full resolution: " << num_satisfied_frames << " / " << num_frames << std::endl;
+        if (settle_statistics.converge_ms_ >= 0.0) {
+            std::cout << "time to converge after last frame (ms): " << settle_statistics.converge_ms_ << std::endl;
+        }
+        else {
+            std::cout << "time to converge after last frame (ms): not reached within " << settle_time_in_ms << std::endl;
+        }
+    }
+    std::cout << "tiles uploaded to the physical texture: " << total_uploaded << " (" << total_uploaded * slot_byte_size << " bytes)" << std::endl;
+    std::cout << "peak physical texture use: " << max_allocated_slots << " / " << size_feedback << " slots" << std::endl;
+    std::cout << std::endl;
+    std::cout << "RAM cache hit rate: " << hit_rate(tile_statistics) << " (" << tile_statistics.hits << " of "
+              << tile_statistics.hits + tile_statistics.misses << " lookups)" << std::endl;
+    std::cout << "tiles requested: " << tile_statistics.requested << std::endl;
+    std::cout << "tiles loaded: " << tile_statistics.loaded << std::endl;
+    std::cout << "tiles evicted: " << tile_statistics.evicted << std::endl;
+    // requests dropped by the loaders, because every tile of the cache was held by a cut
+    std::cout << "cache depletion events: " << tile_statistics.depletions << " (in " << num_depletion_frames << " frames)" << std::endl;
+    std::cout << "peak RAM cache use: " << max_resident_tiles << " / " << tile_statistics.cacheTiles << " tiles ("
+              << (double)(max_resident_tiles * tile_statistics.tileByteSize) / (1024.0 * 1024.0) << " MB)" << std::endl;
+
+    return 0;
+}
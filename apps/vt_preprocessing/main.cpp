@@ -9,15 +9,21 @@
 #include <lamure/vt/pre/AtlasFile.h>
 #include <lamure/vt/ooc/TileProvider.h>
 #include <lamure/vt/pre/DeltaECalculator.h>
+#include <lamure/vt/pre/AtlasCompressor.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <cstring>
+#include <fstream>
 #include <iostream>
+#include <map>
 #include <random>
 #include <sstream>
 #include <string>
 #include <thread>
+#include <vector>
 
 using namespace vt::pre;
 
@@ -49,6 +55,8 @@ const char *printLayout(AtlasFile::LAYOUT layout){
             return "raw";
         case AtlasFile::LAYOUT::PACKED:
             return "packed";
+        case AtlasFile::LAYOUT::COMPRESSED:
+            return "compressed";
     }
 }
 
@@ -64,14 +72,14 @@ const char *printPxFormat(Bitmap::PIXEL_FORMAT pxFormat){
 }
 
 int process(const int argc, const char **argv){
-    if(argc != 10){
+    if(argc != 10 && argc != 11){
         std::cout << "Wrong count of parameters." << std::endl;
         std::cout << "Expected parameters:" << std::endl;
         std::cout << "\t<image file> <image pixel format (r, rgb, rgba)>" << std::endl;
         std::cout << "\t<image width> <image height>" << std::endl;
         std::cout << "\t<tile width> <tile height> <padding>" << std::endl;
         std::cout << "\t<out file (without extension)> <out pixel format (r, rgb, rgba)>" << std::endl;
-        std::cout << "\t<max memory usage (in GB)>" << std::endl;
+        std::cout << "\t<max memory usage (in GB)> [threads (0 for one per core)]" << std::endl;
 
         return 1;
     }
@@ -169,11 +177,143 @@ int process(const int argc, const char **argv){
     //convert to GB
     maxMemory *= 1024*1024*1024;
 
+    size_t threadCount = 0;
+
+    if(argc == 11){
+        stream.clear();
+        stream.write(argv[10], std::strlen(argv[10]));
+
+        if (!(stream >> threadCount)) {
+            std::cerr << "Invalid thread count \"" << argv[10] << "\"." << std::endl;
+
+            return 1;
+        }
+    }
+
     Preprocessor pre(argv[0], inPixelFormat, imageWidth, imageHeight);
 
+    if(threadCount != 0){
+        pre.setThreadCount(threadCount);
+    }
+
     pre.setOutput(argv[7], outPixelFormat, AtlasFile::LAYOUT::PACKED, tileWidth, tileHeight, padding);
     pre.run(maxMemory);
 
+    for(auto &timing : pre.getPhaseTimings()){
+        std::cout << timing.name << ": " << timing.duration.count() << " ms" << std::endl;
+    }
+
+    return 0;
+}
+
+int processTiled(const int argc, const char **argv){
+    if(argc != 13 && argc != 14){
+        std::cout << "Wrong count of parameters." << std::endl;
+        std::cout << "Expected parameters:" << std::endl;
+        std::cout << "\t<source layout (dir, container)> <tile directory or container file> <image pixel format (r, rgb, rgba)>" << std::endl;
+        std::cout << "\t<image width> <image height> <source tile width> <source tile height>" << std::endl;
+        std::cout << "\t<tile width> <tile height> <padding>" << std::endl;
+        std::cout << "\t<out file (without extension)> <out pixel format (r, rgb, rgba)>" << std::endl;
+        std::cout << "\t<max memory usage (in GB)> [threads (0 for one per core)]" << std::endl;
+        std::cout << "A tile directory holds raw tiles \"<x>_<y>.data\" as wide and high as their part of the image," << std::endl;
+        std::cout << "a container file holds full size raw tiles row after row." << std::endl;
+
+        return 1;
+    }
+
+    bool isDirectory = std::strcmp(argv[0], "dir") == 0;
+
+    if(!isDirectory && std::strcmp(argv[0], "container") != 0){
+        std::cout << "Invalid source layout given: \"" << argv[0] << "\"." << std::endl;
+
+        return 1;
+    }
+
+    Bitmap::PIXEL_FORMAT inPixelFormat;
+    Bitmap::PIXEL_FORMAT outPixelFormat;
+
+    try {
+        inPixelFormat = parsePixelFormat(argv[2]);
+    }catch(std::runtime_error &error){
+        std::cout << "Invalid input pixel format given: \"" << argv[2] << "\"." << std::endl;
+
+        return 1;
+    }
+
+    try {
+        outPixelFormat = parsePixelFormat(argv[11]);
+    }catch(std::runtime_error &error){
+        std::cout << "Invalid output pixel format given: \"" << argv[11] << "\"." << std::endl;
+
+        return 1;
+    }
+
+    const char *names[] = {"image width", "image height", "source tile width", "source tile height", "tile width", "tile height", "padding"};
+    const int indices[] = {3, 4, 5, 6, 7, 8, 9};
+    size_t values[7];
+
+    for(size_t i = 0; i < 7; ++i){
+        std::stringstream stream(argv[indices[i]]);
+
+        if (!(stream >> values[i])) {
+            std::cerr << "Invalid " << names[i] << " \"" << argv[indices[i]] << "\"." << std::endl;
+
+            return 1;
+        }
+    }
+
+    size_t maxMemory;
+    std::stringstream memoryStream(argv[12]);
+
+    if (!(memoryStream >> maxMemory)) {
+        std::cerr << "Invalid maximum memory size \"" << argv[12] << "\"." << std::endl;
+
+        return 1;
+    }
+    //convert to GB
+    maxMemory *= 1024*1024*1024;
+
+    size_t threadCount = 0;
+
+    if(argc == 14){
+        std::stringstream threadStream(argv[13]);
+
+        if (!(threadStream >> threadCount)) {
+            std::cerr << "Invalid thread count \"" << argv[13] << "\"." << std::endl;
+
+            return 1;
+        }
+    }
+
+    // a quarter of the memory caches source tiles, the rest goes to the extraction and the mip levels
+    size_t sourceMemory = maxMemory / 4;
+    TiledImageSource *source;
+
+    try {
+        if(isDirectory){
+            source = TiledImageSource::openDirectory(argv[1], ".data", inPixelFormat, values[0], values[1], values[2], values[3], sourceMemory);
+        }else{
+            source = TiledImageSource::openContainer(argv[1], inPixelFormat, values[0], values[1], values[2], values[3], sourceMemory);
+        }
+    }catch(std::runtime_error &error){
+        std::cout << error.what() << std::endl;
+
+        return 1;
+    }
+
+    Preprocessor pre(source);
+
+    if(threadCount != 0){
+        pre.setThreadCount(threadCount);
+    }
+
+    pre.setOutput(argv[10], outPixelFormat, AtlasFile::LAYOUT::PACKED, values[4], values[5], values[6]);
+    pre.run(maxMemory - sourceMemory);
+
+    for(auto &timing : pre.getPhaseTimings()){
+        std::cout << timing.name << ": " << timing.duration.count() << " ms" << std::endl;
+    }
+
     return 0;
 }
 
@@ -300,11 +440,12 @@ int extract_raw(const int argc, const char **argv){
 }
 
 int delta(const int argc, const char **argv){
-    if(argc != 2){
+    if(argc != 2 && argc != 3){
         std::cout << "Wrong count of parameters." << std::endl;
         std::cout << "Expected parameters:" << std::endl;
         std::cout << "\t<processed image>" << std::endl;
         std::cout << "\t<max memory usage>" << std::endl;
+        std::cout << "\t[<threads, default: hardware concurrency>]" << std::endl;
 
         return 1;
     }
@@ -329,13 +470,130 @@ int delta(const int argc, const char **argv){
         return 1;
     }
 
-    calculator->calculate(maxMemory);
+    size_t threadCount = argc == 3 ? (size_t)std::max(1ll, std::atoll(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+
+    calculator->calculate(maxMemory, threadCount);
 
     delete calculator;
 
     return 0;
 }
 
+int compress(const int argc, const char **argv){
+    if(argc != 2 && argc != 3){
+        std::cout << "Wrong count of parameters." << std::endl;
+        std::cout << "Expected parameters:" << std::endl;
+        std::cout << "\t<processed image>" << std::endl;
+        std::cout << "\t<output file (without extension)>" << std::endl;
+        std::cout << "\t[<threads, default: hardware concurrency>]" << std::endl;
+
+        return 1;
+    }
+
+    size_t threadCount = argc == 3 ? (size_t)std::max(1ll, std::atoll(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+
+    try{
+        AtlasCompressor compressor(argv[0]);
+
+        auto start = std::chrono::steady_clock::now();
+        compressor.compress((std::string(argv[1]) + ".atlas").c_str(), threadCount);
+
+        std::cout << "compressed " << compressor.getFilledTiles() << " tiles in "
+                  << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s" << std::endl;
+    }catch(std::runtime_error &error){
+        std::cout << error.what() << std::endl;
+
+        return 1;
+    }
+
+    return 0;
+}
+
+int benchmarkCompression(const int argc, const char **argv){
+    if(argc != 2){
+        std::cout << "Wrong count of parameters." << std::endl;
+        std::cout << "Expected parameters:" << std::endl;
+        std::cout << "\t<packed atlas>" << std::endl;
+        std::cout << "\t<compressed atlas of the same image>" << std::endl;
+
+        return 1;
+    }
+
+    AtlasFile packed(argv[0]);
+    AtlasFile compressed(argv[1]);
+
+    if(packed.getTotalTiles() != compressed.getTotalTiles() || packed.getTileByteSize() != compressed.getTileByteSize() ||
+       packed.getPixelFormat() != compressed.getPixelFormat()){
+        std::cout << "Atlases do not belong to the same image." << std::endl;
+
+        return 1;
+    }
+
+    uint64_t tileByteSize = packed.getTileByteSize();
+    std::vector<uint8_t> packedTile(tileByteSize);
+    std::vector<uint8_t> compressedTile(tileByteSize);
+
+    AtlasFile *atlases[] = {&packed, &compressed};
+    const char *names[] = {"packed    ", "compressed"};
+    uint64_t storedSizes[] = {0, 0};
+
+    for(size_t i = 0; i < 2; ++i){
+        std::ifstream file(argv[i], std::ios::binary | std::ios::ate);
+        uint64_t fileSize = (uint64_t)file.tellg();
+        uint64_t &storedSize = storedSizes[i];
+        uint64_t tileCount = 0;
+
+        auto start = std::chrono::steady_clock::now();
+
+        for(uint64_t id = 0; id < atlases[i]->getTotalTiles(); ++id){
+            if(atlases[i]->getTile(id, packedTile.data())){
+                storedSize += atlases[i]->getStoredTileByteSize(id);
+                ++tileCount;
+            }
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << names[i] << ": " << fileSize << " bytes on disk, " << storedSize << " bytes of tiles, "
+                  << (double)tileCount / seconds << " tiles/s, " << (double)(tileCount * tileByteSize) / (seconds * 1024.0 * 1024.0) << " MB/s decoded" << std::endl;
+    }
+
+    // PSNR over all channels of all filled tiles
+    double squaredError = 0.0;
+    uint64_t valueCount = 0;
+
+    for(uint64_t id = 0; id < packed.getTotalTiles(); ++id){
+        if(!packed.getTile(id, packedTile.data())){
+            continue;
+        }
+
+        if(!compressed.getTile(id, compressedTile.data())){
+            std::cout << "Tile " << id << " is missing in the compressed atlas." << std::endl;
+
+            return 1;
+        }
+
+        for(uint64_t i = 0; i < tileByteSize; ++i){
+            double diff = (double)packedTile[i] - (double)compressedTile[i];
+            squaredError += diff * diff;
+        }
+
+        valueCount += tileByteSize;
+    }
+
+    double mse = valueCount == 0 ? 0.0 : squaredError / (double)valueCount;
+
+    std::cout << "ratio: " << (double)storedSizes[0] / (double)std::max<uint64_t>(1, storedSizes[1]) << ":1" << std::endl;
+
+    if(mse == 0.0){
+        std::cout << "PSNR: lossless" << std::endl;
+    }else{
+        std::cout << "PSNR: " << 10.0 * std::log10(255.0 * 255.0 / mse) << " dB" << std::endl;
+    }
+
+    return 0;
+}
+
 uint64_t createRandomImage(const char *fileName, uint64_t width, uint64_t height, Bitmap::PIXEL_FORMAT pxFormat, size_t maxBufferSize) {
     std::random_device random;
     std::default_random_engine randomEng(random());
@@ -400,7 +658,7 @@ void benchmarkPreprocessing(const char *folderName, size_t tileWidth, size_t til
         DeltaECalculator delta((atlasFileName + ".atlas").c_str());
 
         start = std::chrono::system_clock::now();
-        delta.calculate(maxMemorySize);
+        delta.calculate(maxMemorySize, std::max(1u, std::thread::hardware_concurrency()));
         auto deltaDuration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - start);
 
         std::cout << processDuration.count() << std::endl;
@@ -466,12 +724,267 @@ void benchmarkOutOfCore(const char *folderName, const char *atlasFileName, size_
     benchmarkFile.close();
 }
 
+int benchmarkTrace(const int argc, const char **argv){
+    if(argc != 3 && argc != 4){
+        std::cout << "Wrong count of parameters." << std::endl;
+        std::cout << "Expected parameters:" << std::endl;
+        std::cout << "\t<trace file, one request per line: \"<time in ms> <tile id> <priority> <atlas file>\">" << std::endl;
+        std::cout << "\t<max memory usage (in MB)> <loader threads (0 uses one per core)>" << std::endl;
+        std::cout << "\t[<replay speed, 0 replays as fast as possible (default: 1)>]" << std::endl;
+
+        return 1;
+    }
+
+    struct TraceEntry {
+        double time;
+        uint64_t tileId;
+        float priority;
+        std::string atlasFileName;
+    };
+
+    std::vector<TraceEntry> trace;
+    std::ifstream traceFile(argv[0]);
+
+    if(!traceFile.is_open()){
+        std::cout << "Could not open file \"" << argv[0] << "\"." << std::endl;
+
+        return 1;
+    }
+
+    std::string line;
+
+    while(std::getline(traceFile, line)){
+        std::istringstream lineStream(line);
+        TraceEntry entry;
+
+        if(line.empty() || line[0] == '#' || !(lineStream >> entry.time >> entry.tileId >> entry.priority >> entry.atlasFileName)){
+            continue;
+        }
+
+        trace.push_back(entry);
+    }
+
+    traceFile.close();
+
+    if(trace.empty()){
+        std::cout << "Trace is empty." << std::endl;
+
+        return 1;
+    }
+
+    std::stable_sort(trace.begin(), trace.end(), [](const TraceEntry &a, const TraceEntry &b){ return a.time < b.time; });
+
+    size_t maxMemSize = (size_t)std::atoll(argv[1]) * 1024 * 1024;
+    size_t loaderThreadCount = (size_t)std::atoll(argv[2]);
+    double replaySpeed = argc == 4 ? std::atof(argv[3]) : 1.0;
+
+    vt::ooc::TileProvider provider;
+
+    // the provider keeps the file name pointers, the trace outlives it
+    std::map<std::string, AtlasFile*> atlases;
+
+    for(auto &entry : trace){
+        if(atlases.find(entry.atlasFileName) == atlases.end()){
+            atlases[entry.atlasFileName] = provider.loadResource(entry.atlasFileName.c_str());
+        }
+    }
+
+    provider.start(maxMemSize, loaderThreadCount);
+
+    struct PendingTile {
+        AtlasFile *atlas;
+        uint64_t tileId;
+        float priority;
+        std::chrono::steady_clock::time_point requested;
+    };
+
+    std::vector<PendingTile> pending;
+    std::vector<double> latencies;
+    size_t hitCount = 0;
+    size_t nextEntry = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    while(nextEntry < trace.size() || !pending.empty()){
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double, std::milli>(now - start).count();
+
+        while(nextEntry < trace.size() && (replaySpeed <= 0.0 || trace[nextEntry].time / replaySpeed <= elapsed)){
+            auto &entry = trace[nextEntry++];
+            auto atlas = atlases[entry.atlasFileName];
+
+            if(provider.getTile(atlas, entry.tileId, entry.priority, 0) != nullptr){
+                ++hitCount;
+                provider.ungetTile(atlas, entry.tileId, 0);
+            }else{
+                pending.push_back({atlas, entry.tileId, entry.priority, now});
+            }
+        }
+
+        for(size_t i = 0; i < pending.size();){
+            auto &tile = pending[i];
+
+            if(provider.getTile(tile.atlas, tile.tileId, tile.priority, 0) != nullptr){
+                latencies.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tile.requested).count());
+                provider.ungetTile(tile.atlas, tile.tileId, 0);
+
+                tile = pending.back();
+                pending.pop_back();
+            }else{
+                ++i;
+            }
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    provider.stop();
+
+    std::sort(latencies.begin(), latencies.end());
+
+    auto percentile = [&latencies](double p) -> double {
+        return latencies.empty() ? 0.0 : latencies[std::min(latencies.size() - 1, (size_t)(p * latencies.size()))];
+    };
+
+    std::cout << "requests: " << trace.size() << " (" << hitCount << " cache hits)" << std::endl;
+    std::cout << "loader threads: " << (loaderThreadCount == 0 ? std::thread::hardware_concurrency() : loaderThreadCount) << std::endl;
+    std::cout << "loaded tiles: " << latencies.size() << " in " << seconds << " s, " << (double)latencies.size() / seconds << " tiles/s" << std::endl;
+    std::cout << "request latency: p50 " << percentile(0.5) << " ms, p99 " << percentile(0.99) << " ms, max " << (latencies.empty() ? 0.0 : latencies.back()) << " ms" << std::endl;
+
+    return 0;
+}
+
+int benchmarkGetTile(const int argc, const char **argv){
+    if(argc != 3 && argc != 4){
+        std::cout << "Wrong count of parameters." << std::endl;
+        std::cout << "Expected parameters:" << std::endl;
+        std::cout << "\t<processed image> <feedback threads> <calls per thread>" << std::endl;
+        std::cout << "\t[<max memory usage (in MB), default: 256>]" << std::endl;
+
+        return 1;
+    }
+
+    size_t threadCount = std::max(1ll, std::atoll(argv[1]));
+    size_t callCount = std::max(1ll, std::atoll(argv[2]));
+    size_t maxMemSize = (size_t)(argc == 4 ? std::atoll(argv[3]) : 256) * 1024 * 1024;
+
+    vt::ooc::TileProvider provider;
+
+    auto atlas = provider.loadResource(argv[0]);
+    uint64_t tileCount = atlas->getTotalTiles();
+
+    provider.start(maxMemSize);
+
+    std::atomic<size_t> hitCount(0);
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // every thread plays a context that reports the tiles of its feedback buffer
+    for(size_t i = 0; i < threadCount; ++i){
+        threads.emplace_back([&, i](){
+            std::default_random_engine randomEng(i);
+            std::uniform_int_distribution<uint64_t> randomGen(0, tileCount - 1);
+            std::uniform_real_distribution<float> randomPriority(0.f, 1.f);
+            size_t hits = 0;
+
+            for(size_t call = 0; call < callCount; ++call){
+                uint64_t tileId = randomGen(randomEng);
+
+                if(provider.getTile(atlas, tileId, randomPriority(randomEng), (uint16_t)i) != nullptr){
+                    ++hits;
+                    provider.ungetTile(atlas, tileId, (uint16_t)i);
+                }
+            }
+
+            hitCount += hits;
+        });
+    }
+
+    for(auto &thread : threads){
+        thread.join();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    provider.stop();
+
+    std::cout << "feedback threads: " << threadCount << std::endl;
+    std::cout << "getTile calls: " << threadCount * callCount << " in " << seconds << " s, " << (double)(threadCount * callCount) / seconds << " calls/s" << std::endl;
+    std::cout << "hits: " << hitCount.load() << std::endl;
+
+    return 0;
+}
+
+int benchmarkBitmap(const int argc, const char **argv){
+    if(argc > 1){
+        std::cout << "Wrong count of parameters." << std::endl;
+        std::cout << "Expected parameters:" << std::endl;
+        std::cout << "\t[<edge length in pixels, default: 2048>]" << std::endl;
+
+        return 1;
+    }
+
+    size_t size = (size_t)std::max(2ll, argc == 1 ? std::atoll(argv[0]) : 2048ll);
+    const Bitmap::PIXEL_FORMAT formats[] = {Bitmap::PIXEL_FORMAT::R8, Bitmap::PIXEL_FORMAT::RGB8, Bitmap::PIXEL_FORMAT::RGBA8, Bitmap::PIXEL_FORMAT::LAB};
+    const char *names[] = {"R8", "RGB8", "RGBA8", "LAB"};
+
+    std::default_random_engine randomEng(0);
+    std::uniform_int_distribution<int> randomGen(0, 255);
+    std::vector<uint8_t> srcData(size * size * Bitmap::pixelSize(Bitmap::PIXEL_FORMAT::RGBA8));
+
+    for(auto &value : srcData){
+        value = (uint8_t)randomGen(randomEng);
+    }
+
+    // source pixels per second, every conversion runs for at least a quarter second
+    for(size_t src = 0; src < 3; ++src){
+        Bitmap srcBitmap(size, size, formats[src], srcData.data());
+
+        for(size_t dest = 0; dest < 4; ++dest){
+            Bitmap destBitmap(size, size, formats[dest]);
+
+            for(size_t deflate = 0; deflate < 2; ++deflate){
+                if(deflate == 1 && formats[dest] == Bitmap::PIXEL_FORMAT::LAB){
+                    continue;
+                }
+
+                size_t runs = 0;
+                double seconds = 0.0;
+                auto start = std::chrono::steady_clock::now();
+
+                while(seconds < 0.25){
+                    if(deflate == 1){
+                        destBitmap.deflateRectFrom(srcBitmap, 0, 0, 0, 0, size, size);
+                    }else{
+                        destBitmap.copyRectFrom(srcBitmap, 0, 0, 0, 0, size, size);
+                    }
+
+                    ++runs;
+                    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                }
+
+                std::cout << (deflate == 1 ? "deflate " : "copy    ") << names[src] << " -> " << names[dest] << ": "
+                          << (double)(runs * size * size) / (seconds * 1000000.0) << " MPixel/s" << std::endl;
+            }
+        }
+    }
+
+    return 0;
+}
+
 int main(const int argc, const char **argv){
     if(argc >= 2){
         if(std::strcmp(argv[1], "process") == 0){
             return process(argc - 2, (const char**)((size_t)argv + 2 * sizeof(char*)));
+        }else if(std::strcmp(argv[1], "process_tiled") == 0){
+            return processTiled(argc - 2, (const char**)((size_t)argv + 2 * sizeof(char*)));
         }else if(std::strcmp(argv[1], "delta") == 0){
             return delta(argc - 2, (const char**)((size_t)argv + 2 * sizeof(char*)));
+        }else if(std::strcmp(argv[1], "compress") == 0){
+            return compress(argc - 2, (const char**)((size_t)argv + 2 * sizeof(char*)));
         }else if(std::strcmp(argv[1], "info") == 0){
             return info(argc - 2, (const char**)((size_t)argv + 2 * sizeof(char*)));
         }else if(std::strcmp(argv[1], "extract") == 0){
@@ -481,6 +994,14 @@ int main(const int argc, const char **argv){
         }else if(std::strcmp(argv[1], "benchmark_preprocess") == 0){
             benchmarkPreprocessing("/mnt/terabytes_of_textures/benchmark", 256, 256, 1, 10, Bitmap::PIXEL_FORMAT::RGB8, 1000000000);
             return 0;
+        }else if(std::strcmp(argv[1], "benchmark_bitmap") == 0){
+            return benchmarkBitmap(argc - 2, (const char**)((size_t)argv + 2 * sizeof(char*)));
+        }else if(std::strcmp(argv[1], "benchmark_get_tile") == 0){
+            return benchmarkGetTile(argc - 2, (const char**)((size_t)argv + 2 * sizeof(char*)));
+        }else if(std::strcmp(argv[1], "benchmark_compression") == 0){
+            return benchmarkCompression(argc - 2, (const char**)((size_t)argv + 2 * sizeof(char*)));
+        }else if(std::strcmp(argv[1], "benchmark_trace") == 0){
+            return benchmarkTrace(argc - 2, (const char**)((size_t)argv + 2 * sizeof(char*)));
         }else if(std::strcmp(argv[1], "benchmark_ooc") == 0){
             benchmarkOutOfCore("/mnt/terabytes_of_textures/benchmark", "/mnt/terabytes_of_textures/benchmark/atlas/l7_w16256_h16256.atlas", 2000000000);
             return 0;
@@ -490,9 +1011,15 @@ int main(const int argc, const char **argv){
     std::cout << "Expected instruction." << std::endl;
     std::cout << "Available:" << std::endl;
     std::cout << "\tprocess - to preprocess an image" << std::endl;
+    std::cout << "\tprocess_tiled - to preprocess an image stored as a directory or container of raw tiles" << std::endl;
     std::cout << "\tdelta - to calculate delta e values on image" << std::endl;
+    std::cout << "\tcompress - to block compress the tiles of a preprocessed image, after delta" << std::endl;
     std::cout << "\tinfo - to read meta information of preprocessed image" << std::endl;
     std::cout << "\textract - to extract a certain level of detail from preprocessed image" << std::endl;
+    std::cout << "\tbenchmark_trace - to replay a recorded tile request trace and report tiles/s and latencies" << std::endl;
+    std::cout << "\tbenchmark_bitmap - to measure MPixel/s of the pixel format conversions and the mip reduction" << std::endl;
+    std::cout << "\tbenchmark_compression - to compare size, tiles/s and PSNR of a packed and a compressed atlas" << std::endl;
+    std::cout << "\tbenchmark_get_tile - to measure getTile calls/s from several feedback threads" << std::endl;
     std::cout << std::endl;
 
     return 1;
@@ -11,6 +11,7 @@
 #include <vector>
 #include <string>
 #include <mutex>
+#include <memory>
 
 #include <lamure/pvs/pvs.h>
 #include "lamure/pvs/grid.h"
@@ -25,6 +26,8 @@ namespace lamure
 namespace pvs
 {
 
+class visibility_file_mapping;
+
 class PVS_COMMON_DLL grid_irregular : public grid
 {
 public:
@@ -103,6 +106,9 @@ protected:
 	std::vector<node_t> ids_;
 
 	mutable std::mutex mutex_;
+
+	// Mapping of the .pvs file used by load_cell_visibility_from_file(), kept open between calls.
+	std::shared_ptr<visibility_file_mapping> visibility_mapping_;
 };
 
 }
@@ -13,12 +13,15 @@
 #include "lamure/pvs/grid_octree_node.h"
 
 #include <mutex>
+#include <memory>
 
 namespace lamure
 {
 namespace pvs
 {
 
+class visibility_file_mapping;
+
 class PVS_COMMON_DLL grid_octree : public grid
 {
 public:
@@ -74,6 +77,9 @@ protected:
 
 	mutable std::mutex mutex_;
 
+	// Mapping of the .pvs file used by load_cell_visibility_from_file(), kept open between calls.
+	std::shared_ptr<visibility_file_mapping> visibility_mapping_;
+
 	// Used to improve performance of get_cell_at_index().
 	std::vector<view_cell*> cells_by_indices_;
 };
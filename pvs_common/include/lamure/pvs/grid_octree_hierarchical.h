@@ -15,6 +15,8 @@
 
 #include <mutex>
 
+#include <boost/dynamic_bitset.hpp>
+
 namespace lamure
 {
 namespace pvs
@@ -45,6 +47,23 @@ public:
 
 protected:
 	double calculate_average_node_hierarchy_visibility() const;
+
+	// The visibility file contains one record per octree node in breadth-first order.
+	// Runtime access to a single cell combines the record of the cell with the records of its parents.
+	virtual size_t get_visibility_file_header_size() const;
+	virtual bool read_visibility_record(const visibility_file_mapping& mapping, uint64_t& offset, std::vector<boost::dynamic_bitset<>>* visibility) const;
+	virtual bool is_parent_visibility_combined() const;
+
+	// Loads the visibility of a cell from its records, the grid must be locked by the caller.
+	bool load_cell_records(const std::string& file_path, const size_t& cell_index);
+
+	bool read_node_indices(const visibility_file_mapping& mapping, uint64_t& offset, const bool& indices_visible, boost::dynamic_bitset<>* visibility, const model_t& model_id) const;
+	bool compute_visibility_record_offsets(const visibility_file_mapping& mapping);
+	void compute_cell_records();
+
+	// Record indices of each cell and its parents, starting at the cell itself.
+	std::vector<std::vector<size_t>> cell_records_;
+	std::vector<uint64_t> record_offsets_;
 };
 
 }
@@ -35,7 +35,9 @@ public:
 	virtual bool load_grid_from_file(const std::string& file_path);
 	virtual bool load_visibility_from_file(const std::string& file_path);
 
-	virtual bool load_cell_visibility_from_file(const std::string& file_path, const size_t& cell_index);
+protected:
+	virtual size_t get_visibility_file_header_size() const;
+	virtual bool read_visibility_record(const visibility_file_mapping& mapping, uint64_t& offset, std::vector<boost::dynamic_bitset<>>* visibility) const;
 };
 
 }
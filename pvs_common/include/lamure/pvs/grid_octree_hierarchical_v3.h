@@ -39,6 +39,10 @@ public:
 	virtual bool load_cell_visibility_from_file(const std::string& file_path, const size_t& cell_index);
 
 protected:
+	virtual size_t get_visibility_file_header_size() const;
+	virtual bool read_visibility_record(const visibility_file_mapping& mapping, uint64_t& offset, std::vector<boost::dynamic_bitset<>>* visibility) const;
+	virtual bool is_parent_visibility_combined() const;
+
 	void propagate_node_visibility(view_cell* cell);
 	void set_node_parents_visible(view_cell* cell, const model_t& model_id, const node_t& node_id);
 	void set_node_children_visible(view_cell* cell, const model_t& model_id, const node_t& node_id);
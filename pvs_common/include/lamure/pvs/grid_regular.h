@@ -11,6 +11,7 @@
 #include <vector>
 #include <string>
 #include <mutex>
+#include <memory>
 
 #include <lamure/pvs/pvs.h>
 #include "lamure/pvs/grid.h"
@@ -24,6 +25,8 @@ namespace lamure
 namespace pvs
 {
 
+class visibility_file_mapping;
+
 class PVS_COMMON_DLL grid_regular : public grid
 {
 public:
@@ -59,6 +62,9 @@ public:
 protected:
 	void create_grid(const size_t& num_cells, const double& cell_size, const scm::math::vec3d& position_center);
 
+	// Allows derived grids to store their visibility in different view cell types.
+	virtual view_cell_regular* create_view_cell(const double& cell_size, const scm::math::vec3d& position_center) const;
+
 	view_cell* calculate_cell_at_position(const scm::math::vec3d& position, size_t* cell_index) const;
 
 	void save_regular_grid(const std::string& file_path, const std::string& grid_type) const;
@@ -72,6 +78,9 @@ protected:
 	std::vector<node_t> ids_;
 
 	mutable std::mutex mutex_;
+
+	// Mapping of the .pvs file used by load_cell_visibility_from_file(), kept open between calls.
+	std::shared_ptr<visibility_file_mapping> visibility_mapping_;
 };
 
 }
@@ -0,0 +1,58 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group 
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef LAMURE_PVS_REGULAR_GRID_RUN_LENGTH_H
+#define LAMURE_PVS_REGULAR_GRID_RUN_LENGTH_H
+
+#include <lamure/pvs/pvs.h>
+#include "lamure/pvs/grid_regular.h"
+#include "lamure/pvs/run_length_visibility.h"
+#include "lamure/pvs/view_cell_regular_run_length.h"
+
+namespace lamure
+{
+namespace pvs
+{
+
+// Regular grid storing the visibility of its view cells as runs of visible node ids.
+// Unlike the gzip compressed grids, visibility queries work on the compressed data directly.
+class PVS_COMMON_DLL grid_regular_run_length : public grid_regular
+{
+public:
+	grid_regular_run_length();
+	grid_regular_run_length(const size_t& number_cells, const double& cell_size, const scm::math::vec3d& position_center, const std::vector<node_t>& ids);
+	~grid_regular_run_length();
+
+	virtual std::string get_grid_type() const;
+	static std::string get_grid_identifier();
+
+	virtual void save_grid_to_file(const std::string& file_path) const;
+	virtual void save_visibility_to_file(const std::string& file_path) const;
+
+	virtual bool load_grid_from_file(const std::string& file_path);
+	virtual bool load_visibility_from_file(const std::string& file_path);
+
+	virtual bool load_cell_visibility_from_file(const std::string& file_path, const size_t& cell_index);
+
+	// Nodes of a model visible from the first cell but not from the second one, e.g. the nodes which become visible when the viewer moves between neighbouring cells.
+	run_length_visibility get_cell_visibility_difference(const size_t& cell_index, const size_t& other_cell_index, const model_t& model_id) const;
+	run_length_visibility get_common_cell_visibility(const size_t& cell_index, const size_t& other_cell_index, const model_t& model_id) const;
+
+protected:
+	virtual view_cell_regular* create_view_cell(const double& cell_size, const scm::math::vec3d& position_center) const;
+
+	bool read_block_offsets(const visibility_file_mapping& mapping);
+	bool read_cell_block(const visibility_file_mapping& mapping, const size_t& cell_index);
+
+	// Start of each cell's data within the visibility file, followed by the end of the last block.
+	std::vector<uint64_t> visibility_block_offsets_;
+};
+
+}
+}
+
+#endif
@@ -23,16 +23,46 @@ namespace pvs
 class PVS_COMMON_DLL id_histogram
 {
 public:
+	struct entry
+	{
+		model_t model_id_;
+		node_t node_id_;
+		size_t num_pixels_;
+	};
+
 	id_histogram();
 	~id_histogram();
 
+	// Pixels are counted by several threads in parallel, zero threads uses all hardware threads.
 	void create(const void* pixelData, const size_t& numPixels);
+	void create(const void* pixelData, const size_t& numPixels, const unsigned int& numThreads);
 	
 	std::map<model_t, std::vector<node_t>> get_visible_nodes(const size_t& numPixels, const float& visibilityThreshold) const;
+
+	// Calls function(model_id, node_id) for every visible node in ascending order, without copying the histogram.
+	template<typename Function>
+	void for_each_visible_node(const size_t& numPixels, const float& visibilityThreshold, Function function) const
+	{
+		for(const entry& current_entry : entries_)
+		{
+			if(is_visible(current_entry, numPixels, visibilityThreshold))
+			{
+				function(current_entry.model_id_, current_entry.node_id_);
+			}
+		}
+	}
+
+	// Entries are sorted by model ID first and node ID second.
+	const std::vector<entry>& get_entries() const;
 	std::map<model_t, std::map<node_t, size_t>> get_histogram() const;
 
 private:
-	std::map<model_t, std::map<node_t, size_t>> histogram_;			// first key is model ID, second key is node ID, final value is amount of visible pixels
+	static bool is_visible(const entry& current_entry, const size_t& numPixels, const float& visibilityThreshold)
+	{
+		return ((float)current_entry.num_pixels_ / (float)numPixels) * 100.0f >= visibilityThreshold;
+	}
+
+	std::vector<entry> entries_;			// one entry per model and node ID with the amount of visible pixels
 };
 
 }
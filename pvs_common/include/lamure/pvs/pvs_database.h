@@ -8,12 +8,16 @@
 #ifndef LAMURE_PVS_PVS_DATABASE_H
 #define LAMURE_PVS_PVS_DATABASE_H
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <map>
 #include <set>
 #include <string>
 #include <thread>
 #include <vector>
 #include <mutex>
-#include <queue>
 
 #include <lamure/pvs/pvs.h>
 #include "lamure/pvs/grid.h"
@@ -27,6 +31,19 @@ namespace pvs
 class PVS_COMMON_DLL pvs_database
 {
 public:
+	struct statistics
+	{
+		// Number of view cell changes where the entered cell was already loaded or not.
+		size_t cell_hits_;
+		size_t cell_misses_;
+
+		// Accumulated time the viewer spent in cells without visibility data.
+		double stall_time_in_ms_;
+
+		size_t loaded_cells_;
+		size_t evicted_cells_;
+	};
+
 	virtual ~pvs_database();
 	static pvs_database* get_instance();
 
@@ -49,6 +66,17 @@ public:
 	const grid* get_bounding_grid() const;
 	void clear_visibility_grid();
 
+	// Cells along the viewer path extrapolated this far into the future are loaded ahead of time.
+	void set_prefetch_time(const double& time_in_s);
+	double get_prefetch_time() const;
+
+	// Loaded cells are released in least recently used order once their visibility exceeds this budget.
+	void set_memory_budget(const size_t& budget_in_bytes);
+	size_t get_memory_budget() const;
+
+	statistics get_statistics() const;
+	void reset_statistics();
+
 protected:
 	pvs_database();
 
@@ -57,9 +85,41 @@ protected:
 private:
 	void loading_thread_loop();
 	void load_visibility_data_async(uint64_t cell_index);
-	std::queue<uint64_t> loading_queue_;
+	void update_loading_queue(const size_t& viewer_cell_index);
+	void update_viewer_velocity(const scm::math::vec3d& position);
+	void update_stall_time();
+	void touch_cell(const uint64_t& cell_index);
+	void evict_cells();
+	void reset_loading_state();
+
+	// Cells to load ordered by priority, the front is loaded next.
+	std::deque<uint64_t> loading_queue_;
 	semaphore semaphore_;
 
+	// Cells of the current request, these are never evicted.
+	std::set<uint64_t> pinned_cell_indices_;
+	std::set<uint64_t> cells_in_flight_;
+	std::condition_variable loading_finished_;
+
+	// Loaded cells, most recently used at the front.
+	std::list<uint64_t> lru_cell_indices_;
+	std::map<uint64_t, std::list<uint64_t>::iterator> lru_positions_;
+	size_t cell_memory_size_;
+	size_t memory_budget_;
+
+	// Viewer motion used to predict which cells will be entered next.
+	double prefetch_time_in_s_;
+	scm::math::vec3d viewer_velocity_;
+	std::chrono::steady_clock::time_point last_position_time_;
+	bool has_last_position_;
+	size_t viewer_cell_index_;
+	size_t predicted_cell_index_;
+
+	bool is_stalled_;
+	size_t stalled_cell_index_;
+	std::chrono::steady_clock::time_point stall_begin_;
+	statistics statistics_;
+
 	// Grid storing the major visibility data of the scene.
 	grid* visibility_grid_;
 
@@ -80,9 +140,8 @@ private:
 	std::string pvs_file_path_;
 
 	scm::math::vec3d smallest_cell_size_;
-	std::set<size_t> previously_loaded_cell_indices_;
 
-	std::thread visibility_data_loading_thread_;
+	std::vector<std::thread> visibility_data_loading_threads_;
 
 	// Used to achieve thread safety.
 	mutable std::mutex mutex_;
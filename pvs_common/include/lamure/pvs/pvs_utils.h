@@ -24,6 +24,10 @@ PVS_COMMON_DLL void analyze_grid_visibility(const grid* input_grid, const unsign
 // Calculate the current occlusion percentage within a given grid.
 PVS_COMMON_DLL double calculate_grid_occlusion(const grid* input_grid);
 
+// Compare node visibility of a grid against a reference grid (e.g. computed by another visibility test) and output the differences into a given file.
+// Cells are matched by their center position, so both grids may use different cell layouts.
+PVS_COMMON_DLL void compare_grid_visibility(const grid* input_grid, const grid* reference_grid, const std::string& output_file_name);
+
 }
 }
 
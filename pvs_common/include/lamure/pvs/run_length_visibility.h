@@ -0,0 +1,69 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group 
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef LAMURE_PVS_RUN_LENGTH_VISIBILITY_H
+#define LAMURE_PVS_RUN_LENGTH_VISIBILITY_H
+
+#include <string>
+#include <vector>
+
+#include <lamure/pvs/pvs.h>
+#include <lamure/types.h>
+
+namespace lamure
+{
+namespace pvs
+{
+
+// Visibility of the nodes of one model, stored as sorted runs of consecutive visible node ids.
+// Since node ids are assigned level by level, visible nodes of a view cell tend to form few long runs.
+// Single nodes are queried by binary search over the runs, so no decompression is required.
+class PVS_COMMON_DLL run_length_visibility
+{
+public:
+	struct run
+	{
+		// Visible node ids are [first_, first_ + count_).
+		node_t first_;
+		node_t count_;
+	};
+
+	run_length_visibility();
+	~run_length_visibility();
+
+	void set_visibility(const node_t& node_id, const bool& visible);
+	bool get_visibility(const node_t& node_id) const;
+
+	// Number of node ids covered, visible or not. Grows like a bitset when visibility is set.
+	node_t get_size() const;
+	void set_size(const node_t& size);
+
+	size_t get_num_visible() const;
+	const std::vector<run>& get_runs() const;
+
+	bool empty() const;
+	void clear();
+
+	static run_length_visibility unite(const run_length_visibility& first, const run_length_visibility& second);
+	static run_length_visibility intersect(const run_length_visibility& first, const run_length_visibility& second);
+	static run_length_visibility subtract(const run_length_visibility& first, const run_length_visibility& second);
+
+	// Runs are stored as variable length integers of the gap to the previous run and the run length.
+	void serialize(std::string& output) const;
+	bool deserialize(const char*& data, const char* data_end, const node_t& size);
+
+private:
+	void append_run(const node_t& first, const node_t& count);
+
+	std::vector<run> runs_;
+	node_t size_;
+};
+
+}
+}
+
+#endif
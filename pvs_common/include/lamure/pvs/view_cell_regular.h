@@ -10,6 +10,7 @@
 
 #include <vector>
 #include <map>
+#include <memory>
 
 #include <scm/core/math.h>
 #include <lamure/types.h>
@@ -24,6 +25,8 @@ namespace lamure
 namespace pvs
 {
 
+class visibility_file_mapping;
+
 class PVS_COMMON_DLL view_cell_regular : public view_cell
 {
 public:
@@ -47,11 +50,32 @@ public:
 	virtual boost::dynamic_bitset<> get_bitset(const model_t& object_id) const;
 	virtual void set_bitset(const model_t& object_id, const boost::dynamic_bitset<>& bitset);
 
+	// Sets the visibility of a model from a line of a .pvs file (one bit per node, lowest bit first).
+	void set_visibility_data(const model_t& object_id, const char* data, const node_t& num_nodes);
+
+	// Like set_visibility_data(), but the line is not copied. The cell keeps the mapping alive until
+	// the visibility of the model is changed or cleared.
+	void borrow_visibility_data(const model_t& object_id, const char* data, const node_t& num_nodes, const std::shared_ptr<const visibility_file_mapping>& mapping);
+
 private:
+	struct borrowed_visibility
+	{
+		const char* data_;
+		node_t num_nodes_;
+	};
+
+	bool is_borrowed(const model_t& object_id) const;
+	void copy_borrowed(const model_t& object_id);
+
 	double cell_size_;
 	scm::math::vec3d position_center_;
 
 	std::vector<boost::dynamic_bitset<>> visibility_;
+
+	// Models whose visibility still refers to mapped file data. Their bitsets in visibility_ are empty.
+	std::vector<borrowed_visibility> borrowed_visibility_;
+	size_t num_borrowed_;
+	std::shared_ptr<const visibility_file_mapping> mapping_;
 };
 
 }
@@ -0,0 +1,51 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group 
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef LAMURE_PVS_VIEW_CELL_REGULAR_RUN_LENGTH_H
+#define LAMURE_PVS_VIEW_CELL_REGULAR_RUN_LENGTH_H
+
+#include <lamure/pvs/pvs.h>
+#include "lamure/pvs/view_cell_regular.h"
+#include "lamure/pvs/run_length_visibility.h"
+
+namespace lamure
+{
+namespace pvs
+{
+
+// Regular view cell which stores the visibility of each model as runs of visible node ids instead of bitsets.
+class PVS_COMMON_DLL view_cell_regular_run_length : public view_cell_regular
+{
+public:
+	view_cell_regular_run_length();
+	view_cell_regular_run_length(const double& cell_size, const scm::math::vec3d& position_center);
+	~view_cell_regular_run_length();
+
+	virtual std::string get_cell_type() const;
+	static std::string get_cell_identifier();
+
+	virtual void set_visibility(const model_t& object_id, const node_t& node_id, const bool& visible);
+	virtual bool get_visibility(const model_t& object_id, const node_t& node_id) const;
+
+	virtual bool contains_visibility_data() const;
+	virtual std::map<model_t, std::vector<node_t>> get_visible_indices() const;
+	virtual void clear_visibility_data();
+
+	virtual boost::dynamic_bitset<> get_bitset(const model_t& object_id) const;
+	virtual void set_bitset(const model_t& object_id, const boost::dynamic_bitset<>& bitset);
+
+	const run_length_visibility& get_runs(const model_t& object_id) const;
+	void set_runs(const model_t& object_id, const run_length_visibility& runs);
+
+private:
+	std::vector<run_length_visibility> run_visibility_;
+};
+
+}
+}
+
+#endif
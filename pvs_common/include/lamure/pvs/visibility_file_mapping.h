@@ -0,0 +1,57 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group 
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef LAMURE_PVS_VISIBILITY_FILE_MAPPING_H
+#define LAMURE_PVS_VISIBILITY_FILE_MAPPING_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <lamure/pvs/pvs.h>
+#include <lamure/types.h>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+namespace lamure
+{
+namespace pvs
+{
+
+class view_cell_regular;
+
+// Read-only memory mapping of a .pvs file.
+// The file stores one block per view cell, each block contains one line per model and each line one bit per node.
+// View cells may refer to the mapped lines instead of copying them, so the mapping is shared with those cells.
+class PVS_COMMON_DLL visibility_file_mapping : public std::enable_shared_from_this<visibility_file_mapping>
+{
+public:
+	visibility_file_mapping(const std::string& file_path);
+	~visibility_file_mapping();
+
+	bool is_open() const;
+	const std::string& get_file_path() const;
+
+	const char* get_data() const;
+	size_t get_size() const;
+
+	// Loads the visibility of the view cell at the given index into the given view cell.
+	// If borrow is set, the view cell refers to the mapped data, otherwise the data is copied.
+	bool load_cell_visibility(view_cell_regular* cell, const size_t& cell_index, const std::vector<node_t>& ids, const bool& borrow) const;
+
+	static size_t get_line_size(const node_t& num_nodes);
+	static size_t get_cell_size(const std::vector<node_t>& ids);
+
+private:
+	std::string file_path_;
+	boost::iostreams::mapped_file_source file_;
+};
+
+}
+}
+
+#endif
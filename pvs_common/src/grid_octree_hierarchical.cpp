@@ -7,9 +7,12 @@
 
 #include <fstream>
 #include <deque>
+#include <cstring>
+#include <algorithm>
 
 #include "lamure/pvs/grid_octree_hierarchical.h"
 #include "lamure/pvs/pvs_utils.h"
+#include "lamure/pvs/visibility_file_mapping.h"
 
 namespace lamure
 {
@@ -239,7 +242,7 @@ load_cell_visibility_from_file(const std::string& file_path, const size_t& cell_
 {
 	std::lock_guard<std::mutex> lock(mutex_);
 
-	view_cell* current_cell = cells_by_indices_[cell_index];
+	view_cell_regular* current_cell = static_cast<view_cell_regular*>(cells_by_indices_[cell_index]);
 
 	// First check if visibility data is already loaded.
 	if(current_cell->contains_visibility_data())
@@ -247,71 +250,224 @@ load_cell_visibility_from_file(const std::string& file_path, const size_t& cell_
 		return true;
 	}
 
-	// If no visibility data exists, open the file and load them.
-	std::fstream file_in;
-	file_in.open(file_path, std::ios::in | std::ios::binary);
+	return load_cell_records(file_path, cell_index);
+}
 
-	if(!file_in.is_open())
+bool grid_octree_hierarchical::
+load_cell_records(const std::string& file_path, const size_t& cell_index)
+{
+	view_cell_regular* current_cell = static_cast<view_cell_regular*>(cells_by_indices_[cell_index]);
+
+	// The file stays mapped between calls and the position of every record is only computed once.
+	if(visibility_mapping_ == nullptr || visibility_mapping_->get_file_path() != file_path || cell_records_.size() != cells_by_indices_.size())
 	{
-		return false;
+		visibility_mapping_ = std::make_shared<visibility_file_mapping>(file_path);
+		compute_cell_records();
+
+		if(!visibility_mapping_->is_open() || !compute_visibility_record_offsets(*visibility_mapping_))
+		{
+			visibility_mapping_.reset();
+			return false;
+		}
 	}
 
+	std::vector<boost::dynamic_bitset<>> cell_visibility;
+	const std::vector<size_t>& records = cell_records_[cell_index];
+
+	for(size_t record_index = 0; record_index < records.size(); ++record_index)
+	{
+		uint64_t offset = record_offsets_[records[record_index]];
+		std::vector<boost::dynamic_bitset<>> record_visibility;
+
+		if(!read_visibility_record(*visibility_mapping_, offset, &record_visibility))
+		{
+			return false;
+		}
+
+		if(record_index == 0)
+		{
+			cell_visibility = record_visibility;
+		}
+		else
+		{
+			// Visibility common to all children is stored within the parent.
+			for(model_t model_index = 0; model_index < ids_.size(); ++model_index)
+			{
+				cell_visibility[model_index] |= record_visibility[model_index];
+			}
+		}
+
+		if(!is_parent_visibility_combined())
+		{
+			break;
+		}
+	}
+
+	for(model_t model_index = 0; model_index < ids_.size(); ++model_index)
+	{
+		current_cell->set_bitset(model_index, cell_visibility[model_index]);
+	}
+
+	return true;
+}
+
+size_t grid_octree_hierarchical::
+get_visibility_file_header_size() const
+{
 	// First byte is used to save whether visibility or occlusion data are written.
-	bool load_occlusion;
-	file_in.read(reinterpret_cast<char*>(&load_occlusion), sizeof(load_occlusion));
+	return sizeof(bool);
+}
 
-	// Must iterate over whole parent nodes from root to leaf level first.
-	size_t num_parents = 0;
-	size_t current_parent_level = cells_by_indices_.size();
+bool grid_octree_hierarchical::
+read_visibility_record(const visibility_file_mapping& mapping, uint64_t& offset, std::vector<boost::dynamic_bitset<>>* visibility) const
+{
+	bool load_occlusion = *reinterpret_cast<const bool*>(mapping.get_data());
 
-	// Sum up parent levels.
-	while(current_parent_level / 8 > 0)
+	if(visibility != nullptr)
 	{
-		current_parent_level = current_parent_level / 8;
-		num_parents += current_parent_level;
+		visibility->resize(ids_.size());
 	}
 
-	// Move to proper start point within file.
-	for(size_t jump_over_index = 0; jump_over_index < (cell_index + num_parents); ++jump_over_index)
-	{	
-		for(model_t model_index = 0; model_index < ids_.size(); ++model_index)
+	for(model_t model_index = 0; model_index < ids_.size(); ++model_index)
+	{
+		if(!read_node_indices(mapping, offset, !load_occlusion, visibility != nullptr ? &(*visibility)[model_index] : nullptr, model_index))
 		{
-			// Read number of values to pass.
-			node_t number_visibility_elements;
-			file_in.read(reinterpret_cast<char*>(&number_visibility_elements), sizeof(number_visibility_elements));
+			return false;
+		}
+	}
+
+	return true;
+}
 
-			file_in.seekg(file_in.tellg() + (std::streampos)(number_visibility_elements * sizeof(number_visibility_elements)));
+bool grid_octree_hierarchical::
+is_parent_visibility_combined() const
+{
+	return true;
+}
+
+bool grid_octree_hierarchical::
+read_node_indices(const visibility_file_mapping& mapping, uint64_t& offset, const bool& indices_visible, boost::dynamic_bitset<>* visibility, const model_t& model_id) const
+{
+	// Number of stored indices, followed by the indices.
+	node_t number_visibility_elements = 0;
+
+	if(offset + sizeof(node_t) > mapping.get_size())
+	{
+		return false;
+	}
+
+	std::memcpy(&number_visibility_elements, mapping.get_data() + offset, sizeof(node_t));
+	offset += sizeof(node_t);
+
+	if(offset + (uint64_t)number_visibility_elements * sizeof(node_t) > mapping.get_size())
+	{
+		return false;
+	}
+
+	if(visibility != nullptr)
+	{
+		// Nodes which are not listed have the opposite visibility.
+		visibility->clear();
+		visibility->resize(ids_[model_id], !indices_visible);
+
+		for(node_t element_index = 0; element_index < number_visibility_elements; ++element_index)
+		{
+			node_t visibility_index = 0;
+			std::memcpy(&visibility_index, mapping.get_data() + offset + element_index * sizeof(node_t), sizeof(node_t));
+
+			if(visibility_index < ids_[model_id])
+			{
+				(*visibility)[visibility_index] = indices_visible;
+			}
 		}
 	}
 
-	// WARNING: currently completely ignoring parent visibility! Therefore, runtime access is not correct!
-	// TODO: implement proper access including parents.
+	offset += (uint64_t)number_visibility_elements * sizeof(node_t);
+	return true;
+}
 
-	// Read the visibility data.
-	for(model_t model_index = 0; model_index < ids_.size(); ++model_index)
+bool grid_octree_hierarchical::
+compute_visibility_record_offsets(const visibility_file_mapping& mapping)
+{
+	record_offsets_.clear();
+
+	uint64_t offset = get_visibility_file_header_size();
+
+	if(offset > mapping.get_size())
+	{
+		return false;
+	}
+
+	// Records have variable size, so all of them have to be passed once.
+	size_t num_records = 0;
+	for(size_t cell_index = 0; cell_index < cell_records_.size(); ++cell_index)
 	{
-		// Set all nodes to proper default value depending on which kind of visibility index is stored.
-		for(node_t node_index = 0; node_index < ids_[model_index]; ++node_index)
+		if(cell_records_[cell_index].size() > 0)
 		{
-			current_cell->set_visibility(model_index, node_index, load_occlusion);
+			num_records = std::max(num_records, cell_records_[cell_index][0] + 1);
 		}
+	}
 
-		// Read number of values to be read afterwards.
-		node_t number_visibility_elements;
-		file_in.read(reinterpret_cast<char*>(&number_visibility_elements), sizeof(number_visibility_elements));
+	for(size_t record_index = 0; record_index < num_records; ++record_index)
+	{
+		record_offsets_.push_back(offset);
 
-		for(node_t node_index = 0; node_index < number_visibility_elements; ++node_index)
+		if(!read_visibility_record(mapping, offset, nullptr))
 		{
-			node_t visibility_index;
-			file_in.read(reinterpret_cast<char*>(&visibility_index), sizeof(visibility_index));
-			current_cell->set_visibility(model_index, visibility_index, !load_occlusion);
+			record_offsets_.clear();
+			return false;
 		}
 	}
 
-	file_in.close();
 	return true;
 }
 
+void grid_octree_hierarchical::
+compute_cell_records()
+{
+	cell_records_.clear();
+	cell_records_.resize(cells_by_indices_.size());
+
+	std::map<const view_cell*, size_t> cell_indices;
+	for(size_t cell_index = 0; cell_index < cells_by_indices_.size(); ++cell_index)
+	{
+		cell_indices[cells_by_indices_[cell_index]] = cell_index;
+	}
+
+	// Same breadth-first order as used when saving, the parent record is remembered for each node.
+	std::deque<std::pair<const grid_octree_node*, std::vector<size_t>>> unvisited_nodes;
+	unvisited_nodes.push_back(std::make_pair(root_node_, std::vector<size_t>()));
+
+	size_t record_index = 0;
+
+	while(unvisited_nodes.size() != 0)
+	{
+		const grid_octree_node* current_node = unvisited_nodes.front().first;
+		std::vector<size_t> records = unvisited_nodes.front().second;
+		unvisited_nodes.pop_front();
+
+		records.insert(records.begin(), record_index);
+		++record_index;
+
+		if(current_node->has_children())
+		{
+			for(size_t child_index = 0; child_index < 8; ++child_index)
+			{
+				unvisited_nodes.push_back(std::make_pair(current_node->get_child_at_index_const(child_index), records));
+			}
+		}
+		else
+		{
+			std::map<const view_cell*, size_t>::const_iterator cell_iter = cell_indices.find(current_node);
+
+			if(cell_iter != cell_indices.end())
+			{
+				cell_records_[cell_iter->second] = records;
+			}
+		}
+	}
+}
+
 void grid_octree_hierarchical::
 combine_visibility(const unsigned short& num_allowed_unequal_elements)
 {
@@ -9,6 +9,7 @@
 #include <deque>
 
 #include "lamure/pvs/grid_octree_hierarchical_v2.h"
+#include "lamure/pvs/visibility_file_mapping.h"
 
 namespace lamure
 {
@@ -227,84 +228,37 @@ load_visibility_from_file(const std::string& file_path)
 	return true;
 }
 
-bool grid_octree_hierarchical_v2::
-load_cell_visibility_from_file(const std::string& file_path, const size_t& cell_index)
+size_t grid_octree_hierarchical_v2::
+get_visibility_file_header_size() const
 {
-	std::lock_guard<std::mutex> lock(mutex_);
-
-	view_cell* current_cell = cells_by_indices_[cell_index];
-
-	// First check if visibility data is already loaded.
-	if(current_cell->contains_visibility_data())
-	{
-		return true;
-	}
-
-	// If no visibility data exists, open the file and load them.
-	std::fstream file_in;
-	file_in.open(file_path, std::ios::in | std::ios::binary);
-
-	if(!file_in.is_open())
-	{
-		return false;
-	}
-
-	// Must iterate over whole parent nodes from root to leaf level first.
-	size_t num_parents = 0;
-	size_t current_parent_level = cells_by_indices_.size();
+	return 0;
+}
 
-	// Sum up parent levels.
-	while(current_parent_level / 8 > 0)
+bool grid_octree_hierarchical_v2::
+read_visibility_record(const visibility_file_mapping& mapping, uint64_t& offset, std::vector<boost::dynamic_bitset<>>* visibility) const
+{
+	if(visibility != nullptr)
 	{
-		current_parent_level = current_parent_level / 8;
-		num_parents += current_parent_level;
+		visibility->resize(ids_.size());
 	}
 
-	// Move to proper start point within file.
-	for(size_t jump_over_index = 0; jump_over_index < (cell_index + num_parents); ++jump_over_index)
-	{	
-		for(model_t model_index = 0; model_index < ids_.size(); ++model_index)
-		{
-			// First byte is used to save whether visibility or occlusion data are written.
-			file_in.seekg(size_t(file_in.tellg()) + sizeof(bool));
-
-			// Read number of values to pass.
-			node_t number_visibility_elements;
-			file_in.read(reinterpret_cast<char*>(&number_visibility_elements), sizeof(number_visibility_elements));
-
-			file_in.seekg(file_in.tellg() + (std::streampos)(number_visibility_elements * sizeof(node_t)));
-		}
-	}
-
-	// WARNING: currently completely ignoring parent visibility! Therefore, runtime access is not correct!
-	// TODO: implement proper access including parents.
-
-	// Read the visibility data.
 	for(model_t model_index = 0; model_index < ids_.size(); ++model_index)
 	{
-		// First byte is used to save whether visibility or occlusion data are written.
-		bool load_occlusion;
-		file_in.read(reinterpret_cast<char*>(&load_occlusion), sizeof(load_occlusion));
-
-		// Set all nodes to proper default value depending on which kind of visibility index is stored.
-		for(node_t node_index = 0; node_index < ids_[model_index]; ++node_index)
+		// First byte of every model is used to save whether visibility or occlusion data are written.
+		if(offset + sizeof(bool) > mapping.get_size())
 		{
-			current_cell->set_visibility(model_index, node_index, load_occlusion);
+			return false;
 		}
 
-		// Read number of values to be read afterwards.
-		node_t number_visibility_elements;
-		file_in.read(reinterpret_cast<char*>(&number_visibility_elements), sizeof(number_visibility_elements));
+		bool load_occlusion = *reinterpret_cast<const bool*>(mapping.get_data() + offset);
+		offset += sizeof(bool);
 
-		for(node_t node_index = 0; node_index < number_visibility_elements; ++node_index)
+		if(!read_node_indices(mapping, offset, !load_occlusion, visibility != nullptr ? &(*visibility)[model_index] : nullptr, model_index))
 		{
-			node_t visibility_index;
-			file_in.read(reinterpret_cast<char*>(&visibility_index), sizeof(visibility_index));
-			current_cell->set_visibility(model_index, visibility_index, !load_occlusion);
+			return false;
 		}
 	}
 
-	file_in.close();
 	return true;
 }
 
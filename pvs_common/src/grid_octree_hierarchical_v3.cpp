@@ -9,6 +9,7 @@
 #include <deque>
 
 #include "lamure/pvs/grid_octree_hierarchical_v3.h"
+#include "lamure/pvs/visibility_file_mapping.h"
 
 namespace lamure
 {
@@ -189,68 +190,49 @@ load_cell_visibility_from_file(const std::string& file_path, const size_t& cell_
 		return true;
 	}
 
-	// If no visibility data exists, open the file and load them.
-	std::fstream file_in;
-	file_in.open(file_path, std::ios::in | std::ios::binary);
-
-	if(!file_in.is_open())
+	if(!load_cell_records(file_path, cell_index))
 	{
 		return false;
 	}
 
-	// Must iterate over whole parent nodes from root to leaf level first.
-	size_t num_parents = 0;
-	size_t current_parent_level = cells_by_indices_.size();
+	propagate_node_visibility(current_cell);
 
-	// Sum up parent levels.
-	while(current_parent_level / 8 > 0)
-	{
-		current_parent_level = current_parent_level / 8;
-		num_parents += current_parent_level;
-	}
+	return true;
+}
 
-	// Move to proper start point within file.
-	for(size_t jump_over_index = 0; jump_over_index < (cell_index + num_parents); ++jump_over_index)
-	{	
-		for(model_t model_index = 0; model_index < ids_.size(); ++model_index)
-		{
-			// Read number of values to pass.
-			node_t number_visibility_elements;
-			file_in.read(reinterpret_cast<char*>(&number_visibility_elements), sizeof(number_visibility_elements));
+size_t grid_octree_hierarchical_v3::
+get_visibility_file_header_size() const
+{
+	return 0;
+}
 
-			file_in.seekg(file_in.tellg() + (std::streampos)(number_visibility_elements * sizeof(number_visibility_elements)));
-		}
+bool grid_octree_hierarchical_v3::
+read_visibility_record(const visibility_file_mapping& mapping, uint64_t& offset, std::vector<boost::dynamic_bitset<>>* visibility) const
+{
+	if(visibility != nullptr)
+	{
+		visibility->resize(ids_.size());
 	}
 
-	// Read the visibility data.
+	// Only visible IDs are stored.
 	for(model_t model_index = 0; model_index < ids_.size(); ++model_index)
 	{
-		// Set all nodes to proper default value depending on which kind of visibility index is stored.
-		for(node_t node_index = 0; node_index < ids_[model_index]; ++node_index)
-		{
-			current_cell->set_visibility(model_index, node_index, false);
-		}
-
-		// Read number of values to be read afterwards.
-		node_t number_visibility_elements;
-		file_in.read(reinterpret_cast<char*>(&number_visibility_elements), sizeof(number_visibility_elements));
-
-		// Read visible IDs.
-		for(node_t node_index = 0; node_index < number_visibility_elements; ++node_index)
+		if(!read_node_indices(mapping, offset, true, visibility != nullptr ? &(*visibility)[model_index] : nullptr, model_index))
 		{
-			node_t visibility_index;
-			file_in.read(reinterpret_cast<char*>(&visibility_index), sizeof(visibility_index));
-			current_cell->set_visibility(model_index, visibility_index, true);
-
+			return false;
 		}
-		
-		propagate_node_visibility(current_cell);
 	}
 
-	file_in.close();
 	return true;
 }
 
+bool grid_octree_hierarchical_v3::
+is_parent_visibility_combined() const
+{
+	// Cells of this grid type are never combined, so parents do not carry visibility.
+	return false;
+}
+
 void grid_octree_hierarchical_v3::
 propagate_node_visibility(view_cell* cell)
 {
@@ -6,6 +6,7 @@
 // http://www.uni-weimar.de/medien/vr
 
 #include "lamure/pvs/grid_regular.h"
+#include "lamure/pvs/visibility_file_mapping.h"
 
 #include <fstream>
 #include <stdexcept>
@@ -309,52 +310,32 @@ load_visibility_from_file(const std::string& file_path)
 {
 	std::lock_guard<std::mutex> lock(mutex_);
 
-	std::fstream file_in;
-	file_in.open(file_path, std::ios::in | std::ios::binary);
+	std::shared_ptr<visibility_file_mapping> mapping = std::make_shared<visibility_file_mapping>(file_path);
 
-	if(!file_in.is_open())
+	if(!mapping->is_open())
 	{
 		return false;
 	}
 
-	for(size_t cell_index = 0; cell_index < cells_.size(); ++cell_index)
+	// The data is copied, so the file is unmapped again afterwards.
+	size_t num_cells = cells_.size();
+	for(size_t cell_index = 0; cell_index < num_cells; ++cell_index)
 	{
-		view_cell* current_cell = cells_[cell_index];
+		view_cell_regular* current_cell = cells_[cell_index];
 
-		// One line per model.
-		for(model_t model_index = 0; model_index < ids_.size(); ++model_index)
+		if(!mapping->load_cell_visibility(current_cell, cell_index, ids_, false))
 		{
-			node_t num_nodes = ids_.at(model_index);
-			size_t line_length = num_nodes / CHAR_BIT + (num_nodes % CHAR_BIT == 0 ? 0 : 1);
-
-      std::vector<char> current_line_data(line_length);
-
-			file_in.read(&current_line_data[0], line_length);
-
-			// Used to avoid continuing resize within visibility data.
-			current_cell->set_visibility(model_index, num_nodes - 1, false);
-
-			for(node_t character_index = 0; character_index < line_length; ++character_index)
-			{
-				char current_byte = current_line_data[character_index];
-				
-				for(unsigned short bit_index = 0; bit_index < CHAR_BIT; ++bit_index)
-				{
-					bool visible = ((current_byte >> bit_index) & 1) == 0x01;
-					current_cell->set_visibility(model_index, (character_index * CHAR_BIT) + bit_index, visible);
-				}
-			}
+			return false;
 		}
 	}
 
-	file_in.close();
 	return true;
 }
 
 void grid_regular::
 clear_cell_visibility(const size_t& cell_index)
 {
-	if(this->get_num_models() <= cell_index)
+	if(this->get_cell_count() <= cell_index)
 	{
 		return;
 	}
@@ -369,7 +350,7 @@ load_cell_visibility_from_file(const std::string& file_path, const size_t& cell_
 {
 	std::lock_guard<std::mutex> lock(mutex_);
 
-	view_cell* current_cell = cells_[cell_index];
+	view_cell_regular* current_cell = cells_[cell_index];
 
 	// First check if visibility data is already loaded.
 	if(current_cell->contains_visibility_data())
@@ -377,63 +358,19 @@ load_cell_visibility_from_file(const std::string& file_path, const size_t& cell_
 		return true;
 	}
 
-	// If no visibility data exists, open the file and load them.
-	std::fstream file_in;
-	file_in.open(file_path, std::ios::in | std::ios::binary);
-
-	if(!file_in.is_open())
-	{
-		return false;
-	}
-
-	// Calculate the number of bytes of a view cell (note: every view cell requires same storage).
-	node_t single_cell_bytes = 0;
-
-	for(model_t model_index = 0; model_index < ids_.size(); ++model_index)
+	// The file stays mapped between calls, the cell only refers to its part of the mapped data.
+	if(visibility_mapping_ == nullptr || visibility_mapping_->get_file_path() != file_path)
 	{
-		node_t num_nodes = ids_.at(model_index);
-
-		// If the number of node IDs is not dividable by 8 there is one additional character.
-		node_t addition = 0;
-		if(num_nodes % CHAR_BIT != 0)
-		{
-			addition = 1;
-		}
-
-		node_t line_size = (num_nodes / CHAR_BIT) + addition;
-		single_cell_bytes += line_size;
+		visibility_mapping_ = std::make_shared<visibility_file_mapping>(file_path);
 	}
 
-	// Move to proper start point within file.
-	file_in.seekg(cell_index * single_cell_bytes);
-
-	// Read the visibility data.
-	for(model_t model_index = 0; model_index < ids_.size(); ++model_index)
+	if(!visibility_mapping_->is_open())
 	{
-		node_t num_nodes = ids_.at(model_index);
-		size_t line_length = num_nodes / CHAR_BIT + (num_nodes % CHAR_BIT == 0 ? 0 : 1);
-    std::vector<char> current_line_data(line_length);
-
-		file_in.read(&current_line_data[0], line_length);
-
-		// Used to avoid continuing resize within visibility data.
-		current_cell->set_visibility(model_index, num_nodes - 1, false);
-
-		for(node_t character_index = 0; character_index < line_length; ++character_index)
-		{
-			char current_byte = current_line_data[character_index];
-			
-			for(unsigned short bit_index = 0; bit_index < CHAR_BIT; ++bit_index)
-			{
-				bool visible = ((current_byte >> bit_index) & 1) == 0x01;
-				current_cell->set_visibility(model_index, (character_index * CHAR_BIT) + bit_index, visible);
-			}
-		}
+		visibility_mapping_.reset();
+		return false;
 	}
 
-	file_in.close();
-
-	return true;
+	return visibility_mapping_->load_cell_visibility(current_cell, cell_index, ids_, true);
 }
 
 void grid_regular::
@@ -456,7 +393,7 @@ create_grid(const size_t& num_cells, const double& cell_size, const scm::math::v
 			for(size_t index_x = 0; index_x < num_cells; ++index_x)
 			{
 				scm::math::vec3d pos = position_center + (scm::math::vec3d(index_x , index_y, index_z) * cell_size) - half_size + cell_offset;
-				cells_.push_back(new view_cell_regular(cell_size, pos));
+				cells_.push_back(create_view_cell(cell_size, pos));
 			}
 		}
 	}
@@ -466,6 +403,12 @@ create_grid(const size_t& num_cells, const double& cell_size, const scm::math::v
 	position_center_ = scm::math::vec3d(position_center);
 }
 
+view_cell_regular* grid_regular::
+create_view_cell(const double& cell_size, const scm::math::vec3d& position_center) const
+{
+	return new view_cell_regular(cell_size, position_center);
+}
+
 model_t grid_regular::
 get_num_models() const
 {
@@ -0,0 +1,241 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group 
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include "lamure/pvs/grid_regular_run_length.h"
+#include "lamure/pvs/visibility_file_mapping.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace lamure
+{
+namespace pvs
+{
+
+grid_regular_run_length::
+grid_regular_run_length() : grid_regular_run_length(1, 1.0, scm::math::vec3d(0.0, 0.0, 0.0), std::vector<node_t>())
+{
+}
+
+grid_regular_run_length::
+grid_regular_run_length(const size_t& number_cells, const double& cell_size, const scm::math::vec3d& position_center, const std::vector<node_t>& ids) : grid_regular(number_cells, cell_size, position_center, ids)
+{
+	// The constructor of the regular grid can not create the derived view cells, so the cells are recreated.
+	create_grid(number_cells, cell_size_, position_center_);
+}
+
+grid_regular_run_length::
+~grid_regular_run_length()
+{
+}
+
+std::string grid_regular_run_length::
+get_grid_type() const
+{
+	return get_grid_identifier();
+}
+
+std::string grid_regular_run_length::
+get_grid_identifier()
+{
+	return "regular_run_length";
+}
+
+void grid_regular_run_length::
+save_grid_to_file(const std::string& file_path) const
+{
+	save_regular_grid(file_path, get_grid_identifier());
+}
+
+void grid_regular_run_length::
+save_visibility_to_file(const std::string& file_path) const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	std::fstream file_out;
+	file_out.open(file_path, std::ios::out | std::ios::binary);
+
+	if(!file_out.is_open())
+	{
+		throw std::invalid_argument("invalid file path: " + file_path);
+	}
+
+	std::vector<std::string> data_blocks(cells_.size());
+
+	// Iterate over view cells, each block contains the runs of all models.
+	for(size_t cell_index = 0; cell_index < cells_.size(); ++cell_index)
+	{
+		const view_cell_regular_run_length* current_cell = static_cast<const view_cell_regular_run_length*>(cells_[cell_index]);
+
+		for(model_t model_id = 0; model_id < ids_.size(); ++model_id)
+		{
+			current_cell->get_runs(model_id).serialize(data_blocks[cell_index]);
+		}
+	}
+
+	// Save sizes of data blocks.
+	for(size_t current_block_index = 0; current_block_index < data_blocks.size(); ++current_block_index)
+	{
+		uint64_t current_block_size = data_blocks[current_block_index].size();
+		file_out.write(reinterpret_cast<char*>(&current_block_size), sizeof(current_block_size));
+	}
+
+	// Save data blocks.
+	for(size_t current_block_index = 0; current_block_index < data_blocks.size(); ++current_block_index)
+	{
+		file_out.write(data_blocks[current_block_index].c_str(), data_blocks[current_block_index].length());
+	}
+
+	file_out.close();
+}
+
+bool grid_regular_run_length::
+load_grid_from_file(const std::string& file_path)
+{
+	return load_regular_grid(file_path, get_grid_identifier());
+}
+
+bool grid_regular_run_length::
+load_visibility_from_file(const std::string& file_path)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	visibility_file_mapping mapping(file_path);
+
+	if(!mapping.is_open() || !read_block_offsets(mapping))
+	{
+		return false;
+	}
+
+	for(size_t cell_index = 0; cell_index < cells_.size(); ++cell_index)
+	{
+		if(!read_cell_block(mapping, cell_index))
+		{
+			return false;
+		}
+	}
+
+	// Offsets are only valid for the file mapped by load_cell_visibility_from_file().
+	visibility_block_offsets_.clear();
+	visibility_mapping_.reset();
+
+	return true;
+}
+
+bool grid_regular_run_length::
+load_cell_visibility_from_file(const std::string& file_path, const size_t& cell_index)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	view_cell* current_cell = cells_[cell_index];
+
+	// First check if visibility data is already loaded.
+	if(current_cell->contains_visibility_data())
+	{
+		return true;
+	}
+
+	// The file stays mapped between calls, so loading a cell only decodes its runs.
+	if(visibility_mapping_ == nullptr || visibility_mapping_->get_file_path() != file_path)
+	{
+		visibility_mapping_ = std::make_shared<visibility_file_mapping>(file_path);
+
+		if(!visibility_mapping_->is_open() || !read_block_offsets(*visibility_mapping_))
+		{
+			visibility_mapping_.reset();
+			return false;
+		}
+	}
+
+	return read_cell_block(*visibility_mapping_, cell_index);
+}
+
+bool grid_regular_run_length::
+read_block_offsets(const visibility_file_mapping& mapping)
+{
+	visibility_block_offsets_.clear();
+
+	// First data is the block sizes (one 64 bit integer per view cell).
+	uint64_t header_size = cells_.size() * sizeof(uint64_t);
+
+	if(mapping.get_size() < header_size)
+	{
+		return false;
+	}
+
+	uint64_t block_offset = header_size;
+
+	for(size_t cell_index = 0; cell_index < cells_.size(); ++cell_index)
+	{
+		uint64_t block_size = 0;
+		std::memcpy(&block_size, mapping.get_data() + cell_index * sizeof(uint64_t), sizeof(uint64_t));
+
+		visibility_block_offsets_.push_back(block_offset);
+		block_offset += block_size;
+	}
+
+	visibility_block_offsets_.push_back(block_offset);
+
+	return block_offset <= mapping.get_size();
+}
+
+bool grid_regular_run_length::
+read_cell_block(const visibility_file_mapping& mapping, const size_t& cell_index)
+{
+	view_cell_regular_run_length* current_cell = static_cast<view_cell_regular_run_length*>(cells_[cell_index]);
+
+	const char* data = mapping.get_data() + visibility_block_offsets_[cell_index];
+	const char* data_end = mapping.get_data() + visibility_block_offsets_[cell_index + 1];
+
+	for(model_t model_index = 0; model_index < ids_.size(); ++model_index)
+	{
+		run_length_visibility runs;
+
+		if(!runs.deserialize(data, data_end, ids_[model_index]))
+		{
+			current_cell->clear_visibility_data();
+			return false;
+		}
+
+		current_cell->set_runs(model_index, runs);
+	}
+
+	return true;
+}
+
+run_length_visibility grid_regular_run_length::
+get_cell_visibility_difference(const size_t& cell_index, const size_t& other_cell_index, const model_t& model_id) const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	const view_cell_regular_run_length* current_cell = static_cast<const view_cell_regular_run_length*>(cells_[cell_index]);
+	const view_cell_regular_run_length* other_cell = static_cast<const view_cell_regular_run_length*>(cells_[other_cell_index]);
+
+	return run_length_visibility::subtract(current_cell->get_runs(model_id), other_cell->get_runs(model_id));
+}
+
+run_length_visibility grid_regular_run_length::
+get_common_cell_visibility(const size_t& cell_index, const size_t& other_cell_index, const model_t& model_id) const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	const view_cell_regular_run_length* current_cell = static_cast<const view_cell_regular_run_length*>(cells_[cell_index]);
+	const view_cell_regular_run_length* other_cell = static_cast<const view_cell_regular_run_length*>(cells_[other_cell_index]);
+
+	return run_length_visibility::intersect(current_cell->get_runs(model_id), other_cell->get_runs(model_id));
+}
+
+view_cell_regular* grid_regular_run_length::
+create_view_cell(const double& cell_size, const scm::math::vec3d& position_center) const
+{
+	return new view_cell_regular_run_length(cell_size, position_center);
+}
+
+}
+}
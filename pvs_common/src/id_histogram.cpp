@@ -6,15 +6,128 @@
 // http://www.uni-weimar.de/medien/vr
 
 #include "lamure/pvs/id_histogram.h"
-#include <iostream>
-#include <fstream>
-#include <bitset>
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
 
 namespace lamure
 {
 namespace pvs
 {
 
+namespace
+{
+
+// Below this amount of pixels starting threads costs more than it saves.
+const size_t min_pixels_per_thread = 1 << 16;
+
+// Open addressing hash table counting pixel values.
+// A pixel value of zero has an alpha value of zero, which maps to the invalid model ID 255, so it marks empty slots.
+class pixel_count_table
+{
+public:
+	pixel_count_table()
+		: keys_(1 << 12, 0), counts_(1 << 12, 0), num_keys_(0)
+	{
+	}
+
+	void add(const uint32_t& key, const uint32_t& count)
+	{
+		// Keep the load factor below one half so probe sequences stay short.
+		if((num_keys_ + 1) * 2 > keys_.size())
+		{
+			grow();
+		}
+
+		size_t mask = keys_.size() - 1;
+		size_t slot = hash(key) & mask;
+
+		while(keys_[slot] != key)
+		{
+			if(keys_[slot] == 0)
+			{
+				keys_[slot] = key;
+				++num_keys_;
+				break;
+			}
+
+			slot = (slot + 1) & mask;
+		}
+
+		counts_[slot] += count;
+	}
+
+	const std::vector<uint32_t>& get_keys() const
+	{
+		return keys_;
+	}
+
+	const std::vector<uint32_t>& get_counts() const
+	{
+		return counts_;
+	}
+
+	size_t get_num_keys() const
+	{
+		return num_keys_;
+	}
+
+private:
+	static size_t hash(const uint32_t& key)
+	{
+		return (size_t)((key * 2654435761u) ^ (key >> 16));
+	}
+
+	void grow()
+	{
+		std::vector<uint32_t> old_keys(keys_.size() * 2, 0);
+		std::vector<uint32_t> old_counts(counts_.size() * 2, 0);
+		old_keys.swap(keys_);
+		old_counts.swap(counts_);
+		num_keys_ = 0;
+
+		for(size_t slot = 0; slot < old_keys.size(); ++slot)
+		{
+			if(old_keys[slot] != 0)
+			{
+				add(old_keys[slot], old_counts[slot]);
+			}
+		}
+	}
+
+	std::vector<uint32_t> keys_;
+	std::vector<uint32_t> counts_;
+	size_t num_keys_;
+};
+
+void count_pixels(const uint32_t* pixels, const size_t& numPixels, pixel_count_table* table)
+{
+	size_t index = 0;
+
+	// Splats cover many neighbouring pixels, so equal values are counted as a run before touching the table.
+	while(index < numPixels)
+	{
+		uint32_t pixelValue = pixels[index];
+		size_t runEnd = index + 1;
+
+		while(runEnd < numPixels && pixels[runEnd] == pixelValue)
+		{
+			++runEnd;
+		}
+
+		// RGBA-value is written in order AGBR, alpha value zero results in model ID 255 which marks empty pixels.
+		if((pixelValue >> 24) != 0)
+		{
+			table->add(pixelValue, (uint32_t)(runEnd - index));
+		}
+
+		index = runEnd;
+	}
+}
+
+}
+
 id_histogram::id_histogram()
 {
 }
@@ -26,20 +139,81 @@ id_histogram::~id_histogram()
 void id_histogram::
 create(const void* pixelData, const size_t& numPixels)
 {
-	histogram_.clear();
-	const unsigned int* pixelDataInt = (unsigned int*)pixelData;
+	create(pixelData, numPixels, 0);
+}
+
+void id_histogram::
+create(const void* pixelData, const size_t& numPixels, const unsigned int& numThreads)
+{
+	entries_.clear();
+	const uint32_t* pixelDataInt = (const uint32_t*)pixelData;
+
+	size_t numUsedThreads = numThreads > 0 ? numThreads : std::max(1u, std::thread::hardware_concurrency());
+	numUsedThreads = std::max((size_t)1, std::min(numUsedThreads, numPixels / min_pixels_per_thread));
+
+	// Every thread counts a contiguous range of pixels into its own table.
+	std::vector<pixel_count_table> tables(numUsedThreads);
+	std::vector<std::thread> threads;
+	size_t pixelsPerThread = (numPixels + numUsedThreads - 1) / numUsedThreads;
+
+	for(size_t threadIndex = 1; threadIndex < numUsedThreads; ++threadIndex)
+	{
+		size_t begin = std::min(numPixels, threadIndex * pixelsPerThread);
+		size_t end = std::min(numPixels, begin + pixelsPerThread);
+		threads.push_back(std::thread(count_pixels, pixelDataInt + begin, end - begin, &tables[threadIndex]));
+	}
+
+	count_pixels(pixelDataInt, std::min(numPixels, pixelsPerThread), &tables[0]);
+
+	for(std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	// Reduce the tables by sorting all counted values on model and node ID and merging equal ones.
+	size_t numKeys = 0;
+	for(const pixel_count_table& table : tables)
+	{
+		numKeys += table.get_num_keys();
+	}
+
+	std::vector<std::pair<uint32_t, uint32_t>> counts;
+	counts.reserve(numKeys);
 
-	for(size_t index = 0; index < numPixels; ++index)
+	for(const pixel_count_table& table : tables)
 	{
-		unsigned int pixelValue = pixelDataInt[index];
-		model_t modelID = (pixelValue >> 24) & 0xFF;					// RGBA-value is written in order AGBR, so skip 24 bits to get to model ID within alpha channel.
+		for(size_t slot = 0; slot < table.get_keys().size(); ++slot)
+		{
+			uint32_t pixelValue = table.get_keys()[slot];
+
+			if(pixelValue != 0)
+			{
+				// Model ID is stored inverted in the alpha channel. Helps to create a more visible object by starting at higher alpha values.
+				uint32_t modelID = 255 - ((pixelValue >> 24) & 0xFF);
+				counts.push_back(std::make_pair((modelID << 24) | (pixelValue & 0xFFFFFF), table.get_counts()[slot]));
+			}
+		}
+	}
+
+	std::sort(counts.begin(), counts.end());
+	entries_.reserve(counts.size());
 
-		modelID = 255 - modelID;										// Debug thingie. Helps to create a more visible object by starting at higher alpha values.
+	for(const std::pair<uint32_t, uint32_t>& count : counts)
+	{
+		model_t modelID = count.first >> 24;
+		node_t nodeID = count.first & 0xFFFFFF;
 
-		if(modelID != 255)
+		if(!entries_.empty() && entries_.back().model_id_ == modelID && entries_.back().node_id_ == nodeID)
+		{
+			entries_.back().num_pixels_ += count.second;
+		}
+		else
 		{
-			node_t nodeID = pixelValue & 0xFFFFFF;						// RGBA-value is written in order AGBR, so first 24 bits are node ID.
-			histogram_[modelID][nodeID]++;
+			entry newEntry;
+			newEntry.model_id_ = modelID;
+			newEntry.node_id_ = nodeID;
+			newEntry.num_pixels_ = count.second;
+			entries_.push_back(newEntry);
 		}
 	}
 }
@@ -49,24 +223,31 @@ get_visible_nodes(const size_t& numPixels, const float& visibilityThreshold) con
 {
 	std::map<model_t, std::vector<node_t>> visibleNodes;
 
-	for(std::map<model_t, std::map<node_t, size_t>>::const_iterator modelIter = histogram_.begin(); modelIter != histogram_.end(); ++modelIter)
+	for_each_visible_node(numPixels, visibilityThreshold, [&visibleNodes](const model_t& modelID, const node_t& nodeID)
 	{
-		for(std::map<node_t, size_t>::const_iterator nodeIter = modelIter->second.begin(); nodeIter != modelIter->second.end(); ++nodeIter)
-		{
-			if(((float)nodeIter->second / (float)numPixels) * 100.0f >= visibilityThreshold)
-			{
-				visibleNodes[modelIter->first].push_back(nodeIter->first);
-			}
-		}
-	}
+		visibleNodes[modelID].push_back(nodeID);
+	});
 
 	return visibleNodes;
 }
 
+const std::vector<id_histogram::entry>& id_histogram::
+get_entries() const
+{
+	return entries_;
+}
+
 std::map<model_t, std::map<node_t, size_t>> id_histogram::
 get_histogram() const
 {
-	return histogram_;
+	std::map<model_t, std::map<node_t, size_t>> histogram;
+
+	for(const entry& current_entry : entries_)
+	{
+		histogram[current_entry.model_id_][current_entry.node_id_] = current_entry.num_pixels_;
+	}
+
+	return histogram;
 }
 
 }
@@ -5,12 +5,16 @@
 // Faculty of Media, Bauhaus-Universitaet Weimar
 // http://www.uni-weimar.de/medien/vr
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <limits>
 #include <string>
 
 #include "lamure/pvs/pvs_database.h"
 #include "lamure/pvs/grid_regular.h"
 #include "lamure/pvs/grid_regular_compressed.h"
+#include "lamure/pvs/grid_regular_run_length.h"
 #include "lamure/pvs/grid_octree.h"
 #include "lamure/pvs/grid_octree_compressed.h"
 #include "lamure/pvs/grid_octree_hierarchical.h"
@@ -38,13 +42,29 @@ pvs_database()
 	activated_ = true;
 	do_preload_ = false;
 	shutdown_ = false;
+
+	cell_memory_size_ = 0;
+	memory_budget_ = 256 * 1024 * 1024;
+	prefetch_time_in_s_ = 1.0;
+	viewer_velocity_ = scm::math::vec3d(0.0, 0.0, 0.0);
+	has_last_position_ = false;
+	viewer_cell_index_ = std::numeric_limits<size_t>::max();
+	predicted_cell_index_ = std::numeric_limits<size_t>::max();
+	is_stalled_ = false;
+	stalled_cell_index_ = 0;
+	reset_statistics();
 	
 	//configure semaphore
   semaphore_.set_min_signal_count(1);
   semaphore_.set_max_signal_count(std::numeric_limits<size_t>::max());
-	
-	visibility_data_loading_thread_ = std::thread(&pvs_database::loading_thread_loop, this);
-	
+
+	// Loading is bound by file access, a few threads suffice to keep several requests in flight.
+	unsigned int num_loading_threads = std::max(2u, std::min(4u, std::thread::hardware_concurrency() / 2));
+
+	for(unsigned int thread_index = 0; thread_index < num_loading_threads; ++thread_index)
+	{
+		visibility_data_loading_threads_.push_back(std::thread(&pvs_database::loading_thread_loop, this));
+	}
 }
 
 pvs_database::
@@ -53,9 +73,12 @@ pvs_database::
   shutdown_ = true;
   semaphore_.shutdown();
 
-	if(visibility_data_loading_thread_.joinable())
+	for(std::thread& loading_thread : visibility_data_loading_threads_)
 	{
-		visibility_data_loading_thread_.join();
+		if(loading_thread.joinable())
+		{
+			loading_thread.join();
+		}
 	}
 	
 	if(visibility_grid_ != nullptr)
@@ -78,9 +101,12 @@ get_instance()
 bool pvs_database::
 load_pvs_from_file(const std::string& grid_file_path, const std::string& pvs_file_path, const bool& do_preload)
 {
+	reset_loading_state();
+
 	std::lock_guard<std::mutex> lock(mutex_);
 
 	do_preload_ = do_preload;
+	viewer_cell_ = nullptr;
 	visibility_grid_ = load_grid_from_file(grid_file_path);
 
 	if(visibility_grid_ == nullptr)
@@ -110,11 +136,12 @@ load_pvs_from_file(const std::string& grid_file_path, const std::string& pvs_fil
 		}
 	}
 
-	// Force preload on certain grid types since runtime access is not working properly.
-	if(visibility_grid_->get_grid_type() == grid_octree_hierarchical::get_grid_identifier() ||
-		visibility_grid_->get_grid_type() == grid_octree_hierarchical_v2::get_grid_identifier())
+	// Memory of a loaded cell is dominated by one visibility bit per node.
+	cell_memory_size_ = 0;
+
+	for(model_t model_index = 0; model_index < visibility_grid_->get_num_models(); ++model_index)
 	{
-		do_preload_ = true;
+		cell_memory_size_ += (visibility_grid_->get_num_nodes(model_index) + 7) / 8;
 	}
 	
 	if(do_preload_)
@@ -220,6 +247,10 @@ create_grid_by_type(const std::string& grid_type) const
     {
         output_grid = new grid_regular_compressed();
     }
+    else if(grid_type == grid_regular_run_length::get_grid_identifier())
+    {
+        output_grid = new grid_regular_run_length();
+    }
     else if(grid_type == grid_octree::get_grid_identifier())
     {   
         output_grid = new grid_octree();
@@ -267,6 +298,10 @@ create_grid_by_type(const std::string& grid_type, const size_t& num_cells_x, con
     {
         output_grid = new grid_regular_compressed(max_num_cells, bounds_size, position_center, ids);
     }
+    else if(grid_type == grid_regular_run_length::get_grid_identifier())
+    {
+        output_grid = new grid_regular_run_length(max_num_cells, bounds_size, position_center, ids);
+    }
     else if(grid_type == grid_octree::get_grid_identifier())
     {   
         output_grid = new grid_octree(max_num_cells, bounds_size, position_center, ids);
@@ -300,31 +335,44 @@ create_grid_by_type(const std::string& grid_type, const size_t& num_cells_x, con
 }
 
 void pvs_database::
-loading_thread_loop() {
-
-  while (true) {
-  
-    semaphore_.wait();
-    
-    if (shutdown_) {
-      break;
-    }
-    
-    int64_t cell_index = -1;
-    if (loading_queue_.size() > 0) {
-      loading_mutex_.lock();
-      if (loading_queue_.size() > 0) {
-        cell_index = loading_queue_.front();
-        loading_queue_.pop();
-      }
-      loading_mutex_.unlock();
-    }
-    
-    if (cell_index >= 0) {
-      load_visibility_data_async(cell_index);
-    }
-  }
+loading_thread_loop()
+{
+	while(true)
+	{
+		semaphore_.wait();
 
+		if(shutdown_)
+		{
+			break;
+		}
+
+		int64_t cell_index = -1;
+
+		{
+			std::lock_guard<std::mutex> lock(loading_mutex_);
+
+			// Requests which are not pinned anymore became stale since the viewer moved on.
+			while(!loading_queue_.empty() && cell_index < 0)
+			{
+				uint64_t next_cell_index = loading_queue_.front();
+				loading_queue_.pop_front();
+
+				if(visibility_grid_ != nullptr &&
+					pinned_cell_indices_.find(next_cell_index) != pinned_cell_indices_.end() &&
+					cells_in_flight_.find(next_cell_index) == cells_in_flight_.end() &&
+					!visibility_grid_->get_cell_at_index(next_cell_index)->contains_visibility_data())
+				{
+					cells_in_flight_.insert(next_cell_index);
+					cell_index = next_cell_index;
+				}
+			}
+		}
+
+		if(cell_index >= 0)
+		{
+			load_visibility_data_async(cell_index);
+		}
+	}
 }
 
 void pvs_database::
@@ -336,33 +384,65 @@ set_viewer_position(const scm::math::vec3d& position)
 	{
 		if(position != position_viewer_)
 		{
+			update_viewer_velocity(position);
 			position_viewer_ = position;
+
 			size_t cell_index = 0;
 			const view_cell* view_cell_at_position = visibility_grid_->get_cell_at_position(position, &cell_index);
 
 			// Position is outside of major grid. Use bounding grid instead.
 			if(view_cell_at_position != nullptr)
 			{
+				// The cell at the end of the extrapolated path decides whether the prefetch request is outdated.
+				size_t predicted_cell_index = cell_index;
+				if(visibility_grid_->get_cell_at_position(position + viewer_velocity_ * prefetch_time_in_s_, &predicted_cell_index) == nullptr)
+				{
+					predicted_cell_index = cell_index;
+				}
+
+				std::lock_guard<std::mutex> lock(loading_mutex_);
+
 				// Only set viewer cell if it changed.
 				if(view_cell_at_position != viewer_cell_)
 				{
 					viewer_cell_ = view_cell_at_position;
+					viewer_cell_index_ = cell_index;
+					update_stall_time();
 
-					// If the view cell changed and the visibility data is not preloaded, it should be loaded now.
-					if(!do_preload_)
+					if(view_cell_at_position->contains_visibility_data())
 					{
-					
-            loading_mutex_.lock();
-            loading_queue_.push(cell_index);
-            //std::cout << "add cell " << cell_index << std::endl;
-						loading_mutex_.unlock();
-						semaphore_.signal(1);
-						
+						++statistics_.cell_hits_;
+					}
+					else
+					{
+						++statistics_.cell_misses_;
+
+						is_stalled_ = true;
+						stalled_cell_index_ = cell_index;
+						stall_begin_ = std::chrono::steady_clock::now();
 					}
 				}
+				else if(predicted_cell_index == predicted_cell_index_)
+				{
+					return;
+				}
+
+				predicted_cell_index_ = predicted_cell_index;
+
+				// If the visibility data is not preloaded, the cells around the viewer and along its path should be loaded now.
+				if(!do_preload_)
+				{
+					update_loading_queue(cell_index);
+				}
 			}
 			else
 			{
+				{
+					std::lock_guard<std::mutex> lock(loading_mutex_);
+					viewer_cell_index_ = std::numeric_limits<size_t>::max();
+					update_stall_time();
+				}
+
 				if(bounding_grid_ != nullptr)
 				{
 					view_cell_at_position = bounding_grid_->get_cell_at_position(position, &cell_index);
@@ -379,19 +459,60 @@ set_viewer_position(const scm::math::vec3d& position)
 }
 
 void pvs_database::
-load_visibility_data_async(uint64_t cell_index)
+update_viewer_velocity(const scm::math::vec3d& position)
+{
+	std::chrono::steady_clock::time_point current_time = std::chrono::steady_clock::now();
+
+	if(has_last_position_)
+	{
+		double elapsed_time = std::chrono::duration<double>(current_time - last_position_time_).count();
+
+		// After long pauses or jumps the previous motion says nothing about the next one.
+		if(elapsed_time > 0.0 && elapsed_time < 0.5)
+		{
+			scm::math::vec3d current_velocity = (position - position_viewer_) / elapsed_time;
+			viewer_velocity_ = viewer_velocity_ * 0.5 + current_velocity * 0.5;
+		}
+		else
+		{
+			viewer_velocity_ = scm::math::vec3d(0.0, 0.0, 0.0);
+		}
+	}
+
+	has_last_position_ = true;
+	last_position_time_ = current_time;
+}
+
+void pvs_database::
+update_loading_queue(const size_t& viewer_cell_index)
 {
-  const view_cell* cell = visibility_grid_->get_cell_at_index(cell_index);
-  //
-  if (cell != viewer_cell_) {
-    return;
-  }
-  
-  //std::cout << "loading cell " << cell_index << std::endl;
-  
-	scm::math::vec3d center = cell->get_position_center();
-
-	std::set<size_t> cell_indices_to_load;
+	std::vector<uint64_t> requested_cell_indices;
+	requested_cell_indices.push_back(viewer_cell_index);
+
+	// Sample the extrapolated path densely enough to not skip the smallest cells.
+	scm::math::vec3d path = viewer_velocity_ * prefetch_time_in_s_;
+	double path_length = scm::math::length(path);
+	double step_length = 0.5 * std::min(smallest_cell_size_.x, std::min(smallest_cell_size_.y, smallest_cell_size_.z));
+	size_t num_steps = 0;
+
+	if(step_length > 0.0)
+	{
+		num_steps = std::min((size_t)64, (size_t)std::ceil(path_length / step_length));
+	}
+
+	for(size_t step = 1; step <= num_steps; ++step)
+	{
+		size_t path_cell_index = 0;
+		scm::math::vec3d path_position = position_viewer_ + path * ((double)step / (double)num_steps);
+
+		if(visibility_grid_->get_cell_at_position(path_position, &path_cell_index) != nullptr)
+		{
+			requested_cell_indices.push_back(path_cell_index);
+		}
+	}
+
+	// The direct neighbourhood covers sudden changes of direction.
+	scm::math::vec3d center = visibility_grid_->get_cell_at_index(viewer_cell_index)->get_position_center();
 
 	for(double z = -1.0; z < 1.5; z += 1.0)
 	{
@@ -401,37 +522,140 @@ load_visibility_data_async(uint64_t cell_index)
 			{
 				size_t local_cell_index = 0;
 				scm::math::vec3d direction = smallest_cell_size_ * scm::math::vec3d(x, y, z);
-				const view_cell* local_view_cell_at_position = visibility_grid_->get_cell_at_position(center + direction, &local_cell_index);
 
-				if(local_view_cell_at_position != nullptr)
+				if(visibility_grid_->get_cell_at_position(center + direction, &local_cell_index) != nullptr)
 				{
-					cell_indices_to_load.insert(local_cell_index);
+					requested_cell_indices.push_back(local_cell_index);
 				}
 			}
 		}
 	}
-  
-  std::lock_guard<std::mutex> lock(mutex_);
 
-	// Load required visibility data which is not yet loaded.
-	for (std::set<size_t>::iterator iter = cell_indices_to_load.begin(); iter != cell_indices_to_load.end(); ++iter)
+	// Replace the previous request, keeping the order of first occurrence as priority.
+	loading_queue_.clear();
+	pinned_cell_indices_.clear();
+
+	for(uint64_t requested_cell_index : requested_cell_indices)
 	{
-		if(previously_loaded_cell_indices_.find(*iter) == previously_loaded_cell_indices_.end())
+		if(!pinned_cell_indices_.insert(requested_cell_index).second)
 		{
-			visibility_grid_->load_cell_visibility_from_file(pvs_file_path_, *iter);
+			continue;
+		}
+
+		if(visibility_grid_->get_cell_at_index(requested_cell_index)->contains_visibility_data())
+		{
+			touch_cell(requested_cell_index);
+		}
+		else if(cells_in_flight_.find(requested_cell_index) == cells_in_flight_.end())
+		{
+			loading_queue_.push_back(requested_cell_index);
 		}
 	}
 
-	// Release visibility data not within current neighbourhood.
-	for (std::set<size_t>::iterator iter = previously_loaded_cell_indices_.begin(); iter != previously_loaded_cell_indices_.end(); ++iter)
+	if(!loading_queue_.empty())
 	{
-		if(cell_indices_to_load.find(*iter) == cell_indices_to_load.end())
+		semaphore_.signal(loading_queue_.size());
+	}
+}
+
+void pvs_database::
+load_visibility_data_async(uint64_t cell_index)
+{
+	bool loaded = visibility_grid_->load_cell_visibility_from_file(pvs_file_path_, cell_index);
+
+	{
+		std::lock_guard<std::mutex> lock(loading_mutex_);
+
+		cells_in_flight_.erase(cell_index);
+
+		if(loaded)
 		{
-			visibility_grid_->clear_cell_visibility(*iter);
+			++statistics_.loaded_cells_;
+
+			touch_cell(cell_index);
+			update_stall_time();
+			evict_cells();
 		}
 	}
 
-	previously_loaded_cell_indices_ = std::set<size_t>(cell_indices_to_load);
+	loading_finished_.notify_all();
+}
+
+void pvs_database::
+update_stall_time()
+{
+	if(!is_stalled_)
+	{
+		return;
+	}
+
+	// A stall ends once the data of the entered cell arrived or the viewer left the cell.
+	if(stalled_cell_index_ != viewer_cell_index_ || visibility_grid_->get_cell_at_index(stalled_cell_index_)->contains_visibility_data())
+	{
+		statistics_.stall_time_in_ms_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - stall_begin_).count();
+		is_stalled_ = false;
+	}
+}
+
+void pvs_database::
+touch_cell(const uint64_t& cell_index)
+{
+	std::map<uint64_t, std::list<uint64_t>::iterator>::iterator position_iter = lru_positions_.find(cell_index);
+
+	if(position_iter != lru_positions_.end())
+	{
+		lru_cell_indices_.splice(lru_cell_indices_.begin(), lru_cell_indices_, position_iter->second);
+	}
+	else
+	{
+		lru_cell_indices_.push_front(cell_index);
+		lru_positions_[cell_index] = lru_cell_indices_.begin();
+	}
+}
+
+void pvs_database::
+evict_cells()
+{
+	// Pinned cells are kept even if the current request alone exceeds the budget.
+	std::list<uint64_t>::iterator lru_iter = lru_cell_indices_.end();
+
+	while(lru_cell_indices_.size() * cell_memory_size_ > memory_budget_ && lru_iter != lru_cell_indices_.begin())
+	{
+		--lru_iter;
+		uint64_t cell_index = *lru_iter;
+
+		if(pinned_cell_indices_.find(cell_index) != pinned_cell_indices_.end() || cells_in_flight_.find(cell_index) != cells_in_flight_.end())
+		{
+			continue;
+		}
+
+		visibility_grid_->clear_cell_visibility(cell_index);
+		lru_positions_.erase(cell_index);
+		lru_iter = lru_cell_indices_.erase(lru_iter);
+
+		++statistics_.evicted_cells_;
+	}
+}
+
+void pvs_database::
+reset_loading_state()
+{
+	std::unique_lock<std::mutex> lock(loading_mutex_);
+
+	loading_queue_.clear();
+	pinned_cell_indices_.clear();
+
+	// The grid must not change while a loading thread still accesses it.
+	loading_finished_.wait(lock, [this]{ return cells_in_flight_.empty(); });
+
+	lru_cell_indices_.clear();
+	lru_positions_.clear();
+
+	has_last_position_ = false;
+	viewer_velocity_ = scm::math::vec3d(0.0, 0.0, 0.0);
+	viewer_cell_index_ = std::numeric_limits<size_t>::max();
+	predicted_cell_index_ = std::numeric_limits<size_t>::max();
+	is_stalled_ = false;
 }
 
 bool pvs_database::
@@ -476,6 +700,8 @@ get_bounding_grid() const
 void pvs_database::
 clear_visibility_grid()
 {
+	reset_loading_state();
+
 	std::lock_guard<std::mutex> lock(mutex_);
 
 	viewer_cell_ = nullptr;
@@ -484,5 +710,62 @@ clear_visibility_grid()
 	visibility_grid_ = nullptr;
 }
 
+void pvs_database::
+set_prefetch_time(const double& time_in_s)
+{
+	std::lock_guard<std::mutex> lock(loading_mutex_);
+
+	prefetch_time_in_s_ = std::max(0.0, time_in_s);
+}
+
+double pvs_database::
+get_prefetch_time() const
+{
+	std::lock_guard<std::mutex> lock(loading_mutex_);
+
+	return prefetch_time_in_s_;
+}
+
+void pvs_database::
+set_memory_budget(const size_t& budget_in_bytes)
+{
+	std::lock_guard<std::mutex> lock(loading_mutex_);
+
+	memory_budget_ = budget_in_bytes;
+
+	if(visibility_grid_ != nullptr)
+	{
+		evict_cells();
+	}
+}
+
+size_t pvs_database::
+get_memory_budget() const
+{
+	std::lock_guard<std::mutex> lock(loading_mutex_);
+
+	return memory_budget_;
+}
+
+pvs_database::statistics pvs_database::
+get_statistics() const
+{
+	std::lock_guard<std::mutex> lock(loading_mutex_);
+
+	return statistics_;
+}
+
+void pvs_database::
+reset_statistics()
+{
+	std::lock_guard<std::mutex> lock(loading_mutex_);
+
+	statistics_.cell_hits_ = 0;
+	statistics_.cell_misses_ = 0;
+	statistics_.stall_time_in_ms_ = 0.0;
+	statistics_.loaded_cells_ = 0;
+	statistics_.evicted_cells_ = 0;
+}
+
 }
 }
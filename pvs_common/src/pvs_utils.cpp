@@ -5,6 +5,7 @@
 // Faculty of Media, Bauhaus-Universitaet Weimar
 // http://www.uni-weimar.de/medien/vr
 
+#include <algorithm>
 #include <fstream>
 
 #include "lamure/pvs/pvs_utils.h"
@@ -102,5 +103,86 @@ double calculate_grid_occlusion(const grid* input_grid)
     return 1.0 - ((double)total_visible_nodes / (double)total_num_nodes);
 }
 
+void compare_grid_visibility(const grid* input_grid, const grid* reference_grid, const std::string& output_file_name)
+{
+    std::ofstream file_out;
+    file_out.open(output_file_name);
+
+    size_t num_cells = input_grid->get_cell_count();
+    size_t num_unmatched_cells = 0;
+
+    size_t total_visible_in_both = 0;
+    size_t total_visible_in_input_only = 0;
+    size_t total_visible_in_reference_only = 0;
+    size_t total_num_nodes = 0;
+
+    for(size_t cell_index = 0; cell_index < num_cells; ++cell_index)
+    {
+        const view_cell* input_cell = input_grid->get_cell_at_index(cell_index);
+
+        size_t reference_cell_index = 0;
+        const view_cell* reference_cell = reference_grid->get_cell_at_position(input_cell->get_position_center(), &reference_cell_index);
+
+        if(reference_cell == nullptr)
+        {
+            ++num_unmatched_cells;
+            file_out << "cell: " << cell_index << " no reference cell" << std::endl;
+            continue;
+        }
+
+        size_t visible_in_both = 0;
+        size_t visible_in_input_only = 0;
+        size_t visible_in_reference_only = 0;
+
+        lamure::model_t num_models = std::min(input_grid->get_num_models(), reference_grid->get_num_models());
+
+        for(lamure::model_t model_index = 0; model_index < num_models; ++model_index)
+        {
+            lamure::node_t num_nodes = std::min(input_grid->get_num_nodes(model_index), reference_grid->get_num_nodes(model_index));
+            total_num_nodes += num_nodes;
+
+            for(lamure::node_t node_index = 0; node_index < num_nodes; ++node_index)
+            {
+                bool input_visibility = input_cell->get_visibility(model_index, node_index);
+                bool reference_visibility = reference_cell->get_visibility(model_index, node_index);
+
+                if(input_visibility && reference_visibility)
+                {
+                    ++visible_in_both;
+                }
+                else if(input_visibility)
+                {
+                    ++visible_in_input_only;
+                }
+                else if(reference_visibility)
+                {
+                    ++visible_in_reference_only;
+                }
+            }
+        }
+
+        file_out << "cell: " << cell_index << " reference cell: " << reference_cell_index << "   both: " << visible_in_both
+                 << " input only: " << visible_in_input_only << " reference only: " << visible_in_reference_only << std::endl;
+
+        total_visible_in_both += visible_in_both;
+        total_visible_in_input_only += visible_in_input_only;
+        total_visible_in_reference_only += visible_in_reference_only;
+    }
+
+    size_t total_visible_in_any = total_visible_in_both + total_visible_in_input_only + total_visible_in_reference_only;
+    size_t total_agreeing = total_num_nodes - total_visible_in_input_only - total_visible_in_reference_only;
+
+    // Output resulting data.
+    file_out << "\ntotal:" << std::endl;
+    file_out << "unmatched cells: " << num_unmatched_cells << "/" << num_cells << std::endl;
+    file_out << "visible in both: " << total_visible_in_both << std::endl;
+    file_out << "visible in input only: " << total_visible_in_input_only << std::endl;
+    file_out << "visible in reference only: " << total_visible_in_reference_only << std::endl;
+    file_out << "agreement of all node states: " << (total_num_nodes > 0 ? (double)total_agreeing / (double)total_num_nodes * 100.0 : 100.0) << " %" << std::endl;
+    file_out << "agreement of visible nodes (intersection over union): " << (total_visible_in_any > 0 ? (double)total_visible_in_both / (double)total_visible_in_any * 100.0 : 100.0) << " %" << std::endl;
+
+    file_out.close();
+}
+
 }
 }
\ No newline at end of file
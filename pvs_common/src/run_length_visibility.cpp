@@ -0,0 +1,384 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group 
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include "lamure/pvs/run_length_visibility.h"
+
+#include <algorithm>
+
+namespace lamure
+{
+namespace pvs
+{
+
+namespace
+{
+
+void write_variable_length(std::string& output, uint64_t value)
+{
+	while(value >= 0x80)
+	{
+		output.push_back((char)((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+
+	output.push_back((char)value);
+}
+
+bool read_variable_length(const char*& data, const char* data_end, uint64_t& value)
+{
+	value = 0;
+
+	for(unsigned int shift = 0; shift < 64; shift += 7)
+	{
+		if(data >= data_end)
+		{
+			return false;
+		}
+
+		unsigned char current_byte = (unsigned char)*data++;
+		value |= (uint64_t)(current_byte & 0x7F) << shift;
+
+		if((current_byte & 0x80) == 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool run_starts_before(const node_t& node_id, const run_length_visibility::run& current_run)
+{
+	return node_id < current_run.first_;
+}
+
+}
+
+run_length_visibility::
+run_length_visibility()
+{
+	size_ = 0;
+}
+
+run_length_visibility::
+~run_length_visibility()
+{
+}
+
+void run_length_visibility::
+set_visibility(const node_t& node_id, const bool& visible)
+{
+	size_ = std::max(size_, node_id + 1);
+
+	// First run starting behind the node, the run in front of it is the only one that may contain it.
+	std::vector<run>::iterator next_run = std::upper_bound(runs_.begin(), runs_.end(), node_id, run_starts_before);
+	bool has_previous = next_run != runs_.begin();
+	bool contained = has_previous && node_id < (next_run - 1)->first_ + (next_run - 1)->count_;
+
+	if(visible)
+	{
+		if(contained)
+		{
+			return;
+		}
+
+		bool extends_previous = has_previous && (next_run - 1)->first_ + (next_run - 1)->count_ == node_id;
+		bool extends_next = next_run != runs_.end() && next_run->first_ == node_id + 1;
+
+		if(extends_previous && extends_next)
+		{
+			// The node closes the gap between two runs.
+			(next_run - 1)->count_ += 1 + next_run->count_;
+			runs_.erase(next_run);
+		}
+		else if(extends_previous)
+		{
+			++(next_run - 1)->count_;
+		}
+		else if(extends_next)
+		{
+			--next_run->first_;
+			++next_run->count_;
+		}
+		else
+		{
+			runs_.insert(next_run, run{node_id, 1});
+		}
+	}
+	else if(contained)
+	{
+		std::vector<run>::iterator current_run = next_run - 1;
+		node_t run_end = current_run->first_ + current_run->count_;
+
+		if(current_run->count_ == 1)
+		{
+			runs_.erase(current_run);
+		}
+		else if(node_id == current_run->first_)
+		{
+			++current_run->first_;
+			--current_run->count_;
+		}
+		else if(node_id == run_end - 1)
+		{
+			--current_run->count_;
+		}
+		else
+		{
+			// Split the run around the node.
+			current_run->count_ = node_id - current_run->first_;
+			runs_.insert(next_run, run{node_id + 1, run_end - node_id - 1});
+		}
+	}
+}
+
+bool run_length_visibility::
+get_visibility(const node_t& node_id) const
+{
+	std::vector<run>::const_iterator next_run = std::upper_bound(runs_.begin(), runs_.end(), node_id, run_starts_before);
+
+	if(next_run == runs_.begin())
+	{
+		return false;
+	}
+
+	--next_run;
+	return node_id < next_run->first_ + next_run->count_;
+}
+
+node_t run_length_visibility::
+get_size() const
+{
+	return size_;
+}
+
+void run_length_visibility::
+set_size(const node_t& size)
+{
+	size_ = size;
+}
+
+size_t run_length_visibility::
+get_num_visible() const
+{
+	size_t num_visible = 0;
+
+	for(const run& current_run : runs_)
+	{
+		num_visible += current_run.count_;
+	}
+
+	return num_visible;
+}
+
+const std::vector<run_length_visibility::run>& run_length_visibility::
+get_runs() const
+{
+	return runs_;
+}
+
+bool run_length_visibility::
+empty() const
+{
+	return runs_.empty();
+}
+
+void run_length_visibility::
+clear()
+{
+	runs_.clear();
+	size_ = 0;
+}
+
+void run_length_visibility::
+append_run(const node_t& first, const node_t& count)
+{
+	if(count == 0)
+	{
+		return;
+	}
+
+	// Merge with the last run if they touch or overlap.
+	if(!runs_.empty() && runs_.back().first_ + runs_.back().count_ >= first)
+	{
+		node_t end = std::max(runs_.back().first_ + runs_.back().count_, first + count);
+		runs_.back().count_ = end - runs_.back().first_;
+	}
+	else
+	{
+		runs_.push_back(run{first, count});
+	}
+}
+
+run_length_visibility run_length_visibility::
+unite(const run_length_visibility& first, const run_length_visibility& second)
+{
+	run_length_visibility result;
+	result.size_ = std::max(first.size_, second.size_);
+
+	std::vector<run>::const_iterator first_iter = first.runs_.begin();
+	std::vector<run>::const_iterator second_iter = second.runs_.begin();
+
+	// Merge both run lists ordered by start.
+	while(first_iter != first.runs_.end() || second_iter != second.runs_.end())
+	{
+		if(second_iter == second.runs_.end() || (first_iter != first.runs_.end() && first_iter->first_ <= second_iter->first_))
+		{
+			result.append_run(first_iter->first_, first_iter->count_);
+			++first_iter;
+		}
+		else
+		{
+			result.append_run(second_iter->first_, second_iter->count_);
+			++second_iter;
+		}
+	}
+
+	return result;
+}
+
+run_length_visibility run_length_visibility::
+intersect(const run_length_visibility& first, const run_length_visibility& second)
+{
+	run_length_visibility result;
+	result.size_ = std::max(first.size_, second.size_);
+
+	std::vector<run>::const_iterator first_iter = first.runs_.begin();
+	std::vector<run>::const_iterator second_iter = second.runs_.begin();
+
+	while(first_iter != first.runs_.end() && second_iter != second.runs_.end())
+	{
+		node_t first_end = first_iter->first_ + first_iter->count_;
+		node_t second_end = second_iter->first_ + second_iter->count_;
+
+		node_t overlap_begin = std::max(first_iter->first_, second_iter->first_);
+		node_t overlap_end = std::min(first_end, second_end);
+
+		if(overlap_begin < overlap_end)
+		{
+			result.append_run(overlap_begin, overlap_end - overlap_begin);
+		}
+
+		// Advance the run which ends first, it can not overlap any further runs.
+		if(first_end < second_end)
+		{
+			++first_iter;
+		}
+		else
+		{
+			++second_iter;
+		}
+	}
+
+	return result;
+}
+
+run_length_visibility run_length_visibility::
+subtract(const run_length_visibility& first, const run_length_visibility& second)
+{
+	run_length_visibility result;
+	result.size_ = first.size_;
+
+	std::vector<run>::const_iterator second_iter = second.runs_.begin();
+
+	for(const run& current_run : first.runs_)
+	{
+		node_t current_begin = current_run.first_;
+		node_t current_end = current_run.first_ + current_run.count_;
+
+		// Skip runs which end before the current one.
+		while(second_iter != second.runs_.end() && second_iter->first_ + second_iter->count_ <= current_begin)
+		{
+			++second_iter;
+		}
+
+		std::vector<run>::const_iterator cut_iter = second_iter;
+
+		while(cut_iter != second.runs_.end() && cut_iter->first_ < current_end)
+		{
+			if(cut_iter->first_ > current_begin)
+			{
+				result.append_run(current_begin, cut_iter->first_ - current_begin);
+			}
+
+			current_begin = std::max(current_begin, cut_iter->first_ + cut_iter->count_);
+			++cut_iter;
+		}
+
+		if(current_begin < current_end)
+		{
+			result.append_run(current_begin, current_end - current_begin);
+		}
+	}
+
+	return result;
+}
+
+void run_length_visibility::
+serialize(std::string& output) const
+{
+	write_variable_length(output, runs_.size());
+
+	node_t previous_end = 0;
+
+	for(const run& current_run : runs_)
+	{
+		write_variable_length(output, current_run.first_ - previous_end);
+		write_variable_length(output, current_run.count_);
+
+		previous_end = current_run.first_ + current_run.count_;
+	}
+}
+
+bool run_length_visibility::
+deserialize(const char*& data, const char* data_end, const node_t& size)
+{
+	runs_.clear();
+	size_ = size;
+
+	uint64_t num_runs = 0;
+
+	if(!read_variable_length(data, data_end, num_runs))
+	{
+		return false;
+	}
+
+	// Every run takes at least two bytes, a larger count is corrupt and must not size the allocation.
+	if(num_runs > (uint64_t)(data_end - data) / 2)
+	{
+		return false;
+	}
+
+	runs_.reserve(num_runs);
+	uint64_t previous_end = 0;
+
+	for(uint64_t run_index = 0; run_index < num_runs; ++run_index)
+	{
+		uint64_t gap = 0;
+		uint64_t count = 0;
+
+		if(!read_variable_length(data, data_end, gap) || !read_variable_length(data, data_end, count))
+		{
+			return false;
+		}
+
+		uint64_t first = previous_end + gap;
+
+		if(first + count > size)
+		{
+			return false;
+		}
+
+		runs_.push_back(run{(node_t)first, (node_t)count});
+		previous_end = first + count;
+	}
+
+	return true;
+}
+
+}
+}
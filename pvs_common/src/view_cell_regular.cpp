@@ -6,17 +6,56 @@
 // http://www.uni-weimar.de/medien/vr
 
 #include "lamure/pvs/view_cell_regular.h"
+#include "lamure/pvs/visibility_file_mapping.h"
+
+#include <climits>
+#include <cstring>
+
+#include <boost/predef/other/endian.h>
 
 namespace lamure
 {
 namespace pvs
 {
 
+namespace
+{
+
+// Builds a bitset from a .pvs line block by block instead of setting single bits.
+boost::dynamic_bitset<> decode_visibility_data(const char* data, const node_t& num_nodes)
+{
+	typedef boost::dynamic_bitset<>::block_type block_type;
+
+	size_t num_bytes = visibility_file_mapping::get_line_size(num_nodes);
+	std::vector<block_type> blocks((num_bytes + sizeof(block_type) - 1) / sizeof(block_type), 0);
+
+#if BOOST_ENDIAN_LITTLE_BYTE
+	// Bit i of the line is bit i of the little endian blocks.
+	if(num_bytes > 0)
+	{
+		std::memcpy(&blocks[0], data, num_bytes);
+	}
+#else
+	for(size_t byte_index = 0; byte_index < num_bytes; ++byte_index)
+	{
+		blocks[byte_index / sizeof(block_type)] |= (block_type)(unsigned char)data[byte_index] << ((byte_index % sizeof(block_type)) * CHAR_BIT);
+	}
+#endif
+
+	boost::dynamic_bitset<> bitset(blocks.begin(), blocks.end());
+	bitset.resize(num_nodes);
+
+	return bitset;
+}
+
+}
+
 view_cell_regular::
 view_cell_regular()
 {
 	cell_size_ = 1.0;
 	position_center_ = scm::math::vec3d(0.0, 0.0, 0.0);
+	num_borrowed_ = 0;
 }
 
 view_cell_regular::
@@ -24,6 +63,7 @@ view_cell_regular(const double& cell_size, const scm::math::vec3d& position_cent
 {
 	cell_size_ = cell_size;
 	position_center_ = position_center;
+	num_borrowed_ = 0;
 }
 
 view_cell_regular::
@@ -63,6 +103,8 @@ set_visibility(const model_t& object_id, const node_t& node_id, const bool& visi
 		visibility_.resize(object_id + 1);
 	}
 
+	copy_borrowed(object_id);
+
 	boost::dynamic_bitset<>& node_visibility = visibility_[object_id];
 
 	if(node_visibility.size() <= node_id)
@@ -81,6 +123,18 @@ get_visibility(const model_t& object_id, const node_t& node_id) const
 		return false;
 	}
 
+	if(is_borrowed(object_id))
+	{
+		const borrowed_visibility& borrowed = borrowed_visibility_[object_id];
+
+		if(borrowed.num_nodes_ <= node_id)
+		{
+			return false;
+		}
+
+		return ((borrowed.data_[node_id / CHAR_BIT] >> (node_id % CHAR_BIT)) & 1) == 0x01;
+	}
+
 	const boost::dynamic_bitset<>& node_visibility = visibility_[object_id];
 
 	if(node_visibility.size() <= node_id)
@@ -104,6 +158,21 @@ get_visible_indices() const
 
 	for(model_t model_index = 0; model_index < visibility_.size(); ++model_index)
 	{
+		if(is_borrowed(model_index))
+		{
+			const borrowed_visibility& borrowed = borrowed_visibility_[model_index];
+
+			for(node_t node_index = 0; node_index < borrowed.num_nodes_; ++node_index)
+			{
+				if(((borrowed.data_[node_index / CHAR_BIT] >> (node_index % CHAR_BIT)) & 1) == 0x01)
+				{
+					indices[model_index].push_back(node_index);
+				}
+			}
+
+			continue;
+		}
+
 		const boost::dynamic_bitset<>& node_visibility = visibility_[model_index];
 
 		for(node_t node_index = 0; node_index < node_visibility.size(); ++node_index)
@@ -122,6 +191,9 @@ void view_cell_regular::
 clear_visibility_data()
 {
 	visibility_.clear();
+	borrowed_visibility_.clear();
+	num_borrowed_ = 0;
+	mapping_.reset();
 }
 
 boost::dynamic_bitset<> view_cell_regular::
@@ -132,6 +204,11 @@ get_bitset(const model_t& object_id) const
 		return boost::dynamic_bitset<>();
 	}
 
+	if(is_borrowed(object_id))
+	{
+		return decode_visibility_data(borrowed_visibility_[object_id].data_, borrowed_visibility_[object_id].num_nodes_);
+	}
+
 	return visibility_[object_id];
 }
 
@@ -143,8 +220,96 @@ set_bitset(const model_t& object_id, const boost::dynamic_bitset<>& bitset)
 		visibility_.resize(object_id + 1);
 	}
 
+	copy_borrowed(object_id);
+
 	visibility_[object_id] = boost::dynamic_bitset<>(bitset);
 }
 
+void view_cell_regular::
+set_visibility_data(const model_t& object_id, const char* data, const node_t& num_nodes)
+{
+	if(visibility_.size() <= object_id)
+	{
+		visibility_.resize(object_id + 1);
+	}
+
+	// The old data is replaced completely, so a borrowed line is released without copying it.
+	if(is_borrowed(object_id))
+	{
+		borrowed_visibility_[object_id].data_ = nullptr;
+		--num_borrowed_;
+	}
+
+	visibility_[object_id] = decode_visibility_data(data, num_nodes);
+
+	if(num_borrowed_ == 0)
+	{
+		mapping_.reset();
+	}
+}
+
+void view_cell_regular::
+borrow_visibility_data(const model_t& object_id, const char* data, const node_t& num_nodes, const std::shared_ptr<const visibility_file_mapping>& mapping)
+{
+	if(visibility_.size() <= object_id)
+	{
+		visibility_.resize(object_id + 1);
+	}
+
+	if(borrowed_visibility_.size() <= object_id)
+	{
+		borrowed_visibility_.resize(object_id + 1, borrowed_visibility{nullptr, 0});
+	}
+
+	if(!is_borrowed(object_id))
+	{
+		++num_borrowed_;
+	}
+
+	// All borrowed lines of a cell refer to the same mapping.
+	if(mapping_ != mapping && num_borrowed_ > 1)
+	{
+		for(model_t model_index = 0; model_index < borrowed_visibility_.size(); ++model_index)
+		{
+			if(model_index != object_id)
+			{
+				copy_borrowed(model_index);
+			}
+		}
+	}
+
+	mapping_ = mapping;
+
+	visibility_[object_id].clear();
+	borrowed_visibility_[object_id].data_ = data;
+	borrowed_visibility_[object_id].num_nodes_ = num_nodes;
+}
+
+bool view_cell_regular::
+is_borrowed(const model_t& object_id) const
+{
+	return borrowed_visibility_.size() > object_id && borrowed_visibility_[object_id].data_ != nullptr;
+}
+
+void view_cell_regular::
+copy_borrowed(const model_t& object_id)
+{
+	if(!is_borrowed(object_id))
+	{
+		return;
+	}
+
+	borrowed_visibility& borrowed = borrowed_visibility_[object_id];
+	visibility_[object_id] = decode_visibility_data(borrowed.data_, borrowed.num_nodes_);
+
+	borrowed.data_ = nullptr;
+	--num_borrowed_;
+
+	if(num_borrowed_ == 0)
+	{
+		mapping_.reset();
+	}
+}
+
 }
 }
@@ -0,0 +1,156 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group 
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include "lamure/pvs/view_cell_regular_run_length.h"
+
+namespace lamure
+{
+namespace pvs
+{
+
+view_cell_regular_run_length::
+view_cell_regular_run_length() : view_cell_regular()
+{
+}
+
+view_cell_regular_run_length::
+view_cell_regular_run_length(const double& cell_size, const scm::math::vec3d& position_center) : view_cell_regular(cell_size, position_center)
+{
+}
+
+view_cell_regular_run_length::
+~view_cell_regular_run_length()
+{
+}
+
+std::string view_cell_regular_run_length::
+get_cell_type() const
+{
+	return get_cell_identifier();
+}
+
+std::string view_cell_regular_run_length::
+get_cell_identifier()
+{
+	return "view_cell_regular_run_length";
+}
+
+void view_cell_regular_run_length::
+set_visibility(const model_t& object_id, const node_t& node_id, const bool& visible)
+{
+	if(run_visibility_.size() <= object_id)
+	{
+		run_visibility_.resize(object_id + 1);
+	}
+
+	run_visibility_[object_id].set_visibility(node_id, visible);
+}
+
+bool view_cell_regular_run_length::
+get_visibility(const model_t& object_id, const node_t& node_id) const
+{
+	if(run_visibility_.size() <= object_id)
+	{
+		return false;
+	}
+
+	return run_visibility_[object_id].get_visibility(node_id);
+}
+
+bool view_cell_regular_run_length::
+contains_visibility_data() const
+{
+	return run_visibility_.size() > 0;
+}
+
+std::map<model_t, std::vector<node_t>> view_cell_regular_run_length::
+get_visible_indices() const
+{
+	std::map<model_t, std::vector<node_t>> indices;
+
+	for(model_t model_index = 0; model_index < run_visibility_.size(); ++model_index)
+	{
+		for(const run_length_visibility::run& current_run : run_visibility_[model_index].get_runs())
+		{
+			for(node_t node_index = current_run.first_; node_index < current_run.first_ + current_run.count_; ++node_index)
+			{
+				indices[model_index].push_back(node_index);
+			}
+		}
+	}
+
+	return indices;
+}
+
+void view_cell_regular_run_length::
+clear_visibility_data()
+{
+	run_visibility_.clear();
+}
+
+boost::dynamic_bitset<> view_cell_regular_run_length::
+get_bitset(const model_t& object_id) const
+{
+	if(run_visibility_.size() <= object_id)
+	{
+		return boost::dynamic_bitset<>();
+	}
+
+	const run_length_visibility& runs = run_visibility_[object_id];
+	boost::dynamic_bitset<> bitset(runs.get_size());
+
+	for(const run_length_visibility::run& current_run : runs.get_runs())
+	{
+		for(node_t node_index = current_run.first_; node_index < current_run.first_ + current_run.count_; ++node_index)
+		{
+			bitset[node_index] = true;
+		}
+	}
+
+	return bitset;
+}
+
+void view_cell_regular_run_length::
+set_bitset(const model_t& object_id, const boost::dynamic_bitset<>& bitset)
+{
+	run_length_visibility runs;
+	runs.set_size(bitset.size());
+
+	for(size_t node_index = bitset.find_first(); node_index != boost::dynamic_bitset<>::npos; node_index = bitset.find_next(node_index))
+	{
+		runs.set_visibility(node_index, true);
+	}
+
+	set_runs(object_id, runs);
+}
+
+const run_length_visibility& view_cell_regular_run_length::
+get_runs(const model_t& object_id) const
+{
+	static const run_length_visibility empty_runs;
+
+	if(run_visibility_.size() <= object_id)
+	{
+		return empty_runs;
+	}
+
+	return run_visibility_[object_id];
+}
+
+void view_cell_regular_run_length::
+set_runs(const model_t& object_id, const run_length_visibility& runs)
+{
+	if(run_visibility_.size() <= object_id)
+	{
+		run_visibility_.resize(object_id + 1);
+	}
+
+	run_visibility_[object_id] = runs;
+}
+
+}
+}
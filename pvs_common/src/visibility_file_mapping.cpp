@@ -0,0 +1,126 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group 
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include "lamure/pvs/visibility_file_mapping.h"
+#include "lamure/pvs/view_cell_regular.h"
+
+#include <climits>
+#include <iostream>
+
+namespace lamure
+{
+namespace pvs
+{
+
+visibility_file_mapping::
+visibility_file_mapping(const std::string& file_path)
+{
+	file_path_ = file_path;
+
+	try
+	{
+		file_.open(file_path);
+	}
+	catch(const std::exception& e)
+	{
+		// Missing or empty files can not be mapped.
+		std::cout << "Not able to map file: " << file_path << std::endl;
+	}
+}
+
+visibility_file_mapping::
+~visibility_file_mapping()
+{
+	if(file_.is_open())
+	{
+		file_.close();
+	}
+}
+
+bool visibility_file_mapping::
+is_open() const
+{
+	return file_.is_open();
+}
+
+const std::string& visibility_file_mapping::
+get_file_path() const
+{
+	return file_path_;
+}
+
+const char* visibility_file_mapping::
+get_data() const
+{
+	return file_.data();
+}
+
+size_t visibility_file_mapping::
+get_size() const
+{
+	return file_.size();
+}
+
+bool visibility_file_mapping::
+load_cell_visibility(view_cell_regular* cell, const size_t& cell_index, const std::vector<node_t>& ids, const bool& borrow) const
+{
+	if(!is_open())
+	{
+		return false;
+	}
+
+	// Every view cell requires the same storage, so the start of the cell data can be calculated directly.
+	size_t offset = cell_index * get_cell_size(ids);
+
+	if(offset + get_cell_size(ids) > get_size())
+	{
+		return false;
+	}
+
+	const char* cell_data = get_data() + offset;
+
+	for(model_t model_index = 0; model_index < ids.size(); ++model_index)
+	{
+		node_t num_nodes = ids[model_index];
+
+		if(borrow)
+		{
+			cell->borrow_visibility_data(model_index, cell_data, num_nodes, shared_from_this());
+		}
+		else
+		{
+			cell->set_visibility_data(model_index, cell_data, num_nodes);
+		}
+
+		cell_data += get_line_size(num_nodes);
+	}
+
+	return true;
+}
+
+size_t visibility_file_mapping::
+get_line_size(const node_t& num_nodes)
+{
+	// If the number of node IDs is not dividable by 8 there is one additional character.
+	return num_nodes / CHAR_BIT + (num_nodes % CHAR_BIT == 0 ? 0 : 1);
+}
+
+size_t visibility_file_mapping::
+get_cell_size(const std::vector<node_t>& ids)
+{
+	size_t cell_size = 0;
+
+	for(model_t model_index = 0; model_index < ids.size(); ++model_index)
+	{
+		cell_size += get_line_size(ids[model_index]);
+	}
+
+	return cell_size;
+}
+
+}
+}
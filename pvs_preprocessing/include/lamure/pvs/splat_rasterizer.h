@@ -0,0 +1,103 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef LAMURE_PVS_SPLAT_RASTERIZER_H_
+#define LAMURE_PVS_SPLAT_RASTERIZER_H_
+
+#include <lamure/pvs/pvs_preprocessing.h>
+#include <lamure/types.h>
+
+#include <scm/core/math.h>
+#include <scm/gl_core/primitives/box.h>
+
+#include <vector>
+
+namespace lamure
+{
+namespace pvs
+{
+
+// Software counterpart of the node visibility pass of the Renderer.
+// Draws the surfels of cut nodes as oriented discs into an id and a depth buffer.
+// The id buffer uses the same encoding as the GPU pass, so it can be fed to id_histogram::create.
+// The screen is split into tiles, which are rasterized by several threads in parallel.
+class PVS_PREPROCESSING_DLL splat_rasterizer
+{
+public:
+    struct node
+    {
+        model_t             model_id_;
+        node_t              node_id_;
+        // Surfels as stored in the ooc-cache, position, color, radius and normal.
+        const char*         surfels_;
+        size_t              num_surfels_;
+        // Bounding box in model space, used to assign nodes to tiles.
+        scm::gl::boxf       bounding_box_;
+    };
+
+                        splat_rasterizer(const uint32_t& width, const uint32_t& height, const uint32_t& num_threads);
+                        ~splat_rasterizer();
+
+                        splat_rasterizer(const splat_rasterizer&) = delete;
+                        splat_rasterizer& operator=(const splat_rasterizer&) = delete;
+
+    // Model view matrices are indexed by model id, the projection must be a perspective projection.
+    void                render(const std::vector<node>& nodes,
+                                const std::vector<scm::math::mat4f>& model_view_matrices,
+                                const scm::math::mat4f& projection_matrix,
+                                const float& near_plane,
+                                const float& far_plane,
+                                const float& radius_scale = 1.0f);
+
+    const std::vector<uint32_t>& get_id_buffer() const;
+    const std::vector<float>& get_depth_buffer() const;
+
+    uint32_t            get_width() const;
+    uint32_t            get_height() const;
+    size_t              get_rendered_node_count() const;
+
+    // Model id in the upper 8 bits, starting at 255 (so cleared pixels read as invalid), node id in the lower 24 bits.
+    static uint32_t     encode_id(const model_t& model_id, const node_t& node_id);
+
+private:
+    struct screen_rect
+    {
+        int32_t             min_x_;
+        int32_t             min_y_;
+        int32_t             max_x_;
+        int32_t             max_y_;
+    };
+
+    bool                project_node(const node& current_node, const scm::math::mat4f& model_view_matrix, screen_rect& rect) const;
+    void                rasterize_tile(const size_t& tile_index, const std::vector<node>& nodes, const std::vector<scm::math::mat4f>& model_view_matrices);
+
+    uint32_t            width_;
+    uint32_t            height_;
+    uint32_t            num_threads_;
+
+    uint32_t            num_tiles_x_;
+    uint32_t            num_tiles_y_;
+
+    std::vector<uint32_t> id_buffer_;
+    std::vector<float>  depth_buffer_;
+
+    // Indices of the nodes which overlap each tile.
+    std::vector<std::vector<uint32_t>> tile_nodes_;
+    size_t              rendered_node_count_;
+
+    // Parameters of the current render call.
+    scm::math::mat4f    projection_matrix_;
+    float               near_plane_;
+    float               far_plane_;
+    float               radius_scale_;
+    size_t              surfel_size_;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,34 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group 
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef LAMURE_PVS_VISIBILITY_PROPAGATION_H_
+#define LAMURE_PVS_VISIBILITY_PROPAGATION_H_
+
+#include <vector>
+
+#include <lamure/pvs/pvs_preprocessing.h>
+#include "lamure/pvs/grid.h"
+
+namespace lamure
+{
+namespace pvs
+{
+
+// Post-processing shared by all visibility tests, independent of how the node ids were rendered.
+
+// Sets nodes visible which are inside a view cell. Nodes are taken from the average depth of the nodes rendered from that cell.
+// Depths and counts are indexed by model id, then by cell index.
+PVS_PREPROCESSING_DLL void set_nodes_within_cells_visible(grid* visibility_grid, const std::vector<std::vector<size_t>>& total_depths, const std::vector<std::vector<size_t>>& total_nums);
+
+// Advance node visibility downwards and upwards in the LOD-hierarchy.
+// Since only a single LOD-level was rendered in the visibility test, this is necessary to produce a complete PVS.
+PVS_PREPROCESSING_DLL void propagate_node_visibility(grid* visibility_grid);
+
+}
+}
+
+#endif
@@ -0,0 +1,61 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef LAMURE_PVS_VISIBILITY_TEST_CPU_SPLAT_RENDERER_H
+#define LAMURE_PVS_VISIBILITY_TEST_CPU_SPLAT_RENDERER_H
+
+#include <lamure/pvs/pvs_preprocessing.h>
+#include "lamure/pvs/visibility_test.h"
+#include "lamure/pvs/splat_rasterizer.h"
+#include "lamure/pvs/grid.h"
+
+#include <string>
+#include <vector>
+
+namespace lamure
+{
+namespace pvs
+{
+
+// Visibility test which needs no window or OpenGL context.
+// For every view cell the six cube faces share one cut from the cut_update_pool and are rasterized
+// in parallel on the CPU, the resulting node id images are evaluated like those of the GPU renderers.
+class PVS_PREPROCESSING_DLL visibility_test_cpu_splat_renderer : public visibility_test
+{
+public:
+	visibility_test_cpu_splat_renderer();
+	virtual ~visibility_test_cpu_splat_renderer();
+
+	virtual int initialize(int& argc, char** argv);
+	virtual void test_visibility(grid* visibility_grid);
+	virtual void shutdown();
+
+	virtual bounding_box get_scene_bounds() const;
+
+private:
+	int resolution_x_;
+	int resolution_y_;
+	unsigned int main_memory_budget_;
+    unsigned int video_memory_budget_;
+    unsigned int max_upload_budget_;
+    unsigned int num_threads_;
+
+    float error_threshold_;
+    float visibility_threshold_;
+    float far_plane_;
+
+    std::string pvs_file_path_;
+    std::vector<scm::math::mat4f> model_transformations_;
+
+    bool initialized_;
+    bounding_box scene_bounds_;
+};
+
+}
+}
+
+#endif
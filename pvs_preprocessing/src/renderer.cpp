@@ -750,12 +750,9 @@ compare_histogram_to_cut(const lamure::pvs::id_histogram& hist, const float& vis
 
     std::fstream f;
     f.open("/home/tiwo9285/test.txt", std::ios::out);
-    for(std::map<lamure::model_t, std::map<lamure::node_t, size_t>>::iterator modelIter = hist.get_histogram().begin(); modelIter != hist.get_histogram().end(); ++modelIter)
+    for(const lamure::pvs::id_histogram::entry& hist_entry : hist.get_entries())
     {
-        for(std::map<lamure::node_t, size_t>::iterator nodeIter = modelIter->second.begin(); nodeIter != modelIter->second.end(); ++nodeIter)
-        {
-            f << "model: " << modelIter->first << "  node: " << nodeIter->first << "  amount: " << nodeIter->second << "  percent: " << ((float)nodeIter->second / (float)numPixels) * 100.0f << std::endl;
-        }
+        f << "model: " << hist_entry.model_id_ << "  node: " << hist_entry.node_id_ << "  amount: " << hist_entry.num_pixels_ << "  percent: " << ((float)hist_entry.num_pixels_ / (float)numPixels) * 100.0f << std::endl;
     }
 
     f << "\n";
@@ -0,0 +1,422 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include "lamure/pvs/splat_rasterizer.h"
+
+#include <lamure/ren/model_database.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#define LAMURE_PVS_SPLAT_RASTERIZER_TILE_SIZE 32
+
+namespace lamure
+{
+namespace pvs
+{
+
+namespace
+{
+
+// Byte offsets of the surfel attributes, see the vertex format in gpu_access.
+const size_t SURFEL_POSITION_OFFSET = 0;
+const size_t SURFEL_RADIUS_OFFSET = 16;
+const size_t SURFEL_NORMAL_OFFSET = 20;
+
+inline scm::math::vec3f transform_point(const scm::math::mat4f& m, const scm::math::vec3f& p)
+{
+    return scm::math::vec3f(m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12],
+                            m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13],
+                            m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14]);
+}
+
+inline scm::math::vec3f transform_vector(const scm::math::mat4f& m, const scm::math::vec3f& v)
+{
+    return scm::math::vec3f(m[0] * v.x + m[4] * v.y + m[8] * v.z,
+                            m[1] * v.x + m[5] * v.y + m[9] * v.z,
+                            m[2] * v.x + m[6] * v.y + m[10] * v.z);
+}
+
+}
+
+splat_rasterizer::
+splat_rasterizer(const uint32_t& width, const uint32_t& height, const uint32_t& num_threads)
+    : width_(width),
+      height_(height),
+      num_threads_(std::max(1u, num_threads)),
+      rendered_node_count_(0),
+      near_plane_(0.01f),
+      far_plane_(1000.0f),
+      radius_scale_(1.0f),
+      surfel_size_(0)
+{
+    num_tiles_x_ = (width_ + LAMURE_PVS_SPLAT_RASTERIZER_TILE_SIZE - 1) / LAMURE_PVS_SPLAT_RASTERIZER_TILE_SIZE;
+    num_tiles_y_ = (height_ + LAMURE_PVS_SPLAT_RASTERIZER_TILE_SIZE - 1) / LAMURE_PVS_SPLAT_RASTERIZER_TILE_SIZE;
+
+    id_buffer_.resize(width_ * height_, 0);
+    depth_buffer_.resize(width_ * height_, std::numeric_limits<float>::max());
+    tile_nodes_.resize(num_tiles_x_ * num_tiles_y_);
+}
+
+splat_rasterizer::
+~splat_rasterizer()
+{
+}
+
+uint32_t splat_rasterizer::
+encode_id(const model_t& model_id, const node_t& node_id)
+{
+    // Same layout as color_from_id() in node_visibility.glslf read back as little endian RGBA.
+    return ((uint32_t)((255 - model_id) & 0xFF) << 24) | ((uint32_t)node_id & 0xFFFFFF);
+}
+
+void splat_rasterizer::
+render(const std::vector<node>& nodes,
+        const std::vector<scm::math::mat4f>& model_view_matrices,
+        const scm::math::mat4f& projection_matrix,
+        const float& near_plane,
+        const float& far_plane,
+        const float& radius_scale)
+{
+    projection_matrix_ = projection_matrix;
+    near_plane_ = near_plane;
+    far_plane_ = far_plane;
+    radius_scale_ = radius_scale;
+    surfel_size_ = lamure::ren::model_database::get_instance()->get_primitive_size(lamure::ren::bvh::primitive_type::POINTCLOUD);
+
+    std::fill(id_buffer_.begin(), id_buffer_.end(), 0);
+    std::fill(depth_buffer_.begin(), depth_buffer_.end(), std::numeric_limits<float>::max());
+
+    for(auto& tile : tile_nodes_)
+    {
+        tile.clear();
+    }
+
+    // Assign nodes to all tiles covered by their projected bounds.
+    rendered_node_count_ = 0;
+
+    for(uint32_t node_index = 0; node_index < nodes.size(); ++node_index)
+    {
+        const node& current_node = nodes[node_index];
+        screen_rect rect;
+
+        if(!project_node(current_node, model_view_matrices[current_node.model_id_], rect))
+        {
+            continue;
+        }
+
+        ++rendered_node_count_;
+
+        for(int32_t tile_y = rect.min_y_ / LAMURE_PVS_SPLAT_RASTERIZER_TILE_SIZE; tile_y <= rect.max_y_ / LAMURE_PVS_SPLAT_RASTERIZER_TILE_SIZE; ++tile_y)
+        {
+            for(int32_t tile_x = rect.min_x_ / LAMURE_PVS_SPLAT_RASTERIZER_TILE_SIZE; tile_x <= rect.max_x_ / LAMURE_PVS_SPLAT_RASTERIZER_TILE_SIZE; ++tile_x)
+            {
+                tile_nodes_[tile_y * num_tiles_x_ + tile_x].push_back(node_index);
+            }
+        }
+    }
+
+    // Tiles cover disjoint pixels, so threads can write to the buffers without synchronization.
+    std::atomic<size_t> next_tile(0);
+    size_t num_tiles = tile_nodes_.size();
+
+    auto worker = [&]()
+    {
+        size_t tile_index;
+        while((tile_index = next_tile.fetch_add(1)) < num_tiles)
+        {
+            rasterize_tile(tile_index, nodes, model_view_matrices);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(uint32_t thread_index = 1; thread_index < num_threads_; ++thread_index)
+    {
+        threads.push_back(std::thread(worker));
+    }
+
+    worker();
+
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+bool splat_rasterizer::
+project_node(const node& current_node, const scm::math::mat4f& model_view_matrix, screen_rect& rect) const
+{
+    if(current_node.surfels_ == nullptr || current_node.num_surfels_ == 0)
+    {
+        return false;
+    }
+
+    // Surfel centers lie inside the node bounds, their discs may reach out by their radius.
+    float max_radius = 0.0f;
+    for(size_t surfel_index = 0; surfel_index < current_node.num_surfels_; ++surfel_index)
+    {
+        const float* radius = (const float*)(current_node.surfels_ + surfel_index * surfel_size_ + SURFEL_RADIUS_OFFSET);
+        max_radius = std::max(max_radius, *radius);
+    }
+    max_radius *= radius_scale_;
+
+    scm::math::vec3f box_min = current_node.bounding_box_.min_vertex() - scm::math::vec3f(max_radius);
+    scm::math::vec3f box_max = current_node.bounding_box_.max_vertex() + scm::math::vec3f(max_radius);
+
+    float min_depth = std::numeric_limits<float>::max();
+    float max_depth = -std::numeric_limits<float>::max();
+    float min_x = std::numeric_limits<float>::max();
+    float min_y = std::numeric_limits<float>::max();
+    float max_x = -std::numeric_limits<float>::max();
+    float max_y = -std::numeric_limits<float>::max();
+
+    for(uint32_t corner_index = 0; corner_index < 8; ++corner_index)
+    {
+        scm::math::vec3f corner((corner_index & 1) ? box_max.x : box_min.x,
+                                (corner_index & 2) ? box_max.y : box_min.y,
+                                (corner_index & 4) ? box_max.z : box_min.z);
+
+        scm::math::vec3f eye_corner = transform_point(model_view_matrix, corner);
+        float depth = -eye_corner.z;
+
+        min_depth = std::min(min_depth, depth);
+        max_depth = std::max(max_depth, depth);
+
+        if(depth > 0.0f)
+        {
+            const scm::math::mat4f& p = projection_matrix_;
+            float ndc_x = (p[0] * eye_corner.x + p[8] * eye_corner.z) / depth;
+            float ndc_y = (p[5] * eye_corner.y + p[9] * eye_corner.z) / depth;
+
+            min_x = std::min(min_x, ndc_x);
+            min_y = std::min(min_y, ndc_y);
+            max_x = std::max(max_x, ndc_x);
+            max_y = std::max(max_y, ndc_y);
+        }
+    }
+
+    if(max_depth < near_plane_ || min_depth > far_plane_)
+    {
+        return false;
+    }
+
+    if(min_depth < near_plane_)
+    {
+        // Bounds cross the near plane, projected corners are meaningless.
+        min_x = -1.0f;
+        min_y = -1.0f;
+        max_x = 1.0f;
+        max_y = 1.0f;
+    }
+
+    if(max_x < -1.0f || max_y < -1.0f || min_x > 1.0f || min_y > 1.0f)
+    {
+        return false;
+    }
+
+    rect.min_x_ = std::max(0, (int32_t)std::floor((min_x + 1.0f) * 0.5f * width_));
+    rect.min_y_ = std::max(0, (int32_t)std::floor((min_y + 1.0f) * 0.5f * height_));
+    rect.max_x_ = std::min((int32_t)width_ - 1, (int32_t)std::ceil((max_x + 1.0f) * 0.5f * width_));
+    rect.max_y_ = std::min((int32_t)height_ - 1, (int32_t)std::ceil((max_y + 1.0f) * 0.5f * height_));
+
+    return rect.min_x_ <= rect.max_x_ && rect.min_y_ <= rect.max_y_;
+}
+
+void splat_rasterizer::
+rasterize_tile(const size_t& tile_index, const std::vector<node>& nodes, const std::vector<scm::math::mat4f>& model_view_matrices)
+{
+    const std::vector<uint32_t>& tile_nodes = tile_nodes_[tile_index];
+    if(tile_nodes.empty())
+    {
+        return;
+    }
+
+    const int32_t tile_min_x = (tile_index % num_tiles_x_) * LAMURE_PVS_SPLAT_RASTERIZER_TILE_SIZE;
+    const int32_t tile_min_y = (tile_index / num_tiles_x_) * LAMURE_PVS_SPLAT_RASTERIZER_TILE_SIZE;
+    const int32_t tile_max_x = std::min((int32_t)width_, tile_min_x + LAMURE_PVS_SPLAT_RASTERIZER_TILE_SIZE) - 1;
+    const int32_t tile_max_y = std::min((int32_t)height_, tile_min_y + LAMURE_PVS_SPLAT_RASTERIZER_TILE_SIZE) - 1;
+
+    const scm::math::mat4f& p = projection_matrix_;
+
+    // Eye space view ray through a pixel center is (ray_x, ray_y, -1).
+    float ray_x[LAMURE_PVS_SPLAT_RASTERIZER_TILE_SIZE];
+    float ray_y[LAMURE_PVS_SPLAT_RASTERIZER_TILE_SIZE];
+
+    for(int32_t x = tile_min_x; x <= tile_max_x; ++x)
+    {
+        float ndc_x = ((x + 0.5f) / width_) * 2.0f - 1.0f;
+        ray_x[x - tile_min_x] = (ndc_x + p[8]) / p[0];
+    }
+
+    for(int32_t y = tile_min_y; y <= tile_max_y; ++y)
+    {
+        float ndc_y = ((y + 0.5f) / height_) * 2.0f - 1.0f;
+        ray_y[y - tile_min_y] = (ndc_y + p[9]) / p[5];
+    }
+
+    const float half_width = 0.5f * width_;
+    const float half_height = 0.5f * height_;
+
+    for(uint32_t node_index : tile_nodes)
+    {
+        const node& current_node = nodes[node_index];
+        const scm::math::mat4f& model_view_matrix = model_view_matrices[current_node.model_id_];
+        const uint32_t id = encode_id(current_node.model_id_, current_node.node_id_);
+
+        for(size_t surfel_index = 0; surfel_index < current_node.num_surfels_; ++surfel_index)
+        {
+            const char* surfel = current_node.surfels_ + surfel_index * surfel_size_;
+            const float* position = (const float*)(surfel + SURFEL_POSITION_OFFSET);
+            const float* normal = (const float*)(surfel + SURFEL_NORMAL_OFFSET);
+            float radius = *(const float*)(surfel + SURFEL_RADIUS_OFFSET) * radius_scale_;
+
+            if(!(radius > 0.0f))
+            {
+                continue;
+            }
+
+            scm::math::vec3f ms_n(normal[0], normal[1], normal[2]);
+            float normal_length = scm::math::length(ms_n);
+            if(!(normal_length > 0.0f))
+            {
+                continue;
+            }
+            ms_n /= normal_length;
+
+            // Tangent vectors as in compute_tangent_vectors.glsl.
+            scm::math::vec3f tmp_ms_u;
+            if(ms_n.z != 0.0f)
+            {
+                tmp_ms_u = scm::math::vec3f(1.0f, 1.0f, (-ms_n.x - ms_n.y) / ms_n.z);
+            }
+            else if(ms_n.y != 0.0f)
+            {
+                tmp_ms_u = scm::math::vec3f(1.0f, (-ms_n.x - ms_n.z) / ms_n.y, 1.0f);
+            }
+            else
+            {
+                tmp_ms_u = scm::math::vec3f((-ms_n.y - ms_n.z) / ms_n.x, 1.0f, 1.0f);
+            }
+
+            scm::math::vec3f es_center = transform_point(model_view_matrix, scm::math::vec3f(position[0], position[1], position[2]));
+            scm::math::vec3f es_u = transform_vector(model_view_matrix, scm::math::normalize(tmp_ms_u) * radius);
+            scm::math::vec3f es_v = transform_vector(model_view_matrix, scm::math::normalize(scm::math::cross(ms_n, tmp_ms_u)) * radius);
+
+            float uu = scm::math::dot(es_u, es_u);
+            float vv = scm::math::dot(es_v, es_v);
+            float es_radius = std::sqrt(std::max(uu, vv));
+            float center_depth = -es_center.z;
+
+            if(center_depth + es_radius < near_plane_ || center_depth - es_radius > far_plane_)
+            {
+                continue;
+            }
+
+            // Conservative screen bounds of the disc, the whole tile if it crosses the near plane.
+            int32_t min_x = tile_min_x;
+            int32_t min_y = tile_min_y;
+            int32_t max_x = tile_max_x;
+            int32_t max_y = tile_max_y;
+
+            float closest_depth = center_depth - es_radius;
+            if(closest_depth > near_plane_)
+            {
+                float center_x = ((p[0] * es_center.x + p[8] * es_center.z) / center_depth + 1.0f) * half_width;
+                float center_y = ((p[5] * es_center.y + p[9] * es_center.z) / center_depth + 1.0f) * half_height;
+                float extent_x = (es_radius / closest_depth) * std::abs(p[0]) * half_width + 1.0f;
+                float extent_y = (es_radius / closest_depth) * std::abs(p[5]) * half_height + 1.0f;
+
+                min_x = std::max(min_x, (int32_t)std::floor(center_x - extent_x));
+                min_y = std::max(min_y, (int32_t)std::floor(center_y - extent_y));
+                max_x = std::min(max_x, (int32_t)std::ceil(center_x + extent_x));
+                max_y = std::min(max_y, (int32_t)std::ceil(center_y + extent_y));
+            }
+
+            if(min_x > max_x || min_y > max_y)
+            {
+                continue;
+            }
+
+            // Intersect each pixel ray with the splat plane and test against the disc.
+            scm::math::vec3f es_n = scm::math::cross(es_u, es_v);
+            float plane_distance = scm::math::dot(es_center, es_n);
+            float inv_uu = 1.0f / uu;
+            float inv_vv = 1.0f / vv;
+
+            for(int32_t y = min_y; y <= max_y; ++y)
+            {
+                float dy = ray_y[y - tile_min_y];
+                size_t row = (size_t)y * width_;
+
+                for(int32_t x = min_x; x <= max_x; ++x)
+                {
+                    float dx = ray_x[x - tile_min_x];
+
+                    float denominator = dx * es_n.x + dy * es_n.y - es_n.z;
+                    if(std::abs(denominator) < 1e-20f)
+                    {
+                        continue;
+                    }
+
+                    float depth = plane_distance / denominator;
+                    if(depth < near_plane_ || depth > far_plane_ || depth >= depth_buffer_[row + x])
+                    {
+                        continue;
+                    }
+
+                    scm::math::vec3f offset(dx * depth - es_center.x, dy * depth - es_center.y, -depth - es_center.z);
+                    float a = scm::math::dot(offset, es_u) * inv_uu;
+                    float b = scm::math::dot(offset, es_v) * inv_vv;
+
+                    if(a * a + b * b > 1.0f)
+                    {
+                        continue;
+                    }
+
+                    depth_buffer_[row + x] = depth;
+                    id_buffer_[row + x] = id;
+                }
+            }
+        }
+    }
+}
+
+const std::vector<uint32_t>& splat_rasterizer::
+get_id_buffer() const
+{
+    return id_buffer_;
+}
+
+const std::vector<float>& splat_rasterizer::
+get_depth_buffer() const
+{
+    return depth_buffer_;
+}
+
+uint32_t splat_rasterizer::
+get_width() const
+{
+    return width_;
+}
+
+uint32_t splat_rasterizer::
+get_height() const
+{
+    return height_;
+}
+
+size_t splat_rasterizer::
+get_rendered_node_count() const
+{
+    return rendered_node_count_;
+}
+
+}
+}
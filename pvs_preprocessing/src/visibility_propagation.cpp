@@ -0,0 +1,139 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group 
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include "lamure/pvs/visibility_propagation.h"
+
+#include <iostream>
+#include <map>
+
+#include <lamure/bounding_box.h>
+#include <lamure/ren/model_database.h>
+#include <lamure/ren/bvh.h>
+
+namespace lamure
+{
+namespace pvs
+{
+
+namespace
+{
+
+void set_node_parents_visible(grid* visibility_grid, const size_t& cell_id, const view_cell* cell, const model_t& model_id, const node_t& node_id)
+{
+    // Set parents of a visible node visible, too.
+    // Necessary since only a single LOD-level is rendered during the visibility test.
+    lamure::ren::model_database* database = lamure::ren::model_database::get_instance();
+    node_t parent_id = database->get_model(model_id)->get_bvh()->get_parent_id(node_id);
+    
+    if(parent_id != lamure::invalid_node_t && !cell->get_visibility(model_id, parent_id))
+    {
+        visibility_grid->set_cell_visibility(cell_id, model_id, parent_id, true);
+        set_node_parents_visible(visibility_grid, cell_id, cell, model_id, parent_id);
+    }
+}
+
+void set_node_children_visible(grid* visibility_grid, const size_t& cell_id, const view_cell* cell, const model_t& model_id, const node_t& node_id)
+{
+    // Set children of a visible node visible, too.
+    lamure::ren::model_database* database = lamure::ren::model_database::get_instance();
+    uint32_t fan_factor = database->get_model(model_id)->get_bvh()->get_fan_factor();
+
+    for(uint32_t child_index = 0; child_index < fan_factor; ++child_index)
+    {
+        node_t child_id = database->get_model(model_id)->get_bvh()->get_child_id(node_id, child_index);
+        if(child_id < database->get_model(model_id)->get_bvh()->get_num_nodes() && !cell->get_visibility(model_id, child_id))
+        {
+            visibility_grid->set_cell_visibility(cell_id, model_id, child_id, true);
+            set_node_children_visible(visibility_grid, cell_id, cell, model_id, child_id);
+        }
+    }
+}
+
+}
+
+void set_nodes_within_cells_visible(grid* visibility_grid, const std::vector<std::vector<size_t>>& total_depths, const std::vector<std::vector<size_t>>& total_nums)
+{
+    lamure::ren::model_database* database = lamure::ren::model_database::get_instance();
+
+    for(model_t model_index = 0; model_index < database->num_models(); ++model_index)
+    {
+        for(size_t cell_index = 0; cell_index < visibility_grid->get_cell_count(); ++cell_index)
+        {
+            // No node of this model was rendered from the cell.
+            if(total_nums[model_index][cell_index] == 0)
+            {
+                continue;
+            }
+
+            // Create bounding box of view cell.
+            const view_cell* current_cell = visibility_grid->get_cell_at_index(cell_index);
+                
+            vec3r min_vertex(current_cell->get_position_center() - (current_cell->get_size() * 0.5f));
+            vec3r max_vertex(current_cell->get_position_center() + (current_cell->get_size() * 0.5f));
+            bounding_box cell_bounds(min_vertex, max_vertex);
+
+            // We can get the first and last index of the nodes on a certain depth inside the bvh.
+            unsigned int average_depth = total_depths[model_index][cell_index] / total_nums[model_index][cell_index];
+
+            node_t start_index = database->get_model(model_index)->get_bvh()->get_first_node_id_of_depth(average_depth);
+            node_t end_index = start_index + database->get_model(model_index)->get_bvh()->get_length_of_depth(average_depth);
+
+            for(node_t node_index = start_index; node_index < end_index; ++node_index)
+            {
+                // Create bounding box of node.
+                scm::gl::boxf node_bounding_box = database->get_model(model_index)->get_bvh()->get_bounding_boxes()[node_index];
+                vec3r min_vertex = vec3r(node_bounding_box.min_vertex()) + database->get_model(model_index)->get_bvh()->get_translation();
+                vec3r max_vertex = vec3r(node_bounding_box.max_vertex()) + database->get_model(model_index)->get_bvh()->get_translation();
+                bounding_box node_bounds(min_vertex, max_vertex);
+
+                // check if the bounding boxes collide.
+                if(cell_bounds.intersects(node_bounds))
+                {
+                    visibility_grid->set_cell_visibility(cell_index, model_index, node_index, true);
+                }
+            }
+        }
+    }
+}
+
+void propagate_node_visibility(grid* visibility_grid)
+{
+    float steps_finished = 0.0f;
+    float total_steps = visibility_grid->get_cell_count();
+
+    #pragma omp parallel for
+    for(size_t cell_index = 0; cell_index < visibility_grid->get_cell_count(); ++cell_index)
+    {
+        const view_cell* current_cell = visibility_grid->get_cell_at_index(cell_index);
+        std::map<model_t, std::vector<node_t>> visible_indices = current_cell->get_visible_indices();
+
+        for(std::map<model_t, std::vector<node_t>>::const_iterator map_iter = visible_indices.begin(); map_iter != visible_indices.end(); ++map_iter)
+        {
+            for(node_t node_index = 0; node_index < map_iter->second.size(); ++node_index)
+            {
+                node_t visible_node_id = map_iter->second.at(node_index);
+
+                // Communicate visibility to children and parents nodes of visible nodes.
+                set_node_children_visible(visibility_grid, cell_index, current_cell, map_iter->first, visible_node_id);
+                set_node_parents_visible(visibility_grid, cell_index, current_cell, map_iter->first, visible_node_id);
+            }       
+        }
+
+        #pragma omp critical
+        {
+            // Calculate current node propagation state so user gets visual feedback on the preprocessing progress.
+            steps_finished++;
+            float current_percentage_done = (steps_finished / total_steps) * 100.0f;
+            std::cout << "\rvisibility propagation in progress [" << current_percentage_done << "]       " << std::flush;
+        }
+    }
+
+    std::cout << std::endl;
+}
+
+}
+}
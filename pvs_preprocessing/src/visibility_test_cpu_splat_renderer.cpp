@@ -0,0 +1,508 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include "lamure/pvs/visibility_test_cpu_splat_renderer.h"
+#include "lamure/pvs/visibility_propagation.h"
+#include "lamure/pvs/id_histogram.h"
+#include "lamure/pvs/utils.h"
+#include "lamure/pvs/pvs_database.h"
+
+#include "lamure/ren/model_database.h"
+#include "lamure/ren/cut_database.h"
+#include "lamure/ren/cut_update_pool.h"
+#include "lamure/ren/ooc_cache.h"
+#include "lamure/ren/camera.h"
+#include "lamure/ren/policy.h"
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <thread>
+
+// Number of cut updates without growing cuts after which the cut of a view cell is considered final.
+#define LAMURE_PVS_CUT_CONVERGENCE_REPETITIONS 10
+
+namespace lamure
+{
+namespace pvs
+{
+
+visibility_test_cpu_splat_renderer::
+visibility_test_cpu_splat_renderer()
+{
+	resolution_x_ = 1024;
+	resolution_y_ = 1024;
+	video_memory_budget_ = 2048;
+	main_memory_budget_ = 4096;
+	max_upload_budget_ = 64;
+	num_threads_ = std::max(1u, std::thread::hardware_concurrency());
+
+	error_threshold_ = LAMURE_DEFAULT_THRESHOLD;
+	visibility_threshold_ = 0.0001f;
+	far_plane_ = 1000.0f;
+
+	initialized_ = false;
+}
+
+visibility_test_cpu_splat_renderer::
+~visibility_test_cpu_splat_renderer()
+{
+	shutdown();
+}
+
+int visibility_test_cpu_splat_renderer::
+initialize(int& argc, char** argv)
+{
+ 	namespace po = boost::program_options;
+    namespace fs = boost::filesystem;
+
+    const std::string exec_name = (argc > 0) ? fs::basename(argv[0]) : "";
+
+    std::string resource_file_path = "";
+
+    // These value are read, but not used. Yet ignoring them in the terminal parameters would lead to misinterpretation.
+    std::string visibility_test_type = "";
+    std::string grid_type = "";
+    unsigned int grid_size = 1;
+    unsigned int num_steps = 11;
+    double oversize_factor = 1.5;
+    float optimization_threshold = 1.0f;
+    std::string reference_pvs_file_path = "";
+
+	po::options_description desc("Usage: " + exec_name + " [OPTION]... INPUT\n\n"
+                               "Allowed Options");
+    desc.add_options()
+      ("help", "print help message")
+      ("width,w", po::value<int>(&resolution_x_)->default_value(1024), "specify image width per cube face (default=1024)")
+      ("height,h", po::value<int>(&resolution_y_)->default_value(1024), "specify image height per cube face (default=1024)")
+      ("resource-file,f", po::value<std::string>(&resource_file_path), "specify resource input-file")
+      ("vram,v", po::value<unsigned>(&video_memory_budget_)->default_value(2048), "specify render budget of the cut in MB (default=2048)")
+      ("mem,m", po::value<unsigned>(&main_memory_budget_)->default_value(4096), "specify main memory budget in MB (default=4096)")
+      ("upload,u", po::value<unsigned>(&max_upload_budget_)->default_value(64), "specify maximum upload budget per cut update in MB (default=64)")
+      ("threads,t", po::value<unsigned>(&num_threads_)->default_value(num_threads_), "specify number of rasterization threads (default=number of cores)")
+    // The following parameters are used by the main app only, yet must be identified nonetheless since otherwise they are dealt with as file paths.
+      ("pvs-file,p", po::value<std::string>(&pvs_file_path_), "specify output file of calculated pvs data")
+      ("vistest", po::value<std::string>(&visibility_test_type)->default_value("cpu"), "specify type of visibility test to be used.")
+      ("gridtype", po::value<std::string>(&grid_type)->default_value("octree"), "specify type of grid to store visibility data ('regular', 'octree', 'hierarchical')")
+      ("gridsize", po::value<unsigned int>(&grid_size)->default_value(1), "specify size/depth of the grid used for the visibility test (depends on chosen grid type)")
+      ("oversize", po::value<double>(&oversize_factor)->default_value(1.5), "factor the grid bounds will be scaled by, default is 1.5 (grid bounds will exceed scene bounds by factor of 1.5)")
+      ("optithresh", po::value<float>(&optimization_threshold)->default_value(1.0f), "specify the threshold at which common data are converged. Default is 1.0, which means data must be 100 percent equal.")
+      ("numsteps,n", po::value<unsigned int>(&num_steps)->default_value(11), "specify the number of intervals the occlusion values will be split into (visibility analysis only)")
+      ("reference", po::value<std::string>(&reference_pvs_file_path), "specify a pvs file the result will be compared against");
+      ;
+
+    po::variables_map vm;
+
+    try
+    {
+		auto parsed_options = po::command_line_parser(argc, argv).options(desc).allow_unregistered().run();
+		po::store(parsed_options, vm);
+		po::notify(vm);
+
+		std::vector<std::string> to_pass_further = po::collect_unrecognized(parsed_options.options, po::include_positional);
+		bool no_input = !vm.count("input") && to_pass_further.empty();
+
+		if (resource_file_path == "")
+		{
+			if (vm.count("help") || no_input)
+			{
+				std::cout << desc;
+				return 0;
+			}
+		}
+
+		// no explicit input -> use unknown options
+		if (!vm.count("input") && resource_file_path == "")
+		{
+			resource_file_path = "auto_generated.rsc";
+			std::fstream ofstr(resource_file_path, std::ios::out);
+			if (ofstr.good())
+			{
+				for (auto argument : to_pass_further)
+				{
+					ofstr << argument << std::endl;
+				}
+			}
+			else
+			{
+				throw std::runtime_error("Cannot open file");
+			}
+			ofstr.close();
+		}
+	}
+	catch (std::exception& e)
+	{
+		std::cout << "Warning: No input file specified. \n" << desc;
+		return 0;
+	}
+
+    num_threads_ = std::max(1u, num_threads_);
+
+    std::pair< std::vector<std::string>, std::vector<scm::math::mat4f> > model_attributes;
+    std::set<lamure::model_t> visible_set;
+    std::set<lamure::model_t> invisible_set;
+    model_attributes = read_model_string(resource_file_path, &visible_set, &invisible_set);
+
+    model_transformations_ = model_attributes.second;
+    std::vector<std::string> const& model_filenames = model_attributes.first;
+
+    lamure::ren::policy* policy = lamure::ren::policy::get_instance();
+    policy->set_max_upload_budget_in_mb(max_upload_budget_);
+    policy->set_render_budget_in_mb(video_memory_budget_);
+    policy->set_out_of_core_budget_in_mb(main_memory_budget_);
+    policy->set_window_width(resolution_x_);
+    policy->set_window_height(resolution_y_);
+
+#ifndef LAMURE_PVS_USE_AS_RENDERER
+    lamure::pvs::pvs_database::get_instance()->activate(false);
+#endif
+
+	lamure::ren::model_database* database = lamure::ren::model_database::get_instance();
+
+    lamure::model_t num_models = 0;
+    for (const auto& filename : model_filenames)
+    {
+        database->add_model(filename, std::to_string(num_models));
+        ++num_models;
+    }
+
+    database->apply();
+
+    float scene_diameter = far_plane_;
+
+    for(lamure::model_t model_id = 0; model_id < database->num_models(); ++model_id)
+    {
+        const scm::gl::boxf& box_model_root = database->get_model(model_id)->get_bvh()->get_bounding_boxes()[0];
+        scene_diameter = std::max(scm::math::length(box_model_root.max_vertex() - box_model_root.min_vertex()), scene_diameter);
+
+        // Same model transformations as used by management_base.
+        model_transformations_[model_id] = model_transformations_[model_id] * scm::math::make_translation(database->get_model(model_id)->get_bvh()->get_translation());
+
+        // Cast required from boxf to bounding_box.
+        vec3r min_vertex(box_model_root.min_vertex() + database->get_model(model_id)->get_bvh()->get_translation());
+        vec3r max_vertex(box_model_root.max_vertex() + database->get_model(model_id)->get_bvh()->get_translation());
+        bounding_box model_root_box(min_vertex, max_vertex);
+
+        if(model_id == 0)
+        {
+            scene_bounds_ = bounding_box(model_root_box);
+        }
+        else
+        {
+            scene_bounds_.expand(model_root_box);
+        }
+    }
+
+    far_plane_ = 2.0f * scene_diameter;
+    initialized_ = true;
+
+    return 0;
+}
+
+void visibility_test_cpu_splat_renderer::
+test_visibility(grid* visibility_grid)
+{
+    if(!initialized_ || visibility_grid == nullptr)
+    {
+        return;
+    }
+
+    lamure::ren::model_database* database = lamure::ren::model_database::get_instance();
+    lamure::ren::cut_database* cuts = lamure::ren::cut_database::get_instance();
+    lamure::ren::ooc_cache* ooc_cache = lamure::ren::ooc_cache::get_instance();
+    lamure::ren::policy* policy = lamure::ren::policy::get_instance();
+
+    const lamure::context_t context_id = 0;
+    const lamure::model_t num_models = database->num_models();
+    const size_t num_pixels = resolution_x_ * resolution_y_;
+    const size_t num_cells = visibility_grid->get_cell_count();
+
+    // Without a GPU, the cut update writes its uploads into main memory.
+    size_t slot_size = database->get_slot_size();
+    lamure::node_t upload_budget_in_nodes = (max_upload_budget_ * 1024u * 1024u) / slot_size;
+    lamure::node_t render_budget_in_nodes = (video_memory_budget_ * 1024u * 1024u) / slot_size;
+
+    std::vector<char> storage_a(upload_budget_in_nodes * slot_size);
+    std::vector<char> storage_b(upload_budget_in_nodes * slot_size);
+
+    std::unique_ptr<lamure::ren::cut_update_pool> pool(new lamure::ren::cut_update_pool(context_id, upload_budget_in_nodes, render_budget_in_nodes));
+
+    // The six faces are rendered at the same time, the remaining threads are shared among them.
+    std::vector<std::unique_ptr<splat_rasterizer>> rasterizers;
+    for(uint32_t face = 0; face < 6; ++face)
+    {
+        rasterizers.emplace_back(new splat_rasterizer(resolution_x_, resolution_y_, std::max(1u, num_threads_ / 6)));
+    }
+
+    std::vector<std::vector<size_t>> total_depth_rendered_nodes(num_models, std::vector<size_t>(num_cells, 0));
+    std::vector<std::vector<size_t>> total_num_rendered_nodes(num_models, std::vector<size_t>(num_cells, 0));
+
+    double total_cut_update_time = 0.0;
+    double total_render_time = 0.0;
+
+    std::chrono::time_point<std::chrono::system_clock> test_start_time = std::chrono::system_clock::now();
+
+    for(size_t cell_index = 0; cell_index < num_cells; ++cell_index)
+    {
+        const view_cell* current_cell = visibility_grid->get_cell_at_index(cell_index);
+
+        // Cube face cameras, same orientation and near planes as the GPU renderers.
+        std::vector<lamure::ren::camera> cameras;
+        std::vector<scm::math::mat4f> projections(6);
+        std::vector<float> near_planes(6);
+
+        for(uint32_t face = 0; face < 6; ++face)
+        {
+            scm::math::vec3d look_dir;
+            scm::math::vec3d up_dir(0.0, 1.0, 0.0);
+
+            switch(face)
+            {
+                case 0: look_dir = scm::math::vec3d(1.0, 0.0, 0.0); near_planes[face] = current_cell->get_size().x * 0.5f; break;
+                case 1: look_dir = scm::math::vec3d(-1.0, 0.0, 0.0); near_planes[face] = current_cell->get_size().x * 0.5f; break;
+                case 2: look_dir = scm::math::vec3d(0.0, 1.0, 0.0); up_dir = scm::math::vec3d(0.0, 0.0, 1.0); near_planes[face] = current_cell->get_size().y * 0.5f; break;
+                case 3: look_dir = scm::math::vec3d(0.0, -1.0, 0.0); up_dir = scm::math::vec3d(0.0, 0.0, 1.0); near_planes[face] = current_cell->get_size().y * 0.5f; break;
+                case 4: look_dir = scm::math::vec3d(0.0, 0.0, 1.0); near_planes[face] = current_cell->get_size().z * 0.5f; break;
+                default: look_dir = scm::math::vec3d(0.0, 0.0, -1.0); near_planes[face] = current_cell->get_size().z * 0.5f; break;
+            }
+
+            scm::math::mat4f view_matrix = scm::math::mat4f(scm::math::make_look_at_matrix(current_cell->get_position_center(), current_cell->get_position_center() + look_dir, up_dir));
+            scm::math::perspective_matrix(projections[face], 90.0f, float(resolution_x_) / float(resolution_y_), near_planes[face], far_plane_);
+
+            cameras.push_back(lamure::ren::camera(face, near_planes[face], view_matrix, projections[face]));
+        }
+
+        // Update the cut until it stops growing.
+        std::chrono::time_point<std::chrono::system_clock> start_time = std::chrono::system_clock::now();
+
+        std::vector<size_t> old_cut_lengths(6 * num_models, 0);
+        int repetition_counter = 0;
+
+        while(repetition_counter < LAMURE_PVS_CUT_CONVERGENCE_REPETITIONS)
+        {
+            for(lamure::model_t model_id = 0; model_id < num_models; ++model_id)
+            {
+                cuts->send_transform(context_id, model_id, model_transformations_[model_id]);
+                cuts->send_threshold(context_id, model_id, error_threshold_);
+                cuts->send_rendered(context_id, model_id);
+                database->get_model(model_id)->set_transform(model_transformations_[model_id]);
+            }
+
+            for(uint32_t face = 0; face < 6; ++face)
+            {
+                std::vector<scm::math::vec3d> corner_values = cameras[face].get_frustum_corners();
+                double top_minus_bottom = scm::math::length((corner_values[2]) - (corner_values[0]));
+                float height_divided_by_top_minus_bottom = policy->window_height() / top_minus_bottom;
+
+                cuts->send_camera(context_id, face, cameras[face]);
+                cuts->send_height_divided_by_top_minus_bottom(context_id, face, height_divided_by_top_minus_bottom);
+            }
+
+            cuts->swap(context_id);
+            pool->dispatch_cut_update(storage_a.data(), storage_b.data(), nullptr, nullptr);
+
+            while(pool->is_running())
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(10));
+            }
+
+            if(cuts->is_front_modified(context_id))
+            {
+                cuts->signal_upload_complete(context_id);
+            }
+
+            bool length_changed = false;
+
+            for(uint32_t face = 0; face < 6; ++face)
+            {
+                for(lamure::model_t model_id = 0; model_id < num_models; ++model_id)
+                {
+                    size_t cut_length = cuts->get_cut(context_id, face, model_id).complete_set().size();
+                    if(cut_length > old_cut_lengths[face * num_models + model_id])
+                    {
+                        length_changed = true;
+                    }
+                    old_cut_lengths[face * num_models + model_id] = cut_length;
+                }
+            }
+
+            repetition_counter = length_changed ? 0 : repetition_counter + 1;
+        }
+
+        std::chrono::time_point<std::chrono::system_clock> end_time = std::chrono::system_clock::now();
+        total_cut_update_time += std::chrono::duration<double>(end_time - start_time).count();
+
+        // Collect the surfels of the cut nodes, the cut keeps them resident in the ooc-cache.
+        std::vector<std::vector<splat_rasterizer::node>> face_nodes(6);
+        std::vector<std::vector<scm::math::mat4f>> face_model_views(6, std::vector<scm::math::mat4f>(num_models));
+
+        for(uint32_t face = 0; face < 6; ++face)
+        {
+            for(lamure::model_t model_id = 0; model_id < num_models; ++model_id)
+            {
+                const lamure::ren::bvh* bvh = database->get_model(model_id)->get_bvh();
+                if(bvh->get_primitive() != lamure::ren::bvh::primitive_type::POINTCLOUD)
+                {
+                    continue;
+                }
+
+                face_model_views[face][model_id] = cameras[face].get_view_matrix() * model_transformations_[model_id];
+
+                std::vector<lamure::ren::cut::node_slot_aggregate> renderable = cuts->get_cut(context_id, face, model_id).complete_set();
+
+                for(auto const& node_slot_aggregate : renderable)
+                {
+                    splat_rasterizer::node current_node;
+                    current_node.model_id_ = model_id;
+                    current_node.node_id_ = node_slot_aggregate.node_id_;
+                    current_node.surfels_ = ooc_cache->node_data(model_id, node_slot_aggregate.node_id_);
+                    current_node.num_surfels_ = bvh->get_primitives_per_node();
+                    current_node.bounding_box_ = bvh->get_bounding_boxes()[node_slot_aggregate.node_id_];
+                    face_nodes[face].push_back(current_node);
+
+                    // Collect data to calculate average depth of nodes per model.
+                    total_depth_rendered_nodes[model_id][cell_index] += bvh->get_depth_of_node(node_slot_aggregate.node_id_);
+                    total_num_rendered_nodes[model_id][cell_index] += 1;
+                }
+            }
+        }
+
+        // Rasterize and evaluate the six faces in parallel.
+        start_time = std::chrono::system_clock::now();
+
+        std::vector<std::map<model_t, std::vector<node_t>>> face_visible_ids(6);
+        std::vector<std::thread> face_threads;
+
+        for(uint32_t face = 0; face < 6; ++face)
+        {
+            face_threads.push_back(std::thread([&, face]()
+            {
+                rasterizers[face]->render(face_nodes[face], face_model_views[face], projections[face], near_planes[face], far_plane_);
+
+                id_histogram hist;
+                hist.create(rasterizers[face]->get_id_buffer().data(), num_pixels, std::max(1u, num_threads_ / 6));
+                face_visible_ids[face] = hist.get_visible_nodes(num_pixels, visibility_threshold_);
+            }));
+        }
+
+        for(auto& face_thread : face_threads)
+        {
+            face_thread.join();
+        }
+
+        for(uint32_t face = 0; face < 6; ++face)
+        {
+            for(const auto& model_visible_ids : face_visible_ids[face])
+            {
+                for(node_t node_id : model_visible_ids.second)
+                {
+                    visibility_grid->set_cell_visibility(cell_index, model_visible_ids.first, node_id, true);
+                }
+            }
+        }
+
+        end_time = std::chrono::system_clock::now();
+        total_render_time += std::chrono::duration<double>(end_time - start_time).count();
+
+        if((cell_index + 1) % 8 == 0 || cell_index + 1 == num_cells)
+        {
+            // Calculate current rendering state so user gets visual feedback on the preprocessing progress.
+            double elapsed_seconds = std::chrono::duration<double>(std::chrono::system_clock::now() - test_start_time).count();
+            float current_percentage_done = ((float)(cell_index + 1) / (float)num_cells) * 100.0f;
+            std::cout << "\rrendering in progress [" << current_percentage_done << "]  " << (cell_index + 1) / elapsed_seconds << " cells/s       " << std::flush;
+        }
+    }
+
+    std::cout << std::endl;
+
+    double test_time = std::chrono::duration<double>(std::chrono::system_clock::now() - test_start_time).count();
+
+    // The pool holds slots of the caches, release it before the caches are destroyed.
+    pool.reset();
+
+    std::chrono::time_point<std::chrono::system_clock> start_time = std::chrono::system_clock::now();
+
+    // ... calculate which nodes are inside the view cells based on the average depth of the nodes inside the cuts during rendering.
+    std::cout << "start check for nodes inside grid cells..." << std::endl;
+    set_nodes_within_cells_visible(visibility_grid, total_depth_rendered_nodes, total_num_rendered_nodes);
+    std::cout << "node check finished" << std::endl;
+
+    std::chrono::time_point<std::chrono::system_clock> end_time = std::chrono::system_clock::now();
+    double node_within_cell_check_time = std::chrono::duration<double>(end_time - start_time).count();
+    start_time = std::chrono::system_clock::now();
+
+    // Hardcoded heresy. This grid type applies visibility propagation at runtime.
+    if(visibility_grid->get_grid_type() != "octree_hierarchical_v3")
+    {
+        // ... set visibility of LOD-trees based on rendered nodes.
+        std::cout << "start visibility propagation..." << std::endl;
+        propagate_node_visibility(visibility_grid);
+        std::cout << "visibility propagation finished" << std::endl;
+    }
+
+    end_time = std::chrono::system_clock::now();
+    double visibility_propagation_time = std::chrono::duration<double>(end_time - start_time).count();
+
+    double cells_per_second = num_cells / std::max(test_time, 1e-9);
+    std::cout << "cpu visibility test: " << num_cells << " cells in " << test_time << " s (" << cells_per_second << " cells/s, "
+              << num_threads_ << " threads)" << std::endl;
+
+    if(pvs_file_path_.size() > 4)
+    {
+        std::string performance_file_path = pvs_file_path_;
+        performance_file_path.resize(performance_file_path.size() - 4);
+        performance_file_path += "_performance.txt";
+
+        std::ofstream file_out;
+        file_out.open(performance_file_path);
+
+        file_out << "---------- average performance in seconds ----------" << std::endl;
+        file_out << "cut update: " << total_cut_update_time / num_cells << std::endl;
+        file_out << "rendering and histogram evaluation (6 faces): " << total_render_time / num_cells << std::endl;
+
+        file_out << "\n---------- total performance in seconds ----------" << std::endl;
+        file_out << "cut update: " << total_cut_update_time << std::endl;
+        file_out << "rendering and histogram evaluation: " << total_render_time << std::endl;
+        file_out << "node in cell check: " << node_within_cell_check_time << std::endl;
+        file_out << "visibility propagation: " << visibility_propagation_time << std::endl;
+        file_out << "cells per second: " << cells_per_second << std::endl;
+        file_out << "rasterization threads: " << num_threads_ << std::endl;
+        file_out << std::endl;
+
+        file_out.close();
+    }
+}
+
+void visibility_test_cpu_splat_renderer::
+shutdown()
+{
+    if (initialized_)
+    {
+        delete lamure::pvs::pvs_database::get_instance();
+
+        delete lamure::ren::cut_database::get_instance();
+        delete lamure::ren::model_database::get_instance();
+        delete lamure::ren::policy::get_instance();
+        delete lamure::ren::ooc_cache::get_instance();
+
+        initialized_ = false;
+    }
+}
+
+bounding_box visibility_test_cpu_splat_renderer::
+get_scene_bounds() const
+{
+	return scene_bounds_;
+}
+
+}
+}
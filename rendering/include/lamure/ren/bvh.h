@@ -79,9 +79,12 @@ public:
     void                set_visibility(const node_t node_id, const node_visibility visibility);
     void                set_primitive(const primitive_type primitive) { primitive_ = primitive; };
 
-    void                write_bvh_file(const std::string& filename);
+    // version 1 writes one record per node, version 2 writes the node
+    // attributes as aligned columns that are read without parsing
+    void                write_bvh_file(const std::string& filename, const uint32_t version = 1);
 
 protected:
+    friend class bvh_stream;
 
     void                load_bvh_file(const std::string& filename);
 
@@ -41,6 +41,8 @@ public:
 
     void read_bvh(const std::string& filename, bvh& bvh);
     void write_bvh(const std::string& filename, bvh& bvh);
+    //version 2, node attributes are stored as columns instead of node segments
+    void write_bvh_columns(const std::string& filename, bvh& bvh);
 
 
 protected:
@@ -73,6 +75,21 @@ protected:
         BVH_NODE_VISIBLE = 0,
         BVH_NODE_INVISIBLE = 1
     };
+    enum bvh_column_type {
+        BVH_COLUMN_BOUNDING_BOXES = 0,
+        BVH_COLUMN_CENTROIDS = 1,
+        BVH_COLUMN_AVG_SURFEL_RADII = 2,
+        BVH_COLUMN_MAX_SURFEL_RADIUS_DEVIATIONS = 3,
+        BVH_COLUMN_VISIBILITY = 4,
+        BVH_COLUMN_COUNT = 5
+    };
+    struct bvh_column {
+        uint32_t type_;
+        uint32_t element_size_;
+        uint64_t offset_; //absolute file position, aligned to 64 bytes
+        uint64_t length_;
+        const char* data_; //not serialized, source of the column when writing
+    };
     enum bvh_tree_state {
         BVH_STATE_NULL            = 0, //null tree
         BVH_STATE_EMPTY           = 1, //initialized, but empty tree
@@ -442,6 +459,81 @@ protected:
     };
 
 
+    class bvh_column_seg : public bvh_serializable {
+    public:
+        bvh_column_seg()
+        : bvh_serializable(),
+          data_size_(0) {};
+        ~bvh_column_seg() {};
+
+        uint32_t segment_id_;
+        uint32_t num_nodes_;
+        uint32_t num_columns_;
+        uint32_t reserved_;
+        std::vector<bvh_column> columns_;
+
+        //alignment and column data behind the column table
+        size_t data_size_;
+
+    protected:
+        friend class bvh_stream;
+        const size_t size() const {
+            return 4*sizeof(uint32_t) + num_columns_*24 + data_size_;
+        };
+        void signature(char* signature) {
+            signature[0] = 'B';
+            signature[1] = 'V';
+            signature[2] = 'H';
+            signature[3] = 'X';
+            signature[4] = 'C';
+            signature[5] = 'O';
+            signature[6] = 'L';
+            signature[7] = 'S';
+        }
+        void serialize(std::fstream& file) {
+            if (!file.is_open()) {
+                throw std::runtime_error(
+                    "PLOD: bvh_stream::Unable to serialize");
+            }
+            file.write((char*)&segment_id_, 4);
+            file.write((char*)&num_nodes_, 4);
+            file.write((char*)&num_columns_, 4);
+            file.write((char*)&reserved_, 4);
+            for (const auto& column : columns_) {
+                file.write((char*)&column.type_, 4);
+                file.write((char*)&column.element_size_, 4);
+                file.write((char*)&column.offset_, 8);
+                file.write((char*)&column.length_, 8);
+            }
+            for (const auto& column : columns_) {
+                while ((uint64_t)file.tellp() < column.offset_) {
+                    char c = 0;
+                    file.write(&c, 1);
+                }
+                file.write(column.data_, column.length_);
+            }
+        }
+        void deserialize(std::fstream& file) {
+            if (!file.is_open()) {
+                throw std::runtime_error(
+                    "PLOD: bvh_stream::Unable to deserialize");
+            }
+            file.read((char*)&segment_id_, 4);
+            file.read((char*)&num_nodes_, 4);
+            file.read((char*)&num_columns_, 4);
+            file.read((char*)&reserved_, 4);
+            columns_.resize(num_columns_);
+            for (auto& column : columns_) {
+                file.read((char*)&column.type_, 4);
+                file.read((char*)&column.element_size_, 4);
+                file.read((char*)&column.offset_, 8);
+                file.read((char*)&column.length_, 8);
+                column.data_ = nullptr;
+            }
+        }
+
+    };
+
     class bvh_tree_extension_seg: public bvh_serializable
     {
     public:
@@ -542,6 +634,7 @@ protected:
     void close_stream(const bool remove_file);    
  
     void write(bvh_serializable& serializable);
+    void read_columns(const bvh_column_seg& columns, bvh& bvh);
 
 
 private:
@@ -14,6 +14,7 @@
 
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <scm/core.h>
 #include <scm/gl_core.h>
 
@@ -45,6 +46,10 @@ public:
     void                lock();
     void                unlock();
 
+    // readers of resident nodes may share the cache, lock() excludes them
+    void                lock_shared();
+    void                unlock_shared();
+
     void                aquire_node(const context_t context_id, const view_t view_id, const model_t model_id, const node_t node_id);
     void                release_node(const context_t context_id, const view_t view_id, const model_t model_id, const node_t node_id);
     const bool          release_node_invalidate(const context_t context_id, const view_t view_id, const model_t model_id, const node_t node_id);
@@ -53,7 +58,7 @@ protected:
                         cache(const slot_t num_slots);
 
     cache_index*        index_;
-    std::mutex          mutex_;
+    std::shared_timed_mutex mutex_;
 
 private:
     /* data */
@@ -27,15 +27,38 @@ namespace ren {
 class RENDERING_DLL cache_index
 {
 public:
+
+    //counts slots that were reserved by the prefetcher. a prefetched slot is
+    //used once it is aquired and wasted if it is evicted before that
+    struct prefetch_statistics
+    {
+        prefetch_statistics()
+            : num_requested_(0),
+            num_loaded_(0),
+            num_used_(0),
+            num_wasted_(0),
+            num_outstanding_(0) {};
+
+        size_t          num_requested_;
+        size_t          num_loaded_;
+        size_t          num_used_;
+        size_t          num_wasted_;
+        size_t          num_outstanding_;
+    };
+
                         cache_index(const model_t num_models, const slot_t num_slots);
     virtual             ~cache_index();
 
     const slot_t        num_slots() const { return num_slots_; };
+    const model_t       num_models() const { return num_models_; };
 
     const slot_t        num_free_slots();
     const slot_t        reserve_slot();
+    //also reports the node that was evicted from the slot, invalid ids if the slot was empty
+    const slot_t        reserve_slot(model_t& evicted_model_id, node_t& evicted_node_id);
     void                apply_slot(const slot_t slot_id, const model_t model_id, const node_t node_id);
     void                unreserve_slot(const slot_t slot_id);
+    void                mark_prefetched(const slot_t slot_id);
 
     const slot_t        get_slot(const model_t model_id, const node_t node_id);
     const bool          is_node_indexed(const model_t model_id, const node_t node_id);
@@ -45,6 +68,9 @@ public:
     void                release_slot(const view_t view_id, const model_t model_id, const node_t node_id);
     const bool          release_slot_invalidate(const view_t view_id, const model_t model_id, const node_t node_id);
 
+    const prefetch_statistics get_prefetch_statistics();
+    void                reset_prefetch_statistics();
+
 private:
 
     model_t             num_models_;
@@ -62,25 +88,30 @@ private:
             : model_id_(model_id),
             node_id_(node_id),
             prev_(prev),
-            next_(next) {};
+            next_(next),
+            prefetched_(false) {};
 
         cache_index_node()
             : model_id_(invalid_model_t),
             node_id_(invalid_node_t),
             prev_(invalid_slot_t),
-            next_(invalid_slot_t) {};
+            next_(invalid_slot_t),
+            prefetched_(false) {};
 
         model_t         model_id_;
         node_t          node_id_;
         slot_t          prev_;
         slot_t          next_;
         std::set<view_t> views_;
+        bool            prefetched_;
     };
 
     std::mutex          mutex_;
 
     std::vector<cache_index_node> slots_;
     std::vector<std::map<node_t, slot_t>> maps_;
+
+    prefetch_statistics prefetch_statistics_;
 };
 
 
@@ -0,0 +1,74 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef REN_CAMERA_MOTION_PREDICTOR_H_
+#define REN_CAMERA_MOTION_PREDICTOR_H_
+
+#include <deque>
+#include <map>
+
+#include <scm/core/math.h>
+
+#include <lamure/types.h>
+#include <lamure/ren/config.h>
+#include <lamure/ren/platform.h>
+
+namespace lamure {
+namespace ren {
+
+// keeps a short history of view matrices per view, estimates linear and
+// angular velocity of the camera and extrapolates future view matrices.
+class RENDERING_DLL camera_motion_predictor
+{
+public:
+                        camera_motion_predictor();
+    virtual             ~camera_motion_predictor();
+
+    void                push_view_matrix(const view_t view_id, const scm::math::mat4f& view_matrix, const double time_in_ms);
+
+    //returns false if there is not enough history or the camera does not move
+    const bool          predict_view_matrix(const view_t view_id, const float horizon_in_ms, scm::math::mat4f& predicted_view_matrix) const;
+
+    void                reset();
+
+private:
+
+    struct sample
+    {
+        double          time_in_ms_;
+        //inverse of the view matrix, rotation in the upper 3x3, position in the last column
+        scm::math::mat4f camera_matrix_;
+    };
+
+    struct motion
+    {
+        motion()
+            : angular_speed_(0.f), valid_(false) {
+            velocity_[0] = velocity_[1] = velocity_[2] = 0.f;
+            angular_axis_[0] = angular_axis_[1] = angular_axis_[2] = 0.f;
+        };
+
+        //world space units per ms
+        float           velocity_[3];
+        //world space rotation axis and radians per ms
+        float           angular_axis_[3];
+        float           angular_speed_;
+        bool            valid_;
+    };
+
+    void                estimate_motion(const view_t view_id);
+
+    std::map<view_t, std::deque<sample>> history_;
+    std::map<view_t, motion> motions_;
+
+};
+
+
+} } // namespace lamure
+
+
+#endif // REN_CAMERA_MOTION_PREDICTOR_H_
@@ -39,14 +39,23 @@ namespace ren {
 
 //#define LAMURE_CUT_UPDATE_ENABLE_CUT_UPDATE_EXPERIMENTAL_MODE
 
+//default number of cut update worker threads, can be changed at runtime through
+//policy::set_num_cut_update_threads
 #define LAMURE_CUT_UPDATE_NUM_CUT_UPDATE_THREADS 4
 
+//cut fronts are split into chunks of at least this many nodes
+//which are analysed concurrently
+#define LAMURE_CUT_UPDATE_MIN_NODES_PER_ANALYSIS_CHUNK 4096
+
 //#define LAMURE_CUT_UPDATE_ENABLE_SHOW_OOC_CACHE_USAGE
 //#define LAMURE_CUT_UPDATE_ENABLE_SHOW_GPU_CACHE_USAGE
 
 //allow multiple cut updates per frame
 #define LAMURE_CUT_UPDATE_ENABLE_REPEAT_MODE
 #define LAMURE_CUT_UPDATE_MAX_NUM_UPDATES_PER_FRAME 8
+//wall-clock deadline for additional updates after a dispatch,
+//0 uses half of the interval between the last two dispatches
+#define LAMURE_CUT_UPDATE_DEFAULT_DEADLINE_IN_MS 0.f
 
 #define LAMURE_CUT_UPDATE_ENABLE_SPLIT_AGAIN_MODE
 
@@ -66,6 +75,16 @@ namespace ren {
 #define LAMURE_CUT_UPDATE_PREFETCH_FACTOR 5.f
 #define LAMURE_CUT_UPDATE_PREFETCH_BUDGET 1024
 
+//predictive prefetching, enabled at runtime through
+//policy::set_enable_predictive_prefetching. nodes are requested for the
+//frustums extrapolated at horizon/n, 2*horizon/n, ... horizon ms
+#define LAMURE_CUT_UPDATE_DEFAULT_PREFETCH_HORIZON_IN_MS 500.f
+#define LAMURE_CUT_UPDATE_PREFETCH_NUM_HORIZONS 2
+#define LAMURE_CUT_UPDATE_DEFAULT_PREFETCH_BUDGET 256
+#define LAMURE_CUT_UPDATE_PREDICTION_WINDOW_IN_MS 100.0
+#define LAMURE_CUT_UPDATE_PREDICTION_MAX_SAMPLE_GAP_IN_MS 250.0
+#define LAMURE_CUT_UPDATE_PREDICTION_MAX_ANGLE 1.57f
+
 #define LAMURE_MIN_UPLOAD_BUDGET 16
 #define LAMURE_MIN_VIDEO_MEMORY_BUDGET 128
 #define LAMURE_MIN_MAIN_MEMORY_BUDGET 512
@@ -74,6 +93,9 @@ namespace ren {
 #define LAMURE_DEFAULT_MAIN_MEMORY_BUDGET 4096
 #define LAMURE_DEFAULT_SIZE_OF_PROVENANCE 0
 
+//compressed second tier for nodes evicted from the ooc-cache, 0 disables it
+#define LAMURE_DEFAULT_VICTIM_CACHE_BUDGET 0
+
 //------------------------------
 //for ooc_cache:
 //------------------------------
@@ -50,6 +50,8 @@ class RENDERING_DLL controller
     void dispatch(const context_t context_id, scm::gl::render_device_ptr device, Data_Provenance const &data_provenance);
     const bool is_cut_update_in_progress(const context_t context_id);
     const bool is_cut_update_in_progress(const context_t context_id, Data_Provenance const &data_provenanc);
+    // per stage timings of the last cut update of the context, zero if no update was published yet
+    const cut_update_pool::stage_timings get_cut_update_stage_timings(const context_t context_id);
 
     scm::gl::buffer_ptr get_context_buffer(const context_t context_id, scm::gl::render_device_ptr device);
     scm::gl::buffer_ptr get_context_buffer(const context_t context_id, scm::gl::render_device_ptr device, Data_Provenance const &data_provenance);
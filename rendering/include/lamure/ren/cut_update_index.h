@@ -94,6 +94,7 @@ public:
     const size_t        num_actions(const queue_t queue);
 
     void                push_action(const action& action, bool sort);
+    void                push_actions(const std::vector<action>& actions, bool sort);
     const action        front_action(const queue_t queue);
     const action        back_action(const queue_t queue);
     void                pop_front_action(const queue_t queue);
@@ -10,9 +10,9 @@
 
 
 #include <lamure/ren/config.h>
-#include <lamure/semaphore.h>
 
 #include <lamure/utils.h>
+#include <chrono>
 #include <vector>
 
 #include <lamure/ren/cut_database.h>
@@ -21,10 +21,12 @@
 
 #include <lamure/memory_status.h>
 #include <lamure/ren/camera.h>
+#include <lamure/ren/camera_motion_predictor.h>
 #include <lamure/ren/cut.h>
 #include <lamure/ren/cut_update_index.h>
-#include <lamure/ren/cut_update_queue.h>
+#include <lamure/ren/cut_update_scheduler.h>
 #include <lamure/ren/gpu_cache.h>
+#include <lamure/ren/node_batch_evaluator.h>
 #include <lamure/ren/ooc_cache.h>
 
 namespace lamure
@@ -44,7 +46,39 @@ class cut_update_pool
     // void                    dispatch_cut_update(char* current_gpu_storage_A, char* current_gpu_storage_B);
     const bool is_running();
 
+    // wall-clock time per stage of the last published cut update, summed over all rounds
+    struct stage_timings
+    {
+        stage_timings()
+            : prepare_in_ms_(0.0), analysis_in_ms_(0.0), sort_in_ms_(0.0), update_in_ms_(0.0),
+              transfer_in_ms_(0.0), publish_in_ms_(0.0), total_in_ms_(0.0), num_rounds_(0) {};
+
+        double prepare_in_ms_;
+        double analysis_in_ms_;
+        double sort_in_ms_;
+        double update_in_ms_;
+        double transfer_in_ms_;
+        double publish_in_ms_;
+        double total_in_ms_;
+        uint32_t num_rounds_;
+    };
+
+    const stage_timings last_stage_timings();
+
+    // wall-clock time spent analysing the cut during the last dispatched update
+    const double analysis_time_in_ms();
+
   protected:
+    // contiguous range [begin_, end_) of the previous cut front of one (view, model)
+    // pair, aligned so that a group of siblings is never split across two chunks
+    struct analysis_chunk
+    {
+        view_t view_id_;
+        model_t model_id_;
+        size_t begin_;
+        size_t end_;
+    };
+
     void initialize(bool provenance = false);
     const bool prepare();
 
@@ -53,22 +87,28 @@ class cut_update_pool
     void cut_update_split_again(const cut_update_index::action &split_action);
 
     const bool is_all_nodes_in_cut(const model_t model_id, const std::vector<node_t> &node_ids, const std::set<node_t> &cut);
+    const bool is_all_nodes_in_cut(const model_t model_id, const std::vector<node_t> &node_ids, const std::vector<node_t> &sorted_cut);
     const bool is_node_in_frustum(const view_t view_id, const model_t model_id, const node_t node_id, const scm::gl::frustum &frustum);
     const bool is_no_node_in_frustum(const view_t view_id, const model_t model_id, const std::vector<node_t> &node_ids, const scm::gl::frustum &frustum);
 
     const float calculate_node_error(const view_t view_id, const model_t model_id, const node_t node_id);
 
-    /*virtual*/ void run();
     void shutdown();
 
     void cut_master();
-    void cut_analysis(view_t view_id, model_t model_id);
+    void begin_round();
+    void prepare_analysis_chunks();
+    void cut_analysis(const size_t chunk_id);
+    void cut_sort();
     void cut_update();
+    void cut_transfer();
+    void publish();
     void compile_transfer_list();
     void compile_render_list();
 #ifdef LAMURE_CUT_UPDATE_ENABLE_PREFETCHING
     void prefetch_routine();
 #endif
+    void predictive_prefetch();
 
   private:
     bool is_shutdown();
@@ -77,22 +117,34 @@ class cut_update_pool
     context_t context_id_;
 
     bool locked_;
-    semaphore semaphore_;
     std::mutex mutex_;
 
     uint32_t num_threads_;
-    std::vector<std::thread> threads_;
+    cut_update_scheduler *scheduler_;
 
     bool shutdown_;
 
-    cut_update_queue job_queue_;
-
     gpu_cache *gpu_cache_;
     cut_update_index *index_;
 
     std::vector<cut_database_record::slot_update_desc> transfer_list_;
     std::vector<std::vector<std::vector<cut::node_slot_aggregate>>> render_list_;
 
+    //[view][model] sorted copy of the previous cut, read-only during analysis
+    std::vector<std::vector<std::vector<node_t>>> analysis_fronts_;
+    std::vector<analysis_chunk> analysis_chunks_;
+
+    // interval between calls to dispatch_cut_update, guarded by mutex_
+    std::chrono::steady_clock::time_point last_dispatch_call_;
+    double frame_interval_in_ms_;
+
+    // written on dispatch, then only touched by the task chain of the running update
+    std::chrono::steady_clock::time_point dispatch_time_;
+    std::chrono::steady_clock::time_point deadline_;
+    std::chrono::steady_clock::time_point round_start_;
+    stage_timings current_timings_;
+    stage_timings last_timings_;
+
     char *current_gpu_storage_A_;
     char *current_gpu_storage_B_;
     char *current_gpu_storage_;
@@ -108,6 +160,11 @@ class cut_update_pool
     std::map<model_t, scm::math::mat4f> model_transforms_;
     std::map<model_t, float> model_thresholds_;
 
+    node_batch_evaluator evaluator_;
+
+    camera_motion_predictor motion_predictor_;
+    std::chrono::steady_clock::time_point start_time_;
+
     scm::math::mat4f previous_camera_view_;
 
     size_t upload_budget_in_nodes_;
@@ -123,13 +180,6 @@ class cut_update_pool
     std::vector<cut_update_index::action> pending_prefetch_set_;
 #endif
 
-#ifdef LAMURE_CUT_UPDATE_ENABLE_REPEAT_MODE
-    boost::timer::cpu_timer master_timer_;
-
-    boost::timer::nanosecond_type last_frame_elapsed_;
-#endif
-
-    semaphore master_semaphore_;
     bool master_dispatched_;
 };
 }
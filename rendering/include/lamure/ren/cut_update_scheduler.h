@@ -0,0 +1,81 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef REN_CUT_UPDATE_SCHEDULER_H_
+#define REN_CUT_UPDATE_SCHEDULER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <lamure/types.h>
+#include <lamure/ren/platform.h>
+
+namespace lamure {
+namespace ren {
+
+// runs a graph of dependent tasks on a fixed set of worker threads.
+// a task becomes ready once all of its dependencies have finished, each
+// ready task wakes exactly one idle worker. tasks may add further tasks
+// while they run, which is how the cut update expands its own graph.
+class RENDERING_DLL cut_update_scheduler
+{
+public:
+
+    typedef size_t      task_id;
+    typedef std::function<void()> task_function;
+
+                        cut_update_scheduler(const uint32_t num_threads);
+                        cut_update_scheduler(const cut_update_scheduler&) = delete;
+                        cut_update_scheduler& operator=(const cut_update_scheduler&) = delete;
+    virtual             ~cut_update_scheduler();
+
+    const uint32_t      num_threads() const { return num_threads_; };
+
+    //dependencies must be ids of the current graph, finished dependencies
+    //are satisfied immediately. ids are recycled once no task is left
+    const task_id       add_task(const task_function& function, const std::vector<task_id>& dependencies = std::vector<task_id>());
+
+    const bool          is_idle();
+
+    //workers finish the task they are running, pending tasks are dropped
+    void                shutdown();
+
+protected:
+    void                run();
+
+private:
+
+    struct task
+    {
+        task_function   function_;
+        size_t          num_pending_dependencies_;
+        bool            finished_;
+        std::vector<task_id> successors_;
+    };
+
+    std::mutex          mutex_;
+    std::condition_variable ready_signal_;
+
+    uint32_t            num_threads_;
+    std::vector<std::thread> threads_;
+    bool                shutdown_;
+
+    std::deque<task>    tasks_;
+    std::deque<task_id> ready_;
+    size_t              num_unfinished_;
+
+};
+
+
+} } // namespace lamure
+
+
+#endif // REN_CUT_UPDATE_SCHEDULER_H_
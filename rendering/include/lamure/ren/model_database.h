@@ -9,7 +9,13 @@
 #define REN_MODEL_DATABASE_H_
 
 #include <unordered_map>
+#include <atomic>
 #include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <lamure/utils.h>
 #include <lamure/types.h>
@@ -33,6 +39,14 @@ public:
     static model_database* get_instance();
 
     const model_t       add_model(const std::string& filepath, const std::string& model_key);
+    //returns the model id right away, the .bvh is loaded by a background thread.
+    //apply() publishes a model once it and every model with a smaller id are loaded,
+    //until then it is not counted by num_models()
+    const model_t       add_model_async(const std::string& filepath, const std::string& model_key);
+    //blocks until all asynchronous loads finished, throws if one of them failed
+    void                wait_for_models();
+    const bool          is_model_ready(const model_t model_id) const { return model_id < num_datasets_; };
+
     dataset*            get_model(const model_t model_id);
     void                apply();
 
@@ -54,14 +68,41 @@ protected:
     static model_database* single_;
 
 private:
+    struct load_job
+    {
+        model_t         model_id_;
+        std::string     filepath_;
+    };
+
+    //publishes the loaded models with contiguous ids, the caller holds mutex_
+    void                publish_models();
+    void                run_loader();
+    //nullptr unless the model is published
+    dataset*            find_model(const model_t model_id) const;
+
     static std::mutex   mutex_;
 
-    std::unordered_map<model_t, dataset*> datasets_;
+    static const size_t model_block_size_ = 256;
+    static const size_t max_model_blocks_ = 1024;
 
-    model_t             num_datasets_;
-    model_t             num_datasets_pending_;
+    //published models, read without locking by the render, cut update and ooc threads.
+    //blocks are never moved or freed, a model is written before num_datasets_ counts it
+    dataset**           model_blocks_[max_model_blocks_];
+
+    std::atomic<model_t> num_datasets_;
     size_t              primitives_per_node_;
-    size_t              primitives_per_node_pending_;
+
+    //asynchronous loading, guarded by load_mutex_
+    std::mutex          load_mutex_;
+    std::condition_variable load_signal_;
+    std::condition_variable load_finished_;
+    std::vector<std::thread> loader_threads_;
+    std::deque<load_job> load_jobs_;
+    //loaded models waiting for publication
+    std::unordered_map<model_t, dataset*> loaded_datasets_;
+    std::vector<std::string> load_errors_;
+    size_t              num_loads_in_flight_;
+    bool                shutdown_loaders_;
 
 
 };
@@ -0,0 +1,100 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef REN_NODE_BATCH_EVALUATOR_H_
+#define REN_NODE_BATCH_EVALUATOR_H_
+
+#include <vector>
+#include <mutex>
+
+#include <lamure/types.h>
+#include <lamure/ren/platform.h>
+#include <lamure/ren/bvh.h>
+#include <lamure/ren/camera.h>
+
+namespace lamure {
+namespace ren {
+
+// evaluates view-space depth, projected error and frustum classification
+// for contiguous arrays of node ids, 8 (AVX2) or 4 (SSE) nodes at a time.
+// node attributes are read from column (SoA) copies of the bvh data,
+// matrices and frustum planes are precomputed once per (view, model).
+class RENDERING_DLL node_batch_evaluator
+{
+public:
+
+    // same ordering as scm::gl::frustum::classification_result
+    enum classification_result
+    {
+        INSIDE = 0,
+        OUTSIDE = 1,
+        INTERSECTING = 2
+    };
+
+    struct bvh_columns
+    {
+        std::vector<float> centroid_x_;
+        std::vector<float> centroid_y_;
+        std::vector<float> centroid_z_;
+        std::vector<float> avg_primitive_extent_;
+        std::vector<float> min_x_;
+        std::vector<float> min_y_;
+        std::vector<float> min_z_;
+        std::vector<float> max_x_;
+        std::vector<float> max_y_;
+        std::vector<float> max_z_;
+    };
+
+    struct view_model_constants
+    {
+        //third row of view * model, yields view space depth
+        float           depth_row_[4];
+        //2 * radius_scaling * near_plane * height_divided_by_top_minus_bottom
+        float           error_scale_;
+        //inward facing planes of proj * view * model (a, b, c, d)
+        float           planes_[6][4];
+        bool            valid_;
+    };
+
+                        node_batch_evaluator();
+    virtual             ~node_batch_evaluator();
+
+    static const uint32_t batch_width();
+
+    //builds the column copy of a model's bvh once, bvhs are immutable after loading
+    void                update_model(const model_t model_id, const bvh* bvh);
+    void                update_view_model(const view_t view_id, const model_t model_id,
+                                          const camera& camera,
+                                          const scm::math::mat4f& model_matrix,
+                                          const float height_divided_by_top_minus_bottom);
+
+    //node ids must be valid, output arrays must hold num_nodes entries.
+    //any of the output pointers may be nullptr
+    void                evaluate(const view_t view_id, const model_t model_id,
+                                 const node_t* node_ids, const size_t num_nodes,
+                                 float* view_depths, float* errors, uint8_t* classifications) const;
+
+private:
+
+    void                evaluate_scalar(const bvh_columns& columns, const view_model_constants& constants,
+                                        const node_t* node_ids, const size_t num_nodes,
+                                        float* view_depths, float* errors, uint8_t* classifications) const;
+
+    std::mutex          mutex_;
+
+    //[model]
+    std::vector<bvh_columns> columns_;
+    //[view][model]
+    std::vector<std::vector<view_model_constants>> constants_;
+
+};
+
+
+} } // namespace lamure
+
+
+#endif // REN_NODE_BATCH_EVALUATOR_H_
@@ -11,6 +11,7 @@
 #include <lamure/ren/cache.h>
 #include <lamure/ren/config.h>
 #include <lamure/ren/ooc_pool.h>
+#include <lamure/ren/victim_cache.h>
 #include <lamure/utils.h>
 #include <map>
 #include <queue>
@@ -27,18 +28,38 @@ namespace ren
 class RENDERING_DLL ooc_cache : public cache
 {
   public:
+    // hit rates of the uncompressed ooc_cache, the compressed victim cache and the disk
+    struct tier_statistics
+    {
+        tier_statistics() : num_lookups_(0), num_lookup_hits_(0){};
+
+        // residency checks of children during splits
+        size_t num_lookups_;
+        size_t num_lookup_hits_;
+        ooc_pool::load_statistics loads_;
+        victim_cache::statistics victim_cache_;
+    };
+
     ooc_cache(const ooc_cache &) = delete;
     ooc_cache &operator=(const ooc_cache &) = delete;
     virtual ~ooc_cache();
 
     static ooc_cache *get_instance(Data_Provenance const &data_provenance);
     static ooc_cache *get_instance();
+    // destroys the instance if models were published that do not fit its index or
+    // its slots, the next get_instance() creates a cache for the current models
+    static void reset_if_outdated();
 
     void register_node(const model_t model_id, const node_t node_id, const int32_t priority);
+    // requests a node that is expected to be needed soon, never touches nodes that are
+    // already requested. returns true if a load was enqueued
+    const bool prefetch_node(const model_t model_id, const node_t node_id, const int32_t priority);
     char *node_data(const model_t model_id, const node_t node_id);
     char *node_data_provenance(const model_t model_id, const node_t node_id);
 
     const bool is_node_resident_and_aquired(const model_t model_id, const node_t node_id);
+    // same as is_node_resident, counted in the tier statistics
+    const bool lookup_node(const model_t model_id, const node_t node_id);
 
     void refresh();
 
@@ -48,6 +69,12 @@ class RENDERING_DLL ooc_cache : public cache
     void begin_measure();
     void end_measure();
 
+    const cache_index::prefetch_statistics get_prefetch_statistics();
+    void reset_prefetch_statistics();
+
+    const tier_statistics get_tier_statistics();
+    void reset_tier_statistics();
+
   protected:
     ooc_cache(const size_t num_slots);
     ooc_cache(const size_t num_slots, Data_Provenance const &data_provenance);
@@ -57,10 +84,17 @@ class RENDERING_DLL ooc_cache : public cache
   private:
     static std::mutex mutex_;
 
+    const slot_t reserve_slot();
+
     char *cache_data_;
     char *cache_data_provenance_;
     uint32_t maintenance_counter_;
     ooc_pool *pool_;
+    victim_cache *victim_cache_;
+
+    std::mutex statistics_mutex_;
+    size_t num_lookups_;
+    size_t num_lookup_hits_;
 };
 }
 } // namespace lamure
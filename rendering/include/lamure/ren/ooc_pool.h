@@ -31,6 +31,7 @@
 #include <lamure/ren/lod_stream.h>
 #include <lamure/ren/cache_queue.h>
 #include <lamure/ren/cache_index.h>
+#include <lamure/ren/victim_cache.h>
 
 namespace lamure {
 namespace ren {
@@ -38,8 +39,20 @@ namespace ren {
 class ooc_pool
 {
   public:
-    ooc_pool(const uint32_t num_loader_threads, const size_t size_of_slot_in_bytes);
-    ooc_pool(const uint32_t num_loader_threads, const size_t size_of_slot_in_bytes, const size_t size_of_slot_provenance_, Data_Provenance const &data_provenance);
+    struct load_statistics
+    {
+        load_statistics() : num_disk_loads_(0), num_victim_cache_loads_(0), bytes_read_from_disk_(0), bytes_read_from_victim_cache_(0){};
+
+        size_t num_disk_loads_;
+        size_t num_victim_cache_loads_;
+        size_t bytes_read_from_disk_;
+        size_t bytes_read_from_victim_cache_;
+    };
+
+    // the optional victim cache is asked before reading from disk, it is not owned by the pool
+    ooc_pool(const uint32_t num_loader_threads, const size_t size_of_slot_in_bytes, victim_cache *victim_cache = nullptr);
+    ooc_pool(const uint32_t num_loader_threads, const size_t size_of_slot_in_bytes, const size_t size_of_slot_provenance_, Data_Provenance const &data_provenance,
+             victim_cache *victim_cache = nullptr);
     /*virtual*/ ~ooc_pool();
 
     const uint32_t num_threads() const { return num_threads_; };
@@ -58,6 +71,9 @@ class ooc_pool
     void begin_measure();
     void end_measure();
 
+    const load_statistics get_load_statistics();
+    void reset_load_statistics();
+
   protected:
     void run();
     bool is_shutdown();
@@ -76,6 +92,9 @@ class ooc_pool
 
     size_t bytes_loaded_;
 
+    victim_cache *victim_cache_;
+    load_statistics load_statistics_;
+
     std::vector<cache_queue::job> history_;
 
     cache_queue priority_queue_;
@@ -0,0 +1,98 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef REN_OOC_RAY_QUERY_H_
+#define REN_OOC_RAY_QUERY_H_
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <lamure/ren/bvh.h>
+#include <lamure/ren/dataset.h>
+#include <lamure/ren/lod_stream.h>
+#include <lamure/ren/platform.h>
+#include <lamure/ren/ray.h>
+#include <lamure/types.h>
+
+#include <scm/core/math.h>
+
+namespace lamure
+{
+namespace ren
+{
+// exact splat-based picking of a single model that does not depend on the current cut.
+// the bvh is traversed down to the requested depth and nodes are read directly from
+// the .lod file into a small private cache, the ooc-cache is never modified.
+// the closest surfel whose disc contains the intersection with its plane is returned
+class RENDERING_DLL ooc_ray_query
+{
+  public:
+    struct statistics
+    {
+        statistics() : num_queries_(0), num_nodes_tested_(0), num_nodes_read_(0), num_nodes_from_ooc_cache_(0), bytes_read_(0){};
+
+        size_t num_queries_;
+        size_t num_nodes_tested_;
+        size_t num_nodes_read_;
+        size_t num_nodes_from_ooc_cache_;
+        size_t bytes_read_;
+    };
+
+    // headless, loads the .bvh and reads the .lod next to it
+    ooc_ray_query(const std::string &bvh_filename);
+    // uses the bvh of a model of the model_database, resident nodes are copied from the ooc-cache
+    ooc_ray_query(const model_t model_id);
+    ooc_ray_query(const ooc_ray_query &) = delete;
+    ooc_ray_query &operator=(const ooc_ray_query &) = delete;
+    ~ooc_ray_query();
+
+    // max_depth 0 traverses down to the leaves
+    const bool intersect(const ray &r, const scm::math::mat4f &model_transform, const uint32_t max_depth, ray::intersection &intersection);
+    const size_t intersect(const std::vector<ray> &rays, const scm::math::mat4f &model_transform, const uint32_t max_depth, std::vector<ray::intersection> &intersections);
+
+    const bvh *get_bvh() const { return bvh_; };
+
+    // number of nodes kept in memory between queries
+    void set_node_budget(const size_t num_nodes);
+    const size_t node_budget() const { return node_budget_; };
+
+    const statistics &get_statistics() const { return statistics_; };
+    void reset_statistics() { statistics_ = statistics(); };
+
+  private:
+    struct candidate
+    {
+        node_t node_id_;
+        float t_min_;
+    };
+
+    void open_lod_file();
+    const dataset::serialized_surfel *get_node_data(const node_t node_id);
+    void collect_candidates(const scm::math::vec3f &origin, const scm::math::vec3f &direction, const float max_distance, const uint32_t target_depth,
+                            std::vector<candidate> &candidates);
+    static const bool intersect_aabb(const scm::gl::boxf &bb, const scm::math::vec3f &origin, const scm::math::vec3f &direction, float &t_min);
+
+    const bvh *bvh_;
+    bool owns_bvh_;
+    model_t model_id_;
+
+    lod_stream lod_stream_;
+    size_t node_size_;
+
+    // private node cache, most recently used at the front
+    size_t node_budget_;
+    std::list<node_t> lru_nodes_;
+    std::unordered_map<node_t, std::pair<std::vector<char>, std::list<node_t>::iterator>> node_data_;
+
+    statistics statistics_;
+};
+}
+}
+
+#endif
@@ -32,13 +32,27 @@ public:
     void                set_max_upload_budget_in_mb(const size_t max_upload_budget) { max_upload_budget_in_mb_ = max_upload_budget; };
     void                set_render_budget_in_mb(const size_t render_budget) { render_budget_in_mb_ = render_budget; };
     void                set_out_of_core_budget_in_mb(const size_t out_of_core_budget) { out_of_core_budget_in_mb_ = out_of_core_budget; };
+    void                set_victim_cache_budget_in_mb(const size_t victim_cache_budget) { victim_cache_budget_in_mb_ = victim_cache_budget; };
     void                set_size_of_provenance(const size_t size_of_provenance) { size_of_provenance_ = size_of_provenance; };
+    void                set_num_cut_update_threads(const uint32_t num_cut_update_threads) { num_cut_update_threads_ = num_cut_update_threads; };
+    void                set_min_nodes_per_cut_analysis_chunk(const size_t min_nodes) { min_nodes_per_cut_analysis_chunk_ = min_nodes; };
+    void                set_cut_update_deadline_in_ms(const float deadline) { cut_update_deadline_in_ms_ = deadline; };
+    void                set_enable_predictive_prefetching(const bool enable) { enable_predictive_prefetching_ = enable; };
+    void                set_prefetch_budget_in_mb(const size_t prefetch_budget) { prefetch_budget_in_mb_ = prefetch_budget; };
+    void                set_prefetch_horizon_in_ms(const float prefetch_horizon) { prefetch_horizon_in_ms_ = prefetch_horizon; };
 
     const bool          reset_system() const { return reset_system_; };
     const size_t        max_upload_budget_in_mb() const { return max_upload_budget_in_mb_; };
     const size_t        render_budget_in_mb() const { return render_budget_in_mb_; };
     const size_t        out_of_core_budget_in_mb() const { return out_of_core_budget_in_mb_; };
+    const size_t        victim_cache_budget_in_mb() const { return victim_cache_budget_in_mb_; };
     const size_t        size_of_provenance() const { return size_of_provenance_; };
+    const uint32_t      num_cut_update_threads() const { return num_cut_update_threads_; };
+    const size_t        min_nodes_per_cut_analysis_chunk() const { return min_nodes_per_cut_analysis_chunk_; };
+    const float         cut_update_deadline_in_ms() const { return cut_update_deadline_in_ms_; };
+    const bool          enable_predictive_prefetching() const { return enable_predictive_prefetching_; };
+    const size_t        prefetch_budget_in_mb() const { return prefetch_budget_in_mb_; };
+    const float         prefetch_horizon_in_ms() const { return prefetch_horizon_in_ms_; };
 
     const int32_t       window_width() const { return window_width_; };
     const int32_t       window_height() const { return window_height_; };
@@ -61,9 +75,18 @@ private:
     size_t              max_upload_budget_in_mb_;
     size_t              render_budget_in_mb_;
     size_t              out_of_core_budget_in_mb_;
+    size_t              victim_cache_budget_in_mb_;
 
     size_t              size_of_provenance_;
 
+    uint32_t            num_cut_update_threads_;
+    size_t              min_nodes_per_cut_analysis_chunk_;
+    float               cut_update_deadline_in_ms_;
+
+    bool                enable_predictive_prefetching_;
+    size_t              prefetch_budget_in_mb_;
+    float               prefetch_horizon_in_ms_;
+
     int32_t             window_width_;
     int32_t             window_height_;
 
@@ -102,6 +102,9 @@ class RENDERING_DLL ray
     const bool intersect_model_bvh(const model_t model_id, const scm::math::mat4f &model_transform, const float aabb_scale, intersection_bvh &intersection);
 
   protected:
+    friend class ray_query_service;
+    friend class ooc_ray_query;
+
     const bool intersect_model_unsafe(const model_t model_id, const scm::math::mat4f &model_transform, const float aabb_scale, const unsigned int max_depth, const unsigned int surfel_skip,
                                       const bool is_wysiwyg, intersection &intersection);
     static const bool intersect_aabb(const scm::gl::boxf &bb, const scm::math::vec3f &ray_origin, const scm::math::vec3f &ray_direction, scm::math::vec2f &t);
@@ -0,0 +1,115 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef REN_RAY_QUERY_SERVICE_H_
+#define REN_RAY_QUERY_SERVICE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <lamure/ren/platform.h>
+#include <lamure/ren/ray.h>
+#include <lamure/types.h>
+
+#include <scm/core/math.h>
+
+namespace lamure
+{
+namespace ren
+{
+// splat-based picking of many rays at once. the worker threads persist between
+// batches, rays are traced in packets that share the traversal of the node
+// bounding boxes and only nodes resident in the ooc-cache are read, under a
+// shared lock of the cache
+class RENDERING_DLL ray_query_service
+{
+  public:
+    struct query_parameters
+    {
+        float aabb_scale_;
+        unsigned int max_depth_;
+        unsigned int surfel_skip_;
+        bool is_wysiwyg_;
+
+        query_parameters() : aabb_scale_(1.f), max_depth_(0), surfel_skip_(1), is_wysiwyg_(false) {}
+    };
+
+    // rays of one packet share the traversal of a model
+    static const uint32_t packet_size = 8;
+    // nodes that would not fit on the traversal stack anymore are intersected directly
+    static const uint32_t max_stack_size = 512;
+
+    ray_query_service(const uint32_t num_threads);
+    ray_query_service(const ray_query_service &) = delete;
+    ray_query_service &operator=(const ray_query_service &) = delete;
+    ~ray_query_service();
+
+    static ray_query_service *get_instance();
+
+    // intersects every ray with all models, intersections[i] belongs to rays[i].
+    // rays without hit keep an error_ of std::numeric_limits<float>::max(),
+    // returns the number of rays that hit
+    const size_t intersect(const std::vector<ray> &rays, const query_parameters &parameters, std::vector<ray::intersection> &intersections);
+
+    const uint32_t num_threads() const { return num_threads_; };
+
+  private:
+    struct packet_ray
+    {
+        scm::math::vec3f origin_;
+        scm::math::vec3f direction_;
+        scm::math::vec3f inv_direction_;
+        float max_distance_;
+        float object_to_world_scale_;
+    };
+
+    struct stack_entry
+    {
+        node_t node_id_;
+        uint32_t ray_mask_;
+    };
+
+    void run();
+    const size_t process_packets();
+    void intersect_packet(const size_t packet_id);
+    void intersect_packet_model(const model_t model_id, const ray *rays, const uint32_t num_rays, ray::intersection *intersections) const;
+
+    static const uint32_t intersect_aabb_packet(const scm::gl::boxf &bb, const packet_ray *rays, const uint32_t ray_mask, const bool check_distance);
+    const uint32_t intersect_splats(const model_t model_id, const node_t node_id, const scm::math::mat4f &model_transform, const scm::math::mat4f &normal_transform, const ray *rays,
+                                    const packet_ray *object_rays, const uint32_t ray_mask, ray::intersection *intersections) const;
+
+    static std::mutex instance_mutex_;
+    static ray_query_service *single_;
+
+    uint32_t num_threads_;
+    std::vector<std::thread> threads_;
+
+    // guards the hand-over of batches to the workers
+    std::mutex mutex_;
+    std::condition_variable work_signal_;
+    std::condition_variable done_signal_;
+    bool shutdown_;
+    bool batch_active_;
+    uint64_t batch_counter_;
+    uint32_t num_active_workers_;
+    size_t num_finished_packets_;
+
+    // one batch at a time, callers from several threads queue up here
+    std::mutex batch_mutex_;
+    const std::vector<ray> *rays_;
+    std::vector<ray::intersection> *intersections_;
+    query_parameters parameters_;
+    size_t num_packets_;
+    std::atomic<size_t> next_packet_;
+};
+}
+}
+
+#endif
@@ -0,0 +1,173 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef REN_SPATIAL_QUERY_H_
+#define REN_SPATIAL_QUERY_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <lamure/ren/bvh.h>
+#include <lamure/ren/dataset.h>
+#include <lamure/ren/lod_stream.h>
+#include <lamure/ren/platform.h>
+#include <lamure/types.h>
+
+#include <scm/core/math.h>
+#include <scm/gl_core/primitives/box.h>
+#include <scm/gl_core/primitives/frustum.h>
+
+namespace lamure
+{
+namespace ren
+{
+// box, sphere, frustum and k-nearest-neighbour queries against a .bvh/.lod pair.
+// the cut is chosen by an error bound: a node is used as soon as its average
+// surfel extent is at most max_error, a max_error of 0 uses the leaves.
+// selected nodes are read with positional reads and filtered by the worker
+// threads in parallel, surfels are tested by their center only
+class RENDERING_DLL spatial_query
+{
+  public:
+    struct statistics
+    {
+        statistics() : num_queries_(0), num_nodes_tested_(0), num_nodes_read_(0), bytes_read_(0), num_surfels_returned_(0){};
+
+        size_t num_queries_;
+        size_t num_nodes_tested_;
+        size_t num_nodes_read_;
+        size_t bytes_read_;
+        size_t num_surfels_returned_;
+    };
+
+    // num_threads 0 uses one thread per core
+    spatial_query(const std::string &bvh_filename, const uint32_t num_threads = 0);
+    spatial_query(const spatial_query &) = delete;
+    spatial_query &operator=(const spatial_query &) = delete;
+    ~spatial_query();
+
+    // all queries are in object space of the model, replace the content of
+    // surfels and return the number of surfels found
+    const size_t query_box(const scm::gl::boxf &box, const float max_error, std::vector<dataset::serialized_surfel> &surfels);
+    const size_t query_sphere(const scm::math::vec3f &center, const float radius, const float max_error, std::vector<dataset::serialized_surfel> &surfels);
+    // view_projection maps object space to clip space
+    const size_t query_frustum(const scm::math::mat4f &view_projection, const float max_error, std::vector<dataset::serialized_surfel> &surfels);
+    // surfels are sorted by increasing distance to point
+    const size_t query_nearest(const scm::math::vec3f &point, const uint32_t k, const float max_error, std::vector<dataset::serialized_surfel> &surfels);
+
+    const bvh *get_bvh() const { return bvh_; };
+    const uint32_t num_threads() const { return num_threads_; };
+
+    const statistics &get_statistics() const { return statistics_; };
+    void reset_statistics() { statistics_ = statistics(); };
+
+  private:
+    enum query_type
+    {
+        QUERY_BOX,
+        QUERY_SPHERE,
+        QUERY_FRUSTUM,
+        QUERY_NEAREST
+    };
+
+    struct query
+    {
+        query_type type_;
+        scm::gl::boxf box_;
+        scm::math::vec3f center_;
+        float radius_sq_;
+        scm::math::mat4f view_projection_;
+        scm::gl::frustum frustum_;
+        uint32_t k_;
+    };
+
+    struct selected_node
+    {
+        node_t node_id_;
+        // every surfel of a contained node passes the query
+        bool contained_;
+        float distance_sq_;
+    };
+
+    struct ranked_surfel
+    {
+        float distance_sq_;
+        dataset::serialized_surfel surfel_;
+
+        bool operator<(const ranked_surfel &other) const { return distance_sq_ < other.distance_sq_; }
+    };
+
+    struct worker_data
+    {
+        worker_data() : num_nodes_read_(0){};
+
+        std::vector<char> node_buffer_;
+        // bounded max-heap of the closest surfels of a nearest query
+        std::vector<ranked_surfel> nearest_;
+        size_t num_nodes_read_;
+    };
+
+    const size_t query_range(std::vector<dataset::serialized_surfel> &surfels);
+    void select_nodes(const float max_error);
+    const bool is_cut_node(const node_t node_id, const float max_error) const;
+    // returns false if the box can not contain a surfel of the query
+    const bool classify_box(const scm::gl::boxf &box, bool &contained, float &distance_sq) const;
+    const bool test_surfel(const dataset::serialized_surfel &surfel, float &distance_sq) const;
+
+    void execute(const size_t num_nodes);
+    void run(const uint32_t worker_id);
+    const size_t process_nodes(const uint32_t worker_id);
+    void process_node(const uint32_t worker_id, const size_t node_index);
+    void read_node(const node_t node_id, char *data) const;
+
+    bvh *bvh_;
+    size_t node_size_;
+    uint32_t num_surfels_per_node_;
+
+#if WIN32
+    mutable std::mutex stream_mutex_;
+    lod_stream lod_stream_;
+#else
+    int lod_file_descriptor_;
+#endif
+
+    uint32_t num_threads_;
+    std::vector<std::thread> threads_;
+    std::vector<worker_data> worker_data_;
+
+    // guards the hand-over of node lists to the workers
+    std::mutex mutex_;
+    std::condition_variable work_signal_;
+    std::condition_variable done_signal_;
+    bool shutdown_;
+    bool batch_active_;
+    uint64_t batch_counter_;
+    uint32_t num_active_workers_;
+    size_t num_finished_nodes_;
+    // first exception thrown by a worker during the current batch
+    std::exception_ptr error_;
+
+    // one query at a time
+    std::mutex query_mutex_;
+    query query_;
+    std::vector<selected_node> selected_nodes_;
+    std::vector<std::vector<dataset::serialized_surfel>> node_results_;
+    size_t num_nodes_;
+    float nearest_bound_sq_;
+    std::atomic<size_t> next_node_;
+
+    statistics statistics_;
+};
+}
+}
+
+#endif
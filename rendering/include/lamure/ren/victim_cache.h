@@ -0,0 +1,113 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef REN_VICTIM_CACHE_H_
+#define REN_VICTIM_CACHE_H_
+
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <lamure/types.h>
+#include <lamure/ren/config.h>
+#include <lamure/ren/platform.h>
+
+namespace lamure {
+namespace ren {
+
+// second cache tier between the ooc_cache and the disk. nodes evicted from
+// the ooc_cache are copied in, compressed by a background thread and kept
+// in lru order within a separate budget. a fetch removes the node again,
+// since it moves back into the ooc_cache.
+class RENDERING_DLL victim_cache
+{
+public:
+
+    struct statistics
+    {
+        statistics()
+            : num_inserted_(0),
+            num_hits_(0),
+            num_misses_(0),
+            num_evicted_(0),
+            num_entries_(0),
+            uncompressed_bytes_(0),
+            stored_bytes_(0) {};
+
+        size_t          num_inserted_;
+        size_t          num_hits_;
+        size_t          num_misses_;
+        size_t          num_evicted_;
+        size_t          num_entries_;
+        //size of the node data currently held, before and after compression
+        size_t          uncompressed_bytes_;
+        size_t          stored_bytes_;
+    };
+
+                        victim_cache(const size_t budget_in_bytes);
+                        victim_cache(const victim_cache&) = delete;
+                        victim_cache& operator=(const victim_cache&) = delete;
+    virtual             ~victim_cache();
+
+    const size_t        budget_in_bytes() const { return budget_in_bytes_; };
+
+    void                insert(const model_t model_id, const node_t node_id, const char* data, const size_t size_in_bytes);
+    //copies the node data to data and removes the node, returns false if the node is not cached
+    const bool          fetch(const model_t model_id, const node_t node_id, char* data, const size_t size_in_bytes);
+
+    const statistics    get_statistics();
+    void                reset_statistics();
+
+    //byte shuffle followed by deflate at the fastest level
+    static const bool   compress(const char* data, const size_t size_in_bytes, std::vector<char>& compressed);
+    static const bool   decompress(const std::vector<char>& compressed, char* data, const size_t size_in_bytes);
+
+protected:
+    void                run();
+
+private:
+
+    struct entry
+    {
+        std::vector<char> data_;
+        size_t          size_in_bytes_;
+        bool            compressed_;
+        uint64_t        generation_;
+        std::list<uint64_t>::iterator lru_it_;
+    };
+
+    static const uint64_t key(const model_t model_id, const node_t node_id) { return (((uint64_t)model_id) << 32) | (uint64_t)node_id; };
+
+    void                evict_to_budget();
+
+    std::mutex          mutex_;
+    std::condition_variable signal_;
+    std::thread         thread_;
+    bool                shutdown_;
+
+    size_t              budget_in_bytes_;
+    size_t              used_bytes_;
+    uint64_t            generation_;
+
+    //least recently inserted first
+    std::list<uint64_t> lru_;
+    std::unordered_map<uint64_t, entry> entries_;
+    std::deque<std::pair<uint64_t, uint64_t>> pending_;
+
+    statistics          statistics_;
+
+};
+
+
+} } // namespace lamure
+
+
+#endif // REN_VICTIM_CACHE_H_
@@ -107,12 +107,17 @@ load_bvh_file(const std::string& filename) {
 
 
 void bvh::
-write_bvh_file(const std::string& filename) {
+write_bvh_file(const std::string& filename, const uint32_t version) {
     
     filename_ = filename;
 
     bvh_stream bvh_stream;
-    bvh_stream.write_bvh(filename, *this);
+    if (version >= 2) {
+        bvh_stream.write_bvh_columns(filename, *this);
+    }
+    else {
+        bvh_stream.write_bvh(filename, *this);
+    }
 
 }
 
@@ -10,6 +10,20 @@
 namespace lamure {
 namespace ren {
 
+//columns are read straight into the vectors of the bvh
+static_assert(sizeof(scm::gl::boxf) == 6*sizeof(float), "bvh_stream: unexpected box layout");
+static_assert(sizeof(scm::math::vec3f) == 3*sizeof(float), "bvh_stream: unexpected vector layout");
+
+namespace {
+
+const uint64_t column_alignment = 64;
+
+uint64_t align_column_offset(const uint64_t offset) {
+    return (offset + column_alignment - 1) / column_alignment * column_alignment;
+}
+
+}
+
 bvh_stream::
 bvh_stream()
 : filename_(""),
@@ -144,6 +158,7 @@ read_bvh(const std::string& filename, bvh& bvh) {
     uint32_t tree_ext_id = 0;
     uint32_t node_id = 0;
     uint32_t node_ext_id = 0;
+    uint32_t columns_id = 0;
 
 
     //go through entire stream and fetch the segments
@@ -219,6 +234,14 @@ read_bvh(const std::string& filename, bvh& bvh) {
                 }
                 break;
             }
+            case 'C': { //"BVHXCOLS"
+                bvh_column_seg columns;
+                columns.deserialize(file_);
+                read_columns(columns, bvh);
+                node_id = columns.num_nodes_;
+                ++columns_id;
+                break;
+            }
             default: {
                 throw std::runtime_error(
                     "lamure: bvh_stream::file corrupt -- Invalid segment encountered");
@@ -247,6 +270,11 @@ read_bvh(const std::string& filename, bvh& bvh) {
            "lamure: bvh_stream::Stream corrupt -- Invalid number of bvh extensions");
     }    
 
+    if (columns_id > 1 || (columns_id == 1 && !nodes.empty())) {
+       throw std::runtime_error(
+           "lamure: bvh_stream::Stream corrupt -- Invalid number of column segments");
+    }
+
     //Note: this is the rendering library version of the file reader!
 
     bvh.set_depth(tree.depth_);
@@ -285,6 +313,71 @@ read_bvh(const std::string& filename, bvh& bvh) {
 
 }
 
+void bvh_stream::
+read_columns(const bvh_stream::bvh_column_seg& columns, bvh& bvh) {
+
+    const size_t num_nodes = columns.num_nodes_;
+
+    bvh.bounding_boxes_.resize(num_nodes);
+    bvh.centroids_.resize(num_nodes);
+    bvh.avg_primitive_extent_.resize(num_nodes);
+    bvh.max_primitive_extent_deviation_.assign(num_nodes, 0.f);
+    bvh.visibility_.assign(num_nodes, bvh::node_visibility::NODE_VISIBLE);
+
+    std::vector<uint8_t> visibility;
+
+    for (const auto& column : columns.columns_) {
+        char* destination = nullptr;
+        size_t element_size = 0;
+
+        switch (column.type_) {
+            case BVH_COLUMN_BOUNDING_BOXES:
+                destination = (char*)bvh.bounding_boxes_.data();
+                element_size = sizeof(scm::gl::boxf);
+                break;
+            case BVH_COLUMN_CENTROIDS:
+                destination = (char*)bvh.centroids_.data();
+                element_size = sizeof(scm::math::vec3f);
+                break;
+            case BVH_COLUMN_AVG_SURFEL_RADII:
+                destination = (char*)bvh.avg_primitive_extent_.data();
+                element_size = sizeof(float);
+                break;
+            case BVH_COLUMN_MAX_SURFEL_RADIUS_DEVIATIONS:
+                destination = (char*)bvh.max_primitive_extent_deviation_.data();
+                element_size = sizeof(float);
+                break;
+            case BVH_COLUMN_VISIBILITY:
+                visibility.resize(num_nodes);
+                destination = (char*)visibility.data();
+                element_size = sizeof(uint8_t);
+                break;
+            default:
+                //unknown columns of newer writers are skipped
+                continue;
+        }
+
+        if (column.element_size_ != element_size || column.length_ != element_size * num_nodes) {
+            throw std::runtime_error(
+                "lamure: bvh_stream::Stream corrupt -- Invalid column size");
+        }
+
+        if (num_nodes > 0) {
+            file_.seekg(column.offset_, std::ios::beg);
+            file_.read(destination, column.length_);
+            if (!file_.good()) {
+                throw std::runtime_error(
+                    "lamure: bvh_stream::Stream corrupt -- Column exceeds file: " + filename_);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < visibility.size(); ++i) {
+        bvh.visibility_[i] = (bvh::node_visibility)visibility[i];
+    }
+
+}
+
 void bvh_stream::
 write_bvh(const std::string& filename, bvh& bvh) {
 
@@ -359,5 +452,94 @@ write_bvh(const std::string& filename, bvh& bvh) {
 
 
 
-} } // namespace lamure
+void bvh_stream::
+write_bvh_columns(const std::string& filename, bvh& bvh) {
+
+   open_stream(filename, bvh_stream_type::BVH_STREAM_OUT);
 
+   if (type_ != BVH_STREAM_OUT) {
+       throw std::runtime_error(
+           "lamure: bvh_stream::Failed to append tree to: " + filename_);
+   }
+   if (!file_.is_open()) {
+       throw std::runtime_error(
+           "lamure: bvh_stream::Failed to append tree to: " + filename_);
+   }
+
+   const uint32_t num_nodes = bvh.get_num_nodes();
+
+   if (bvh.bounding_boxes_.size() < num_nodes ||
+       bvh.centroids_.size() < num_nodes ||
+       bvh.avg_primitive_extent_.size() < num_nodes) {
+       throw std::runtime_error(
+           "lamure: bvh_stream::Incomplete bvh, unable to write: " + filename_);
+   }
+
+   file_.seekp(0, std::ios::beg);
+
+   bvh_file_seg seg;
+   seg.major_version_ = 2;
+   seg.minor_version_ = 0;
+   seg.reserved_ = 0;
+
+   write(seg);
+
+   bvh_tree_seg tree;
+   tree.segment_id_ = num_segments_++;
+   tree.depth_ = bvh.get_depth();
+   tree.num_nodes_ = num_nodes;
+   tree.fan_factor_ = bvh.get_fan_factor();
+   tree.max_surfels_per_node_ = bvh.get_primitives_per_node();
+   tree.serialized_surfel_size_ = bvh.get_size_of_primitive();
+   tree.primitive_ = (bvh_primitive_type)bvh.get_primitive();
+   tree.reserved_0_ = 0;
+   tree.state_ = bvh_tree_state::BVH_STATE_SERIALIZED;
+   tree.reserved_1_ = 0;
+   tree.reserved_2_ = 0;
+   tree.translation_.x_ = bvh.get_translation().x;
+   tree.translation_.y_ = bvh.get_translation().y;
+   tree.translation_.z_ = bvh.get_translation().z;
+   tree.reserved_3_ = 0;
+
+   write(tree);
+
+   //optional attributes of bvhs created in memory
+   std::vector<float> deviations(bvh.max_primitive_extent_deviation_);
+   deviations.resize(num_nodes, 0.f);
+
+   std::vector<uint8_t> visibility(num_nodes, (uint8_t)bvh::node_visibility::NODE_VISIBLE);
+   for (size_t i = 0; i < std::min((size_t)num_nodes, bvh.visibility_.size()); ++i) {
+       visibility[i] = (uint8_t)bvh.visibility_[i];
+   }
+
+   bvh_column_seg columns;
+   columns.segment_id_ = num_segments_++;
+   columns.num_nodes_ = num_nodes;
+   columns.num_columns_ = BVH_COLUMN_COUNT;
+   columns.reserved_ = 0;
+
+   columns.columns_.push_back({BVH_COLUMN_BOUNDING_BOXES, sizeof(scm::gl::boxf), 0, 0, (const char*)bvh.bounding_boxes_.data()});
+   columns.columns_.push_back({BVH_COLUMN_CENTROIDS, sizeof(scm::math::vec3f), 0, 0, (const char*)bvh.centroids_.data()});
+   columns.columns_.push_back({BVH_COLUMN_AVG_SURFEL_RADII, sizeof(float), 0, 0, (const char*)bvh.avg_primitive_extent_.data()});
+   columns.columns_.push_back({BVH_COLUMN_MAX_SURFEL_RADIUS_DEVIATIONS, sizeof(float), 0, 0, (const char*)deviations.data()});
+   columns.columns_.push_back({BVH_COLUMN_VISIBILITY, sizeof(uint8_t), 0, 0, (const char*)visibility.data()});
+
+   //place every column at an aligned position behind the signature and column table
+   bvh_sig sig;
+   uint64_t table_end = (uint64_t)file_.tellp() + sig.size() + 4*sizeof(uint32_t) + columns.num_columns_*24;
+   uint64_t offset = table_end;
+   for (auto& column : columns.columns_) {
+       column.offset_ = align_column_offset(offset);
+       column.length_ = (uint64_t)column.element_size_ * num_nodes;
+       offset = column.offset_ + column.length_;
+   }
+   columns.data_size_ = offset - table_end;
+
+   write(columns);
+
+   close_stream(false);
+
+}
+
+
+} } // namespace lamure
@@ -83,6 +83,16 @@ unlock() {
     mutex_.unlock();
 }
 
+void cache::
+lock_shared() {
+    mutex_.lock_shared();
+}
+
+void cache::
+unlock_shared() {
+    mutex_.unlock_shared();
+}
+
 
 } // namespace ren
 
@@ -46,6 +46,13 @@ num_free_slots() {
 
 const slot_t cache_index::
 reserve_slot() {
+    model_t evicted_model_id;
+    node_t evicted_node_id;
+    return reserve_slot(evicted_model_id, evicted_node_id);
+}
+
+const slot_t cache_index::
+reserve_slot(model_t& evicted_model_id, node_t& evicted_node_id) {
     std::lock_guard<std::mutex> lock(mutex_);
 
     assert(num_free_slots_ > 0);
@@ -71,10 +78,20 @@ reserve_slot() {
 
     assert(node.views_.empty());
 
+    evicted_model_id = node.model_id_;
+    evicted_node_id = node.node_id_;
+
     if (node.node_id_ != invalid_node_t) {
         maps_[node.model_id_].erase(node.node_id_);
     }
 
+    //evicting a prefetched node that was never aquired
+    if (node.prefetched_) {
+        node.prefetched_ = false;
+        ++prefetch_statistics_.num_wasted_;
+        --prefetch_statistics_.num_outstanding_;
+    }
+
     node.node_id_ = invalid_node_t;
     node.model_id_ = invalid_model_t;
 
@@ -111,11 +128,32 @@ apply_slot(const slot_t slot_id, const model_t model_id, const node_t node_id) {
 
     maps_[model_id][node_id] = slot_id+1;
 
+    if (node.prefetched_) {
+        ++prefetch_statistics_.num_loaded_;
+    }
+
     if (num_free_slots_ < num_slots_) {
         ++num_free_slots_;
     }
 }
 
+void cache_index::
+mark_prefetched(const slot_t slot_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    cache_index_node& node = slots_[slot_id+1];
+
+    //this raises when slot was not reserved
+    assert(node.prev_ == invalid_slot_t);
+    assert(node.next_ == invalid_slot_t);
+
+    if (!node.prefetched_) {
+        node.prefetched_ = true;
+        ++prefetch_statistics_.num_requested_;
+        ++prefetch_statistics_.num_outstanding_;
+    }
+}
+
 
 void cache_index::
 unreserve_slot(const slot_t slot_id) {
@@ -150,6 +188,12 @@ unreserve_slot(const slot_t slot_id) {
         node.views_.clear();
     }
 
+    //prefetch request was dropped before loading
+    if (node.prefetched_) {
+        node.prefetched_ = false;
+        --prefetch_statistics_.num_outstanding_;
+    }
+
     if (num_free_slots_ < num_slots_) {
         ++num_free_slots_;
     }
@@ -214,6 +258,12 @@ aquire_slot(const view_t view_id, const model_t model_id, const node_t node_id)
     slot_t slot_id = it->second;
     cache_index_node& node = slots_[slot_id];
 
+    if (node.prefetched_) {
+        node.prefetched_ = false;
+        ++prefetch_statistics_.num_used_;
+        --prefetch_statistics_.num_outstanding_;
+    }
+
     if (node.views_.find(view_id) == node.views_.end()) {
         node.views_.insert(view_id);
 
@@ -330,6 +380,23 @@ release_slot_invalidate(const view_t view_id, const model_t model_id, const node
 }
 
 
+const cache_index::prefetch_statistics cache_index::
+get_prefetch_statistics() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return prefetch_statistics_;
+}
+
+void cache_index::
+reset_prefetch_statistics() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    //slots that are still marked remain outstanding
+    size_t num_outstanding = prefetch_statistics_.num_outstanding_;
+    prefetch_statistics_ = prefetch_statistics();
+    prefetch_statistics_.num_outstanding_ = num_outstanding;
+}
+
+
 } // namespace ren
 
 } // namespace lamure
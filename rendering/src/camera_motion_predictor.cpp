@@ -0,0 +1,176 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/ren/camera_motion_predictor.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace lamure
+{
+
+namespace ren
+{
+
+camera_motion_predictor::
+camera_motion_predictor() {
+
+}
+
+camera_motion_predictor::
+~camera_motion_predictor() {
+
+}
+
+void camera_motion_predictor::
+reset() {
+    history_.clear();
+    motions_.clear();
+}
+
+void camera_motion_predictor::
+push_view_matrix(const view_t view_id, const scm::math::mat4f& view_matrix, const double time_in_ms) {
+    std::deque<sample>& history = history_[view_id];
+
+    //a long pause invalidates the previous motion
+    if (!history.empty() && time_in_ms - history.back().time_in_ms_ > LAMURE_CUT_UPDATE_PREDICTION_MAX_SAMPLE_GAP_IN_MS) {
+        history.clear();
+    }
+
+    sample s;
+    s.time_in_ms_ = time_in_ms;
+    s.camera_matrix_ = scm::math::inverse(view_matrix);
+    history.push_back(s);
+
+    //keep the oldest sample that is still inside the estimation window
+    while (history.size() > 2 && time_in_ms - history[1].time_in_ms_ >= LAMURE_CUT_UPDATE_PREDICTION_WINDOW_IN_MS) {
+        history.pop_front();
+    }
+
+    estimate_motion(view_id);
+}
+
+void camera_motion_predictor::
+estimate_motion(const view_t view_id) {
+    const std::deque<sample>& history = history_[view_id];
+    motion& m = motions_[view_id];
+    m = motion();
+
+    if (history.size() < 2) {
+        return;
+    }
+
+    const sample& first = history.front();
+    const sample& last = history.back();
+
+    float dt = (float)(last.time_in_ms_ - first.time_in_ms_);
+    if (dt < 1.f) {
+        return;
+    }
+
+    //matrices are column major, element (row, col) is at [col*4 + row]
+    const scm::math::mat4f& c0 = first.camera_matrix_;
+    const scm::math::mat4f& c1 = last.camera_matrix_;
+
+    for (uint32_t row = 0; row < 3; ++row) {
+        m.velocity_[row] = (c1[12 + row] - c0[12 + row]) / dt;
+    }
+
+    //relative rotation d = r1 * transpose(r0)
+    float d[3][3];
+    for (uint32_t row = 0; row < 3; ++row) {
+        for (uint32_t col = 0; col < 3; ++col) {
+            d[row][col] = 0.f;
+            for (uint32_t k = 0; k < 3; ++k) {
+                d[row][col] += c1[k*4 + row] * c0[k*4 + col];
+            }
+        }
+    }
+
+    float trace = d[0][0] + d[1][1] + d[2][2];
+    float angle = std::acos(std::max(-1.f, std::min(1.f, (trace - 1.f) * 0.5f)));
+    float sin_angle = std::sin(angle);
+
+    if (angle > 1e-5f && sin_angle > 1e-5f) {
+        m.angular_axis_[0] = (d[2][1] - d[1][2]) / (2.f * sin_angle);
+        m.angular_axis_[1] = (d[0][2] - d[2][0]) / (2.f * sin_angle);
+        m.angular_axis_[2] = (d[1][0] - d[0][1]) / (2.f * sin_angle);
+
+        float axis_length = std::sqrt(m.angular_axis_[0]*m.angular_axis_[0] + m.angular_axis_[1]*m.angular_axis_[1] + m.angular_axis_[2]*m.angular_axis_[2]);
+        if (axis_length > 1e-5f) {
+            for (uint32_t i = 0; i < 3; ++i) {
+                m.angular_axis_[i] /= axis_length;
+            }
+            m.angular_speed_ = angle / dt;
+        }
+    }
+
+    m.valid_ = true;
+}
+
+const bool camera_motion_predictor::
+predict_view_matrix(const view_t view_id, const float horizon_in_ms, scm::math::mat4f& predicted_view_matrix) const {
+    const auto motion_it = motions_.find(view_id);
+    if (motion_it == motions_.end() || !motion_it->second.valid_) {
+        return false;
+    }
+
+    const motion& m = motion_it->second;
+
+    float speed = std::sqrt(m.velocity_[0]*m.velocity_[0] + m.velocity_[1]*m.velocity_[1] + m.velocity_[2]*m.velocity_[2]);
+    if (speed < 1e-7f && m.angular_speed_ < 1e-7f) {
+        return false;
+    }
+
+    const scm::math::mat4f& c = history_.at(view_id).back().camera_matrix_;
+
+    //rotation by angular_speed * horizon around the axis (rodrigues)
+    float angle = std::min(m.angular_speed_ * horizon_in_ms, LAMURE_CUT_UPDATE_PREDICTION_MAX_ANGLE);
+    float x = m.angular_axis_[0];
+    float y = m.angular_axis_[1];
+    float z = m.angular_axis_[2];
+    float cs = std::cos(angle);
+    float sn = std::sin(angle);
+    float t = 1.f - cs;
+
+    float q[3][3] = {
+        {t*x*x + cs,   t*x*y - sn*z, t*x*z + sn*y},
+        {t*x*y + sn*z, t*y*y + cs,   t*y*z - sn*x},
+        {t*x*z - sn*y, t*y*z + sn*x, t*z*z + cs  }
+    };
+
+    float r[3][3];
+    for (uint32_t row = 0; row < 3; ++row) {
+        for (uint32_t col = 0; col < 3; ++col) {
+            r[row][col] = 0.f;
+            for (uint32_t k = 0; k < 3; ++k) {
+                r[row][col] += q[row][k] * c[col*4 + k];
+            }
+        }
+    }
+
+    float p[3];
+    for (uint32_t row = 0; row < 3; ++row) {
+        p[row] = c[12 + row] + m.velocity_[row] * horizon_in_ms;
+    }
+
+    //view matrix is the inverse of the rigid camera matrix: [r^T | -r^T p]
+    predicted_view_matrix = scm::math::mat4f::identity();
+    for (uint32_t row = 0; row < 3; ++row) {
+        for (uint32_t col = 0; col < 3; ++col) {
+            predicted_view_matrix[col*4 + row] = r[col][row];
+        }
+        predicted_view_matrix[12 + row] = -(r[0][row]*p[0] + r[1][row]*p[1] + r[2][row]*p[2]);
+    }
+
+    return true;
+}
+
+
+} // namespace ren
+
+} // namespace lamure
@@ -158,6 +158,9 @@ void controller::reset_system()
 
             gpu_contexts_.clear();
 
+            // models published by apply() may need a larger ooc cache
+            ooc_cache::reset_if_outdated();
+
             // disregard:
             // num_contexts_registered_ = 0;
             // num_views_registered_.clear();
@@ -222,6 +225,9 @@ void controller::reset_system(Data_Provenance const &data_provenance)
 
             gpu_contexts_.clear();
 
+            // models published by apply() may need a larger ooc cache
+            ooc_cache::reset_if_outdated();
+
             // disregard:
             // num_contexts_registered_ = 0;
             // num_views_registered_.clear();
@@ -339,6 +345,20 @@ const bool controller::is_cut_update_in_progress(const context_t context_id, Dat
     return true;
 }
 
+const cut_update_pool::stage_timings controller::get_cut_update_stage_timings(const context_t context_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto cut_update_it = cut_update_pools_.find(context_id);
+
+    if(cut_update_it == cut_update_pools_.end())
+    {
+        return cut_update_pool::stage_timings();
+    }
+
+    return cut_update_it->second->last_stage_timings();
+}
+
 const bool controller::is_cut_update_in_progress(const context_t context_id)
 {
     auto gpu_context_it = gpu_contexts_.find(context_id);
@@ -212,6 +212,19 @@ push_action(const action& action, bool sort) {
     add_action(action, sort);
 }
 
+void cut_update_index::
+push_actions(const std::vector<action>& actions, bool sort) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (const auto& action : actions) {
+        assert(action.model_id_ < num_models_);
+        assert(action.node_id_ < num_nodes_table_[action.model_id_]);
+        assert(action.queue_ < queue_t::NUM_QUEUES);
+
+        add_action(action, sort);
+    }
+}
+
 const cut_update_index::action cut_update_index::
 front_action(const queue_t queue) {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -8,6 +8,8 @@
 #include <lamure/ren/cut_update_pool.h>
 #include <lamure/pvs/pvs_database.h>
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 
 namespace lamure
@@ -15,7 +17,8 @@ namespace lamure
 namespace ren
 {
 cut_update_pool::cut_update_pool(const context_t context_id, const node_t upload_budget_in_nodes, const node_t render_budget_in_nodes, Data_Provenance const &data_provenance)
-    : context_id_(context_id), locked_(false), num_threads_(LAMURE_CUT_UPDATE_NUM_CUT_UPDATE_THREADS), shutdown_(false), current_gpu_storage_A_(nullptr), current_gpu_storage_B_(nullptr),
+    : context_id_(context_id), locked_(false), num_threads_(std::max(1u, policy::get_instance()->num_cut_update_threads())), scheduler_(nullptr), shutdown_(false), frame_interval_in_ms_(0.0),
+      current_gpu_storage_A_(nullptr), current_gpu_storage_B_(nullptr),
       current_gpu_storage_(nullptr), current_gpu_storage_A_provenance_(nullptr), current_gpu_storage_B_provenance_(nullptr), current_gpu_storage_provenance_(nullptr),
       current_gpu_buffer_(cut_database_record::temporary_buffer::BUFFER_A), upload_budget_in_nodes_(upload_budget_in_nodes), render_budget_in_nodes_(render_budget_in_nodes),
 #ifdef LAMURE_CUT_UPDATE_ENABLE_MODEL_TIMEOUT
@@ -27,14 +30,12 @@ cut_update_pool::cut_update_pool(const context_t context_id, const node_t upload
 
     initialize(true);
 
-    for(uint32_t i = 0; i < num_threads_; ++i)
-    {
-        threads_.push_back(std::thread(&cut_update_pool::run, this));
-    }
+    scheduler_ = new cut_update_scheduler(num_threads_);
 }
 
 cut_update_pool::cut_update_pool(const context_t context_id, const node_t upload_budget_in_nodes, const node_t render_budget_in_nodes)
-    : context_id_(context_id), locked_(false), num_threads_(LAMURE_CUT_UPDATE_NUM_CUT_UPDATE_THREADS), shutdown_(false), current_gpu_storage_A_(nullptr), current_gpu_storage_B_(nullptr),
+    : context_id_(context_id), locked_(false), num_threads_(std::max(1u, policy::get_instance()->num_cut_update_threads())), scheduler_(nullptr), shutdown_(false), frame_interval_in_ms_(0.0),
+      current_gpu_storage_A_(nullptr), current_gpu_storage_B_(nullptr),
       current_gpu_storage_(nullptr), current_gpu_storage_A_provenance_(nullptr), current_gpu_storage_B_provenance_(nullptr), current_gpu_storage_provenance_(nullptr),
       current_gpu_buffer_(cut_database_record::temporary_buffer::BUFFER_A), upload_budget_in_nodes_(upload_budget_in_nodes), render_budget_in_nodes_(render_budget_in_nodes),
 #ifdef LAMURE_CUT_UPDATE_ENABLE_MODEL_TIMEOUT
@@ -44,10 +45,7 @@ cut_update_pool::cut_update_pool(const context_t context_id, const node_t upload
 {
     initialize(false);
 
-    for(uint32_t i = 0; i < num_threads_; ++i)
-    {
-        threads_.push_back(std::thread(&cut_update_pool::run, this));
-    }
+    scheduler_ = new cut_update_scheduler(num_threads_);
 }
 
 cut_update_pool::~cut_update_pool()
@@ -56,16 +54,12 @@ cut_update_pool::~cut_update_pool()
         std::lock_guard<std::mutex> lock(mutex_);
 
         shutdown_ = true;
-        semaphore_.shutdown();
-        master_semaphore_.shutdown();
     }
 
-    for(auto &thread : threads_)
-    {
-        if(thread.joinable())
-            thread.join();
-    }
-    threads_.clear();
+    // waits for the running stage, the remaining graph is dropped
+    scheduler_->shutdown();
+    delete scheduler_;
+    scheduler_ = nullptr;
 
     shutdown();
 }
@@ -89,10 +83,7 @@ void cut_update_pool::initialize(bool provenance)
       ooc_cache *ooc_cache = ooc_cache::get_instance();
     }
 
-    semaphore_.set_max_signal_count(1);
-    semaphore_.set_min_signal_count(1);
-
-    
+    start_time_ = std::chrono::steady_clock::now();
 
 #ifdef LAMURE_ENABLE_INFO
     std::cout << "lamure: num models: " << index_->num_models() << std::endl;
@@ -135,6 +126,18 @@ const bool cut_update_pool::is_running()
     return master_dispatched_;
 }
 
+const cut_update_pool::stage_timings cut_update_pool::last_stage_timings()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_timings_;
+}
+
+const double cut_update_pool::analysis_time_in_ms()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_timings_.analysis_in_ms_;
+}
+
 void cut_update_pool::dispatch_cut_update(char *current_gpu_storage_A, char *current_gpu_storage_B, char *current_gpu_storage_A_provenance, char *current_gpu_storage_B_provenance)
 {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -142,12 +145,12 @@ void cut_update_pool::dispatch_cut_update(char *current_gpu_storage_A, char *cur
     assert(current_gpu_storage_A != nullptr);
     assert(current_gpu_storage_B != nullptr);
 
-#ifdef LAMURE_CUT_UPDATE_ENABLE_REPEAT_MODE
-    master_timer_.stop();
-    boost::timer::cpu_times const last_frame_time(master_timer_.elapsed());
-    last_frame_elapsed_ = last_frame_time.system + last_frame_time.user;
-    master_timer_.start();
-#endif
+    auto now = std::chrono::steady_clock::now();
+    if(last_dispatch_call_ != std::chrono::steady_clock::time_point())
+    {
+        frame_interval_in_ms_ = std::chrono::duration<double, std::milli>(now - last_dispatch_call_).count();
+    }
+    last_dispatch_call_ = now;
 
     if(!master_dispatched_)
     {
@@ -160,44 +163,9 @@ void cut_update_pool::dispatch_cut_update(char *current_gpu_storage_A, char *cur
 
         master_dispatched_ = true;
 
-        job_queue_.push_job(cut_update_queue::job(cut_update_queue::task_t::CUT_MASTER_TASK, invalid_view_t, invalid_model_t));
+        dispatch_time_ = now;
 
-        semaphore_.signal(1);
-    }
-}
-
-void cut_update_pool::run()
-{
-    while(true)
-    {
-        semaphore_.wait();
-
-        if(is_shutdown())
-            break;
-
-        // dequeue job
-        cut_update_queue::job job = job_queue_.pop_front_job();
-
-        if(job.task_ != cut_update_queue::task_t::CUT_INVALID_TASK)
-        {
-            switch(job.task_)
-            {
-            case cut_update_queue::task_t::CUT_MASTER_TASK:
-                cut_master();
-                break;
-
-            case cut_update_queue::task_t::CUT_ANALYSIS_TASK:
-                cut_analysis(job.view_id_, job.model_id_);
-                break;
-
-            case cut_update_queue::task_t::CUT_UPDATE_TASK:
-                cut_update();
-                break;
-
-            default:
-                break;
-            }
-        }
+        scheduler_->add_task([this] { cut_master(); });
     }
 }
 
@@ -219,6 +187,30 @@ const bool cut_update_pool::prepare()
 
     index_->update_policy(user_cameras_.size());
 
+    // precompute per (view, model) constants for batched node evaluation
+    model_database *database = model_database::get_instance();
+    for(model_t model_id = 0; model_id < index_->num_models(); ++model_id)
+    {
+        evaluator_.update_model(model_id, database->get_model(model_id)->get_bvh());
+
+        for(const auto &camera_it : user_cameras_)
+        {
+            view_t view_id = camera_it.first;
+            evaluator_.update_view_model(view_id, model_id, camera_it.second, model_transforms_[model_id], height_divided_by_top_minus_bottoms_[view_id]);
+        }
+    }
+
+    // camera history for predictive prefetching
+    if(policy::get_instance()->enable_predictive_prefetching())
+    {
+        double time_in_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time_).count();
+
+        for(const auto &camera_it : user_cameras_)
+        {
+            motion_predictor_.push_view_matrix(camera_it.first, camera_it.second.get_view_matrix(), time_in_ms);
+        }
+    }
+
     // clamp threshold
     for(auto &threshold_it : model_thresholds_)
     {
@@ -313,6 +305,8 @@ const bool cut_update_pool::prepare()
 
 void cut_update_pool::cut_master()
 {
+    auto prepare_start = std::chrono::steady_clock::now();
+
     if(!prepare())
     {
         std::lock_guard<std::mutex> lock(mutex_);
@@ -343,89 +337,94 @@ void cut_update_pool::cut_master()
         current_gpu_storage_provenance_ = current_gpu_storage_A_provenance_;
     }
 
-#ifdef LAMURE_CUT_UPDATE_ENABLE_REPEAT_MODE
-
-    uint32_t num_cut_updates = 0;
-    auto_timer tmr;
+    current_timings_ = stage_timings();
+    current_timings_.prepare_in_ms_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - prepare_start).count();
 
-    while(true)
+    // additional rounds have to finish before the wall-clock deadline
     {
-        boost::timer::cpu_times const elapsed_times(tmr.elapsed());
-        boost::timer::nanosecond_type const elapsed(elapsed_times.system + elapsed_times.user);
+        std::lock_guard<std::mutex> lock(mutex_);
 
+        double deadline_in_ms = policy::get_instance()->cut_update_deadline_in_ms();
+        if(deadline_in_ms <= 0.0)
         {
-            std::lock_guard<std::mutex> lock(mutex_);
-
-            if((num_cut_updates > 0 && elapsed >= last_frame_elapsed_ * 0.5f) || num_cut_updates >= LAMURE_CUT_UPDATE_MAX_NUM_UPDATES_PER_FRAME)
-            {
-                tmr.stop();
-                break;
-            }
+            // half of the interval between the last two frames
+            deadline_in_ms = 0.5 * frame_interval_in_ms_;
         }
 
-        ++num_cut_updates;
+        deadline_ = dispatch_time_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(deadline_in_ms));
+    }
 
-#endif
+    begin_round();
+}
 
-        // swap cut index
-        index_->swap_cuts();
+void cut_update_pool::begin_round()
+{
+    if(is_shutdown())
+        return;
 
-        assert(semaphore_.num_signals() == 0);
-        assert(master_semaphore_.num_signals() == 0);
+    round_start_ = std::chrono::steady_clock::now();
 
-        // re-configure semaphores
-        master_semaphore_.lock();
-        master_semaphore_.set_max_signal_count(index_->num_models() * index_->num_views());
-        master_semaphore_.set_min_signal_count(index_->num_models() * index_->num_views());
-        master_semaphore_.unlock();
+    // swap cut index
+    index_->swap_cuts();
 
-        semaphore_.lock();
-        semaphore_.set_max_signal_count(index_->num_models() * index_->num_views());
-        semaphore_.set_min_signal_count(1);
-        semaphore_.unlock();
+    prepare_analysis_chunks();
+    size_t num_chunks = analysis_chunks_.size();
 
-        // launch slaves
-        for(view_t view_id = 0; view_id < index_->num_views(); ++view_id)
-        {
-            for(model_t model_id = 0; model_id < index_->num_models(); ++model_id)
-            {
-                job_queue_.push_job(cut_update_queue::job(cut_update_queue::task_t::CUT_ANALYSIS_TASK, view_id, model_id));
-            }
-        }
+    // analysis -> sort -> update -> transfer, each stage wakes the next one when it is done
+    std::vector<cut_update_scheduler::task_id> analysis_tasks;
+    for(size_t chunk_id = 0; chunk_id < num_chunks; ++chunk_id)
+    {
+        analysis_tasks.push_back(scheduler_->add_task([this, chunk_id] { cut_analysis(chunk_id); }));
+    }
+
+    cut_update_scheduler::task_id sort_task = scheduler_->add_task([this] { cut_sort(); }, analysis_tasks);
+    cut_update_scheduler::task_id update_task = scheduler_->add_task([this] { cut_update(); }, {sort_task});
+    scheduler_->add_task([this] { cut_transfer(); }, {update_task});
+}
 
-        semaphore_.signal(index_->num_models() * index_->num_views());
+void cut_update_pool::cut_sort()
+{
+    auto sort_start = std::chrono::steady_clock::now();
+    current_timings_.analysis_in_ms_ += std::chrono::duration<double, std::milli>(sort_start - round_start_).count();
 
-        master_semaphore_.wait();
-        if(is_shutdown())
-            return;
+    if(is_shutdown())
+        return;
 
-        assert(semaphore_.num_signals() == 0);
-        assert(master_semaphore_.num_signals() == 0);
+    index_->sort();
 
-        index_->sort();
+    current_timings_.sort_in_ms_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sort_start).count();
+}
 
-        // re-configure semaphores
-        master_semaphore_.lock();
-        master_semaphore_.set_max_signal_count(1);
-        master_semaphore_.set_min_signal_count(1);
-        master_semaphore_.unlock();
+void cut_update_pool::cut_transfer()
+{
+    if(is_shutdown())
+        return;
 
-        semaphore_.lock();
-        semaphore_.set_max_signal_count(1);
-        semaphore_.set_min_signal_count(1);
-        semaphore_.unlock();
+    auto transfer_start = std::chrono::steady_clock::now();
 
-        job_queue_.push_job(cut_update_queue::job(cut_update_queue::task_t::CUT_UPDATE_TASK, 0, 0));
-        semaphore_.signal(1);
+    compile_render_list();
+    compile_transfer_list();
 
-        master_semaphore_.wait();
-        if(is_shutdown())
-            return;
+    auto transfer_end = std::chrono::steady_clock::now();
+    current_timings_.transfer_in_ms_ += std::chrono::duration<double, std::milli>(transfer_end - transfer_start).count();
+    ++current_timings_.num_rounds_;
 
 #ifdef LAMURE_CUT_UPDATE_ENABLE_REPEAT_MODE
+    // refine again if another round of the same length still fits before the deadline
+    if(current_timings_.num_rounds_ < LAMURE_CUT_UPDATE_MAX_NUM_UPDATES_PER_FRAME && transfer_end + (transfer_end - round_start_) < deadline_)
+    {
+        begin_round();
+        return;
     }
 #endif
 
+    publish();
+}
+
+void cut_update_pool::publish()
+{
+    auto publish_start = std::chrono::steady_clock::now();
+
     // apply changes
     {
         // model_database* database = model_database::get_instance();
@@ -452,8 +451,19 @@ void cut_update_pool::cut_master()
 
         cuts->unlock_record(context_id_);
 
+        // the new cut is published, request what the extrapolated views will need
+        if(policy::get_instance()->enable_predictive_prefetching())
+        {
+            predictive_prefetch();
+        }
+
+        auto publish_end = std::chrono::steady_clock::now();
+        current_timings_.publish_in_ms_ = std::chrono::duration<double, std::milli>(publish_end - publish_start).count();
+
         {
             std::lock_guard<std::mutex> lock(mutex_);
+            current_timings_.total_in_ms_ = std::chrono::duration<double, std::milli>(publish_end - dispatch_time_).count();
+            last_timings_ = current_timings_;
             master_dispatched_ = false;
         }
     }
@@ -461,34 +471,109 @@ void cut_update_pool::cut_master()
 
 
 void cut_update_pool::
-cut_analysis(view_t view_id, model_t model_id) {
+prepare_analysis_chunks() {
+
+    policy* policy = policy::get_instance();
+    size_t min_nodes_per_chunk = std::max((size_t)1, policy->min_nodes_per_cut_analysis_chunk());
+    size_t max_chunks_per_front = num_threads_;
+
+    analysis_chunks_.clear();
+    analysis_fronts_.resize(index_->num_views());
+
+    for(view_t view_id = 0; view_id < index_->num_views(); ++view_id)
+    {
+        analysis_fronts_[view_id].resize(index_->num_models());
+
+        for(model_t model_id = 0; model_id < index_->num_models(); ++model_id)
+        {
+            const std::set<node_t>& old_cut = index_->get_previous_cut(view_id, model_id);
+            std::vector<node_t>& front = analysis_fronts_[view_id][model_id];
+            front.assign(old_cut.begin(), old_cut.end());
+
+            index_->reset_cut(view_id, model_id);
+
+            size_t num_chunks = (front.size() + min_nodes_per_chunk - 1) / min_nodes_per_chunk;
+            num_chunks = std::max((size_t)1, std::min(num_chunks, max_chunks_per_front));
+            size_t chunk_size = (front.size() + num_chunks - 1) / num_chunks;
+
+            size_t begin = 0;
+            do
+            {
+                size_t end = std::min(begin + chunk_size, front.size());
+
+                // siblings are analysed as a group, move the chunk boundary
+                // past the last node that shares its parent with the previous node
+                while(end < front.size() && end > 0 &&
+                      index_->get_parent_id(model_id, front[end]) == index_->get_parent_id(model_id, front[end - 1]))
+                {
+                    ++end;
+                }
+
+                analysis_chunk chunk;
+                chunk.view_id_ = view_id;
+                chunk.model_id_ = model_id;
+                chunk.begin_ = begin;
+                chunk.end_ = end;
+                analysis_chunks_.push_back(chunk);
+
+                begin = end;
+            }
+            while(begin < front.size());
+        }
+    }
+}
+
+void cut_update_pool::
+cut_analysis(const size_t chunk_id) {
 
     lamure::pvs::pvs_database* pvs = lamure::pvs::pvs_database::get_instance();
 
+    assert(chunk_id < analysis_chunks_.size());
+
+    const analysis_chunk& chunk = analysis_chunks_[chunk_id];
+    const view_t view_id = chunk.view_id_;
+    const model_t model_id = chunk.model_id_;
+
     assert(view_id != invalid_view_t);
     assert(model_id != invalid_model_t);
     assert(view_id < index_->num_views());
     assert(model_id < index_->num_models());
 
-    scm::math::mat4f model_matrix;
 #ifdef LAMURE_CUT_UPDATE_ENABLE_MODEL_TIMEOUT
     size_t freshness;
-#endif
-    scm::gl::frustum frustum;
 
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        model_matrix = model_transforms_[model_id];
-#ifdef LAMURE_CUT_UPDATE_ENABLE_MODEL_TIMEOUT
         freshness = model_freshness_[model_id];
-#endif
-        frustum = user_cameras_[view_id].get_frustum_by_model(model_matrix);
     }
+#endif
 
     // perform cut analysis
-    std::set<node_t> old_cut = index_->get_previous_cut(view_id, model_id);
+    const std::vector<node_t>& old_cut = analysis_fronts_[view_id][model_id];
+
+    // actions are collected locally and merged into the index once per chunk
+    std::vector<cut_update_index::action> actions;
+    actions.reserve(chunk.end_ - chunk.begin_);
+
+    // evaluate errors and frustum classifications of all nodes in the chunk and their parents in batches
+    const size_t num_chunk_nodes = chunk.end_ - chunk.begin_;
+    std::vector<node_t> parent_ids(num_chunk_nodes);
+    for(size_t i = 0; i < num_chunk_nodes; ++i)
+    {
+        node_t node_id = old_cut[chunk.begin_ + i];
+        parent_ids[i] = node_id > 0 ? index_->get_parent_id(model_id, node_id) : 0;
+    }
+
+    std::vector<float> node_errors(num_chunk_nodes);
+    std::vector<float> parent_errors(num_chunk_nodes);
+    std::vector<uint8_t> node_classifications(num_chunk_nodes);
+    std::vector<uint8_t> parent_classifications(num_chunk_nodes);
 
-    index_->reset_cut(view_id, model_id);
+    if(num_chunk_nodes > 0)
+    {
+        evaluator_.evaluate(view_id, model_id, &old_cut[chunk.begin_], num_chunk_nodes, nullptr, node_errors.data(), node_classifications.data());
+        evaluator_.evaluate(view_id, model_id, parent_ids.data(), num_chunk_nodes, nullptr, parent_errors.data(), parent_classifications.data());
+    }
 
     uint32_t fan_factor = index_->fan_factor(model_id);
 
@@ -501,10 +586,10 @@ cut_analysis(view_t view_id, model_t model_id) {
     float max_error_threshold = model_thresholds_[model_id] + 0.1f;
 
     // cut analysis
-    std::set<node_t>::iterator cut_it;
-    for(cut_it = old_cut.begin(); cut_it != old_cut.end(); ++cut_it)
+    for(size_t cut_idx = chunk.begin_; cut_idx < chunk.end_; ++cut_idx)
     {
-        node_t node_id = *cut_it;
+        node_t node_id = old_cut[cut_idx];
+        size_t chunk_idx = cut_idx - chunk.begin_;
 
         bool all_siblings_in_cut = false;
         bool no_sibling_in_frustum = true;
@@ -520,13 +605,13 @@ cut_analysis(view_t view_id, model_t model_id) {
 
         if (node_id > 0 && node_id < index_->num_nodes(model_id))
         {
-            parent_id = index_->get_parent_id(model_id, node_id);
-            parent_error = calculate_node_error(view_id, model_id, parent_id);
+            parent_id = parent_ids[chunk_idx];
+            parent_error = parent_errors[chunk_idx];
 
             index_->get_all_siblings(model_id, node_id, siblings);
 
             all_siblings_in_cut = is_all_nodes_in_cut(model_id, siblings, old_cut);
-            no_sibling_in_frustum = !is_node_in_frustum(view_id, model_id, parent_id, frustum);
+            no_sibling_in_frustum = parent_classifications[chunk_idx] == node_batch_evaluator::OUTSIDE;
 
             // Check if no sibling is visible via PVS.
             for(node_t sibling_id : siblings)
@@ -541,8 +626,8 @@ cut_analysis(view_t view_id, model_t model_id) {
 
         if (!all_siblings_in_cut)
         {
-            float node_error = calculate_node_error(view_id, model_id, node_id);
-            bool node_in_frustum = is_node_in_frustum(view_id, model_id, node_id, frustum);
+            float node_error = node_errors[chunk_idx];
+            bool node_in_frustum = node_classifications[chunk_idx] != node_batch_evaluator::OUTSIDE;
 
             if (node_in_frustum && node_error > max_error_threshold && pvs->get_viewer_visibility(model_id, node_id))
             {
@@ -568,16 +653,16 @@ cut_analysis(view_t view_id, model_t model_id) {
 
                 if (!split || freshness_timeout)
                 {
-                    index_->push_action(cut_update_index::action(cut_update_index::queue_t::KEEP, view_id, model_id, node_id, parent_error), false);
+                    actions.push_back(cut_update_index::action(cut_update_index::queue_t::KEEP, view_id, model_id, node_id, parent_error));
                 }
                 else
                 {
-                    index_->push_action(cut_update_index::action(cut_update_index::queue_t::MUST_SPLIT,view_id, model_id, node_id, node_error), false);
+                    actions.push_back(cut_update_index::action(cut_update_index::queue_t::MUST_SPLIT,view_id, model_id, node_id, node_error));
                 }
             }
             else
             {
-                index_->push_action(cut_update_index::action(cut_update_index::queue_t::KEEP, view_id, model_id, node_id, parent_error), false);
+                actions.push_back(cut_update_index::action(cut_update_index::queue_t::KEEP, view_id, model_id, node_id, parent_error));
             }
         }
         else
@@ -586,15 +671,15 @@ cut_analysis(view_t view_id, model_t model_id) {
             if (no_sibling_in_frustum)
             {
 #ifdef LAMURE_CUT_UPDATE_MUST_COLLAPSE_OUTSIDE_FRUSTUM
-                index_->push_action(cut_update_index::action(cut_update_index::queue_t::MUST_COLLAPSE, view_id, model_id, parent_id, parent_error), false);
+                actions.push_back(cut_update_index::action(cut_update_index::queue_t::MUST_COLLAPSE, view_id, model_id, parent_id, parent_error));
 #else
-                index_->push_action(cut_update_index::action(cut_update_index::queue_t::COLLAPSE_ON_NEED, view_id, model_id, parent_id, parent_error), false);
+                actions.push_back(cut_update_index::action(cut_update_index::queue_t::COLLAPSE_ON_NEED, view_id, model_id, parent_id, parent_error));
 #endif
             }
             else if(no_sibling_visible_in_pvs)
             {
                 // Parent is invisible from current view point per PVS.
-                index_->push_action(cut_update_index::action(cut_update_index::queue_t::MUST_COLLAPSE, view_id, model_id, parent_id, parent_error), false);
+                actions.push_back(cut_update_index::action(cut_update_index::queue_t::MUST_COLLAPSE, view_id, model_id, parent_id, parent_error));
             }
             else
             {
@@ -602,10 +687,10 @@ cut_analysis(view_t view_id, model_t model_id) {
 
                 if (freshness_timeout)
                 {
-                    index_->push_action(cut_update_index::action(cut_update_index::queue_t::COLLAPSE_ON_NEED, view_id, model_id, parent_id, parent_error), false);
+                    actions.push_back(cut_update_index::action(cut_update_index::queue_t::COLLAPSE_ON_NEED, view_id, model_id, parent_id, parent_error));
 
                     // skip to next group of siblings
-                    std::advance(cut_it, fan_factor - 1);
+                    cut_idx += fan_factor - 1;
                     continue;
                 }
 
@@ -615,10 +700,14 @@ cut_analysis(view_t view_id, model_t model_id) {
 
                 std::vector<bool> keep_sibling;
 
-                for (const auto& sibling_id : siblings)
+                for (size_t sibling_idx = 0; sibling_idx < siblings.size(); ++sibling_idx)
                 {
-                    float sibling_error = calculate_node_error(view_id, model_id, sibling_id);
-                    bool sibling_in_frustum = is_node_in_frustum(view_id, model_id, sibling_id, frustum);
+                    // the complete group of siblings is stored contiguously in the front
+                    const node_t sibling_id = siblings[sibling_idx];
+                    assert(old_cut[cut_idx + sibling_idx] == sibling_id);
+
+                    float sibling_error = node_errors[chunk_idx + sibling_idx];
+                    bool sibling_in_frustum = node_classifications[chunk_idx + sibling_idx] != node_batch_evaluator::OUTSIDE;
 
                     if (sibling_error > max_error_threshold && sibling_in_frustum && pvs->get_viewer_visibility(model_id, sibling_id))
                     {
@@ -649,7 +738,7 @@ cut_analysis(view_t view_id, model_t model_id) {
                         }
                         else
                         {
-                            index_->push_action(cut_update_index::action(cut_update_index::queue_t::MUST_SPLIT, view_id, model_id, sibling_id, sibling_error), false);
+                            actions.push_back(cut_update_index::action(cut_update_index::queue_t::MUST_SPLIT, view_id, model_id, sibling_id, sibling_error));
 
                             keep_all_siblings = false;
                             keep_sibling.push_back(false);
@@ -669,11 +758,11 @@ cut_analysis(view_t view_id, model_t model_id) {
 
                 if (keep_all_siblings && all_sibling_errors_below_min_error_threshold)
                 {
-                    index_->push_action(cut_update_index::action(cut_update_index::queue_t::MUST_COLLAPSE, view_id, model_id, parent_id, parent_error), false);
+                    actions.push_back(cut_update_index::action(cut_update_index::queue_t::MUST_COLLAPSE, view_id, model_id, parent_id, parent_error));
                 }
                 else if (keep_all_siblings)
                 {
-                    index_->push_action(cut_update_index::action(cut_update_index::queue_t::MAYBE_COLLAPSE, view_id, model_id, parent_id, parent_error), false);
+                    actions.push_back(cut_update_index::action(cut_update_index::queue_t::MAYBE_COLLAPSE, view_id, model_id, parent_id, parent_error));
                 }
                 else
                 {
@@ -682,18 +771,18 @@ cut_analysis(view_t view_id, model_t model_id) {
                     {
                         if (keep_sibling[j])
                         {
-                            index_->push_action(cut_update_index::action(cut_update_index::queue_t::KEEP, view_id, model_id, siblings[j], parent_error), false);
+                            actions.push_back(cut_update_index::action(cut_update_index::queue_t::KEEP, view_id, model_id, siblings[j], parent_error));
                         }
                     }
                 }
             }
 
             // skip to next group of siblings
-            std::advance(cut_it, fan_factor - 1);
+            cut_idx += fan_factor - 1;
         }
     }
 
-    master_semaphore_.signal(1);
+    index_->push_actions(actions, false);
 }
 
 void cut_update_pool::cut_update_split_again(const cut_update_index::action &split_action)
@@ -750,6 +839,11 @@ void cut_update_pool::cut_update_split_again(const cut_update_index::action &spl
 
 void cut_update_pool::cut_update()
 {
+    if(is_shutdown())
+        return;
+
+    auto update_start = std::chrono::steady_clock::now();
+
     ooc_cache *ooc_cache = ooc_cache::get_instance(_data_provenance);
     ooc_cache->lock();
     ooc_cache->refresh();
@@ -1059,10 +1153,7 @@ void cut_update_pool::cut_update()
     assert(index_->num_actions(cut_update_index::queue_t::COLLAPSE_ON_NEED) == 0);
     assert(index_->num_actions(cut_update_index::queue_t::MAYBE_COLLAPSE) == 0);
 
-    compile_render_list();
-    compile_transfer_list();
-
-    master_semaphore_.signal(1);
+    current_timings_.update_in_ms_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - update_start).count();
 }
 
 void cut_update_pool::compile_render_list()
@@ -1180,6 +1271,150 @@ void cut_update_pool::prefetch_routine()
 }
 #endif
 
+void cut_update_pool::predictive_prefetch()
+{
+    policy *policy = policy::get_instance();
+    model_database *database = model_database::get_instance();
+    ooc_cache *ooc_cache = ooc_cache::get_instance(_data_provenance);
+
+    size_t budget_in_nodes = (policy->prefetch_budget_in_mb() * 1024u * 1024u) / database->get_slot_size();
+
+    ooc_cache->lock();
+    ooc_cache->refresh();
+
+    // prefetched nodes that were neither used nor evicted yet count against the budget
+    size_t num_outstanding = ooc_cache->get_prefetch_statistics().num_outstanding_;
+    if(num_outstanding >= budget_in_nodes)
+    {
+        ooc_cache->unlock();
+        return;
+    }
+
+    // leave at least half of the evictable slots to demand loads
+    size_t num_requests = std::min(budget_in_nodes - num_outstanding, (size_t)ooc_cache->num_free_slots() / 2);
+
+    const uint32_t num_horizons = LAMURE_CUT_UPDATE_PREFETCH_NUM_HORIZONS;
+    const view_t num_views = index_->num_views();
+
+    std::vector<node_t> frontier;
+    std::vector<float> frontier_errors;
+    std::vector<uint8_t> frontier_classifications;
+    std::vector<node_t> children;
+    std::vector<float> child_errors;
+    std::vector<uint8_t> child_classifications;
+    std::vector<node_t> child_ids;
+
+    // nearest horizon first, its nodes are needed first
+    for(uint32_t horizon = 0; horizon < num_horizons && num_requests > 0; ++horizon)
+    {
+        float horizon_in_ms = policy->prefetch_horizon_in_ms() * (float)(horizon + 1) / (float)num_horizons;
+
+        // demand requests use the node error as priority, prefetch requests stay below zero
+        int32_t horizon_priority = -((int32_t)(horizon + 1) << 16);
+
+        for(view_t view_id = 0; view_id < num_views && num_requests > 0; ++view_id)
+        {
+            scm::math::mat4f predicted_view_matrix;
+            if(!motion_predictor_.predict_view_matrix(view_id, horizon_in_ms, predicted_view_matrix))
+            {
+                continue;
+            }
+
+            const camera &user_camera = user_cameras_[view_id];
+            camera predicted_camera(view_id, user_camera.near_plane_value(), predicted_view_matrix, user_camera.get_projection_matrix());
+
+            // evaluator slots behind the user views hold the predicted views
+            view_t prediction_id = num_views + view_id * num_horizons + horizon;
+
+            for(model_t model_id = 0; model_id < index_->num_models() && num_requests > 0; ++model_id)
+            {
+                evaluator_.update_view_model(prediction_id, model_id, predicted_camera, model_transforms_[model_id], height_divided_by_top_minus_bottoms_[view_id]);
+
+                float min_error_threshold = model_thresholds_[model_id] - 0.1f;
+                float max_error_threshold = model_thresholds_[model_id] + 0.1f;
+                uint32_t fan_factor = index_->fan_factor(model_id);
+
+                const std::set<node_t> &current_cut = index_->get_current_cut(view_id, model_id);
+                frontier.assign(current_cut.begin(), current_cut.end());
+                frontier_errors.resize(frontier.size());
+                frontier_classifications.resize(frontier.size());
+                evaluator_.evaluate(prediction_id, model_id, frontier.data(), frontier.size(), nullptr, frontier_errors.data(), frontier_classifications.data());
+
+                // refine the current cut against the predicted view level by level
+                while(!frontier.empty() && num_requests > 0)
+                {
+                    children.clear();
+
+                    for(size_t i = 0; i < frontier.size(); ++i)
+                    {
+                        if(frontier_classifications[i] == node_batch_evaluator::OUTSIDE || frontier_errors[i] <= max_error_threshold)
+                        {
+                            continue;
+                        }
+
+                        child_ids.clear();
+                        index_->get_all_children(model_id, frontier[i], child_ids);
+                        if(child_ids.empty() || child_ids[0] == invalid_node_t || child_ids[0] >= index_->num_nodes(model_id))
+                        {
+                            continue;
+                        }
+
+                        children.insert(children.end(), child_ids.begin(), child_ids.end());
+                    }
+
+                    if(children.empty())
+                    {
+                        break;
+                    }
+
+                    child_errors.resize(children.size());
+                    child_classifications.resize(children.size());
+                    evaluator_.evaluate(prediction_id, model_id, children.data(), children.size(), nullptr, child_errors.data(), child_classifications.data());
+
+                    frontier.clear();
+                    frontier_errors.clear();
+                    frontier_classifications.clear();
+
+                    for(size_t group = 0; group < children.size() && num_requests > 0; group += fan_factor)
+                    {
+                        // same criterion as the cut analysis: no split if a child would have to collapse again
+                        bool split = true;
+                        for(size_t i = group; i < group + fan_factor; ++i)
+                        {
+                            if(child_errors[i] < min_error_threshold)
+                            {
+                                split = false;
+                                break;
+                            }
+                        }
+
+                        if(!split)
+                        {
+                            continue;
+                        }
+
+                        for(size_t i = group; i < group + fan_factor; ++i)
+                        {
+                            int32_t priority = horizon_priority + (int32_t)std::min(child_errors[i], 65535.f);
+
+                            if(num_requests > 0 && ooc_cache->prefetch_node(model_id, children[i], priority))
+                            {
+                                --num_requests;
+                            }
+
+                            frontier.push_back(children[i]);
+                            frontier_errors.push_back(child_errors[i]);
+                            frontier_classifications.push_back(child_classifications[i]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    ooc_cache->unlock();
+}
+
 void cut_update_pool::compile_transfer_list()
 {
     model_database *database = model_database::get_instance();
@@ -1252,7 +1487,7 @@ void cut_update_pool::split_node(const cut_update_index::action &action)
     // try to obtain children
     for(const auto &child_id : child_ids)
     {
-        if(!ooc_cache->is_node_resident(action.model_id_, child_id))
+        if(!ooc_cache->lookup_node(action.model_id_, child_id))
         {
             if(all_children_fit_in_ooc_cache)
             {
@@ -1359,6 +1594,23 @@ const bool cut_update_pool::is_all_nodes_in_cut(const model_t model_id, const st
     return true;
 }
 
+const bool cut_update_pool::is_all_nodes_in_cut(const model_t model_id, const std::vector<node_t> &node_ids, const std::vector<node_t> &sorted_cut)
+{
+    for(const auto &node_id : node_ids)
+    {
+        if(node_id >= (node_t)index_->num_nodes(model_id))
+            return false;
+
+        if(node_id == invalid_node_t)
+            return false;
+
+        if(!std::binary_search(sorted_cut.begin(), sorted_cut.end(), node_id))
+            return false;
+    }
+
+    return true;
+}
+
 const bool cut_update_pool::is_node_in_frustum(const view_t view_id, const model_t model_id, const node_t node_id, const scm::gl::frustum &frustum)
 {
     model_database *database = model_database::get_instance();
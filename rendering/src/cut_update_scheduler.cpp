@@ -0,0 +1,153 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/ren/cut_update_scheduler.h>
+
+#include <cassert>
+
+namespace lamure
+{
+
+namespace ren
+{
+
+cut_update_scheduler::
+cut_update_scheduler(const uint32_t num_threads)
+: num_threads_(num_threads),
+  shutdown_(false),
+  num_unfinished_(0) {
+    assert(num_threads_ > 0);
+
+    for (uint32_t i = 0; i < num_threads_; ++i) {
+        threads_.push_back(std::thread(&cut_update_scheduler::run, this));
+    }
+}
+
+cut_update_scheduler::
+~cut_update_scheduler() {
+    shutdown();
+}
+
+void cut_update_scheduler::
+shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    ready_signal_.notify_all();
+
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    threads_.clear();
+}
+
+const cut_update_scheduler::task_id cut_update_scheduler::
+add_task(const task_function& function, const std::vector<task_id>& dependencies) {
+    bool is_ready = false;
+
+    task_id id;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        id = tasks_.size();
+        tasks_.push_back(task());
+
+        task& t = tasks_.back();
+        t.function_ = function;
+        t.num_pending_dependencies_ = 0;
+        t.finished_ = false;
+
+        for (const auto dependency : dependencies) {
+            assert(dependency < id);
+
+            if (!tasks_[dependency].finished_) {
+                tasks_[dependency].successors_.push_back(id);
+                ++t.num_pending_dependencies_;
+            }
+        }
+
+        ++num_unfinished_;
+
+        if (t.num_pending_dependencies_ == 0) {
+            ready_.push_back(id);
+            is_ready = true;
+        }
+    }
+
+    if (is_ready) {
+        ready_signal_.notify_one();
+    }
+
+    return id;
+}
+
+const bool cut_update_scheduler::
+is_idle() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_unfinished_ == 0;
+}
+
+void cut_update_scheduler::
+run() {
+    while (true) {
+        task_id id;
+        task_function function;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_signal_.wait(lock, [this]{ return shutdown_ || !ready_.empty(); });
+
+            if (shutdown_) {
+                break;
+            }
+
+            id = ready_.front();
+            ready_.pop_front();
+
+            //deque references stay valid while tasks are appended
+            function = tasks_[id].function_;
+        }
+
+        function();
+
+        size_t num_woken = 0;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            task& t = tasks_[id];
+            t.finished_ = true;
+            --num_unfinished_;
+
+            for (const auto successor : t.successors_) {
+                if (--tasks_[successor].num_pending_dependencies_ == 0) {
+                    ready_.push_back(successor);
+                    ++num_woken;
+                }
+            }
+
+            //the graph is complete, nobody can refer to its ids any more
+            if (num_unfinished_ == 0) {
+                tasks_.clear();
+            }
+        }
+
+        //this worker picks up one of the released tasks itself
+        for (size_t i = 1; i < num_woken; ++i) {
+            ready_signal_.notify_one();
+        }
+    }
+}
+
+
+} // namespace ren
+
+} // namespace lamure
@@ -8,6 +8,9 @@
 #include <lamure/ren/model_database.h>
 #include <lamure/ren/controller.h>
 
+#include <algorithm>
+#include <iostream>
+
 namespace lamure
 {
 
@@ -23,27 +26,47 @@ bool model_database::contains_trimesh_ = false;
 model_database::
 model_database()
 : num_datasets_(0),
-  num_datasets_pending_(0),
   primitives_per_node_(0),
-  primitives_per_node_pending_(0) {
+  num_loads_in_flight_(0),
+  shutdown_loaders_(false) {
 
+    std::fill(model_blocks_, model_blocks_ + max_model_blocks_, nullptr);
 }
 
 model_database::
 ~model_database() {
+    {
+        std::lock_guard<std::mutex> lock(load_mutex_);
+        shutdown_loaders_ = true;
+    }
+    load_signal_.notify_all();
+
+    for (auto& loader_thread : loader_threads_) {
+        loader_thread.join();
+    }
+
+    loader_threads_.clear();
+
+    for (const auto& model_it : loaded_datasets_) {
+        delete model_it.second;
+    }
+
+    loaded_datasets_.clear();
+
     std::lock_guard<std::mutex> lock(mutex_);
 
     is_instanced_ = false;
 
-    for (const auto& model_it : datasets_) {
-        dataset* model = model_it.second;
-        if (model != nullptr) {
-            delete model;
-            model = nullptr;
-        }
+    for (model_t model_id = 0; model_id < num_datasets_; ++model_id) {
+        delete model_blocks_[model_id / model_block_size_][model_id % model_block_size_];
     }
 
-    datasets_.clear();
+    for (size_t block_id = 0; block_id < max_model_blocks_; ++block_id) {
+        delete[] model_blocks_[block_id];
+        model_blocks_[block_id] = nullptr;
+    }
+
+    num_datasets_ = 0;
 }
 
 model_database* model_database::
@@ -67,8 +90,63 @@ void model_database::
 apply() {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    num_datasets_ = num_datasets_pending_;
-    primitives_per_node_ = primitives_per_node_pending_;
+    publish_models();
+}
+
+void model_database::
+publish_models() {
+    //model ids index dense arrays in the caches and cut updates,
+    //so a model is only published after all models with smaller ids
+    model_t num_datasets = num_datasets_;
+
+    {
+        std::lock_guard<std::mutex> lock(load_mutex_);
+
+        while (true) {
+            auto model_it = loaded_datasets_.find(num_datasets);
+            if (model_it == loaded_datasets_.end()) {
+                break;
+            }
+
+            dataset**& block = model_blocks_[num_datasets / model_block_size_];
+            if (block == nullptr) {
+                block = new dataset*[model_block_size_];
+            }
+            block[num_datasets % model_block_size_] = model_it->second;
+
+            loaded_datasets_.erase(model_it);
+            ++num_datasets;
+        }
+    }
+
+    if (num_datasets == num_datasets_) {
+        return;
+    }
+
+    //slots are sized for the largest node of all published models
+    size_t primitives_per_node = 0;
+    bool contains_only_compressed_data = true;
+    bool contains_trimesh = false;
+
+    for (model_t model_id = 0; model_id < num_datasets; ++model_id) {
+        const bvh* bvh = model_blocks_[model_id / model_block_size_][model_id % model_block_size_]->get_bvh();
+
+        primitives_per_node = std::max(primitives_per_node, (size_t)bvh->get_primitives_per_node());
+
+        if (lamure::ren::bvh::primitive_type::POINTCLOUD_QZ != bvh->get_primitive()) {
+            contains_only_compressed_data = false;
+        }
+
+        if (lamure::ren::bvh::primitive_type::TRIMESH == bvh->get_primitive()) {
+            contains_trimesh = true;
+        }
+    }
+
+    model_database::contains_only_compressed_data_ = contains_only_compressed_data;
+    model_database::contains_trimesh_ = contains_trimesh;
+
+    primitives_per_node_ = primitives_per_node;
+    num_datasets_.store(num_datasets, std::memory_order_release);
 }
 
 const model_t model_database::
@@ -83,29 +161,6 @@ add_model(const std::string& filepath, const std::string& model_key) {
     if (model->is_loaded()) {
         const bvh* bvh = model->get_bvh();
 
-        if( lamure::ren::bvh::primitive_type::POINTCLOUD_QZ != bvh->get_primitive() ) {
-            model_database::contains_only_compressed_data_ = false;
-        }
-
-        if( lamure::ren::bvh::primitive_type::TRIMESH == bvh->get_primitive() ) {
-            model_database::contains_trimesh_ = true;
-        }
-
-        if (num_datasets_ == 0) {
-            std::lock_guard<std::mutex> lock(mutex_);
-            if (num_datasets_ == 0) {
-                primitives_per_node_pending_ = bvh->get_primitives_per_node();
-                primitives_per_node_ = primitives_per_node_pending_;
-            }
-        }
-
-        if (bvh->get_primitives_per_node() > primitives_per_node_pending_) {
-            std::lock_guard<std::mutex> lock(mutex_);
-            if (bvh->get_primitives_per_node() > primitives_per_node_pending_) {
-                primitives_per_node_pending_ = bvh->get_primitives_per_node();
-            }
-        }
-
         model_t model_id = 0;
 
         {
@@ -113,13 +168,20 @@ add_model(const std::string& filepath, const std::string& model_key) {
 
             model_id = controller::get_instance()->deduce_model_id(model_key);
 
+            if (model_id >= model_block_size_ * max_model_blocks_) {
+                delete model;
+                throw std::runtime_error(
+                    "lamure: model_database::Too many models: " + filepath);
+            }
+
             model->model_id_ = model_id;
-            datasets_[model_id] = model;
 
-            ++num_datasets_pending_;
+            {
+                std::lock_guard<std::mutex> load_lock(load_mutex_);
+                loaded_datasets_[model_id] = model;
+            }
 
-            num_datasets_ = num_datasets_pending_;
-            primitives_per_node_ = primitives_per_node_pending_;
+            publish_models();
 
             controller::get_instance()->signal_system_reset();
         }
@@ -163,10 +225,137 @@ add_model(const std::string& filepath, const std::string& model_key) {
 
 }
 
+const model_t model_database::
+add_model_async(const std::string& filepath, const std::string& model_key) {
+
+    if (controller::get_instance()->is_model_present(model_key)) {
+        return controller::get_instance()->deduce_model_id(model_key);
+    }
+
+    std::string extension = filepath.substr(filepath.find_last_of(".") + 1);
+    if (extension.compare("bvhqz") != 0 && extension.compare("bvh") != 0) {
+        throw std::runtime_error(
+            "lamure: model_database::Incompatible input file: " + filepath);
+    }
+
+    model_t model_id = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        model_id = controller::get_instance()->deduce_model_id(model_key);
+    }
+
+    if (model_id >= model_block_size_ * max_model_blocks_) {
+        throw std::runtime_error(
+            "lamure: model_database::Too many models: " + filepath);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(load_mutex_);
+
+        if (loader_threads_.empty()) {
+            uint32_t num_loader_threads = std::max(1u, std::min(4u, std::thread::hardware_concurrency()));
+            for (uint32_t i = 0; i < num_loader_threads; ++i) {
+                loader_threads_.push_back(std::thread(&model_database::run_loader, this));
+            }
+        }
+
+        load_jobs_.push_back({model_id, filepath});
+        ++num_loads_in_flight_;
+    }
+
+    load_signal_.notify_one();
+
+    return model_id;
+}
+
+void model_database::
+run_loader() {
+    while (true) {
+        load_job job;
+
+        {
+            std::unique_lock<std::mutex> lock(load_mutex_);
+            load_signal_.wait(lock, [this] { return shutdown_loaders_ || !load_jobs_.empty(); });
+
+            if (shutdown_loaders_) {
+                return;
+            }
+
+            job = load_jobs_.front();
+            load_jobs_.pop_front();
+        }
+
+        dataset* model = nullptr;
+        std::string error;
+
+        try {
+            model = new dataset(job.filepath_);
+            model->model_id_ = job.model_id_;
+        }
+        catch (const std::exception& e) {
+            error = e.what();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(load_mutex_);
+
+            if (model != nullptr) {
+                loaded_datasets_[job.model_id_] = model;
+            }
+            else {
+                load_errors_.push_back(job.filepath_ + " (" + error + ")");
+            }
+
+            --num_loads_in_flight_;
+        }
+
+        load_finished_.notify_all();
+
+        if (model != nullptr) {
+#ifdef LAMURE_ENABLE_INFO
+            std::cout << "lamure: loaded model " << job.model_id_ << ": " << job.filepath_ << std::endl;
+#endif
+            //the reset publishes the model
+            controller::get_instance()->signal_system_reset();
+        }
+        else {
+            std::cerr << "lamure: model_database::Model was not loaded: " << job.filepath_ << " (" << error << ")" << std::endl;
+        }
+    }
+}
+
+void model_database::
+wait_for_models() {
+    std::unique_lock<std::mutex> lock(load_mutex_);
+    load_finished_.wait(lock, [this] { return num_loads_in_flight_ == 0; });
+
+    if (!load_errors_.empty()) {
+        std::string errors;
+        for (const auto& load_error : load_errors_) {
+            errors += "\n" + load_error;
+        }
+        load_errors_.clear();
+
+        throw std::runtime_error(
+            "lamure: model_database::Models were not loaded:" + errors);
+    }
+}
+
+dataset* model_database::
+find_model(const model_t model_id) const {
+    if (model_id >= num_datasets_.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    return model_blocks_[model_id / model_block_size_][model_id % model_block_size_];
+}
+
 dataset* model_database::
 get_model(const model_t model_id) {
-    if (datasets_.find(model_id) != datasets_.end()) {
-        return datasets_[model_id];
+    dataset* model = find_model(model_id);
+    if (model != nullptr) {
+        return model;
     }
     throw std::runtime_error(
         "lamure: model_database::Model was not found:" + std::to_string(model_id));
@@ -191,9 +380,9 @@ get_primitive_size(const bvh::primitive_type type) const {
 
 const size_t model_database::
 get_node_size(const model_t model_id) const {
-    auto model_it = datasets_.find(model_id);
-    if (model_it != datasets_.end()) {
-        const bvh* bvh = model_it->second->get_bvh();
+    const dataset* model = find_model(model_id);
+    if (model != nullptr) {
+        const bvh* bvh = model->get_bvh();
         return get_primitive_size(bvh->get_primitive()) * bvh->get_primitives_per_node();
     }
     throw std::runtime_error(
@@ -204,9 +393,9 @@ get_node_size(const model_t model_id) const {
 
 const size_t model_database::
 get_primitives_per_node(const model_t model_id) const {
-    auto model_it = datasets_.find(model_id);
-    if (model_it != datasets_.end()) {
-        const bvh* bvh = model_it->second->get_bvh();
+    const dataset* model = find_model(model_id);
+    if (model != nullptr) {
+        const bvh* bvh = model->get_bvh();
         return bvh->get_primitives_per_node();
     }
     throw std::runtime_error(
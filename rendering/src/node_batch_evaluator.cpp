@@ -0,0 +1,363 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/ren/node_batch_evaluator.h>
+
+#include <cmath>
+#include <assert.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace lamure
+{
+
+namespace ren
+{
+
+namespace
+{
+
+#if defined(__SSE2__) && !defined(__AVX2__)
+inline __m128 gather4(const float* column, const node_t* node_ids) {
+    return _mm_setr_ps(column[node_ids[0]], column[node_ids[1]], column[node_ids[2]], column[node_ids[3]]);
+}
+#endif
+
+}
+
+node_batch_evaluator::
+node_batch_evaluator() {
+
+}
+
+node_batch_evaluator::
+~node_batch_evaluator() {
+
+}
+
+const uint32_t node_batch_evaluator::
+batch_width() {
+#if defined(__AVX2__)
+    return 8;
+#elif defined(__SSE2__)
+    return 4;
+#else
+    return 1;
+#endif
+}
+
+void node_batch_evaluator::
+update_model(const model_t model_id, const bvh* bvh) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (columns_.size() <= model_id) {
+        columns_.resize(model_id+1);
+    }
+
+    bvh_columns& columns = columns_[model_id];
+    uint32_t num_nodes = bvh->get_num_nodes();
+
+    if (columns.centroid_x_.size() == num_nodes) {
+        return;
+    }
+
+    columns.centroid_x_.resize(num_nodes);
+    columns.centroid_y_.resize(num_nodes);
+    columns.centroid_z_.resize(num_nodes);
+    columns.avg_primitive_extent_.resize(num_nodes);
+    columns.min_x_.resize(num_nodes);
+    columns.min_y_.resize(num_nodes);
+    columns.min_z_.resize(num_nodes);
+    columns.max_x_.resize(num_nodes);
+    columns.max_y_.resize(num_nodes);
+    columns.max_z_.resize(num_nodes);
+
+    const std::vector<vec3f>& centroids = bvh->get_centroids();
+    const std::vector<scm::gl::boxf>& boxes = bvh->get_bounding_boxes();
+
+    for (node_t node_id = 0; node_id < num_nodes; ++node_id) {
+        columns.centroid_x_[node_id] = centroids[node_id].x;
+        columns.centroid_y_[node_id] = centroids[node_id].y;
+        columns.centroid_z_[node_id] = centroids[node_id].z;
+        columns.avg_primitive_extent_[node_id] = bvh->get_avg_primitive_extent(node_id);
+        columns.min_x_[node_id] = boxes[node_id].min_vertex().x;
+        columns.min_y_[node_id] = boxes[node_id].min_vertex().y;
+        columns.min_z_[node_id] = boxes[node_id].min_vertex().z;
+        columns.max_x_[node_id] = boxes[node_id].max_vertex().x;
+        columns.max_y_[node_id] = boxes[node_id].max_vertex().y;
+        columns.max_z_[node_id] = boxes[node_id].max_vertex().z;
+    }
+}
+
+void node_batch_evaluator::
+update_view_model(const view_t view_id, const model_t model_id,
+                  const camera& camera,
+                  const scm::math::mat4f& model_matrix,
+                  const float height_divided_by_top_minus_bottom) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (constants_.size() <= view_id) {
+        constants_.resize(view_id+1);
+    }
+    if (constants_[view_id].size() <= model_id) {
+        constants_[view_id].resize(model_id+1);
+    }
+
+    view_model_constants& constants = constants_[view_id][model_id];
+
+    scm::math::mat4f view_model = camera.get_view_matrix() * model_matrix;
+    scm::math::mat4f clip = camera.get_projection_matrix() * view_model;
+
+    //matrices are column major, element (row, col) is at [col*4 + row]
+    for (uint32_t col = 0; col < 4; ++col) {
+        constants.depth_row_[col] = view_model[col*4 + 2];
+    }
+
+    float radius_scaling = scm::math::length(model_matrix * scm::math::vec4f(1.0f, 0.f, 0.f, 0.f));
+    constants.error_scale_ = 2.0f * radius_scaling * camera.near_plane_value() * height_divided_by_top_minus_bottom;
+
+    //left, right, bottom, top, near, far
+    for (uint32_t plane = 0; plane < 6; ++plane) {
+        uint32_t row = plane / 2;
+        float sign = (plane % 2 == 0) ? 1.f : -1.f;
+        for (uint32_t col = 0; col < 4; ++col) {
+            constants.planes_[plane][col] = clip[col*4 + 3] + sign * clip[col*4 + row];
+        }
+    }
+
+    constants.valid_ = true;
+}
+
+void node_batch_evaluator::
+evaluate(const view_t view_id, const model_t model_id,
+         const node_t* node_ids, const size_t num_nodes,
+         float* view_depths, float* errors, uint8_t* classifications) const {
+
+    assert(model_id < columns_.size());
+    assert(view_id < constants_.size());
+    assert(model_id < constants_[view_id].size());
+
+    const bvh_columns& columns = columns_[model_id];
+    const view_model_constants& constants = constants_[view_id][model_id];
+
+    assert(constants.valid_);
+
+    size_t i = 0;
+
+#if defined(__AVX2__)
+
+    const __m256 r0 = _mm256_set1_ps(constants.depth_row_[0]);
+    const __m256 r1 = _mm256_set1_ps(constants.depth_row_[1]);
+    const __m256 r2 = _mm256_set1_ps(constants.depth_row_[2]);
+    const __m256 r3 = _mm256_set1_ps(constants.depth_row_[3]);
+    const __m256 error_scale = _mm256_set1_ps(constants.error_scale_);
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 zero = _mm256_setzero_ps();
+
+    for (; i + 8 <= num_nodes; i += 8) {
+        const __m256i idx = _mm256_loadu_si256((const __m256i*)(node_ids + i));
+
+        if (view_depths != nullptr || errors != nullptr) {
+            const __m256 cx = _mm256_i32gather_ps(columns.centroid_x_.data(), idx, 4);
+            const __m256 cy = _mm256_i32gather_ps(columns.centroid_y_.data(), idx, 4);
+            const __m256 cz = _mm256_i32gather_ps(columns.centroid_z_.data(), idx, 4);
+
+            const __m256 depth = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r0, cx), _mm256_mul_ps(r1, cy)),
+                                               _mm256_add_ps(_mm256_mul_ps(r2, cz), r3));
+
+            if (view_depths != nullptr) {
+                _mm256_storeu_ps(view_depths + i, depth);
+            }
+
+            if (errors != nullptr) {
+                const __m256 extent = _mm256_i32gather_ps(columns.avg_primitive_extent_.data(), idx, 4);
+                const __m256 error = _mm256_div_ps(_mm256_mul_ps(error_scale, extent), depth);
+                _mm256_storeu_ps(errors + i, _mm256_and_ps(error, abs_mask));
+            }
+        }
+
+        if (classifications != nullptr) {
+            const __m256 bmin[3] = {
+                _mm256_i32gather_ps(columns.min_x_.data(), idx, 4),
+                _mm256_i32gather_ps(columns.min_y_.data(), idx, 4),
+                _mm256_i32gather_ps(columns.min_z_.data(), idx, 4)};
+            const __m256 bmax[3] = {
+                _mm256_i32gather_ps(columns.max_x_.data(), idx, 4),
+                _mm256_i32gather_ps(columns.max_y_.data(), idx, 4),
+                _mm256_i32gather_ps(columns.max_z_.data(), idx, 4)};
+
+            __m256 outside = zero;
+            __m256 intersecting = zero;
+
+            for (uint32_t plane = 0; plane < 6; ++plane) {
+                const float* p = constants.planes_[plane];
+                __m256 dist_p = _mm256_set1_ps(p[3]);
+                __m256 dist_n = dist_p;
+
+                //the normal is the same for all nodes, so is the choice of p- and n-vertex
+                for (uint32_t axis = 0; axis < 3; ++axis) {
+                    const __m256 n = _mm256_set1_ps(p[axis]);
+                    const __m256& positive = p[axis] >= 0.f ? bmax[axis] : bmin[axis];
+                    const __m256& negative = p[axis] >= 0.f ? bmin[axis] : bmax[axis];
+                    dist_p = _mm256_add_ps(dist_p, _mm256_mul_ps(n, positive));
+                    dist_n = _mm256_add_ps(dist_n, _mm256_mul_ps(n, negative));
+                }
+
+                outside = _mm256_or_ps(outside, _mm256_cmp_ps(dist_p, zero, _CMP_LT_OQ));
+                intersecting = _mm256_or_ps(intersecting, _mm256_cmp_ps(dist_n, zero, _CMP_LT_OQ));
+            }
+
+            const int outside_bits = _mm256_movemask_ps(outside);
+            const int intersecting_bits = _mm256_movemask_ps(intersecting);
+
+            for (uint32_t lane = 0; lane < 8; ++lane) {
+                classifications[i + lane] = (outside_bits >> lane) & 1 ? OUTSIDE
+                                          : ((intersecting_bits >> lane) & 1 ? INTERSECTING : INSIDE);
+            }
+        }
+    }
+
+#elif defined(__SSE2__)
+
+    const __m128 r0 = _mm_set1_ps(constants.depth_row_[0]);
+    const __m128 r1 = _mm_set1_ps(constants.depth_row_[1]);
+    const __m128 r2 = _mm_set1_ps(constants.depth_row_[2]);
+    const __m128 r3 = _mm_set1_ps(constants.depth_row_[3]);
+    const __m128 error_scale = _mm_set1_ps(constants.error_scale_);
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 zero = _mm_setzero_ps();
+
+    for (; i + 4 <= num_nodes; i += 4) {
+        const node_t* ids = node_ids + i;
+
+        if (view_depths != nullptr || errors != nullptr) {
+            const __m128 cx = gather4(columns.centroid_x_.data(), ids);
+            const __m128 cy = gather4(columns.centroid_y_.data(), ids);
+            const __m128 cz = gather4(columns.centroid_z_.data(), ids);
+
+            const __m128 depth = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r0, cx), _mm_mul_ps(r1, cy)),
+                                            _mm_add_ps(_mm_mul_ps(r2, cz), r3));
+
+            if (view_depths != nullptr) {
+                _mm_storeu_ps(view_depths + i, depth);
+            }
+
+            if (errors != nullptr) {
+                const __m128 extent = gather4(columns.avg_primitive_extent_.data(), ids);
+                const __m128 error = _mm_div_ps(_mm_mul_ps(error_scale, extent), depth);
+                _mm_storeu_ps(errors + i, _mm_and_ps(error, abs_mask));
+            }
+        }
+
+        if (classifications != nullptr) {
+            const __m128 bmin[3] = {
+                gather4(columns.min_x_.data(), ids),
+                gather4(columns.min_y_.data(), ids),
+                gather4(columns.min_z_.data(), ids)};
+            const __m128 bmax[3] = {
+                gather4(columns.max_x_.data(), ids),
+                gather4(columns.max_y_.data(), ids),
+                gather4(columns.max_z_.data(), ids)};
+
+            __m128 outside = zero;
+            __m128 intersecting = zero;
+
+            for (uint32_t plane = 0; plane < 6; ++plane) {
+                const float* p = constants.planes_[plane];
+                __m128 dist_p = _mm_set1_ps(p[3]);
+                __m128 dist_n = dist_p;
+
+                for (uint32_t axis = 0; axis < 3; ++axis) {
+                    const __m128 n = _mm_set1_ps(p[axis]);
+                    const __m128& positive = p[axis] >= 0.f ? bmax[axis] : bmin[axis];
+                    const __m128& negative = p[axis] >= 0.f ? bmin[axis] : bmax[axis];
+                    dist_p = _mm_add_ps(dist_p, _mm_mul_ps(n, positive));
+                    dist_n = _mm_add_ps(dist_n, _mm_mul_ps(n, negative));
+                }
+
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(dist_p, zero));
+                intersecting = _mm_or_ps(intersecting, _mm_cmplt_ps(dist_n, zero));
+            }
+
+            const int outside_bits = _mm_movemask_ps(outside);
+            const int intersecting_bits = _mm_movemask_ps(intersecting);
+
+            for (uint32_t lane = 0; lane < 4; ++lane) {
+                classifications[i + lane] = (outside_bits >> lane) & 1 ? OUTSIDE
+                                          : ((intersecting_bits >> lane) & 1 ? INTERSECTING : INSIDE);
+            }
+        }
+    }
+
+#endif
+
+    //remainder
+    if (i < num_nodes) {
+        evaluate_scalar(columns, constants, node_ids + i, num_nodes - i,
+                        view_depths != nullptr ? view_depths + i : nullptr,
+                        errors != nullptr ? errors + i : nullptr,
+                        classifications != nullptr ? classifications + i : nullptr);
+    }
+}
+
+void node_batch_evaluator::
+evaluate_scalar(const bvh_columns& columns, const view_model_constants& constants,
+                const node_t* node_ids, const size_t num_nodes,
+                float* view_depths, float* errors, uint8_t* classifications) const {
+
+    for (size_t i = 0; i < num_nodes; ++i) {
+        node_t node_id = node_ids[i];
+
+        float depth = constants.depth_row_[0] * columns.centroid_x_[node_id]
+                    + constants.depth_row_[1] * columns.centroid_y_[node_id]
+                    + constants.depth_row_[2] * columns.centroid_z_[node_id]
+                    + constants.depth_row_[3];
+
+        if (view_depths != nullptr) {
+            view_depths[i] = depth;
+        }
+
+        if (errors != nullptr) {
+            errors[i] = std::abs(constants.error_scale_ * columns.avg_primitive_extent_[node_id] / depth);
+        }
+
+        if (classifications != nullptr) {
+            const float bmin[3] = {columns.min_x_[node_id], columns.min_y_[node_id], columns.min_z_[node_id]};
+            const float bmax[3] = {columns.max_x_[node_id], columns.max_y_[node_id], columns.max_z_[node_id]};
+
+            uint8_t result = INSIDE;
+
+            for (uint32_t plane = 0; plane < 6; ++plane) {
+                const float* p = constants.planes_[plane];
+                float dist_p = p[3];
+                float dist_n = p[3];
+
+                for (uint32_t axis = 0; axis < 3; ++axis) {
+                    dist_p += p[axis] * (p[axis] >= 0.f ? bmax[axis] : bmin[axis]);
+                    dist_n += p[axis] * (p[axis] >= 0.f ? bmin[axis] : bmax[axis]);
+                }
+
+                if (dist_p < 0.f) {
+                    result = OUTSIDE;
+                    break;
+                }
+                if (dist_n < 0.f) {
+                    result = INTERSECTING;
+                }
+            }
+
+            classifications[i] = result;
+        }
+    }
+}
+
+
+} // namespace ren
+
+} // namespace lamure
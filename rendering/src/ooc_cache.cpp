@@ -15,27 +15,40 @@ std::mutex ooc_cache::mutex_;
 bool ooc_cache::is_instanced_ = false;
 ooc_cache *ooc_cache::single_ = nullptr;
 
-ooc_cache::ooc_cache(const slot_t num_slots, Data_Provenance const &data_provenance) : cache(num_slots), maintenance_counter_(0)
+ooc_cache::ooc_cache(const slot_t num_slots, Data_Provenance const &data_provenance)
+    : cache(num_slots), maintenance_counter_(0), victim_cache_(nullptr), num_lookups_(0), num_lookup_hits_(0)
 {
     model_database *database = model_database::get_instance();
+    policy *policy = policy::get_instance();
+
+    if(policy->victim_cache_budget_in_mb() > 0)
+    {
+        victim_cache_ = new victim_cache(policy->victim_cache_budget_in_mb() * 1024 * 1024);
+    }
 
     size_t slot_size_provenance = database->get_primitives_per_node() * data_provenance.get_size_in_bytes();
 
     cache_data_ = new char[num_slots * database->get_slot_size()];
     cache_data_provenance_ = new char[num_slots * slot_size_provenance];
-    pool_ = new ooc_pool(LAMURE_CUT_UPDATE_NUM_LOADING_THREADS, database->get_slot_size(), slot_size_provenance, data_provenance);
+    pool_ = new ooc_pool(LAMURE_CUT_UPDATE_NUM_LOADING_THREADS, database->get_slot_size(), slot_size_provenance, data_provenance, victim_cache_);
 
 #ifdef LAMURE_ENABLE_INFO
     std::cout << "lamure: ooc-cache init (WITH PROVENANCE)" << std::endl;
 #endif
 }
 
-ooc_cache::ooc_cache(const slot_t num_slots) : cache(num_slots), maintenance_counter_(0)
+ooc_cache::ooc_cache(const slot_t num_slots) : cache(num_slots), maintenance_counter_(0), victim_cache_(nullptr), num_lookups_(0), num_lookup_hits_(0)
 {
     model_database *database = model_database::get_instance();
+    policy *policy = policy::get_instance();
+
+    if(policy->victim_cache_budget_in_mb() > 0)
+    {
+        victim_cache_ = new victim_cache(policy->victim_cache_budget_in_mb() * 1024 * 1024);
+    }
 
     cache_data_ = new char[num_slots * database->get_slot_size()];
-    pool_ = new ooc_pool(LAMURE_CUT_UPDATE_NUM_LOADING_THREADS, database->get_slot_size());
+    pool_ = new ooc_pool(LAMURE_CUT_UPDATE_NUM_LOADING_THREADS, database->get_slot_size(), victim_cache_);
 
 #ifdef LAMURE_ENABLE_INFO
     std::cout << "lamure: ooc-cache init (WITHOUT PROVENANCE)" << std::endl;
@@ -54,6 +67,12 @@ ooc_cache::~ooc_cache()
         pool_ = nullptr;
     }
 
+    if(victim_cache_ != nullptr)
+    {
+        delete victim_cache_;
+        victim_cache_ = nullptr;
+    }
+
     if(cache_data_ != nullptr)
     {
         delete[] cache_data_;
@@ -176,6 +195,31 @@ ooc_cache *ooc_cache::get_instance()
     }
 }
 
+void ooc_cache::reset_if_outdated()
+{
+    ooc_cache *outdated = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if(!is_instanced_)
+        {
+            return;
+        }
+
+        model_database *database = model_database::get_instance();
+        if(single_->index_->num_models() >= database->num_models() && single_->slot_size() >= database->get_slot_size())
+        {
+            return;
+        }
+
+        outdated = single_;
+    }
+
+    // the destructor takes the lock and clears is_instanced_
+    delete outdated;
+}
+
 void ooc_cache::register_node(const model_t model_id, const node_t node_id, const int32_t priority)
 {
     if(is_node_resident(model_id, node_id))
@@ -191,7 +235,7 @@ void ooc_cache::register_node(const model_t model_id, const node_t node_id, cons
     {
         Data_Provenance data_provenance;
         model_database *database = model_database::get_instance();
-        slot_t slot_id = index_->reserve_slot();
+        slot_t slot_id = reserve_slot();
         cache_queue::job job(model_id, node_id, slot_id, priority, cache_data_ + slot_id * slot_size(),
                              cache_data_provenance_ + slot_id * database->get_primitives_per_node() * data_provenance.get_size_in_bytes());
         if(!pool_->acknowledge_request(job))
@@ -215,6 +259,71 @@ void ooc_cache::register_node(const model_t model_id, const node_t node_id, cons
     }
 }
 
+const slot_t ooc_cache::reserve_slot()
+{
+    model_t evicted_model_id = invalid_model_t;
+    node_t evicted_node_id = invalid_node_t;
+    slot_t slot_id = index_->reserve_slot(evicted_model_id, evicted_node_id);
+
+    // the slot still holds the evicted node until the loader overwrites it
+    if(victim_cache_ != nullptr && evicted_node_id != invalid_node_t)
+    {
+        model_database *database = model_database::get_instance();
+        victim_cache_->insert(evicted_model_id, evicted_node_id, cache_data_ + slot_id * slot_size(), database->get_node_size(evicted_model_id));
+    }
+
+    return slot_id;
+}
+
+const bool ooc_cache::lookup_node(const model_t model_id, const node_t node_id)
+{
+    bool resident = is_node_resident(model_id, node_id);
+
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    ++num_lookups_;
+    if(resident)
+    {
+        ++num_lookup_hits_;
+    }
+
+    return resident;
+}
+
+const bool ooc_cache::prefetch_node(const model_t model_id, const node_t node_id, const int32_t priority)
+{
+    if(is_node_resident(model_id, node_id))
+    {
+        return false;
+    }
+
+    // a waiting request keeps its priority, prefetching must not demote demand loads
+    if(pool_->acknowledge_query(model_id, node_id) != cache_queue::query_result::NOT_INDEXED)
+    {
+        return false;
+    }
+
+    if(index_->num_free_slots() == 0)
+    {
+        return false;
+    }
+
+    Data_Provenance data_provenance;
+    model_database *database = model_database::get_instance();
+    slot_t slot_id = reserve_slot();
+    cache_queue::job job(model_id, node_id, slot_id, priority, cache_data_ + slot_id * slot_size(),
+                         cache_data_provenance_ + slot_id * database->get_primitives_per_node() * data_provenance.get_size_in_bytes());
+
+    index_->mark_prefetched(slot_id);
+
+    if(!pool_->acknowledge_request(job))
+    {
+        index_->unreserve_slot(slot_id);
+        return false;
+    }
+
+    return true;
+}
+
 char *ooc_cache::node_data(const model_t model_id, const node_t node_id) { 
     return cache_data_ + index_->get_slot(model_id, node_id) * slot_size(); 
 }
@@ -263,6 +372,46 @@ void ooc_cache::begin_measure() { pool_->begin_measure(); }
 
 void ooc_cache::end_measure() { pool_->end_measure(); }
 
+const cache_index::prefetch_statistics ooc_cache::get_prefetch_statistics() { return index_->get_prefetch_statistics(); }
+
+void ooc_cache::reset_prefetch_statistics() { index_->reset_prefetch_statistics(); }
+
+const ooc_cache::tier_statistics ooc_cache::get_tier_statistics()
+{
+    tier_statistics statistics;
+
+    {
+        std::lock_guard<std::mutex> lock(statistics_mutex_);
+        statistics.num_lookups_ = num_lookups_;
+        statistics.num_lookup_hits_ = num_lookup_hits_;
+    }
+
+    statistics.loads_ = pool_->get_load_statistics();
+
+    if(victim_cache_ != nullptr)
+    {
+        statistics.victim_cache_ = victim_cache_->get_statistics();
+    }
+
+    return statistics;
+}
+
+void ooc_cache::reset_tier_statistics()
+{
+    {
+        std::lock_guard<std::mutex> lock(statistics_mutex_);
+        num_lookups_ = 0;
+        num_lookup_hits_ = 0;
+    }
+
+    pool_->reset_load_statistics();
+
+    if(victim_cache_ != nullptr)
+    {
+        victim_cache_->reset_statistics();
+    }
+}
+
 } // namespace ren
 
 } // namespace lamure
@@ -11,7 +11,8 @@ namespace lamure
 {
 namespace ren
 {
-ooc_pool::ooc_pool(const uint32_t num_threads, const size_t size_of_slot_in_bytes) : locked_(false), size_of_slot_(size_of_slot_in_bytes), num_threads_(num_threads), shutdown_(false), bytes_loaded_(0)
+ooc_pool::ooc_pool(const uint32_t num_threads, const size_t size_of_slot_in_bytes, victim_cache *victim_cache)
+    : locked_(false), size_of_slot_(size_of_slot_in_bytes), num_threads_(num_threads), shutdown_(false), bytes_loaded_(0), victim_cache_(victim_cache)
 {
     assert(num_threads_ > 0);
 
@@ -29,8 +30,10 @@ ooc_pool::ooc_pool(const uint32_t num_threads, const size_t size_of_slot_in_byte
     }
 }
 
-ooc_pool::ooc_pool(const uint32_t num_threads, const size_t size_of_slot_in_bytes, const size_t size_of_slot_provenance, Data_Provenance const &data_provenance)
-    : locked_(false), size_of_slot_(size_of_slot_in_bytes), size_of_slot_provenance_(size_of_slot_provenance), num_threads_(num_threads), shutdown_(false), bytes_loaded_(0)
+ooc_pool::ooc_pool(const uint32_t num_threads, const size_t size_of_slot_in_bytes, const size_t size_of_slot_provenance, Data_Provenance const &data_provenance,
+                   victim_cache *victim_cache)
+    : locked_(false), size_of_slot_(size_of_slot_in_bytes), size_of_slot_provenance_(size_of_slot_provenance), num_threads_(num_threads), shutdown_(false), bytes_loaded_(0),
+      victim_cache_(victim_cache)
 {
     assert(num_threads_ > 0);
 
@@ -97,6 +100,18 @@ void ooc_pool::end_measure()
     std::cout << "megabytes loaded: " << bytes_loaded_ / 1024 / 1024 << std::endl;
 }
 
+const ooc_pool::load_statistics ooc_pool::get_load_statistics()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return load_statistics_;
+}
+
+void ooc_pool::reset_load_statistics()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    load_statistics_ = load_statistics();
+}
+
 void ooc_pool::run()
 {
     model_database *database = model_database::get_instance();
@@ -147,15 +162,37 @@ void ooc_pool::run()
             size_t stride_in_bytes = database->get_node_size(job.model_id_);
             size_t offset_in_bytes = job.node_id_ * stride_in_bytes;
 
-            lod_stream access;
-            access.open(lod_files[job.model_id_]);
-            access.read(local_cache, offset_in_bytes, stride_in_bytes);
-            access.close();
+            bool from_victim_cache = victim_cache_ != nullptr && victim_cache_->fetch(job.model_id_, job.node_id_, local_cache, stride_in_bytes);
+
+            if(!from_victim_cache)
+            {
+                lod_stream access;
+                access.open(lod_files[job.model_id_]);
+                access.read(local_cache, offset_in_bytes, stride_in_bytes);
+                access.close();
+            }
 
             std::lock_guard<std::mutex> lock(mutex_);
-            bytes_loaded_ += stride_in_bytes;
+
+            if(from_victim_cache)
+            {
+                ++load_statistics_.num_victim_cache_loads_;
+                load_statistics_.bytes_read_from_victim_cache_ += stride_in_bytes;
+            }
+            else
+            {
+                ++load_statistics_.num_disk_loads_;
+                load_statistics_.bytes_read_from_disk_ += stride_in_bytes;
+                bytes_loaded_ += stride_in_bytes;
+            }
 
             memcpy(job.slot_mem_, local_cache, stride_in_bytes);
+            // models with fewer primitives per node leave the rest of the slot unused,
+            // clear it instead of keeping the primitives of the node evicted before
+            if(stride_in_bytes < size_of_slot_)
+            {
+                memset(job.slot_mem_ + stride_in_bytes, 0, size_of_slot_ - stride_in_bytes);
+            }
 
             history_.push_back(job);
 
@@ -0,0 +1,292 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/ren/ooc_ray_query.h>
+#include <lamure/ren/model_database.h>
+#include <lamure/ren/ooc_cache.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace lamure
+{
+namespace ren
+{
+ooc_ray_query::ooc_ray_query(const std::string &bvh_filename)
+    : bvh_(nullptr), owns_bvh_(true), model_id_(invalid_model_t), node_size_(0), node_budget_(1024)
+{
+    bvh_ = new bvh(bvh_filename);
+    open_lod_file();
+}
+
+ooc_ray_query::ooc_ray_query(const model_t model_id)
+    : bvh_(nullptr), owns_bvh_(false), model_id_(model_id), node_size_(0), node_budget_(1024)
+{
+    model_database *database = model_database::get_instance();
+    if(model_id >= database->num_models())
+    {
+        throw std::runtime_error("lamure: ooc_ray_query::Model was not found: " + std::to_string(model_id));
+    }
+
+    bvh_ = database->get_model(model_id)->get_bvh();
+    open_lod_file();
+}
+
+ooc_ray_query::~ooc_ray_query()
+{
+    lod_stream_.close();
+
+    if(owns_bvh_ && bvh_ != nullptr)
+    {
+        delete bvh_;
+        bvh_ = nullptr;
+    }
+}
+
+void ooc_ray_query::open_lod_file()
+{
+    if(bvh_->get_primitive() != bvh::primitive_type::POINTCLOUD)
+    {
+        throw std::runtime_error("lamure: ooc_ray_query::Only uncompressed point clouds are supported: " + bvh_->get_filename());
+    }
+
+    // same naming as the ooc_pool uses to find the .lod file of a .bvh file
+    std::string bvh_filename = bvh_->get_filename();
+    std::string base_name = bvh_filename.substr(0, bvh_filename.find_last_of(".") + 1);
+    std::string file_extension = bvh_filename.substr(base_name.size());
+    std::string bvh_suffix = file_extension.substr(3);
+
+    lod_stream_.open(base_name + "lod" + bvh_suffix);
+    node_size_ = sizeof(dataset::serialized_surfel) * bvh_->get_primitives_per_node();
+}
+
+void ooc_ray_query::set_node_budget(const size_t num_nodes)
+{
+    node_budget_ = std::max((size_t)1, num_nodes);
+
+    while(lru_nodes_.size() > node_budget_)
+    {
+        node_data_.erase(lru_nodes_.back());
+        lru_nodes_.pop_back();
+    }
+}
+
+const dataset::serialized_surfel *ooc_ray_query::get_node_data(const node_t node_id)
+{
+    auto node_it = node_data_.find(node_id);
+    if(node_it != node_data_.end())
+    {
+        lru_nodes_.splice(lru_nodes_.begin(), lru_nodes_, node_it->second.second);
+        return (const dataset::serialized_surfel *)node_it->second.first.data();
+    }
+
+    while(lru_nodes_.size() >= node_budget_)
+    {
+        node_data_.erase(lru_nodes_.back());
+        lru_nodes_.pop_back();
+    }
+
+    lru_nodes_.push_front(node_id);
+    auto &entry = node_data_[node_id];
+    entry.first.resize(node_size_);
+    entry.second = lru_nodes_.begin();
+
+    bool from_ooc_cache = false;
+
+    if(model_id_ != invalid_model_t)
+    {
+        // copy instead of reading from disk if the renderer has the node anyway
+        ooc_cache *ooc_cache = ooc_cache::get_instance();
+        ooc_cache->lock_shared();
+
+        if(ooc_cache->is_node_resident_and_aquired(model_id_, node_id))
+        {
+            memcpy(entry.first.data(), ooc_cache->node_data(model_id_, node_id), node_size_);
+            from_ooc_cache = true;
+        }
+
+        ooc_cache->unlock_shared();
+    }
+
+    if(from_ooc_cache)
+    {
+        ++statistics_.num_nodes_from_ooc_cache_;
+    }
+    else
+    {
+        lod_stream_.read(entry.first.data(), node_id * node_size_, node_size_);
+        ++statistics_.num_nodes_read_;
+        statistics_.bytes_read_ += node_size_;
+    }
+
+    return (const dataset::serialized_surfel *)entry.first.data();
+}
+
+void ooc_ray_query::collect_candidates(const scm::math::vec3f &origin, const scm::math::vec3f &direction, const float max_distance, const uint32_t target_depth,
+                                       std::vector<candidate> &candidates)
+{
+    node_t num_nodes = bvh_->get_num_nodes();
+    uint32_t fan_factor = bvh_->get_fan_factor();
+
+    std::vector<std::pair<node_t, uint32_t>> stack;
+    stack.push_back(std::make_pair(0, 0));
+
+    while(!stack.empty())
+    {
+        node_t node_id = stack.back().first;
+        uint32_t depth = stack.back().second;
+        stack.pop_back();
+
+        ++statistics_.num_nodes_tested_;
+
+        float t_min = 0.f;
+        if(!intersect_aabb(bvh_->get_bounding_boxes()[node_id], origin, direction, t_min) || t_min > max_distance)
+        {
+            continue;
+        }
+
+        node_t first_child_id = bvh_->get_child_id(node_id, 0);
+
+        if(depth >= target_depth || first_child_id >= num_nodes)
+        {
+            if(bvh_->get_visibility(node_id) != bvh::node_visibility::NODE_INVISIBLE)
+            {
+                candidates.push_back({node_id, t_min});
+            }
+            continue;
+        }
+
+        for(uint32_t i = 0; i < fan_factor; ++i)
+        {
+            if(first_child_id + i < num_nodes)
+            {
+                stack.push_back(std::make_pair(first_child_id + i, depth + 1));
+            }
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const candidate &a, const candidate &b) { return a.t_min_ < b.t_min_; });
+}
+
+const bool ooc_ray_query::intersect(const ray &r, const scm::math::mat4f &model_transform, const uint32_t max_depth, ray::intersection &intersection)
+{
+    ++statistics_.num_queries_;
+
+    scm::math::mat4f inverse_model_transform = scm::math::inverse(model_transform);
+    scm::math::vec3f object_ray_origin = inverse_model_transform * r.origin();
+    scm::math::vec3f object_ray_aux = inverse_model_transform * (r.origin() + r.direction() * r.max_distance());
+    scm::math::vec3f object_ray_direction = object_ray_aux - object_ray_origin;
+    float object_ray_max_distance = scm::math::length(object_ray_direction);
+    object_ray_direction = scm::math::normalize(object_ray_direction);
+
+    uint32_t target_depth = (max_depth == 0 || max_depth > bvh_->get_depth()) ? bvh_->get_depth() : max_depth;
+
+    std::vector<candidate> candidates;
+    collect_candidates(object_ray_origin, object_ray_direction, object_ray_max_distance, target_depth, candidates);
+
+    uint32_t num_surfels_per_node = bvh_->get_primitives_per_node();
+
+    float best_t = std::numeric_limits<float>::max();
+    bool has_hit = false;
+    dataset::serialized_surfel best_surfel;
+
+    for(const auto &current : candidates)
+    {
+        // nodes are sorted by entry distance, nothing behind the closest hit can be closer
+        if(current.t_min_ > best_t)
+        {
+            break;
+        }
+
+        const dataset::serialized_surfel *surfels = get_node_data(current.node_id_);
+
+        for(uint32_t k = 0; k < num_surfels_per_node; ++k)
+        {
+            const dataset::serialized_surfel &surfel = surfels[k];
+
+            if(surfel.size <= std::numeric_limits<float>::min())
+            {
+                continue;
+            }
+
+            float t = -1.f;
+            if(!ray::intersect_surfel(surfel, object_ray_origin, object_ray_direction, t) || t != t || t <= 0.f || t > object_ray_max_distance || t >= best_t)
+            {
+                continue;
+            }
+
+            scm::math::vec3f plane_intersection = object_ray_origin + object_ray_direction * t;
+            if(scm::math::length(plane_intersection - scm::math::vec3f(surfel.x, surfel.y, surfel.z)) > surfel.size)
+            {
+                continue;
+            }
+
+            // the node data may be evicted by the next read, keep a copy
+            best_t = t;
+            best_surfel = surfel;
+            has_hit = true;
+        }
+    }
+
+    if(!has_hit)
+    {
+        return false;
+    }
+
+    scm::math::vec3f splat_position = model_transform * scm::math::vec3f(best_surfel.x, best_surfel.y, best_surfel.z);
+
+    intersection.position_ = model_transform * (object_ray_origin + object_ray_direction * best_t);
+    intersection.distance_ = scm::math::length(intersection.position_ - r.origin());
+    intersection.error_raw_ = scm::math::length(splat_position - intersection.position_);
+    intersection.error_ = intersection.error_raw_;
+
+    scm::math::mat4f normal_transform = scm::math::transpose(inverse_model_transform);
+    intersection.normal_ = scm::math::normalize(normal_transform * scm::math::vec3f(best_surfel.nx, best_surfel.ny, best_surfel.nz));
+    if(scm::math::dot(intersection.normal_, r.direction()) > 0.f)
+    {
+        intersection.normal_ *= -1.f;
+    }
+
+    return true;
+}
+
+const size_t ooc_ray_query::intersect(const std::vector<ray> &rays, const scm::math::mat4f &model_transform, const uint32_t max_depth, std::vector<ray::intersection> &intersections)
+{
+    intersections.assign(rays.size(), ray::intersection());
+
+    size_t num_hits = 0;
+    for(size_t i = 0; i < rays.size(); ++i)
+    {
+        if(intersect(rays[i], model_transform, max_depth, intersections[i]))
+        {
+            ++num_hits;
+        }
+    }
+
+    return num_hits;
+}
+
+const bool ooc_ray_query::intersect_aabb(const scm::gl::boxf &bb, const scm::math::vec3f &origin, const scm::math::vec3f &direction, float &t_min)
+{
+    scm::math::vec3f t1 = ((bb.min_vertex() - origin) / direction);
+    scm::math::vec3f t2 = ((bb.max_vertex() - origin) / direction);
+
+    float tmin = std::max(std::max(std::min(t1.x, t2.x), std::min(t1.y, t2.y)), std::min(t1.z, t2.z));
+    float tmax = std::min(std::min(std::max(t1.x, t2.x), std::max(t1.y, t2.y)), std::max(t1.z, t2.z));
+
+    if(tmax >= 0.f && tmax >= tmin)
+    {
+        t_min = tmin;
+        return true;
+    }
+
+    return false;
+}
+}
+}
@@ -25,7 +25,14 @@ policy()
   max_upload_budget_in_mb_(LAMURE_DEFAULT_UPLOAD_BUDGET),
   render_budget_in_mb_(LAMURE_DEFAULT_VIDEO_MEMORY_BUDGET),
   out_of_core_budget_in_mb_(LAMURE_DEFAULT_MAIN_MEMORY_BUDGET),
+  victim_cache_budget_in_mb_(LAMURE_DEFAULT_VICTIM_CACHE_BUDGET),
   size_of_provenance_(LAMURE_DEFAULT_SIZE_OF_PROVENANCE),
+  num_cut_update_threads_(LAMURE_CUT_UPDATE_NUM_CUT_UPDATE_THREADS),
+  min_nodes_per_cut_analysis_chunk_(LAMURE_CUT_UPDATE_MIN_NODES_PER_ANALYSIS_CHUNK),
+  cut_update_deadline_in_ms_(LAMURE_CUT_UPDATE_DEFAULT_DEADLINE_IN_MS),
+  enable_predictive_prefetching_(false),
+  prefetch_budget_in_mb_(LAMURE_CUT_UPDATE_DEFAULT_PREFETCH_BUDGET),
+  prefetch_horizon_in_ms_(LAMURE_CUT_UPDATE_DEFAULT_PREFETCH_HORIZON_IN_MS),
   window_width_(800),
   window_height_(600) {
 
@@ -6,6 +6,7 @@
 // http://www.uni-weimar.de/medien/vr
 
 #include <lamure/ren/ray.h>
+#include <lamure/ren/ray_query_service.h>
 
 namespace lamure
 {
@@ -70,74 +71,26 @@ const bool ray::intersect(const float aabb_scale, scm::math::vec3f &ray_up_vecto
         best_errors.push_back(std::numeric_limits<float>::max());
     }
 
-    model_database *database = model_database::get_instance();
     ooc_cache *ooc_cache = ooc_cache::get_instance();
 
     ooc_cache->lock();
     ooc_cache->refresh();
+    ooc_cache->unlock();
 
-    ray_queue job_queue;
-    for(unsigned int i = 0; i < num_rays; ++i)
-    {
-        job_queue.push_job(ray_queue::ray_job(i, rays[i]));
-    }
-
-    unsigned int num_threads = 16;
-
-    std::vector<std::thread> threads;
-    for(unsigned int i = 0; i < num_threads; ++i)
-    {
-        threads.push_back(std::thread([&] {
-
-            while(true)
-            {
-                job_queue.wait();
-
-                if(job_queue.is_shutdown())
-                {
-                    break;
-                }
-
-                ray_queue::ray_job job = job_queue.pop_job();
-
-                if(job.id_ >= 0)
-                {
-                    ray &ray = rays[job.id_];
-                    ray::intersection temp;
-                    for(model_t model_id = 0; model_id < database->num_models(); ++model_id)
-                    {
-                        const scm::math::mat4f &model_transform = database->get_model(model_id)->transform();
-                        if(ray.intersect_model_unsafe(model_id, model_transform, aabb_scale, max_depth, surfel_skip, false, temp))
-                        {
-                            if(temp.error_ < best_errors[job.id_])
-                            {
-                                best_errors[job.id_] = temp.error_;
-                                intersections[job.id_] = temp;
-                            }
-                        }
-                    }
-                }
-            }
-
-        }));
-    }
+    // the bundle is traced by the persistent workers of the query service
+    ray_query_service::query_parameters parameters;
+    parameters.aabb_scale_ = aabb_scale;
+    parameters.max_depth_ = max_depth;
+    parameters.surfel_skip_ = surfel_skip;
+    parameters.is_wysiwyg_ = false;
 
-    for(auto &thread : threads)
-    {
-        thread.join();
-    }
+    unsigned int num_rays_hit = (unsigned int)ray_query_service::get_instance()->intersect(rays, parameters, intersections);
 
-    unsigned int num_rays_hit = 0;
-    for(const auto &error : best_errors)
+    for(unsigned int i = 0; i < num_rays; ++i)
     {
-        if(error < std::numeric_limits<float>::max())
-        {
-            ++num_rays_hit;
-        }
+        best_errors[i] = intersections[i].error_;
     }
 
-    ooc_cache->unlock();
-
     if(num_rays_hit > num_rays / 4)
     {
         // fit the plane
@@ -0,0 +1,434 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/ren/ray_query_service.h>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace lamure
+{
+namespace ren
+{
+std::mutex ray_query_service::instance_mutex_;
+ray_query_service *ray_query_service::single_ = nullptr;
+
+ray_query_service::ray_query_service(const uint32_t num_threads)
+    : num_threads_(std::max(1u, num_threads)), shutdown_(false), batch_active_(false), batch_counter_(0), num_active_workers_(0), num_finished_packets_(0), rays_(nullptr),
+      intersections_(nullptr), num_packets_(0), next_packet_(0)
+{
+    // the calling thread takes part in every batch
+    for(uint32_t i = 1; i < num_threads_; ++i)
+    {
+        threads_.push_back(std::thread(&ray_query_service::run, this));
+    }
+}
+
+ray_query_service::~ray_query_service()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    work_signal_.notify_all();
+
+    for(auto &thread : threads_)
+    {
+        if(thread.joinable())
+        {
+            thread.join();
+        }
+    }
+}
+
+ray_query_service *ray_query_service::get_instance()
+{
+    std::lock_guard<std::mutex> lock(instance_mutex_);
+
+    if(single_ == nullptr)
+    {
+        single_ = new ray_query_service(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    return single_;
+}
+
+const size_t ray_query_service::intersect(const std::vector<ray> &rays, const query_parameters &parameters, std::vector<ray::intersection> &intersections)
+{
+    std::lock_guard<std::mutex> batch_lock(batch_mutex_);
+
+    intersections.assign(rays.size(), ray::intersection());
+
+    if(rays.empty())
+    {
+        return 0;
+    }
+
+    ooc_cache *ooc_cache = ooc_cache::get_instance();
+    ooc_cache->lock_shared();
+
+    rays_ = &rays;
+    intersections_ = &intersections;
+    parameters_ = parameters;
+    num_packets_ = (rays.size() + packet_size - 1) / packet_size;
+    next_packet_ = 0;
+
+    if(num_packets_ == 1 || threads_.empty())
+    {
+        // waking workers costs more than a single packet
+        process_packets();
+    }
+    else
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            num_finished_packets_ = 0;
+            batch_active_ = true;
+            ++batch_counter_;
+        }
+        work_signal_.notify_all();
+
+        size_t num_processed = process_packets();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        num_finished_packets_ += num_processed;
+
+        // no worker may touch the batch once the call returned
+        done_signal_.wait(lock, [this] { return num_finished_packets_ == num_packets_ && num_active_workers_ == 0; });
+        batch_active_ = false;
+    }
+
+    ooc_cache->unlock_shared();
+
+    size_t num_hits = 0;
+    for(const auto &intersection : intersections)
+    {
+        if(intersection.error_ < std::numeric_limits<float>::max())
+        {
+            ++num_hits;
+        }
+    }
+
+    return num_hits;
+}
+
+void ray_query_service::run()
+{
+    uint64_t last_batch = 0;
+
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_signal_.wait(lock, [&] { return shutdown_ || (batch_active_ && batch_counter_ != last_batch); });
+
+            if(shutdown_)
+            {
+                break;
+            }
+
+            last_batch = batch_counter_;
+            ++num_active_workers_;
+        }
+
+        size_t num_processed = process_packets();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            num_finished_packets_ += num_processed;
+            --num_active_workers_;
+        }
+        done_signal_.notify_all();
+    }
+}
+
+const size_t ray_query_service::process_packets()
+{
+    size_t num_processed = 0;
+
+    while(true)
+    {
+        size_t packet_id = next_packet_.fetch_add(1);
+
+        if(packet_id >= num_packets_)
+        {
+            break;
+        }
+
+        intersect_packet(packet_id);
+        ++num_processed;
+    }
+
+    return num_processed;
+}
+
+void ray_query_service::intersect_packet(const size_t packet_id)
+{
+    model_database *database = model_database::get_instance();
+
+    size_t first_ray = packet_id * packet_size;
+    uint32_t num_rays = (uint32_t)std::min((size_t)packet_size, rays_->size() - first_ray);
+
+    // intersections keep the best hit over all models
+    for(model_t model_id = 0; model_id < database->num_models(); ++model_id)
+    {
+        intersect_packet_model(model_id, rays_->data() + first_ray, num_rays, intersections_->data() + first_ray);
+    }
+}
+
+void ray_query_service::intersect_packet_model(const model_t model_id, const ray *rays, const uint32_t num_rays, ray::intersection *intersections) const
+{
+    model_database *database = model_database::get_instance();
+    ooc_cache *ooc_cache = ooc_cache::get_instance();
+
+    const bvh *tree = database->get_model(model_id)->get_bvh();
+    if(tree->get_primitive() != bvh::primitive_type::POINTCLOUD)
+    {
+        return;
+    }
+
+    // check if model has started loading, otherwise we cant do nothin
+    if(!ooc_cache->is_node_resident_and_aquired(model_id, 0))
+    {
+        return;
+    }
+
+    const scm::math::mat4f &model_transform = database->get_model(model_id)->transform();
+    scm::math::mat4f inverse_model_transform = scm::math::inverse(model_transform);
+    scm::math::mat4f normal_transform = scm::math::transpose(inverse_model_transform);
+
+    packet_ray object_rays[packet_size];
+    for(uint32_t i = 0; i < num_rays; ++i)
+    {
+        const ray &r = rays[i];
+        packet_ray &object_ray = object_rays[i];
+
+        object_ray.origin_ = inverse_model_transform * r.origin();
+        scm::math::vec3f object_ray_aux = inverse_model_transform * (r.origin() + r.direction() * r.max_distance());
+        object_ray.direction_ = object_ray_aux - object_ray.origin_;
+        object_ray.max_distance_ = scm::math::length(object_ray.direction_);
+        object_ray.direction_ = scm::math::normalize(object_ray.direction_);
+        object_ray.inv_direction_ = scm::math::vec3f(1.f / object_ray.direction_.x, 1.f / object_ray.direction_.y, 1.f / object_ray.direction_.z);
+        object_ray.object_to_world_scale_ = r.max_distance() / object_ray.max_distance_;
+    }
+
+    unsigned int fan_factor = tree->get_fan_factor();
+    node_t num_nodes = tree->get_num_nodes();
+    unsigned int valid_max_depth = parameters_.max_depth_ == 0 ? 255 : parameters_.max_depth_;
+
+    const uint32_t all_rays = (1u << num_rays) - 1u;
+    uint32_t hit_mask = 0;
+
+    stack_entry candidates[max_stack_size];
+    uint32_t num_candidates = 0;
+    candidates[num_candidates++] = {0, all_rays};
+
+    while(num_candidates > 0)
+    {
+        stack_entry current = candidates[--num_candidates];
+        node_t current_parent_id = current.node_id_;
+
+        bool no_child_available = true;
+
+        for(node_t i = 0; i < (node_t)fan_factor; ++i)
+        {
+            node_t node_id = tree->get_child_id(current_parent_id, i);
+
+            if(node_id == invalid_node_t || node_id >= num_nodes)
+            {
+                continue;
+            }
+
+            if(!ooc_cache->is_node_resident_and_aquired(model_id, node_id))
+            {
+                continue;
+            }
+
+            no_child_available = false;
+
+            uint32_t node_mask = intersect_aabb_packet(tree->get_bounding_boxes()[node_id], object_rays, current.ray_mask_, true);
+            if(node_mask == 0)
+            {
+                continue;
+            }
+
+            bool all_children_in_memory = true;
+            for(node_t k = 0; k < fan_factor; ++k)
+            {
+                node_t child_id = tree->get_child_id(node_id, k);
+                if(child_id == invalid_node_t || child_id >= num_nodes || !ooc_cache->is_node_resident_and_aquired(model_id, child_id))
+                {
+                    all_children_in_memory = false;
+                    break;
+                }
+            }
+
+            uint32_t splat_mask = node_mask;
+            uint32_t descend_mask = 0;
+
+            if(all_children_in_memory)
+            {
+                // rays that hit one of the children descend, the others intersect the splats of this node
+                uint32_t child_mask = 0;
+                for(node_t k = 0; k < fan_factor; ++k)
+                {
+                    child_mask |= intersect_aabb_packet(tree->get_bounding_boxes()[tree->get_child_id(node_id, k)], object_rays, node_mask, false);
+                }
+
+                if(tree->get_depth_of_node(node_id) + 1 < valid_max_depth)
+                {
+                    descend_mask = child_mask;
+                    splat_mask = node_mask & ~child_mask;
+                }
+            }
+
+            if(descend_mask != 0)
+            {
+                if(num_candidates < max_stack_size)
+                {
+                    candidates[num_candidates++] = {node_id, descend_mask};
+                }
+                else
+                {
+                    splat_mask |= descend_mask;
+                }
+            }
+
+            if(splat_mask != 0 && tree->get_visibility(node_id) != bvh::node_visibility::NODE_INVISIBLE)
+            {
+                hit_mask |= intersect_splats(model_id, node_id, model_transform, normal_transform, rays, object_rays, splat_mask, intersections);
+            }
+        }
+
+        // fix: no node other than root in ram
+        if(no_child_available && current_parent_id == 0)
+        {
+            uint32_t root_mask = current.ray_mask_ & ~hit_mask;
+            if(root_mask != 0)
+            {
+                hit_mask |= intersect_splats(model_id, 0, model_transform, normal_transform, rays, object_rays, root_mask, intersections);
+            }
+        }
+    }
+}
+
+const uint32_t ray_query_service::intersect_aabb_packet(const scm::gl::boxf &bb, const packet_ray *rays, const uint32_t ray_mask, const bool check_distance)
+{
+    // the box is loaded once and tested against all active rays of the packet
+    const scm::math::vec3f &min_vertex = bb.min_vertex();
+    const scm::math::vec3f &max_vertex = bb.max_vertex();
+
+    uint32_t result = 0;
+
+    for(uint32_t i = 0; i < packet_size; ++i)
+    {
+        if((ray_mask & (1u << i)) == 0)
+        {
+            continue;
+        }
+
+        const packet_ray &r = rays[i];
+
+        float tx1 = (min_vertex.x - r.origin_.x) * r.inv_direction_.x;
+        float tx2 = (max_vertex.x - r.origin_.x) * r.inv_direction_.x;
+        float ty1 = (min_vertex.y - r.origin_.y) * r.inv_direction_.y;
+        float ty2 = (max_vertex.y - r.origin_.y) * r.inv_direction_.y;
+        float tz1 = (min_vertex.z - r.origin_.z) * r.inv_direction_.z;
+        float tz2 = (max_vertex.z - r.origin_.z) * r.inv_direction_.z;
+
+        float tmin = std::max(std::max(std::min(tx1, tx2), std::min(ty1, ty2)), std::min(tz1, tz2));
+        float tmax = std::min(std::min(std::max(tx1, tx2), std::max(ty1, ty2)), std::max(tz1, tz2));
+
+        if(tmax >= 0.f && tmax >= tmin && (!check_distance || tmin <= r.max_distance_))
+        {
+            result |= 1u << i;
+        }
+    }
+
+    return result;
+}
+
+const uint32_t ray_query_service::intersect_splats(const model_t model_id, const node_t node_id, const scm::math::mat4f &model_transform, const scm::math::mat4f &normal_transform,
+                                                   const ray *rays, const packet_ray *object_rays, const uint32_t ray_mask, ray::intersection *intersections) const
+{
+    ooc_cache *ooc_cache = ooc_cache::get_instance();
+    uint32_t num_surfels_per_node = model_database::get_instance()->get_primitives_per_node();
+    unsigned int valid_surfel_skip = parameters_.surfel_skip_ == 0 ? 1 : parameters_.surfel_skip_;
+
+    const float max_intersection_error = 6.f;
+    uint32_t hit_mask = 0;
+
+    const dataset::serialized_surfel *surfels = (const dataset::serialized_surfel *)ooc_cache->node_data(model_id, node_id);
+
+    for(unsigned int k = 0; k < num_surfels_per_node; k += valid_surfel_skip)
+    {
+        const dataset::serialized_surfel &surfel = surfels[k];
+
+        if(surfel.size <= std::numeric_limits<float>::min())
+        {
+            continue;
+        }
+
+        scm::math::vec3f splat_position = model_transform * scm::math::vec3f(surfel.x, surfel.y, surfel.z);
+
+        for(uint32_t i = 0; i < packet_size; ++i)
+        {
+            if((ray_mask & (1u << i)) == 0)
+            {
+                continue;
+            }
+
+            const ray &r = rays[i];
+            const packet_ray &object_ray = object_rays[i];
+
+            float ts = -1.f;
+            if(!ray::intersect_surfel(surfel, object_ray.origin_, object_ray.direction_, ts) || ts != ts || ts <= 0.f)
+            {
+                continue;
+            }
+
+            scm::math::vec3f splat_plane_intersection = r.origin() + r.direction() * ts * object_ray.object_to_world_scale_;
+            float splat_plane_distance = scm::math::length(splat_position - splat_plane_intersection);
+
+            if(scm::math::length(splat_position - r.origin()) >= r.max_distance())
+            {
+                continue;
+            }
+
+            if(parameters_.is_wysiwyg_ && splat_plane_distance > object_ray.object_to_world_scale_ * surfel.size * LAMURE_WYSIWYG_SPLAT_SCALE)
+            {
+                continue;
+            }
+
+            float intersection_distance = scm::math::length(splat_plane_intersection - r.origin());
+            float error = 0.01f * intersection_distance + splat_plane_distance;
+
+            ray::intersection &intersection = intersections[i];
+            if(error < intersection.error_ && error < max_intersection_error)
+            {
+                intersection.error_ = error;
+                intersection.error_raw_ = splat_plane_distance;
+                intersection.distance_ = intersection_distance;
+                intersection.position_ = splat_plane_intersection;
+
+                scm::math::vec3f plane_normal = normal_transform * scm::math::vec3f(surfel.nx, surfel.ny, surfel.nz);
+                intersection.normal_ = scm::math::normalize(plane_normal);
+                if(scm::math::dot(intersection.normal_, r.direction()) > 0.f)
+                {
+                    intersection.normal_ *= -1.f;
+                }
+
+                hit_mask |= 1u << i;
+            }
+        }
+    }
+
+    return hit_mask;
+}
+}
+}
@@ -0,0 +1,638 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/ren/spatial_query.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+#if !WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace lamure
+{
+namespace ren
+{
+spatial_query::spatial_query(const std::string &bvh_filename, const uint32_t num_threads)
+    : bvh_(nullptr), node_size_(0), num_surfels_per_node_(0), num_threads_(num_threads), shutdown_(false), batch_active_(false), batch_counter_(0), num_active_workers_(0),
+      num_finished_nodes_(0), num_nodes_(0), nearest_bound_sq_(std::numeric_limits<float>::max()), next_node_(0)
+{
+    bvh_ = new bvh(bvh_filename);
+
+    if(bvh_->get_primitive() != bvh::primitive_type::POINTCLOUD)
+    {
+        delete bvh_;
+        throw std::runtime_error("lamure: spatial_query::Only uncompressed point clouds are supported: " + bvh_filename);
+    }
+
+    num_surfels_per_node_ = bvh_->get_primitives_per_node();
+    node_size_ = sizeof(dataset::serialized_surfel) * num_surfels_per_node_;
+
+    // same naming as the ooc_pool uses to find the .lod file of a .bvh file
+    std::string base_name = bvh_filename.substr(0, bvh_filename.find_last_of(".") + 1);
+    std::string file_extension = bvh_filename.substr(base_name.size());
+    std::string lod_filename = base_name + "lod" + file_extension.substr(3);
+
+#if WIN32
+    try
+    {
+        lod_stream_.open(lod_filename);
+    }
+    catch(const std::runtime_error &)
+    {
+        delete bvh_;
+        throw;
+    }
+#else
+    lod_file_descriptor_ = open(lod_filename.c_str(), O_RDONLY);
+    if(lod_file_descriptor_ < 0)
+    {
+        delete bvh_;
+        throw std::runtime_error("lamure: spatial_query::Unable to open file: " + lod_filename);
+    }
+#endif
+
+    if(num_threads_ == 0)
+    {
+        num_threads_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    worker_data_.resize(num_threads_);
+
+    // the calling thread takes part in every query as worker 0
+    for(uint32_t worker_id = 1; worker_id < num_threads_; ++worker_id)
+    {
+        threads_.push_back(std::thread(&spatial_query::run, this, worker_id));
+    }
+}
+
+spatial_query::~spatial_query()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    work_signal_.notify_all();
+
+    for(auto &thread : threads_)
+    {
+        if(thread.joinable())
+        {
+            thread.join();
+        }
+    }
+
+#if WIN32
+    lod_stream_.close();
+#else
+    close(lod_file_descriptor_);
+#endif
+
+    delete bvh_;
+    bvh_ = nullptr;
+}
+
+const size_t spatial_query::query_box(const scm::gl::boxf &box, const float max_error, std::vector<dataset::serialized_surfel> &surfels)
+{
+    std::lock_guard<std::mutex> query_lock(query_mutex_);
+
+    query_.type_ = QUERY_BOX;
+    query_.box_ = box;
+
+    select_nodes(max_error);
+    return query_range(surfels);
+}
+
+const size_t spatial_query::query_sphere(const scm::math::vec3f &center, const float radius, const float max_error, std::vector<dataset::serialized_surfel> &surfels)
+{
+    std::lock_guard<std::mutex> query_lock(query_mutex_);
+
+    query_.type_ = QUERY_SPHERE;
+    query_.center_ = center;
+    query_.radius_sq_ = radius * radius;
+
+    select_nodes(max_error);
+    return query_range(surfels);
+}
+
+const size_t spatial_query::query_frustum(const scm::math::mat4f &view_projection, const float max_error, std::vector<dataset::serialized_surfel> &surfels)
+{
+    std::lock_guard<std::mutex> query_lock(query_mutex_);
+
+    query_.type_ = QUERY_FRUSTUM;
+    query_.view_projection_ = view_projection;
+    query_.frustum_ = scm::gl::frustum(view_projection);
+
+    select_nodes(max_error);
+    return query_range(surfels);
+}
+
+const size_t spatial_query::query_nearest(const scm::math::vec3f &point, const uint32_t k, const float max_error, std::vector<dataset::serialized_surfel> &surfels)
+{
+    std::lock_guard<std::mutex> query_lock(query_mutex_);
+
+    ++statistics_.num_queries_;
+    surfels.clear();
+
+    if(k == 0)
+    {
+        return 0;
+    }
+
+    query_.type_ = QUERY_NEAREST;
+    query_.center_ = point;
+    query_.k_ = k;
+
+    // max-heap of the k closest surfels found so far
+    std::vector<ranked_surfel> nearest;
+    float bound_sq = std::numeric_limits<float>::max();
+
+    // best-first traversal, nodes closest to the point first
+    typedef std::pair<float, node_t> queue_entry;
+    std::priority_queue<queue_entry, std::vector<queue_entry>, std::greater<queue_entry>> node_queue;
+    node_queue.push(std::make_pair(0.f, 0));
+
+    // read a few nodes per worker at once, the bound only tightens between waves
+    const size_t wave_size = 2 * num_threads_;
+
+    while(!node_queue.empty())
+    {
+        selected_nodes_.clear();
+
+        while(!node_queue.empty() && selected_nodes_.size() < wave_size)
+        {
+            queue_entry entry = node_queue.top();
+            node_queue.pop();
+
+            if(entry.first > bound_sq)
+            {
+                // everything left in the queue is farther away
+                std::priority_queue<queue_entry, std::vector<queue_entry>, std::greater<queue_entry>>().swap(node_queue);
+                break;
+            }
+
+            node_t node_id = entry.second;
+            ++statistics_.num_nodes_tested_;
+
+            if(bvh_->get_visibility(node_id) == bvh::node_visibility::NODE_INVISIBLE)
+            {
+                continue;
+            }
+
+            if(is_cut_node(node_id, max_error))
+            {
+                selected_nodes_.push_back({node_id, false, entry.first});
+                continue;
+            }
+
+            node_t first_child_id = bvh_->get_child_id(node_id, 0);
+            for(uint32_t i = 0; i < bvh_->get_fan_factor(); ++i)
+            {
+                node_t child_id = first_child_id + i;
+                bool contained = false;
+                float distance_sq = 0.f;
+                if(child_id < bvh_->get_num_nodes() && classify_box(bvh_->get_bounding_boxes()[child_id], contained, distance_sq) && distance_sq <= bound_sq)
+                {
+                    node_queue.push(std::make_pair(distance_sq, child_id));
+                }
+            }
+        }
+
+        if(selected_nodes_.empty())
+        {
+            continue;
+        }
+
+        nearest_bound_sq_ = nearest.size() < k ? std::numeric_limits<float>::max() : bound_sq;
+        for(auto &data : worker_data_)
+        {
+            data.nearest_.clear();
+        }
+
+        execute(selected_nodes_.size());
+
+        for(const auto &data : worker_data_)
+        {
+            for(const auto &candidate : data.nearest_)
+            {
+                if(nearest.size() < k)
+                {
+                    nearest.push_back(candidate);
+                    std::push_heap(nearest.begin(), nearest.end());
+                }
+                else if(candidate.distance_sq_ < nearest.front().distance_sq_)
+                {
+                    std::pop_heap(nearest.begin(), nearest.end());
+                    nearest.back() = candidate;
+                    std::push_heap(nearest.begin(), nearest.end());
+                }
+            }
+        }
+
+        if(nearest.size() == k)
+        {
+            bound_sq = nearest.front().distance_sq_;
+        }
+    }
+
+    std::sort_heap(nearest.begin(), nearest.end());
+
+    surfels.reserve(nearest.size());
+    for(const auto &candidate : nearest)
+    {
+        surfels.push_back(candidate.surfel_);
+    }
+
+    statistics_.num_surfels_returned_ += surfels.size();
+    return surfels.size();
+}
+
+const size_t spatial_query::query_range(std::vector<dataset::serialized_surfel> &surfels)
+{
+    ++statistics_.num_queries_;
+
+    if(node_results_.size() < selected_nodes_.size())
+    {
+        node_results_.resize(selected_nodes_.size());
+    }
+
+    execute(selected_nodes_.size());
+
+    // concatenate in traversal order, independent of the thread that read a node
+    size_t num_surfels = 0;
+    for(size_t i = 0; i < selected_nodes_.size(); ++i)
+    {
+        num_surfels += node_results_[i].size();
+    }
+
+    surfels.clear();
+    surfels.reserve(num_surfels);
+    for(size_t i = 0; i < selected_nodes_.size(); ++i)
+    {
+        surfels.insert(surfels.end(), node_results_[i].begin(), node_results_[i].end());
+    }
+
+    statistics_.num_surfels_returned_ += num_surfels;
+    return num_surfels;
+}
+
+void spatial_query::select_nodes(const float max_error)
+{
+    selected_nodes_.clear();
+
+    std::vector<node_t> stack;
+    stack.push_back(0);
+
+    while(!stack.empty())
+    {
+        node_t node_id = stack.back();
+        stack.pop_back();
+
+        ++statistics_.num_nodes_tested_;
+
+        bool contained = false;
+        float distance_sq = 0.f;
+        if(bvh_->get_visibility(node_id) == bvh::node_visibility::NODE_INVISIBLE || !classify_box(bvh_->get_bounding_boxes()[node_id], contained, distance_sq))
+        {
+            continue;
+        }
+
+        if(is_cut_node(node_id, max_error))
+        {
+            selected_nodes_.push_back({node_id, contained, distance_sq});
+            continue;
+        }
+
+        // reversed, so that nodes are selected in order of their ids
+        node_t first_child_id = bvh_->get_child_id(node_id, 0);
+        for(uint32_t i = bvh_->get_fan_factor(); i > 0; --i)
+        {
+            if(first_child_id + i - 1 < bvh_->get_num_nodes())
+            {
+                stack.push_back(first_child_id + i - 1);
+            }
+        }
+    }
+}
+
+const bool spatial_query::is_cut_node(const node_t node_id, const float max_error) const
+{
+    if(bvh_->get_child_id(node_id, 0) >= bvh_->get_num_nodes())
+    {
+        return true;
+    }
+
+    return max_error > 0.f && bvh_->get_avg_primitive_extent(node_id) <= max_error;
+}
+
+const bool spatial_query::classify_box(const scm::gl::boxf &box, bool &contained, float &distance_sq) const
+{
+    const scm::math::vec3f &min_vertex = box.min_vertex();
+    const scm::math::vec3f &max_vertex = box.max_vertex();
+
+    contained = false;
+    distance_sq = 0.f;
+
+    switch(query_.type_)
+    {
+    case QUERY_BOX:
+    {
+        const scm::math::vec3f &query_min = query_.box_.min_vertex();
+        const scm::math::vec3f &query_max = query_.box_.max_vertex();
+
+        for(uint32_t axis = 0; axis < 3; ++axis)
+        {
+            if(max_vertex[axis] < query_min[axis] || min_vertex[axis] > query_max[axis])
+            {
+                return false;
+            }
+        }
+
+        contained = true;
+        for(uint32_t axis = 0; axis < 3; ++axis)
+        {
+            contained = contained && min_vertex[axis] >= query_min[axis] && max_vertex[axis] <= query_max[axis];
+        }
+        return true;
+    }
+    case QUERY_SPHERE:
+    case QUERY_NEAREST:
+    {
+        float max_distance_sq = 0.f;
+        for(uint32_t axis = 0; axis < 3; ++axis)
+        {
+            float near_distance = std::max(0.f, std::max(min_vertex[axis] - query_.center_[axis], query_.center_[axis] - max_vertex[axis]));
+            float far_distance = std::max(std::abs(query_.center_[axis] - min_vertex[axis]), std::abs(query_.center_[axis] - max_vertex[axis]));
+            distance_sq += near_distance * near_distance;
+            max_distance_sq += far_distance * far_distance;
+        }
+
+        if(query_.type_ == QUERY_NEAREST)
+        {
+            return true;
+        }
+
+        contained = max_distance_sq <= query_.radius_sq_;
+        return distance_sq <= query_.radius_sq_;
+    }
+    case QUERY_FRUSTUM:
+    {
+        scm::gl::frustum::classification_result result = query_.frustum_.classify(box);
+        contained = result == scm::gl::frustum::inside;
+        return result != scm::gl::frustum::outside;
+    }
+    }
+
+    return false;
+}
+
+const bool spatial_query::test_surfel(const dataset::serialized_surfel &surfel, float &distance_sq) const
+{
+    switch(query_.type_)
+    {
+    case QUERY_BOX:
+    {
+        const scm::math::vec3f &query_min = query_.box_.min_vertex();
+        const scm::math::vec3f &query_max = query_.box_.max_vertex();
+        return surfel.x >= query_min.x && surfel.x <= query_max.x && surfel.y >= query_min.y && surfel.y <= query_max.y && surfel.z >= query_min.z && surfel.z <= query_max.z;
+    }
+    case QUERY_SPHERE:
+    case QUERY_NEAREST:
+    {
+        float dx = surfel.x - query_.center_.x;
+        float dy = surfel.y - query_.center_.y;
+        float dz = surfel.z - query_.center_.z;
+        distance_sq = dx * dx + dy * dy + dz * dz;
+        return query_.type_ == QUERY_NEAREST || distance_sq <= query_.radius_sq_;
+    }
+    case QUERY_FRUSTUM:
+    {
+        scm::math::vec4f clip = query_.view_projection_ * scm::math::vec4f(surfel.x, surfel.y, surfel.z, 1.f);
+        return clip.w > 0.f && std::abs(clip.x) <= clip.w && std::abs(clip.y) <= clip.w && std::abs(clip.z) <= clip.w;
+    }
+    }
+
+    return false;
+}
+
+void spatial_query::execute(const size_t num_nodes)
+{
+    num_nodes_ = num_nodes;
+    next_node_ = 0;
+    error_ = nullptr;
+
+    for(auto &data : worker_data_)
+    {
+        data.num_nodes_read_ = 0;
+    }
+
+    if(num_nodes <= 1 || threads_.empty())
+    {
+        // waking workers costs more than a single node
+        process_nodes(0);
+    }
+    else
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            num_finished_nodes_ = 0;
+            batch_active_ = true;
+            ++batch_counter_;
+        }
+        work_signal_.notify_all();
+
+        size_t num_processed = process_nodes(0);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        num_finished_nodes_ += num_processed;
+
+        // no worker may touch the node list once the call returned
+        done_signal_.wait(lock, [this] { return num_finished_nodes_ == num_nodes_ && num_active_workers_ == 0; });
+        batch_active_ = false;
+    }
+
+    for(const auto &data : worker_data_)
+    {
+        statistics_.num_nodes_read_ += data.num_nodes_read_;
+        statistics_.bytes_read_ += data.num_nodes_read_ * node_size_;
+    }
+
+    if(error_)
+    {
+        std::rethrow_exception(error_);
+    }
+}
+
+void spatial_query::run(const uint32_t worker_id)
+{
+    uint64_t last_batch = 0;
+
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_signal_.wait(lock, [&] { return shutdown_ || (batch_active_ && batch_counter_ != last_batch); });
+
+            if(shutdown_)
+            {
+                break;
+            }
+
+            last_batch = batch_counter_;
+            ++num_active_workers_;
+        }
+
+        size_t num_processed = process_nodes(worker_id);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            num_finished_nodes_ += num_processed;
+            --num_active_workers_;
+        }
+        done_signal_.notify_all();
+    }
+}
+
+const size_t spatial_query::process_nodes(const uint32_t worker_id)
+{
+    size_t num_processed = 0;
+
+    while(true)
+    {
+        size_t node_index = next_node_.fetch_add(1);
+
+        if(node_index >= num_nodes_)
+        {
+            break;
+        }
+
+        try
+        {
+            process_node(worker_id, node_index);
+        }
+        catch(...)
+        {
+            // rethrown by execute() on the calling thread, the remaining nodes are still counted
+            std::lock_guard<std::mutex> lock(mutex_);
+            if(!error_)
+            {
+                error_ = std::current_exception();
+            }
+        }
+        ++num_processed;
+    }
+
+    return num_processed;
+}
+
+void spatial_query::process_node(const uint32_t worker_id, const size_t node_index)
+{
+    worker_data &data = worker_data_[worker_id];
+    const selected_node &node = selected_nodes_[node_index];
+
+    bool is_nearest = query_.type_ == QUERY_NEAREST;
+    uint32_t k = query_.k_;
+
+    if(is_nearest && node.distance_sq_ > nearest_bound_sq_)
+    {
+        return;
+    }
+
+    data.node_buffer_.resize(node_size_);
+    read_node(node.node_id_, data.node_buffer_.data());
+    ++data.num_nodes_read_;
+
+    const dataset::serialized_surfel *surfels = (const dataset::serialized_surfel *)data.node_buffer_.data();
+
+    if(!is_nearest)
+    {
+        std::vector<dataset::serialized_surfel> &results = node_results_[node_index];
+        results.clear();
+
+        for(uint32_t i = 0; i < num_surfels_per_node_; ++i)
+        {
+            const dataset::serialized_surfel &surfel = surfels[i];
+
+            // nodes are padded with empty surfels
+            if(surfel.size <= std::numeric_limits<float>::min())
+            {
+                continue;
+            }
+
+            float distance_sq = 0.f;
+            if(node.contained_ || test_surfel(surfel, distance_sq))
+            {
+                results.push_back(surfel);
+            }
+        }
+        return;
+    }
+
+    std::vector<ranked_surfel> &nearest = data.nearest_;
+
+    for(uint32_t i = 0; i < num_surfels_per_node_; ++i)
+    {
+        const dataset::serialized_surfel &surfel = surfels[i];
+
+        if(surfel.size <= std::numeric_limits<float>::min())
+        {
+            continue;
+        }
+
+        float distance_sq = 0.f;
+        test_surfel(surfel, distance_sq);
+
+        if(distance_sq > nearest_bound_sq_)
+        {
+            continue;
+        }
+
+        if(nearest.size() < k)
+        {
+            nearest.push_back({distance_sq, surfel});
+            std::push_heap(nearest.begin(), nearest.end());
+        }
+        else if(distance_sq < nearest.front().distance_sq_)
+        {
+            std::pop_heap(nearest.begin(), nearest.end());
+            nearest.back() = {distance_sq, surfel};
+            std::push_heap(nearest.begin(), nearest.end());
+        }
+    }
+}
+
+void spatial_query::read_node(const node_t node_id, char *data) const
+{
+    size_t offset = (size_t)node_id * node_size_;
+
+#if WIN32
+    std::lock_guard<std::mutex> lock(stream_mutex_);
+    lod_stream_.read(data, offset, node_size_);
+#else
+    size_t num_bytes_read = 0;
+    while(num_bytes_read < node_size_)
+    {
+        ssize_t result = pread(lod_file_descriptor_, data + num_bytes_read, node_size_ - num_bytes_read, offset + num_bytes_read);
+        if(result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(result <= 0)
+        {
+            throw std::runtime_error("lamure: spatial_query::Unable to read node: " + std::to_string(node_id));
+        }
+        num_bytes_read += (size_t)result;
+    }
+#endif
+}
+}
+}
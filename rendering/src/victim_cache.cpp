@@ -0,0 +1,263 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/ren/victim_cache.h>
+
+#include <cstring>
+#include <zlib.h>
+
+namespace lamure
+{
+
+namespace ren
+{
+
+victim_cache::
+victim_cache(const size_t budget_in_bytes)
+: shutdown_(false),
+  budget_in_bytes_(budget_in_bytes),
+  used_bytes_(0),
+  generation_(0) {
+
+    thread_ = std::thread(&victim_cache::run, this);
+}
+
+victim_cache::
+~victim_cache() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    signal_.notify_all();
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void victim_cache::
+insert(const model_t model_id, const node_t node_id, const char* data, const size_t size_in_bytes) {
+    if (size_in_bytes > budget_in_bytes_) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        uint64_t k = key(model_id, node_id);
+
+        auto it = entries_.find(k);
+        if (it != entries_.end()) {
+            used_bytes_ -= it->second.data_.size();
+            statistics_.uncompressed_bytes_ -= it->second.size_in_bytes_;
+            lru_.erase(it->second.lru_it_);
+            entries_.erase(it);
+        }
+
+        //the raw copy is held until the compression thread replaces it
+        entry& e = entries_[k];
+        e.data_.assign(data, data + size_in_bytes);
+        e.size_in_bytes_ = size_in_bytes;
+        e.compressed_ = false;
+        e.generation_ = ++generation_;
+        e.lru_it_ = lru_.insert(lru_.end(), k);
+
+        used_bytes_ += size_in_bytes;
+        statistics_.uncompressed_bytes_ += size_in_bytes;
+        ++statistics_.num_inserted_;
+
+        pending_.push_back(std::make_pair(k, e.generation_));
+
+        evict_to_budget();
+    }
+
+    signal_.notify_one();
+}
+
+const bool victim_cache::
+fetch(const model_t model_id, const node_t node_id, char* data, const size_t size_in_bytes) {
+    entry e;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto it = entries_.find(key(model_id, node_id));
+        if (it == entries_.end() || it->second.size_in_bytes_ != size_in_bytes) {
+            ++statistics_.num_misses_;
+            return false;
+        }
+
+        e.data_.swap(it->second.data_);
+        e.size_in_bytes_ = it->second.size_in_bytes_;
+        e.compressed_ = it->second.compressed_;
+
+        used_bytes_ -= e.data_.size();
+        statistics_.uncompressed_bytes_ -= e.size_in_bytes_;
+        lru_.erase(it->second.lru_it_);
+        entries_.erase(it);
+    }
+
+    bool fetched = true;
+
+    if (!e.compressed_) {
+        memcpy(data, e.data_.data(), size_in_bytes);
+    }
+    else {
+        fetched = decompress(e.data_, data, size_in_bytes);
+    }
+
+    //a node that fails to decompress is read from disk like a miss
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fetched) {
+        ++statistics_.num_hits_;
+    }
+    else {
+        ++statistics_.num_misses_;
+    }
+
+    return fetched;
+}
+
+void victim_cache::
+evict_to_budget() {
+    while (used_bytes_ > budget_in_bytes_ && !lru_.empty()) {
+        auto it = entries_.find(lru_.front());
+        lru_.pop_front();
+
+        if (it != entries_.end()) {
+            used_bytes_ -= it->second.data_.size();
+            statistics_.uncompressed_bytes_ -= it->second.size_in_bytes_;
+            entries_.erase(it);
+            ++statistics_.num_evicted_;
+        }
+    }
+}
+
+void victim_cache::
+run() {
+    std::vector<char> raw;
+    std::vector<char> compressed;
+
+    while (true) {
+        std::pair<uint64_t, uint64_t> job;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            signal_.wait(lock, [this]{ return shutdown_ || !pending_.empty(); });
+
+            if (shutdown_) {
+                break;
+            }
+
+            job = pending_.front();
+            pending_.pop_front();
+
+            auto it = entries_.find(job.first);
+            if (it == entries_.end() || it->second.generation_ != job.second || it->second.compressed_) {
+                continue;
+            }
+
+            raw = it->second.data_;
+        }
+
+        if (!compress(raw.data(), raw.size(), compressed)) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        //the entry may have been fetched, evicted or replaced in the meantime
+        auto it = entries_.find(job.first);
+        if (it == entries_.end() || it->second.generation_ != job.second) {
+            continue;
+        }
+
+        used_bytes_ -= it->second.data_.size();
+        it->second.data_.assign(compressed.begin(), compressed.end());
+        it->second.compressed_ = true;
+        used_bytes_ += it->second.data_.size();
+    }
+}
+
+const victim_cache::statistics victim_cache::
+get_statistics() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    statistics s = statistics_;
+    s.num_entries_ = entries_.size();
+    s.stored_bytes_ = used_bytes_;
+    return s;
+}
+
+void victim_cache::
+reset_statistics() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    //occupancy is not reset
+    size_t uncompressed_bytes = statistics_.uncompressed_bytes_;
+    statistics_ = statistics();
+    statistics_.uncompressed_bytes_ = uncompressed_bytes;
+}
+
+const bool victim_cache::
+compress(const char* data, const size_t size_in_bytes, std::vector<char>& compressed) {
+    //node data is made of 32 bit attributes, grouping the i-th byte of
+    //all words gives the deflate stage long runs of similar exponent bytes
+    std::vector<char> shuffled(size_in_bytes);
+    size_t num_words = size_in_bytes / 4;
+    for (size_t b = 0; b < 4; ++b) {
+        for (size_t w = 0; w < num_words; ++w) {
+            shuffled[b * num_words + w] = data[w * 4 + b];
+        }
+    }
+    for (size_t i = num_words * 4; i < size_in_bytes; ++i) {
+        shuffled[i] = data[i];
+    }
+
+    uLongf compressed_size = compressBound((uLong)size_in_bytes);
+    compressed.resize(compressed_size);
+
+    if (compress2((Bytef*)compressed.data(), &compressed_size, (const Bytef*)shuffled.data(), (uLong)size_in_bytes, Z_BEST_SPEED) != Z_OK) {
+        return false;
+    }
+
+    //not worth keeping if it does not shrink
+    if (compressed_size >= size_in_bytes) {
+        return false;
+    }
+
+    compressed.resize(compressed_size);
+    return true;
+}
+
+const bool victim_cache::
+decompress(const std::vector<char>& compressed, char* data, const size_t size_in_bytes) {
+    std::vector<char> shuffled(size_in_bytes);
+
+    uLongf uncompressed_size = (uLongf)size_in_bytes;
+    if (uncompress((Bytef*)shuffled.data(), &uncompressed_size, (const Bytef*)compressed.data(), (uLong)compressed.size()) != Z_OK ||
+        uncompressed_size != size_in_bytes) {
+        return false;
+    }
+
+    size_t num_words = size_in_bytes / 4;
+    for (size_t b = 0; b < 4; ++b) {
+        for (size_t w = 0; w < num_words; ++w) {
+            data[w * 4 + b] = shuffled[b * num_words + w];
+        }
+    }
+    for (size_t i = num_words * 4; i < size_in_bytes; ++i) {
+        data[i] = shuffled[i];
+    }
+
+    return true;
+}
+
+
+} // namespace ren
+
+} // namespace lamure
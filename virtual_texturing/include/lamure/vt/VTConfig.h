@@ -27,6 +27,14 @@ class VTConfig
         R8
     };
 
+    // replacement policy of the RAM tile cache
+    enum CACHE_POLICY
+    {
+        FIFO,
+        CLOCK_PRO,
+        LEVEL
+    };
+
     static std::string CONFIG_PATH;
 
     static VTConfig& get_instance()
@@ -39,6 +47,7 @@ class VTConfig
     void operator=(VTConfig const&) = delete;
 
     static const FORMAT_TEXTURE which_texture_format(const char* _texture_format);
+    static const CACHE_POLICY which_cache_policy(const char* _cache_policy);
 
     uint16_t get_byte_stride() const;
 
@@ -53,11 +62,22 @@ class VTConfig
      * */
     void define_size_physical_texture(uint32_t max_tex_layers, uint32_t max_tex_px_width_gl);
 
+    // overrides of the configuration file, set them before define_size_physical_texture() and before the first use of CutDatabase
+    void set_size_physical_texture(uint32_t size_physical_texture);
+    void set_size_physical_update_throughput(uint32_t size_physical_update_throughput);
+    void set_size_ram_cache(uint32_t size_ram_cache);
+    void set_num_loader_threads(uint32_t num_loader_threads);
+    void set_cache_policy(CACHE_POLICY cache_policy);
+
     uint16_t get_size_tile() const;
     uint16_t get_size_padding() const;
     uint32_t get_size_physical_update_throughput() const;
 
     uint32_t get_size_ram_cache() const;
+    // 0 if not configured, one loader per core
+    uint32_t get_num_loader_threads() const;
+    // FIFO if not configured
+    CACHE_POLICY get_cache_policy() const;
 
     FORMAT_TEXTURE get_format_texture() const;
     bool is_verbose() const;
@@ -79,6 +99,12 @@ class VTConfig
     static constexpr const char* PHYSICAL_SIZE_MB = "PHYSICAL_SIZE_MB";
     static constexpr const char* PHYSICAL_UPDATE_THROUGHPUT_MB = "PHYSICAL_UPDATE_THROUGHPUT_MB";
     static constexpr const char* RAM_CACHE_SIZE_MB = "RAM_CACHE_SIZE_MB";
+    static constexpr const char* LOADER_THREADS = "LOADER_THREADS";
+
+    static constexpr const char* RAM_CACHE_POLICY = "RAM_CACHE_POLICY";
+    static constexpr const char* RAM_CACHE_POLICY_FIFO = "FIFO";
+    static constexpr const char* RAM_CACHE_POLICY_CLOCK_PRO = "CLOCK_PRO";
+    static constexpr const char* RAM_CACHE_POLICY_LEVEL = "LEVEL";
 
     static constexpr const char* TEXTURE_FORMAT = "TEXTURE_FORMAT";
     static constexpr const char* TEXTURE_FORMAT_RGBA8 = "RGBA8";
@@ -98,6 +124,8 @@ class VTConfig
     uint32_t _size_physical_texture;
     uint32_t _size_physical_update_throughput;
     uint32_t _size_ram_cache;
+    uint32_t _num_loader_threads;
+    VTConfig::CACHE_POLICY _cache_policy;
 
     VTConfig::FORMAT_TEXTURE _format_texture;
     bool _verbose;
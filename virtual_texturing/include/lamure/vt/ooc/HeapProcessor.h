@@ -10,10 +10,11 @@
 
 #include <atomic>
 #include <condition_variable>
-#include <lamure/vt/TileRequestPriorityQueue.h>
 #include <lamure/vt/ooc/TileCache.h>
 #include <lamure/vt/ooc/TileRequest.h>
+#include <lamure/vt/ooc/TileRequestHeap.h>
 #include <thread>
+#include <vector>
 
 namespace vt
 {
@@ -22,10 +23,11 @@ namespace ooc
 class HeapProcessor
 {
   protected:
-    TileRequestPriorityQueue<float> _requests_prio_queue;
+    TileRequestHeap _requests;
 
     std::atomic<bool> _running;
-    std::thread* _thread;
+    size_t _threadCount;
+    std::vector<std::thread> _threads;
 
     TileCache* _cache;
 
@@ -35,6 +37,14 @@ class HeapProcessor
 
     void request(TileRequest* request);
 
+    // reorders a queued request in place, lower priorities are ignored
+    void raisePriority(TileRequest* request, priority_type priority);
+
+    // all threads pop from the same priority queue, has to be set before start()
+    void setThreadCount(size_t threadCount);
+
+    size_t getThreadCount();
+
     void start();
 
     void run();
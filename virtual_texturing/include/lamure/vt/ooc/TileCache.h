@@ -8,14 +8,15 @@
 #ifndef VT_OOC_TILECACHE_H
 #define VT_OOC_TILECACHE_H
 
+#include <atomic>
 #include <condition_variable>
 #include <cstddef>
 #include <cstdint>
 #include <iostream>
+#include <lamure/vt/ooc/TileCachePolicy.h>
 #include <lamure/vt/pre/AtlasFile.h>
 #include <map>
 #include <mutex>
-#include <queue>
 
 namespace vt
 {
@@ -35,11 +36,11 @@ class TileCacheSlot
     };
 
   protected:
-    STATE _state;
+    std::atomic<STATE> _state;
     uint8_t* _buffer;
     size_t _size;
     size_t _id;
-    uint32_t _context_reference;
+    std::atomic<uint32_t> _context_reference;
 
     pre::AtlasFile* _resource;
     uint64_t _tileId;
@@ -52,6 +53,9 @@ class TileCacheSlot
 
     bool compareState(STATE state);
 
+    // atomically moves from expected to desired, false if the slot was not in the expected state
+    bool exchangeState(STATE expected, STATE desired);
+
     void setTileId(uint64_t tileId);
 
     uint64_t getTileId();
@@ -90,23 +94,40 @@ class TileCache
     size_t _tileByteSize;
     size_t _slotCount;
 
-    std::mutex* _locks;
     uint8_t* _buffer;
     slot_type* _slots;
 
-    std::mutex _lruLock;
-    std::condition_variable _lruRepopulationCV;
-    std::queue<TileCacheSlot*> _lru;
+    // slots neither read nor written
+    std::atomic<size_t> _availableCount;
+
+    // taken before _idsLock when both are needed
+    std::mutex _policyLock;
+    std::condition_variable _repopulationCV;
+    TileCachePolicy* _policy;
 
     std::mutex _idsLock;
     std::map<std::pair<pre::AtlasFile*, uint64_t>, slot_type*> _ids;
 
+    std::atomic<uint64_t> _hitCount;
+    std::atomic<uint64_t> _missCount;
+    std::atomic<uint64_t> _loadedCount;
+    std::atomic<uint64_t> _evictedCount;
+    std::atomic<uint64_t> _depletionCount;
+
   public:
-    TileCache(size_t tileByteSize, size_t slotCount);
+    TileCache(size_t tileByteSize, size_t slotCount, VTConfig::CACHE_POLICY policy = VTConfig::CACHE_POLICY::FIFO);
     ~TileCache();
 
     slot_type* requestSlotForReading(pre::AtlasFile* resource, uint64_t tile_id, uint16_t context_id);
     slot_type* requestSlotForWriting();
+    // returns a slot requested for writing that did not receive a tile
+    void releaseSlotForWriting(slot_type* slot);
+
+    // takes a free or unreferenced slot for writing, used by the policy while it holds the policy lock
+    bool claimSlot(slot_type* slot);
+
+    // true if the tile is resident, does not reference the slot
+    bool containsId(pre::AtlasFile* resource, uint64_t tile_id);
 
     void removeContextReferenceFromReadId(pre::AtlasFile* resource, uint64_t tile_id, uint16_t context_id);
 
@@ -115,6 +136,16 @@ class TileCache
 
     void waitUntilLRURepopulation(std::chrono::milliseconds maxTime = std::chrono::milliseconds::zero());
 
+    size_t getSlotCount();
+    size_t getResidentCount();
+    // reads served from and missed by the cache
+    uint64_t getHitCount();
+    uint64_t getMissCount();
+    // tiles made resident, resident tiles whose slot was reused, and slot requests failed because every slot was referenced
+    uint64_t getLoadedCount();
+    uint64_t getEvictedCount();
+    uint64_t getDepletionCount();
+
     void print();
 };
 } // namespace ooc
@@ -0,0 +1,147 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef VT_OOC_TILECACHEPOLICY_H
+#define VT_OOC_TILECACHEPOLICY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <lamure/vt/VTConfig.h>
+#include <lamure/vt/pre/AtlasFile.h>
+#include <map>
+#include <memory>
+#include <queue>
+#include <tuple>
+#include <vector>
+
+namespace vt
+{
+namespace ooc
+{
+class TileCache;
+class TileCacheSlot;
+
+/**
+ * Decides which slot of a TileCache is reused for the next loaded tile.
+ *
+ * The cache serializes all calls but accessed(), which is made by readers in parallel.
+ * Slots read or written by others are not evictable, evict() has to skip them.
+ * */
+class TileCachePolicy
+{
+  public:
+    static TileCachePolicy* create(VTConfig::CACHE_POLICY policy);
+
+    virtual ~TileCachePolicy() = default;
+
+    // all slots are free
+    virtual void init(TileCacheSlot* slots, size_t slotCount) = 0;
+
+    // slot holds a newly loaded tile
+    virtual void loaded(TileCacheSlot* slot) = 0;
+
+    // unreferenced resident slot was requested for reading
+    virtual void accessed(TileCacheSlot* slot) = 0;
+
+    // last context reference of a slot was removed
+    virtual void released(TileCacheSlot* slot) = 0;
+
+    // slot claimed for writing is free again without holding a tile
+    virtual void freed(TileCacheSlot* slot) = 0;
+
+    // returns a slot claimed for writing through TileCache::claimSlot(), nullptr if no slot could be claimed
+    virtual TileCacheSlot* evict(TileCache& cache) = 0;
+};
+
+// slots are reused in the order they were loaded or released
+class TileCacheFIFO : public TileCachePolicy
+{
+  protected:
+    std::queue<TileCacheSlot*> _queue;
+
+  public:
+    void init(TileCacheSlot* slots, size_t slotCount) override;
+    void loaded(TileCacheSlot* slot) override;
+    void accessed(TileCacheSlot* slot) override;
+    void released(TileCacheSlot* slot) override;
+    void freed(TileCacheSlot* slot) override;
+    TileCacheSlot* evict(TileCache& cache) override;
+};
+
+/**
+ * Single hand CLOCK-Pro. Slots are cold after loading and become hot when referenced again after their first use.
+ * If no cold slot is found the hot slots are demoted regardless of the target.
+ * Evicted cold tiles stay in a test period, a tile reloaded within it enters hot and enlarges the cold share,
+ * an expired test period shrinks it. One pass over a burst of new tiles only cycles the cold slots.
+ * */
+class TileCacheClockPro : public TileCachePolicy
+{
+  protected:
+    typedef std::pair<pre::AtlasFile*, uint64_t> key_type;
+
+    TileCacheSlot* _slots;
+    size_t _slotCount;
+    size_t _hand;
+
+    std::unique_ptr<std::atomic<bool>[]> _used;
+    std::unique_ptr<std::atomic<bool>[]> _referenced;
+    std::vector<bool> _hot;
+    size_t _hotCount;
+    size_t _coldTarget;
+
+    uint64_t _testSerial;
+    std::map<key_type, uint64_t> _test;
+    std::deque<std::pair<key_type, uint64_t>> _testOrder;
+
+    void startTest(const key_type& key);
+
+  public:
+    TileCacheClockPro();
+
+    void init(TileCacheSlot* slots, size_t slotCount) override;
+    void loaded(TileCacheSlot* slot) override;
+    void accessed(TileCacheSlot* slot) override;
+    void released(TileCacheSlot* slot) override;
+    void freed(TileCacheSlot* slot) override;
+    TileCacheSlot* evict(TileCache& cache) override;
+};
+
+/**
+ * GreedyDual with a cost doubling per level towards the root, the cost of a tile is the number of leaf tiles
+ * per axis it stands in for. Deep tiles age out first, the top levels are practically pinned.
+ * */
+class TileCacheLevel : public TileCachePolicy
+{
+  protected:
+    // priority, serial, slot id
+    typedef std::tuple<double, uint64_t, size_t> entry_type;
+
+    TileCacheSlot* _slots;
+    double _inflation;
+
+    std::vector<uint64_t> _serials;
+    std::priority_queue<entry_type, std::vector<entry_type>, std::greater<entry_type>> _heap;
+
+    void push(TileCacheSlot* slot, double cost);
+
+  public:
+    TileCacheLevel();
+
+    void init(TileCacheSlot* slots, size_t slotCount) override;
+    void loaded(TileCacheSlot* slot) override;
+    void accessed(TileCacheSlot* slot) override;
+    void released(TileCacheSlot* slot) override;
+    void freed(TileCacheSlot* slot) override;
+    TileCacheSlot* evict(TileCache& cache) override;
+};
+} // namespace ooc
+} // namespace vt
+
+#endif // VT_OOC_TILECACHEPOLICY_H
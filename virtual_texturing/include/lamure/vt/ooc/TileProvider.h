@@ -8,8 +8,11 @@
 #ifndef VT_OOC_TILEPROVIDER_H
 #define VT_OOC_TILEPROVIDER_H
 
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <fstream>
 #include <set>
 #include <lamure/vt/pre/AtlasFile.h>
 #include <lamure/vt/ooc/TileRequestMap.h>
@@ -23,6 +26,22 @@ namespace ooc
 typedef uint64_t id_type;
 typedef float priority_type;
 
+// counters accumulate from start(), resident tiles are counted at the time of the query
+struct TileStatistics
+{
+    // cache lookups of getTile()
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t requested = 0;
+    uint64_t loaded = 0;
+    uint64_t evicted = 0;
+    // requests dropped by a loader, because every cache slot was referenced ("LRU cache depletion reached.")
+    uint64_t depletions = 0;
+    uint64_t residentTiles = 0;
+    uint64_t cacheTiles = 0;
+    uint64_t tileByteSize = 0;
+};
+
 class TileProvider
 {
   protected:
@@ -39,12 +58,22 @@ class TileProvider
     size_t _tilePxHeight;
     size_t _tileByteSize;
 
+    std::atomic<uint64_t> _requestedCount;
+
+    std::mutex _traceLock;
+    std::ofstream _traceFile;
+    std::chrono::steady_clock::time_point _traceStart;
+
   public:
     TileProvider();
 
     ~TileProvider();
 
-    void start(size_t maxMemSize);
+    // loaderThreadCount 0 uses one loader per core
+    void start(size_t maxMemSize, size_t loaderThreadCount = 0, VTConfig::CACHE_POLICY cachePolicy = VTConfig::CACHE_POLICY::FIFO);
+
+    // writes one line "<time in ms> <tile id> <priority> <atlas file>" per new request
+    void recordRequests(const char* fileName);
 
     pre::AtlasFile* loadResource(const char* fileName);
 
@@ -56,6 +85,8 @@ class TileProvider
     void print();
 
     bool wait(std::chrono::milliseconds maxTime = std::chrono::milliseconds::zero());
+
+    TileStatistics getStatistics();
 };
 } // namespace ooc
 } // namespace vt
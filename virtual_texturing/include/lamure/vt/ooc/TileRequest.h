@@ -8,6 +8,8 @@
 #ifndef VT_OOC_TILEREQUEST_H
 #define VT_OOC_TILEREQUEST_H
 
+#include <cstddef>
+#include <cstdint>
 #include <lamure/vt/pre/AtlasFile.h>
 #include <lamure/vt/Observable.h>
 
@@ -16,17 +18,28 @@ namespace vt
 namespace ooc
 {
 typedef float priority_type;
+class TileRequestHeap;
 class TileRequest : public Observable
 {
+    friend class TileRequestHeap;
+
   protected:
     pre::AtlasFile* _resource;
     uint64_t _id;
     priority_type _priority;
     bool _aborted;
 
+    // position in the TileRequestHeap, NOT_QUEUED if not contained
+    size_t _heapIndex;
+
   public:
+    static const size_t NOT_QUEUED = SIZE_MAX;
+
     explicit TileRequest();
 
+    // prepares a processed request for reuse, observers are kept
+    void reset();
+
     void setResource(pre::AtlasFile* resource);
 
     pre::AtlasFile* getResource();
@@ -0,0 +1,51 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef VT_OOC_TILEREQUESTHEAP_H
+#define VT_OOC_TILEREQUESTHEAP_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+#include <lamure/vt/ooc/TileRequest.h>
+
+namespace vt
+{
+namespace ooc
+{
+// binary max-heap of pending requests. every request knows its position in the
+// heap, so raising its priority restores the order in place
+class TileRequestHeap
+{
+  protected:
+    std::mutex _lock;
+    std::condition_variable _newEntry;
+    std::vector<TileRequest*> _heap;
+
+    void _place(size_t index, TileRequest* request);
+    void _siftUp(size_t index);
+    void _siftDown(size_t index);
+
+  public:
+    TileRequestHeap();
+
+    void push(TileRequest* request);
+
+    // pops the request of highest priority
+    bool pop(TileRequest*& request, const std::chrono::milliseconds maxTime);
+
+    // lower priorities are ignored, requests which are not queued only store the new priority
+    void raisePriority(TileRequest* request, priority_type priority);
+
+    size_t size();
+};
+} // namespace ooc
+} // namespace vt
+
+#endif // VT_OOC_TILEREQUESTHEAP_H
@@ -8,33 +8,61 @@
 #ifndef VT_OOC_TILEREQUESTMAP_H
 #define VT_OOC_TILEREQUESTMAP_H
 
+#include <atomic>
+#include <chrono>
 #include <mutex>
 #include <condition_variable>
 #include <cstdint>
+#include <functional>
+#include <unordered_map>
 #include <lamure/vt/pre/AtlasFile.h>
+#include <lamure/vt/ooc/HeapProcessor.h>
 #include <lamure/vt/ooc/TileRequest.h>
+#include <lamure/vt/ooc/TileRequestPool.h>
 #include <lamure/vt/Observer.h>
 
 namespace vt
 {
 namespace ooc
 {
+// pending requests, split into shards with a lock each, so feedback threads
+// asking for different tiles rarely wait for each other
 class TileRequestMap : public Observer
 {
   protected:
-    std::map<std::pair<pre::AtlasFile*, uint64_t>, TileRequest*> _map;
-    std::mutex _mapLock;
+    typedef std::pair<pre::AtlasFile*, uint64_t> key_type;
 
+    struct KeyHash
+    {
+        size_t operator()(const key_type& key) const { return std::hash<pre::AtlasFile*>()(key.first) ^ (std::hash<uint64_t>()(key.second) * 0x9E3779B97F4A7C15ull); }
+    };
+
+    struct Shard
+    {
+        std::mutex lock;
+        std::unordered_map<key_type, TileRequest*, KeyHash> map;
+    };
+
+    static const size_t SHARD_COUNT = 16;
+
+    Shard _shards[SHARD_COUNT];
+    TileRequestPool _pool;
+
+    std::atomic<size_t> _size;
+    std::mutex _emptyLock;
     std::condition_variable _allRequestsProcessed;
 
+    Shard& _getShard(const key_type& key);
+
   public:
-    TileRequestMap();
+    explicit TileRequestMap(size_t capacity = 1 << 16);
 
     ~TileRequestMap();
 
-    TileRequest* getRequest(pre::AtlasFile* resource, uint64_t id);
-
-    bool insertRequest(TileRequest* req);
+    // queues a request at the processor unless the tile is already requested, in
+    // which case only its priority is raised. returns true if a request was queued.
+    // if all requests are in use, nothing is queued and the tile has to be asked for again
+    bool requestTile(pre::AtlasFile* resource, uint64_t id, priority_type priority, HeapProcessor& processor);
 
     void inform(event_type event, Observable* observable);
 
@@ -0,0 +1,47 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef VT_OOC_TILEREQUESTPOOL_H
+#define VT_OOC_TILEREQUESTPOOL_H
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+#include <lamure/vt/ooc/TileRequest.h>
+#include <lamure/vt/Observer.h>
+
+namespace vt
+{
+namespace ooc
+{
+// fixed number of requests allocated in one block. every request is observed by
+// the given observer once, so recycling a request does not allocate
+class TileRequestPool
+{
+  protected:
+    size_t _capacity;
+    TileRequest* _requests;
+
+    std::mutex _freeLock;
+    std::vector<TileRequest*> _free;
+
+  public:
+    TileRequestPool(size_t capacity, Observer* observer);
+
+    ~TileRequestPool();
+
+    // returns nullptr if all requests are in use
+    TileRequest* acquire();
+
+    void release(TileRequest* request);
+
+    size_t getCapacity();
+};
+} // namespace ooc
+} // namespace vt
+
+#endif // VT_OOC_TILEREQUESTPOOL_H
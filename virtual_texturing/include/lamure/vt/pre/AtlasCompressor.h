@@ -0,0 +1,29 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef TILE_PROVIDER_ATLASCOMPRESSOR_H
+#define TILE_PROVIDER_ATLASCOMPRESSOR_H
+
+#include <lamure/vt/pre/AtlasFile.h>
+#include <lamure/vt/pre/OffsetIndex.h>
+
+namespace vt
+{
+namespace pre
+{
+// writes a packed atlas as a compressed one. header and cielab index are taken over,
+// so the delta E is the one of the uncompressed tiles if it was calculated before
+class AtlasCompressor : public AtlasFile
+{
+  public:
+    explicit AtlasCompressor(const char* fileName);
+    void compress(const char* destFileName, size_t threadCount);
+};
+} // namespace pre
+} // namespace vt
+
+#endif // TILE_PROVIDER_ATLASCOMPRESSOR_H
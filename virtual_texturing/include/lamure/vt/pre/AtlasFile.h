@@ -11,6 +11,7 @@
 #include <cstdint>
 #include <fstream>
 #include <cstring>
+#include <mutex>
 #include <lamure/vt/pre/Bitmap.h>
 #include <lamure/vt/pre/QuadTree.h>
 #include <lamure/vt/pre/CielabIndex.h>
@@ -27,7 +28,9 @@ class AtlasFile
     enum LAYOUT
     {
         RAW = 1,
-        PACKED
+        PACKED,
+        // like PACKED, but every tile is encoded by TileCodec and of its own size
+        COMPRESSED
     };
 
     static constexpr size_t HEADER_SIZE = 71;
@@ -36,6 +39,13 @@ class AtlasFile
     const char* _fileName;
     std::ifstream _file;
 
+    // tiles are read with positional reads, so several loaders can share the file
+#ifdef _WIN32
+    std::mutex _fileLock;
+#else
+    int _fileDescriptor;
+#endif
+
     uint64_t _imageWidth;
     uint64_t _imageHeight;
     uint64_t _tileWidth;
@@ -95,7 +105,10 @@ class AtlasFile
 
     const char* getFileName();
 
+    // thread-safe, tiles of compressed atlases are decoded into out
     bool getTile(uint64_t id, uint8_t* out);
+    // count of bytes a tile occupies in the file
+    uint64_t getStoredTileByteSize(uint64_t id);
     float getCielabValue(uint64_t id);
     void extractLevel(uint32_t level, const char* fileName);
 };
@@ -45,9 +45,6 @@ class Bitmap
     bool _externData;
     uint8_t* _data;
 
-    static void _copyPixel(const uint8_t* const srcPx, PIXEL_FORMAT srcFormat, uint8_t* const destPx, PIXEL_FORMAT destFormat);
-    static void _deflatePixels(
-        const uint8_t* const srcPx0, const uint8_t* const srcPx1, const uint8_t* const srcPx2, const uint8_t* const srcPx3, PIXEL_FORMAT srcFormat, uint8_t* const destPx, PIXEL_FORMAT destFormat);
     static void
     _inflatePixel(const uint8_t* const srcPx, PIXEL_FORMAT srcFormat, uint8_t* const destPx0, uint8_t* const destPx1, uint8_t* const destPx2, uint8_t* const destPx3, PIXEL_FORMAT destFormat);
 
@@ -20,11 +20,13 @@ namespace vt
 {
 namespace pre
 {
+// compares every tile with the leaf tiles below it, the mean CIELAB distance is stored in the cielab index.
+// tiles are read with getTile, so compressed atlases are compared as decoded
 class DeltaECalculator : public AtlasFile
 {
   public:
     explicit DeltaECalculator(const char* fileName);
-    void calculate(size_t maxMemory);
+    void calculate(size_t maxMemory, size_t threadCount);
 };
 } // namespace pre
 } // namespace vt
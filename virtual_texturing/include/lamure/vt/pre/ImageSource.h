@@ -0,0 +1,153 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef LAMURE_IMAGESOURCE_H
+#define LAMURE_IMAGESOURCE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <lamure/vt/pre/Bitmap.h>
+
+namespace vt
+{
+namespace pre
+{
+// pixels of the image an atlas is built from, rows from top to bottom
+class ImageSource
+{
+  protected:
+    std::string _name;
+    Bitmap::PIXEL_FORMAT _pxFormat;
+    size_t _width;
+    size_t _height;
+
+  public:
+    ImageSource(const std::string& name, Bitmap::PIXEL_FORMAT pxFormat, size_t width, size_t height);
+
+    virtual ~ImageSource() = default;
+
+    const std::string& getName() const;
+    Bitmap::PIXEL_FORMAT getPixelFormat() const;
+    size_t getWidth() const;
+    size_t getHeight() const;
+
+    // copies a rectangle inside the image to out, whose rows are rowByteSize apart. called by several threads at once
+    virtual void read(size_t x, size_t y, size_t width, size_t height, uint8_t* out, size_t rowByteSize) = 0;
+
+    // the rectangle will be read soon
+    virtual void prefetch(size_t x, size_t y, size_t width, size_t height) {}
+};
+
+// one raw file holding the whole image
+class RawImageSource : public ImageSource
+{
+  protected:
+    std::mutex _filesLock;
+    // idle streams, there are as many as readers ever ran at once
+    std::vector<std::unique_ptr<std::ifstream>> _files;
+
+    std::unique_ptr<std::ifstream> _openFile();
+
+  public:
+    RawImageSource(const std::string& fileName, Bitmap::PIXEL_FORMAT pxFormat, size_t width, size_t height);
+
+    void read(size_t x, size_t y, size_t width, size_t height, uint8_t* out, size_t rowByteSize) override;
+};
+
+/**
+ * Image stored as a grid of source tiles, e.g. the tile directories vt_stitch combines to a raw file.
+ *
+ * Source tiles are loaded on demand into a cache limited to maxMemory. prefetch() queues the source tiles of a
+ * rectangle for read-ahead threads, so loading the next rectangles overlaps the work on the current one.
+ * */
+class TiledImageSource : public ImageSource
+{
+  public:
+    // writes source tile (x, y) to out, rows are tileWidth pixels apart, tiles at the right and bottom border only need to fill their part of the image
+    typedef std::function<void(size_t x, size_t y, uint8_t* out)> loader_type;
+
+  protected:
+    struct Tile
+    {
+        std::unique_ptr<uint8_t[]> data;
+        size_t pins = 0;
+        uint64_t lastUse = 0;
+        bool loading = true;
+        bool failed = false;
+    };
+
+    loader_type _loader;
+    size_t _tileWidth;
+    size_t _tileHeight;
+    size_t _tilesPerRow;
+    size_t _tilesPerColumn;
+    size_t _tileByteSize;
+    size_t _maxTiles;
+
+    std::mutex _tilesLock;
+    std::condition_variable _tileLoaded;
+    std::map<uint64_t, Tile> _tiles;
+    uint64_t _useCount;
+
+    std::condition_variable _queueChanged;
+    std::deque<uint64_t> _queue;
+    bool _running;
+    std::vector<std::thread> _readAheadThreads;
+
+    // pins the tile, loads it if it is not cached
+    uint8_t* _acquire(uint64_t key);
+    void _release(uint64_t key);
+    // expects _tilesLock to be held, drops least recently used unpinned tiles until there is room for another one
+    void _makeRoom();
+    void _readAhead();
+
+  public:
+    TiledImageSource(const std::string& name,
+                     Bitmap::PIXEL_FORMAT pxFormat,
+                     size_t width,
+                     size_t height,
+                     size_t tileWidth,
+                     size_t tileHeight,
+                     loader_type loader,
+                     size_t maxMemory,
+                     size_t readAheadThreadCount = 1);
+
+    ~TiledImageSource();
+
+    // raw files "<x>_<y><extension>", each as wide and high as its part of the image
+    static TiledImageSource* openDirectory(const std::string& dirName,
+                                           const std::string& extension,
+                                           Bitmap::PIXEL_FORMAT pxFormat,
+                                           size_t width,
+                                           size_t height,
+                                           size_t tileWidth,
+                                           size_t tileHeight,
+                                           size_t maxMemory);
+
+    // one raw file of full size tiles, row after row of tiles
+    static TiledImageSource*
+    openContainer(const std::string& fileName, Bitmap::PIXEL_FORMAT pxFormat, size_t width, size_t height, size_t tileWidth, size_t tileHeight, size_t maxMemory);
+
+    void read(size_t x, size_t y, size_t width, size_t height, uint8_t* out, size_t rowByteSize) override;
+
+    void prefetch(size_t x, size_t y, size_t width, size_t height) override;
+};
+} // namespace pre
+} // namespace vt
+
+#endif // LAMURE_IMAGESOURCE_H
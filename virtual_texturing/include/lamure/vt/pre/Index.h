@@ -52,7 +52,7 @@ class Index
     explicit Index<val_type>(size_t size)
     {
         _size = size;
-        _data = new val_type[size];
+        _data = new val_type[size]();
     }
 
     ~Index() { delete[] _data; }
@@ -0,0 +1,61 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef LAMURE_PAYLOADWRITER_H
+#define LAMURE_PAYLOADWRITER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace vt
+{
+namespace pre
+{
+// writes byte ranges of a file on its own thread. write() only blocks while more
+// than maxPendingBytes are queued, flush() waits until everything reached the file
+class PayloadWriter
+{
+  protected:
+    std::fstream& _file;
+    uint64_t _fileOffset;
+    size_t _maxPendingBytes;
+
+    std::mutex _lock;
+    std::condition_variable _queueChanged;
+    std::deque<std::pair<uint64_t, std::vector<uint8_t>>> _queue;
+    size_t _pendingBytes;
+    bool _writing;
+    bool _running;
+    std::exception_ptr _error;
+
+    std::thread _thread;
+
+    void _run();
+
+  public:
+    PayloadWriter(std::fstream& file, uint64_t fileOffset, size_t maxPendingBytes);
+
+    ~PayloadWriter();
+
+    // offset is relative to the fileOffset given on construction
+    void write(uint64_t offset, std::vector<uint8_t>&& data);
+
+    // rethrows an error of the writing thread
+    void flush();
+};
+} // namespace pre
+} // namespace vt
+
+#endif // LAMURE_PAYLOADWRITER_H
@@ -21,12 +21,16 @@
 #include <cstring>
 #include <iomanip>
 #include <cmath>
+#include <functional>
+#include <vector>
 
 #include <lamure/vt/pre/QuadTree.h>
 #include <lamure/vt/pre/Bitmap.h>
 #include <lamure/vt/pre/AtlasFile.h>
 #include <lamure/vt/pre/OffsetIndex.h>
 #include <lamure/vt/pre/CielabIndex.h>
+#include <lamure/vt/pre/ImageSource.h>
+#include <lamure/vt/pre/PayloadWriter.h>
 
 namespace vt
 {
@@ -42,10 +46,16 @@ class Preprocessor
         NOT_COMBINED
     };
 
+    struct PhaseTiming
+    {
+        std::string name;
+        std::chrono::milliseconds duration;
+    };
+
   protected:
     static constexpr size_t _HEADER_SIZE = 71;
 
-    std::string _srcFileName;
+    ImageSource* _src;
     Bitmap::PIXEL_FORMAT _srcPxFormat;
 
     std::string _destFileName;
@@ -67,9 +77,6 @@ class Preprocessor
 
     size_t _treeDepth;
 
-    std::ifstream _srcFile;
-    uint64_t _srcFileSize;
-
     std::fstream* _destHeaderFile;
     uint64_t _destHeaderOffset;
 
@@ -82,32 +89,50 @@ class Preprocessor
     uint64_t _destCielabIndexOffset;
 
     std::fstream _destPayloadFile;
+    std::string _destPayloadFileName;
     uint64_t _destPayloadOffset;
 
+    size_t _threadCount;
+    std::vector<PhaseTiming> _phaseTimings;
+
     bool _isPowerOfTwo(size_t val);
 
-    size_t _loadTileById(uint64_t id, uint8_t* out);
-    size_t _getTileById(uint64_t id, const uint8_t* buffer, uint64_t firstIdInBuffer, uint64_t lastIdInBuffer, const uint64_t* idLookup, size_t bufferTileLen, uint8_t* out);
-    size_t _getBufferedTileById(uint64_t id, const uint8_t* buffer, uint64_t firstIdInBuffer, uint64_t lastIdInBuffer, const uint64_t* idLookup, size_t bufferTileLen, uint8_t* out);
+    // runs work on every thread and rethrows the first exception thrown by any of them
+    void _runThreads(const std::function<void()>& work);
+    void _openPayloadForReading(std::ifstream& file);
+    void _addPhaseTiming(const std::string& name, std::chrono::high_resolution_clock::time_point start);
+
+    size_t _loadTileById(std::ifstream& file, uint64_t id, uint8_t* out);
 
     void _writeHeader();
-    void _extract(size_t bufferTileWidth, size_t writeBufferTileSize);
-    void _deflate(size_t tilesInWriteBuffer);
+    void _extract(size_t bufferTileWidth, size_t maxPendingBytes);
+    void _deflate(size_t maxMemory);
+    // everything of a tile but the bottom and right padding, which are taken from neighbours in the same level
+    void _deflateTile(std::ifstream& payloadFile, uint64_t relIterationId, size_t iterationLevel, size_t levelTileWidth, size_t levelTileHeight, uint8_t* buffer, uint8_t* out);
+    // bottom and right may be nullptr if those paddings are not needed
+    void _padTile(Bitmap& tile, uint64_t x, uint64_t y, size_t levelTileWidth, size_t levelTileHeight, size_t levelPixelWidth, size_t levelPixelHeight, const Bitmap* bottom, const Bitmap* right);
 
     void _putLE(uint64_t num, uint8_t* out);
     void _putPixelFormat(Bitmap::PIXEL_FORMAT pxFormat, uint8_t* out);
     void _putFileFormat(AtlasFile::LAYOUT fileFormat, uint8_t* out);
 
-    void _loadToSeqBuffer(uint8_t* buffer, uint64_t id, size_t count);
-
   public:
     Preprocessor(const std::string& srcFileName, Bitmap::PIXEL_FORMAT srcPxFormat, size_t imageWidth, size_t imageHeight);
 
+    // takes ownership of the source
+    explicit Preprocessor(ImageSource* src);
+
     ~Preprocessor();
 
     void setOutput(const std::string& destFileName, Bitmap::PIXEL_FORMAT destPxFormat, AtlasFile::LAYOUT format, size_t tileWidth, size_t tileHeight, size_t padding, bool combine = true);
 
+    // defaults to one thread per core, maxMemory of run() is shared by all threads
+    void setThreadCount(size_t threadCount);
+
     void run(size_t maxMemory);
+
+    // durations of the phases of the last run
+    const std::vector<PhaseTiming>& getPhaseTimings() const;
 };
 } // namespace pre
 } // namespace vt
@@ -39,6 +39,8 @@ class QuadTree
 
     static size_t getDepth(size_t width, size_t height);
 
+    static size_t getLevelOfId(uint64_t id);
+
     static uint64_t getNeighbour(uint64_t relId, NEIGHBOUR neighbour);
 };
 } // namespace pre
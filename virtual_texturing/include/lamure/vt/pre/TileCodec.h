@@ -0,0 +1,46 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef TILE_PROVIDER_TILECODEC_H
+#define TILE_PROVIDER_TILECODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <lamure/vt/pre/Bitmap.h>
+
+namespace vt
+{
+namespace pre
+{
+// tiles of the compressed atlas layout. an encoded tile starts with its codec id,
+// the rest depends on the codec. the block codecs store 4x4 pixel blocks row by row
+// in the layout of the GPU formats BC1 (RGB8), BC3 (RGBA8) and BC4 (R8)
+class TileCodec
+{
+  public:
+    enum CODEC
+    {
+        RAW = 0,
+        SOLID,
+        BC1,
+        BC3,
+        BC4
+    };
+
+    // upper bound of the encoded size of any tile of the given size and format
+    static size_t maxEncodedSize(size_t width, size_t height, Bitmap::PIXEL_FORMAT format);
+
+    // returns the count of bytes written to out
+    static size_t encode(const uint8_t* tile, size_t width, size_t height, Bitmap::PIXEL_FORMAT format, uint8_t* out);
+
+    // throws if data is not a valid encoding of a tile of the given size and format
+    static void decode(const uint8_t* data, size_t len, size_t width, size_t height, Bitmap::PIXEL_FORMAT format, uint8_t* out);
+};
+} // namespace pre
+} // namespace vt
+
+#endif // TILE_PROVIDER_TILECODEC_H
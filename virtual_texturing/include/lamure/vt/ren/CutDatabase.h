@@ -29,10 +29,13 @@ class SyncStructure
 class StateStructure : public DoubleBuffer<mem_slots_type>
 {
   public:
-    StateStructure(mem_slots_type* front, mem_slots_type* back) : DoubleBuffer<mem_slots_type>(front, back) {}
+    StateStructure(mem_slots_type* front, mem_slots_type* back) : DoubleBuffer<mem_slots_type>(front, back), _free_slot_cursor(0) {}
     ~StateStructure() = default;
 
     void deliver() override { _front->assign(_back->begin(), _back->end()); }
+
+    // position after the slot handed out last, where the search for a free slot continues
+    size_t _free_slot_cursor;
 };
 class CutDatabase
 {
@@ -35,7 +35,8 @@ class CutUpdate
     ContextFeedback* get_context_feedback(uint16_t context_id);
 
     bool can_accept_feedback(uint32_t context_id);
-    void feedback(uint32_t context_id, int32_t* buf_lod, uint32_t* buf_count);
+    // false if the dispatch thread held the feedback and the buffers were dropped
+    bool feedback(uint32_t context_id, int32_t* buf_lod, uint32_t* buf_count);
     const float& get_dispatch_time() const;
 
     void toggle_freeze_dispatch();
@@ -67,6 +68,8 @@ class CutUpdate
 
     bool check_all_siblings_in_cut(id_type tile_id, const cut_type& cut);
     void remove_from_indexed_memory(Cut* cut, id_type tile_id, uint16_t context_id);
+
+    void update_allocated_slots(Cut* cut, uint16_t context_id);
 };
 
 class CutDecision
@@ -78,9 +81,9 @@ class CutDecision
     ~CutDecision() {}
 
   private:
-    id_set_type collapse_to;
-    prioritized_tile_set_type split;
-    id_set_type keep;
+    id_list_type collapse_to;
+    prioritized_tile_list_type split;
+    id_list_type keep;
 };
 
 class ContextFeedback
@@ -88,17 +91,23 @@ class ContextFeedback
   public:
     friend class CutUpdate;
 
-    ContextFeedback(uint16_t id, CutUpdate* cut_update) : _feedback_dispatch_lock(), _feedback_cv(), _feedback_new(), _allocated_slot_index()
+    ContextFeedback(uint16_t id, CutUpdate* cut_update)
+        : _feedback_dispatch_lock(), _feedback_cv(), _feedback_new(), _allocated_slot_index(), _slot_allocated(), _compact_positions(), _slots_allocated(), _slots_freed()
     {
         _id = id;
 
         _feedback_new.store(false);
 
-        _feedback_lod_buffer = new int32_t[CutDatabase::get_instance().get_size_mem_interleaved()];
+        size_t size_mem_interleaved = CutDatabase::get_instance().get_size_mem_interleaved();
+
+        _feedback_lod_buffer = new int32_t[size_mem_interleaved];
 #ifdef RASTERIZATION_COUNT
-        _feedback_count_buffer = new uint32_t[CutDatabase::get_instance().get_size_mem_interleaved()];
+        _feedback_count_buffer = new uint32_t[size_mem_interleaved];
 #endif
 
+        _slot_allocated.assign(size_mem_interleaved, false);
+        _compact_positions.assign(size_mem_interleaved, 0);
+
         _feedback_worker = std::thread(&CutUpdate::run, cut_update, this);
     }
 
@@ -120,18 +129,9 @@ class ContextFeedback
 #endif
     }
 
-    std::set<uint32_t>& get_allocated_slot_index() { return _allocated_slot_index; }
-    uint32_t get_compact_position(uint32_t position)
-    {
-        auto iter = std::find(_allocated_slot_index.begin(), _allocated_slot_index.end(), position);
-
-        if(iter != _allocated_slot_index.end())
-        {
-            return (uint32_t)std::distance(_allocated_slot_index.begin(), iter);
-        }
-
-        return 0;
-    }
+    // allocated memory slots in ascending order, the feedback buffer holds one entry per slot in this order
+    const std::vector<uint32_t>& get_allocated_slot_index() const { return _allocated_slot_index; }
+    uint32_t get_compact_position(uint32_t position) const { return _compact_positions[position]; }
 
   private:
     uint16_t _id;
@@ -140,12 +140,39 @@ class ContextFeedback
     std::mutex _feedback_dispatch_lock;
     std::condition_variable _feedback_cv;
     std::thread _feedback_worker;
-    std::set<uint32_t> _allocated_slot_index;
+
+    std::vector<uint32_t> _allocated_slot_index;
+    std::vector<bool> _slot_allocated;
+    std::vector<uint32_t> _compact_positions;
+
+    // changes of the current dispatch, applied at once by update_slot_index()
+    std::vector<uint32_t> _slots_allocated;
+    std::vector<uint32_t> _slots_freed;
 
     int32_t* _feedback_lod_buffer;
 #ifdef RASTERIZATION_COUNT
     uint32_t* _feedback_count_buffer;
 #endif
+
+    void allocate_slot(uint32_t position)
+    {
+        if(!_slot_allocated[position])
+        {
+            _slot_allocated[position] = true;
+            _slots_allocated.push_back(position);
+        }
+    }
+
+    void free_slot(uint32_t position)
+    {
+        if(_slot_allocated[position])
+        {
+            _slot_allocated[position] = false;
+            _slots_freed.push_back(position);
+        }
+    }
+
+    void update_slot_index();
 };
 } // namespace vt
 
@@ -26,6 +26,8 @@ void VTConfig::read_config(const char* path_config)
     _size_physical_texture = (uint32_t)atoi(ini_config->GetValue(VTConfig::TEXTURE_MANAGEMENT, VTConfig::PHYSICAL_SIZE_MB, VTConfig::UNDEF));
     _size_physical_update_throughput = (uint32_t)atoi(ini_config->GetValue(VTConfig::TEXTURE_MANAGEMENT, VTConfig::PHYSICAL_UPDATE_THROUGHPUT_MB, VTConfig::UNDEF));
     _size_ram_cache = (uint32_t)atoi(ini_config->GetValue(VTConfig::TEXTURE_MANAGEMENT, VTConfig::RAM_CACHE_SIZE_MB, VTConfig::UNDEF));
+    _num_loader_threads = (uint32_t)atoi(ini_config->GetValue(VTConfig::TEXTURE_MANAGEMENT, VTConfig::LOADER_THREADS, "0"));
+    _cache_policy = VTConfig::which_cache_policy(ini_config->GetValue(VTConfig::TEXTURE_MANAGEMENT, VTConfig::RAM_CACHE_POLICY, VTConfig::RAM_CACHE_POLICY_FIFO));
     _format_texture = VTConfig::which_texture_format(ini_config->GetValue(VTConfig::TEXTURE_MANAGEMENT, VTConfig::TEXTURE_FORMAT, VTConfig::UNDEF));
     _verbose = atoi(ini_config->GetValue(VTConfig::DEBUG, VTConfig::VERBOSE, VTConfig::UNDEF)) == 1;
 }
@@ -45,6 +47,11 @@ void VTConfig::define_size_physical_texture(uint32_t max_tex_layers, uint32_t ma
     _phys_tex_tile_width = (uint32_t)tex_tile_width;
     _phys_tex_layers = (uint16_t)layers < (uint16_t)max_tex_layers ? (uint16_t)layers : (uint16_t)max_tex_layers;
 }
+void VTConfig::set_size_physical_texture(uint32_t size_physical_texture) { _size_physical_texture = size_physical_texture; }
+void VTConfig::set_size_physical_update_throughput(uint32_t size_physical_update_throughput) { _size_physical_update_throughput = size_physical_update_throughput; }
+void VTConfig::set_size_ram_cache(uint32_t size_ram_cache) { _size_ram_cache = size_ram_cache; }
+void VTConfig::set_num_loader_threads(uint32_t num_loader_threads) { _num_loader_threads = num_loader_threads; }
+void VTConfig::set_cache_policy(CACHE_POLICY cache_policy) { _cache_policy = cache_policy; }
 uint16_t VTConfig::get_size_tile() const { return _size_tile; }
 uint16_t VTConfig::get_size_padding() const { return _size_padding; }
 VTConfig::FORMAT_TEXTURE VTConfig::get_format_texture() const { return _format_texture; }
@@ -87,6 +94,24 @@ const VTConfig::FORMAT_TEXTURE VTConfig::which_texture_format(const char* _textu
     }
     throw std::runtime_error("Unknown texture format");
 }
+const VTConfig::CACHE_POLICY VTConfig::which_cache_policy(const char* _cache_policy)
+{
+    if(strcmp(_cache_policy, RAM_CACHE_POLICY_FIFO) == 0)
+    {
+        return FIFO;
+    }
+    else if(strcmp(_cache_policy, RAM_CACHE_POLICY_CLOCK_PRO) == 0)
+    {
+        return CLOCK_PRO;
+    }
+    else if(strcmp(_cache_policy, RAM_CACHE_POLICY_LEVEL) == 0)
+    {
+        return LEVEL;
+    }
+    throw std::runtime_error("Unknown cache policy");
+}
 
 uint32_t VTConfig::get_size_ram_cache() const { return _size_ram_cache; }
+uint32_t VTConfig::get_num_loader_threads() const { return _num_loader_threads; }
+VTConfig::CACHE_POLICY VTConfig::get_cache_policy() const { return _cache_policy; }
 } // namespace vt
\ No newline at end of file
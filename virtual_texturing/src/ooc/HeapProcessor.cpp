@@ -7,27 +7,39 @@
 
 #include <lamure/vt/ooc/HeapProcessor.h>
 
+#include <algorithm>
+
 namespace vt
 {
 namespace ooc
 {
 HeapProcessor::HeapProcessor()
 {
-    _thread = nullptr;
+    _threadCount = 1;
     _cache = nullptr;
 }
 
-HeapProcessor::~HeapProcessor()
+HeapProcessor::~HeapProcessor() { stop(); }
+
+void HeapProcessor::request(TileRequest* request) { _requests.push(request); }
+
+void HeapProcessor::raisePriority(TileRequest* request, priority_type priority) { _requests.raisePriority(request, priority); }
+
+void HeapProcessor::setThreadCount(size_t threadCount)
 {
-    stop();
-    delete _thread;
+    if(!_threads.empty())
+    {
+        throw std::runtime_error("HeapProcessor is already started.");
+    }
+
+    _threadCount = std::max((size_t)1, threadCount);
 }
 
-void HeapProcessor::request(TileRequest* request) { _requests_prio_queue.push(request); }
+size_t HeapProcessor::getThreadCount() { return _threadCount; }
 
 void HeapProcessor::start()
 {
-    if(_thread != nullptr)
+    if(!_threads.empty())
     {
         throw std::runtime_error("HeapProcessor is already started.");
     }
@@ -38,7 +50,11 @@ void HeapProcessor::start()
     }
 
     _running = true;
-    _thread = new std::thread(&HeapProcessor::run, this);
+
+    for(size_t i = 0; i < _threadCount; ++i)
+    {
+        _threads.emplace_back(&HeapProcessor::run, this);
+    }
 }
 
 void HeapProcessor::run()
@@ -49,7 +65,7 @@ void HeapProcessor::run()
     {
         TileRequest* req;
 
-        if(!_requests_prio_queue.pop(req, std::chrono::milliseconds(200)))
+        if(!_requests.pop(req, std::chrono::milliseconds(200)))
         {
             continue;
         }
@@ -68,10 +84,16 @@ void HeapProcessor::writeTo(TileCache* cache) { _cache = cache; }
 void HeapProcessor::stop()
 {
     _running = false;
-    if(_thread->joinable())
+
+    for(auto& thread : _threads)
     {
-        _thread->join();
+        if(thread.joinable())
+        {
+            thread.join();
+        }
     }
+
+    _threads.clear();
 }
 
 } // namespace ooc
@@ -16,12 +16,13 @@ typedef TileCacheSlot slot_type;
 
 TileCacheSlot::TileCacheSlot()
 {
-    _state = STATE::FREE;
+    _state.store(STATE::FREE);
     _buffer = nullptr;
     _cache = nullptr;
     _size = 0;
     _tileId = 0;
-    _context_reference = 0;
+    _resource = nullptr;
+    _context_reference.store(0);
 }
 
 TileCacheSlot::~TileCacheSlot()
@@ -29,7 +30,9 @@ TileCacheSlot::~TileCacheSlot()
     // std::cout << "del slot " << this << std::endl;
 }
 
-bool TileCacheSlot::compareState(STATE state) { return _state == state; }
+bool TileCacheSlot::compareState(STATE state) { return _state.load() == state; }
+
+bool TileCacheSlot::exchangeState(STATE expected, STATE desired) { return _state.compare_exchange_strong(expected, desired); }
 
 void TileCacheSlot::setTileId(uint64_t tileId) { _tileId = tileId; }
 
@@ -37,7 +40,7 @@ uint64_t TileCacheSlot::getTileId() { return _tileId; }
 
 void TileCacheSlot::setCache(TileCache* cache) { _cache = cache; }
 
-void TileCacheSlot::setState(STATE state) { _state = state; }
+void TileCacheSlot::setState(STATE state) { _state.store(state); }
 
 void TileCacheSlot::setId(size_t id) { _id = id; }
 
@@ -86,107 +89,164 @@ unsigned int countSetBitsRec(unsigned int num)
     return num_to_bits[nibble] + countSetBitsRec(num >> 4);
 }
 
-uint16_t TileCacheSlot::getContextReferenceCount() { return (uint16_t)countSetBitsRec(_context_reference); }
-void TileCacheSlot::removeAllContextReferences() { _context_reference = 0u; }
-TileCache::TileCache(size_t tileByteSize, size_t slotCount)
+uint16_t TileCacheSlot::getContextReferenceCount() { return (uint16_t)countSetBitsRec(_context_reference.load()); }
+void TileCacheSlot::removeAllContextReferences() { _context_reference.store(0u); }
+TileCache::TileCache(size_t tileByteSize, size_t slotCount, VTConfig::CACHE_POLICY policy)
 {
     _tileByteSize = tileByteSize;
     _slotCount = slotCount;
+    _availableCount.store(slotCount);
+    _hitCount.store(0);
+    _missCount.store(0);
+    _loadedCount.store(0);
+    _evictedCount.store(0);
+    _depletionCount.store(0);
     _buffer = new uint8_t[tileByteSize * slotCount];
     _slots = new slot_type[slotCount];
-    _locks = new std::mutex[slotCount];
 
     for(size_t i = 0; i < slotCount; ++i)
     {
         _slots[i].setId(i);
         _slots[i].setBuffer(&_buffer[tileByteSize * i]);
         _slots[i].setCache(this);
-
-        _lru.push(&_slots[i]);
     }
+
+    _policy = TileCachePolicy::create(policy);
+    _policy->init(_slots, slotCount);
 }
 
 slot_type* TileCache::requestSlotForReading(pre::AtlasFile* resource, uint64_t tile_id, uint16_t context_id)
 {
-    std::lock_guard<std::mutex> lock(_idsLock);
+    slot_type* slot = nullptr;
 
-    auto iter = _ids.find(std::make_pair(resource, tile_id));
-
-    if(iter == _ids.end())
     {
-        return nullptr;
-    }
+        std::lock_guard<std::mutex> lock(_idsLock);
 
-    auto slot = iter->second;
+        auto iter = _ids.find(std::make_pair(resource, tile_id));
 
-    if(slot == nullptr)
-    {
-        if(VTConfig::get_instance().is_verbose())
+        if(iter == _ids.end())
         {
-            std::cerr << "IDX slot is null." << std::endl;
+            ++_missCount;
+            return nullptr;
         }
-        return nullptr;
-    }
 
-    {
-        std::lock_guard<std::mutex> lockSlot(_locks[slot->getId()]);
+        slot = iter->second;
+
+        if(slot == nullptr)
+        {
+            if(VTConfig::get_instance().is_verbose())
+            {
+                std::cerr << "IDX slot is null." << std::endl;
+            }
+            return nullptr;
+        }
+
+        // slots in the IDX are only claimed for writing while holding the IDX lock, so the slot is occupied or read
         slot->addContextReference(context_id);
-        slot->setState(slot_type::STATE::READING);
+
+        if(slot->exchangeState(slot_type::STATE::OCCUPIED, slot_type::STATE::READING))
+        {
+            --_availableCount;
+            _policy->accessed(slot);
+        }
     }
 
+    ++_hitCount;
+
     return slot;
 }
 
 slot_type* TileCache::requestSlotForWriting()
 {
-    std::lock_guard<std::mutex> lock(_lruLock);
-    while(!_lru.empty())
+    slot_type* slot = nullptr;
+
+    if(_availableCount.load() > 0)
     {
-        TileCacheSlot* slot = _lru.front();
-        _lru.pop();
+        std::lock_guard<std::mutex> lock(_policyLock);
+        slot = _policy->evict(*this);
+    }
 
-        {
-            std::lock_guard<std::mutex> lockSlot(_locks[slot->getId()]);
-            if(slot->compareState(TileCacheSlot::STATE::FREE))
-            {
-                slot->setState(slot_type::STATE::WRITING);
-                return slot;
-            }
-            else if(slot->compareState(TileCacheSlot::STATE::OCCUPIED))
-            {
-                unregisterOccupiedId(slot->getResource(), slot->getTileId());
-                slot->removeAllContextReferences();
-                slot->setState(slot_type::STATE::WRITING);
-                return slot;
-            }
-        }
-    };
+    if(slot == nullptr)
+    {
+        ++_depletionCount;
+    }
 
-    return nullptr;
+    return slot;
 }
 
-void TileCache::registerOccupiedId(pre::AtlasFile* resource, uint64_t tile_id, slot_type* slot)
+void TileCache::releaseSlotForWriting(slot_type* slot)
 {
-    std::unique_lock<std::mutex> lockSlot(_locks[slot->getId()], std::defer_lock);
-    std::unique_lock<std::mutex> lock(_idsLock, std::defer_lock);
-    std::unique_lock<std::mutex> lockLRU(_lruLock, std::defer_lock);
+    std::lock_guard<std::mutex> lockPolicy(_policyLock);
+
+    if(!slot->exchangeState(slot_type::STATE::WRITING, slot_type::STATE::FREE))
+    {
+        return;
+    }
 
-    std::lock(lockSlot, lock, lockLRU); // transition to scoped_lock when migrating to C++17
+    ++_availableCount;
+    _policy->freed(slot);
+    _repopulationCV.notify_one();
+}
 
-    if(slot->compareState(TileCacheSlot::WRITING))
+bool TileCache::claimSlot(slot_type* slot)
+{
+    if(slot->exchangeState(slot_type::STATE::FREE, slot_type::STATE::WRITING))
     {
+        --_availableCount;
+        return true;
+    }
+
+    // readers reference slots while holding the IDX lock
+    std::lock_guard<std::mutex> lock(_idsLock);
+
+    if(!slot->exchangeState(slot_type::STATE::OCCUPIED, slot_type::STATE::WRITING))
+    {
+        return false;
+    }
+
+    _ids.erase(std::make_pair(slot->getResource(), slot->getTileId()));
+    slot->removeAllContextReferences();
+    --_availableCount;
+    ++_evictedCount;
+
+    return true;
+}
+
+bool TileCache::containsId(pre::AtlasFile* resource, uint64_t tile_id)
+{
+    std::lock_guard<std::mutex> lock(_idsLock);
+
+    return _ids.find(std::make_pair(resource, tile_id)) != _ids.end();
+}
+
+void TileCache::registerOccupiedId(pre::AtlasFile* resource, uint64_t tile_id, slot_type* slot)
+{
+    std::lock_guard<std::mutex> lockPolicy(_policyLock);
+
+    {
+        std::lock_guard<std::mutex> lock(_idsLock);
+
+        if(!slot->compareState(TileCacheSlot::WRITING))
+        {
+            return;
+        }
+
         _ids.insert(std::make_pair(std::make_pair(resource, tile_id), slot));
         slot->setState(slot_type::STATE::OCCUPIED);
-
-        _lru.push(slot);
-        _lruRepopulationCV.notify_one();
+        ++_availableCount;
+        ++_loadedCount;
     }
+
+    _policy->loaded(slot);
+    _repopulationCV.notify_one();
 }
 
 void TileCache::removeContextReferenceFromReadId(pre::AtlasFile* resource, uint64_t tile_id, uint16_t context_id)
 {
     TileCacheSlot* slot = nullptr;
 
+    std::lock_guard<std::mutex> lockPolicy(_policyLock);
+
     {
         std::lock_guard<std::mutex> lock(_idsLock);
 
@@ -202,33 +262,29 @@ void TileCache::removeContextReferenceFromReadId(pre::AtlasFile* resource, uint6
         }
 
         slot = iter->second;
-    }
 
-    if(slot == nullptr || !slot->compareState(TileCacheSlot::READING))
-    {
-        if(VTConfig::get_instance().is_verbose())
+        if(slot == nullptr || !slot->compareState(TileCacheSlot::READING))
         {
-            std::cerr << "Context reference removal from a slot, which is not read." << std::endl;
+            if(VTConfig::get_instance().is_verbose())
+            {
+                std::cerr << "Context reference removal from a slot, which is not read." << std::endl;
+            }
+            return;
         }
-        return;
-    }
-
-    {
-        std::unique_lock<std::mutex> lockSlot(_locks[slot->getId()], std::defer_lock);
-        std::unique_lock<std::mutex> lock(_idsLock, std::defer_lock);
-        std::unique_lock<std::mutex> lockLRU(_lruLock, std::defer_lock);
-
-        std::lock(lockSlot, lock, lockLRU); // transition to scoped_lock when migrating to C++17
 
         slot->removeContextReference(context_id);
 
-        if(slot->getContextReferenceCount() == 0)
+        if(slot->getContextReferenceCount() != 0)
         {
-            slot->setState(TileCacheSlot::OCCUPIED);
-            _lru.push(slot);
-            _lruRepopulationCV.notify_one();
+            return;
         }
+
+        slot->setState(TileCacheSlot::OCCUPIED);
+        ++_availableCount;
     }
+
+    _policy->released(slot);
+    _repopulationCV.notify_one();
 }
 
 void TileCache::unregisterOccupiedId(pre::AtlasFile* resource, uint64_t tile_id)
@@ -253,7 +309,7 @@ TileCache::~TileCache()
 {
     delete[] _buffer;
     delete[] _slots;
-    delete[] _locks;
+    delete _policy;
 }
 
 void TileCache::print()
@@ -287,14 +343,33 @@ void TileCache::print()
 }
 void TileCache::waitUntilLRURepopulation(std::chrono::milliseconds maxTime)
 {
-    std::unique_lock<std::mutex> lk(_lruLock);
+    std::unique_lock<std::mutex> lk(_policyLock);
 
-    if(!_lru.empty())
+    if(_availableCount.load() > 0)
     {
         return;
     }
 
-    _lruRepopulationCV.wait_until(lk, std::chrono::system_clock::now() + maxTime, [&]() -> bool { return !_lru.empty(); });
+    _repopulationCV.wait_until(lk, std::chrono::system_clock::now() + maxTime, [&]() -> bool { return _availableCount.load() > 0; });
+}
+
+size_t TileCache::getSlotCount() { return _slotCount; }
+
+size_t TileCache::getResidentCount()
+{
+    std::lock_guard<std::mutex> lock(_idsLock);
+
+    return _ids.size();
 }
+
+uint64_t TileCache::getHitCount() { return _hitCount.load(); }
+
+uint64_t TileCache::getMissCount() { return _missCount.load(); }
+
+uint64_t TileCache::getLoadedCount() { return _loadedCount.load(); }
+
+uint64_t TileCache::getEvictedCount() { return _evictedCount.load(); }
+
+uint64_t TileCache::getDepletionCount() { return _depletionCount.load(); }
 } // namespace ooc
 } // namespace vt
\ No newline at end of file
@@ -0,0 +1,289 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/vt/ooc/TileCache.h>
+#include <lamure/vt/ooc/TileCachePolicy.h>
+#include <lamure/vt/pre/QuadTree.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace vt
+{
+namespace ooc
+{
+TileCachePolicy* TileCachePolicy::create(VTConfig::CACHE_POLICY policy)
+{
+    switch(policy)
+    {
+    case VTConfig::CACHE_POLICY::FIFO:
+        return new TileCacheFIFO();
+    case VTConfig::CACHE_POLICY::CLOCK_PRO:
+        return new TileCacheClockPro();
+    case VTConfig::CACHE_POLICY::LEVEL:
+        return new TileCacheLevel();
+    }
+
+    throw std::runtime_error("Unknown cache policy");
+}
+
+void TileCacheFIFO::init(TileCacheSlot* slots, size_t slotCount)
+{
+    for(size_t i = 0; i < slotCount; ++i)
+    {
+        _queue.push(&slots[i]);
+    }
+}
+
+void TileCacheFIFO::loaded(TileCacheSlot* slot) { _queue.push(slot); }
+
+void TileCacheFIFO::accessed(TileCacheSlot* slot) {}
+
+void TileCacheFIFO::released(TileCacheSlot* slot) { _queue.push(slot); }
+
+void TileCacheFIFO::freed(TileCacheSlot* slot) { _queue.push(slot); }
+
+TileCacheSlot* TileCacheFIFO::evict(TileCache& cache)
+{
+    // slots read since they were queued are dropped here and queued again on release
+    while(!_queue.empty())
+    {
+        TileCacheSlot* slot = _queue.front();
+        _queue.pop();
+
+        if(cache.claimSlot(slot))
+        {
+            return slot;
+        }
+    }
+
+    return nullptr;
+}
+
+TileCacheClockPro::TileCacheClockPro()
+{
+    _slots = nullptr;
+    _slotCount = 0;
+    _hand = 0;
+    _hotCount = 0;
+    _coldTarget = 1;
+    _testSerial = 0;
+}
+
+void TileCacheClockPro::init(TileCacheSlot* slots, size_t slotCount)
+{
+    _slots = slots;
+    _slotCount = slotCount;
+    _used.reset(new std::atomic<bool>[slotCount]);
+    _referenced.reset(new std::atomic<bool>[slotCount]);
+    _hot.assign(slotCount, false);
+    _coldTarget = std::max((size_t)1, slotCount / 2);
+
+    for(size_t i = 0; i < slotCount; ++i)
+    {
+        _used[i].store(false);
+        _referenced[i].store(false);
+    }
+}
+
+void TileCacheClockPro::startTest(const key_type& key)
+{
+    _test[key] = ++_testSerial;
+    _testOrder.emplace_back(key, _testSerial);
+
+    // the test period of a tile ends once as many tiles were evicted after it as the cache holds
+    while(_testOrder.size() > _slotCount)
+    {
+        auto iter = _test.find(_testOrder.front().first);
+
+        if(iter != _test.end() && iter->second == _testOrder.front().second)
+        {
+            _test.erase(iter);
+            _coldTarget = std::max((size_t)1, _coldTarget - 1);
+        }
+
+        _testOrder.pop_front();
+    }
+}
+
+void TileCacheClockPro::loaded(TileCacheSlot* slot)
+{
+    size_t id = slot->getId();
+    auto iter = _test.find(std::make_pair(slot->getResource(), slot->getTileId()));
+
+    _used[id].store(false);
+    _referenced[id].store(false);
+
+    if(iter != _test.end())
+    {
+        // reused within its test period, the cold share was too small to keep it
+        _test.erase(iter);
+        _coldTarget = std::min(_slotCount, _coldTarget + 1);
+
+        if(!_hot[id])
+        {
+            _hot[id] = true;
+            ++_hotCount;
+        }
+    }
+    else if(_hot[id])
+    {
+        _hot[id] = false;
+        --_hotCount;
+    }
+}
+
+void TileCacheClockPro::accessed(TileCacheSlot* slot)
+{
+    // the first use follows the miss that loaded the tile
+    if(_used[slot->getId()].exchange(true))
+    {
+        _referenced[slot->getId()].store(true);
+    }
+}
+
+void TileCacheClockPro::released(TileCacheSlot* slot) {}
+
+void TileCacheClockPro::freed(TileCacheSlot* slot)
+{
+    size_t id = slot->getId();
+
+    _used[id].store(false);
+    _referenced[id].store(false);
+
+    if(_hot[id])
+    {
+        _hot[id] = false;
+        --_hotCount;
+    }
+}
+
+TileCacheSlot* TileCacheClockPro::evict(TileCache& cache)
+{
+    // the first round clears references and promotes, the second demotes, the third takes any remaining slot
+    for(size_t step = 0; step < 3 * _slotCount; ++step)
+    {
+        size_t round = step / _slotCount;
+        size_t id = _hand;
+        TileCacheSlot* slot = &_slots[id];
+
+        _hand = (_hand + 1) % _slotCount;
+
+        if(slot->compareState(TileCacheSlot::STATE::READING) || slot->compareState(TileCacheSlot::STATE::WRITING))
+        {
+            continue;
+        }
+
+        if(_hot[id] && round < 2)
+        {
+            if(!_referenced[id].exchange(false) && (round == 1 || _hotCount > _slotCount - _coldTarget))
+            {
+                _hot[id] = false;
+                --_hotCount;
+            }
+
+            continue;
+        }
+
+        if(_referenced[id].exchange(false) && round < 2)
+        {
+            _hot[id] = true;
+            ++_hotCount;
+            continue;
+        }
+
+        bool resident = slot->compareState(TileCacheSlot::STATE::OCCUPIED);
+        key_type key(slot->getResource(), slot->getTileId());
+
+        if(!cache.claimSlot(slot))
+        {
+            continue;
+        }
+
+        if(_hot[id])
+        {
+            _hot[id] = false;
+            --_hotCount;
+        }
+
+        if(resident)
+        {
+            startTest(key);
+        }
+
+        return slot;
+    }
+
+    return nullptr;
+}
+
+TileCacheLevel::TileCacheLevel()
+{
+    _slots = nullptr;
+    _inflation = 0.0;
+}
+
+static double levelCost(TileCacheSlot* slot)
+{
+    size_t depth = slot->getResource()->getDepth();
+    size_t level = pre::QuadTree::getLevelOfId(slot->getTileId());
+
+    return level + 1 < depth ? std::ldexp(1.0, (int)(depth - 1 - level)) : 1.0;
+}
+
+void TileCacheLevel::push(TileCacheSlot* slot, double cost)
+{
+    size_t id = slot->getId();
+
+    _heap.emplace(_inflation + cost, ++_serials[id], id);
+}
+
+void TileCacheLevel::init(TileCacheSlot* slots, size_t slotCount)
+{
+    _slots = slots;
+    _serials.assign(slotCount, 0);
+
+    for(size_t i = 0; i < slotCount; ++i)
+    {
+        push(&slots[i], 0.0);
+    }
+}
+
+void TileCacheLevel::loaded(TileCacheSlot* slot) { push(slot, levelCost(slot)); }
+
+void TileCacheLevel::accessed(TileCacheSlot* slot) {}
+
+void TileCacheLevel::released(TileCacheSlot* slot) { push(slot, levelCost(slot)); }
+
+void TileCacheLevel::freed(TileCacheSlot* slot) { push(slot, 0.0); }
+
+TileCacheSlot* TileCacheLevel::evict(TileCache& cache)
+{
+    while(!_heap.empty())
+    {
+        entry_type entry = _heap.top();
+        _heap.pop();
+
+        size_t id = std::get<2>(entry);
+
+        // superseded by a later load or release
+        if(std::get<1>(entry) != _serials[id])
+        {
+            continue;
+        }
+
+        if(cache.claimSlot(&_slots[id]))
+        {
+            _inflation = std::max(_inflation, std::get<0>(entry));
+            return &_slots[id];
+        }
+    }
+
+    return nullptr;
+}
+} // namespace ooc
+} // namespace vt
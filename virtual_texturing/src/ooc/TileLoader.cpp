@@ -18,7 +18,8 @@ void TileLoader::beforeStart() {}
 
 bool TileLoader::process(TileRequest* req)
 {
-    if(!req->isAborted())
+    // a tile can be requested again between its cache miss and the removal of the previous request
+    if(!req->isAborted() && !_cache->containsId(req->getResource(), req->getId()))
     {
         auto res = req->getResource();
         auto slot = _cache->requestSlotForWriting();
@@ -33,7 +34,17 @@ bool TileLoader::process(TileRequest* req)
             return false;
         }
 
-        res->getTile(req->getId(), slot->getBuffer());
+        try
+        {
+            res->getTile(req->getId(), slot->getBuffer());
+        }
+        catch(std::exception& e)
+        {
+            std::cerr << "Could not load tile " << req->getId() << ": " << e.what() << std::endl;
+            _cache->releaseSlotForWriting(slot);
+            req->erase();
+            return true;
+        }
 
         // provide information on contained tile
         slot->setSize(res->getTileByteSize());
@@ -7,14 +7,18 @@
 
 #include <lamure/vt/ooc/TileProvider.h>
 
+#include <algorithm>
+#include <thread>
+
 namespace vt
 {
 namespace ooc
 {
-TileProvider::TileProvider() : _resourcesLock(), _cacheLock()
+TileProvider::TileProvider() : _resourcesLock(), _cacheLock(), _traceLock()
 {
     _cache = nullptr;
     _tileByteSize = 0;
+    _requestedCount.store(0);
 }
 
 TileProvider::~TileProvider()
@@ -27,7 +31,7 @@ TileProvider::~TileProvider()
     delete _cache;
 }
 
-void TileProvider::start(size_t maxMemSize)
+void TileProvider::start(size_t maxMemSize, size_t loaderThreadCount, VTConfig::CACHE_POLICY cachePolicy)
 {
     if(_tileByteSize == 0)
     {
@@ -41,11 +45,31 @@ void TileProvider::start(size_t maxMemSize)
         throw std::runtime_error("TileProvider tries to start with Cache of size 0.");
     }
 
-    _cache = new TileCache(_tileByteSize, slotCount);
+    if(loaderThreadCount == 0)
+    {
+        loaderThreadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    _cache = new TileCache(_tileByteSize, slotCount, cachePolicy);
     _loader.writeTo(_cache);
+    _loader.setThreadCount(loaderThreadCount);
     _loader.start();
 }
 
+void TileProvider::recordRequests(const char* fileName)
+{
+    std::lock_guard<std::mutex> lock(_traceLock);
+
+    _traceFile.open(fileName, std::ios::trunc);
+
+    if(!_traceFile.is_open())
+    {
+        throw std::runtime_error("Could not open trace file.");
+    }
+
+    _traceStart = std::chrono::steady_clock::now();
+}
+
 pre::AtlasFile* TileProvider::loadResource(const char* fileName)
 {
     std::lock_guard<std::mutex> lock(_resourcesLock);
@@ -80,39 +104,36 @@ pre::AtlasFile* TileProvider::loadResource(const char* fileName)
 
 TileCacheSlot* TileProvider::getTile(pre::AtlasFile* resource, id_type tile_id, priority_type priority, uint16_t context_id)
 {
-    std::lock_guard<std::mutex> lock(_cacheLock);
-
-    if(_cache == nullptr)
     {
-        throw std::runtime_error("Trying to get Tile before starting TileProvider.");
-    }
+        std::lock_guard<std::mutex> lock(_cacheLock);
+
+        if(_cache == nullptr)
+        {
+            throw std::runtime_error("Trying to get Tile before starting TileProvider.");
+        }
 
-    auto slot = _cache->requestSlotForReading(resource, tile_id, context_id);
+        auto slot = _cache->requestSlotForReading(resource, tile_id, context_id);
 
-    if(slot != nullptr)
-    {
-        return slot;
+        if(slot != nullptr)
+        {
+            return slot;
+        }
     }
 
-    auto req = _requestsMap.getRequest(resource, tile_id);
-
-    if(req != nullptr)
+    if(!_requestsMap.requestTile(resource, tile_id, priority, _loader))
     {
-        // if one wants to rensert according to priority, this should happen here
-        req->setPriority(std::max(req->getPriority(), priority));
-
         return nullptr;
     }
 
-    req = new TileRequest();
-
-    req->setResource(resource);
-    req->setId(tile_id);
-    req->setPriority(priority);
+    ++_requestedCount;
 
-    _requestsMap.insertRequest(req);
+    std::lock_guard<std::mutex> lock(_traceLock);
 
-    _loader.request(req);
+    if(_traceFile.is_open())
+    {
+        _traceFile << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _traceStart).count() << " " << tile_id << " " << priority << " " << resource->getFileName()
+                   << "\n";
+    }
 
     return nullptr;
 }
@@ -127,6 +148,28 @@ void TileProvider::print()
 
 bool TileProvider::wait(std::chrono::milliseconds maxTime) { return _requestsMap.waitUntilEmpty(maxTime); }
 
+TileStatistics TileProvider::getStatistics()
+{
+    std::lock_guard<std::mutex> lock(_cacheLock);
+
+    TileStatistics statistics;
+    statistics.requested = _requestedCount.load();
+    statistics.tileByteSize = _tileByteSize;
+
+    if(_cache != nullptr)
+    {
+        statistics.hits = _cache->getHitCount();
+        statistics.misses = _cache->getMissCount();
+        statistics.loaded = _cache->getLoadedCount();
+        statistics.evicted = _cache->getEvictedCount();
+        statistics.depletions = _cache->getDepletionCount();
+        statistics.residentTiles = _cache->getResidentCount();
+        statistics.cacheTiles = _cache->getSlotCount();
+    }
+
+    return statistics;
+}
+
 void TileProvider::ungetTile(pre::AtlasFile* resource, id_type tile_id, uint16_t context_id)
 {
     std::lock_guard<std::mutex> lock(_cacheLock);
@@ -11,10 +11,24 @@ namespace vt
 {
 namespace ooc
 {
+const size_t TileRequest::NOT_QUEUED;
+
 TileRequest::TileRequest() : Observable()
 {
     _resource = nullptr;
+    _id = 0;
+    _priority = 0;
+    _aborted = false;
+    _heapIndex = NOT_QUEUED;
+}
+
+void TileRequest::reset()
+{
+    _resource = nullptr;
+    _id = 0;
+    _priority = 0;
     _aborted = false;
+    _heapIndex = NOT_QUEUED;
 }
 
 void TileRequest::setResource(pre::AtlasFile* resource) { _resource = resource; }
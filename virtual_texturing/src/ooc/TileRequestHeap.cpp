@@ -0,0 +1,133 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/vt/ooc/TileRequestHeap.h>
+
+namespace vt
+{
+namespace ooc
+{
+TileRequestHeap::TileRequestHeap() : _lock(), _newEntry() {}
+
+void TileRequestHeap::_place(size_t index, TileRequest* request)
+{
+    _heap[index] = request;
+    request->_heapIndex = index;
+}
+
+void TileRequestHeap::_siftUp(size_t index)
+{
+    auto request = _heap[index];
+
+    while(index > 0)
+    {
+        size_t parent = (index - 1) >> 1;
+
+        if(_heap[parent]->_priority >= request->_priority)
+        {
+            break;
+        }
+
+        _place(index, _heap[parent]);
+        index = parent;
+    }
+
+    _place(index, request);
+}
+
+void TileRequestHeap::_siftDown(size_t index)
+{
+    auto request = _heap[index];
+    size_t count = _heap.size();
+
+    while(true)
+    {
+        size_t child = (index << 1) + 1;
+
+        if(child >= count)
+        {
+            break;
+        }
+
+        if(child + 1 < count && _heap[child + 1]->_priority > _heap[child]->_priority)
+        {
+            ++child;
+        }
+
+        if(request->_priority >= _heap[child]->_priority)
+        {
+            break;
+        }
+
+        _place(index, _heap[child]);
+        index = child;
+    }
+
+    _place(index, request);
+}
+
+void TileRequestHeap::push(TileRequest* request)
+{
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+
+        _heap.push_back(request);
+        _siftUp(_heap.size() - 1);
+    }
+
+    _newEntry.notify_one();
+}
+
+bool TileRequestHeap::pop(TileRequest*& request, const std::chrono::milliseconds maxTime)
+{
+    std::unique_lock<std::mutex> lock(_lock);
+
+    if(!_newEntry.wait_for(lock, maxTime, [this]() -> bool { return !_heap.empty(); }))
+    {
+        return false;
+    }
+
+    request = _heap.front();
+    request->_heapIndex = TileRequest::NOT_QUEUED;
+
+    auto last = _heap.back();
+    _heap.pop_back();
+
+    if(!_heap.empty())
+    {
+        _place(0, last);
+        _siftDown(0);
+    }
+
+    return true;
+}
+
+void TileRequestHeap::raisePriority(TileRequest* request, priority_type priority)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    if(priority <= request->_priority)
+    {
+        return;
+    }
+
+    request->_priority = priority;
+
+    if(request->_heapIndex != TileRequest::NOT_QUEUED)
+    {
+        _siftUp(request->_heapIndex);
+    }
+}
+
+size_t TileRequestHeap::size()
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    return _heap.size();
+}
+} // namespace ooc
+} // namespace vt
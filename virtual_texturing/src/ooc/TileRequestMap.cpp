@@ -11,79 +11,78 @@ namespace vt
 {
 namespace ooc
 {
-TileRequestMap::TileRequestMap() : Observer() {}
+TileRequestMap::TileRequestMap(size_t capacity) : Observer(), _pool(capacity, this), _emptyLock() { _size = 0; }
 
-TileRequestMap::~TileRequestMap()
-{
-    for(auto& iter : _map)
-    {
-        delete iter.second;
-    }
-}
+// requests are owned by the pool
+TileRequestMap::~TileRequestMap() = default;
 
-TileRequest* TileRequestMap::getRequest(pre::AtlasFile* resource, uint64_t tile_id)
+TileRequestMap::Shard& TileRequestMap::_getShard(const key_type& key) { return _shards[(KeyHash()(key) >> 7) % SHARD_COUNT]; }
+
+bool TileRequestMap::requestTile(pre::AtlasFile* resource, uint64_t tile_id, priority_type priority, HeapProcessor& processor)
 {
-    std::lock_guard<std::mutex> lock(_mapLock);
+    auto key = std::make_pair(resource, tile_id);
+    auto& shard = _getShard(key);
+
+    std::lock_guard<std::mutex> lock(shard.lock);
 
-    auto iter = _map.find(std::make_pair(resource, tile_id));
+    auto iter = shard.map.find(key);
 
-    if(iter == _map.end())
+    if(iter != shard.map.end())
     {
-        return nullptr;
+        processor.raisePriority(iter->second, priority);
+
+        return false;
     }
 
-    return iter->second;
-}
+    auto req = _pool.acquire();
 
-bool TileRequestMap::insertRequest(TileRequest* req)
-{
-    std::lock_guard<std::mutex> lock(_mapLock);
+    if(req == nullptr)
+    {
+        return false;
+    }
 
-    auto resource = req->getResource();
-    auto id = req->getId();
-    auto iter = _map.find(std::make_pair(resource, id));
+    req->setResource(resource);
+    req->setId(tile_id);
+    req->setPriority(priority);
 
-    if(iter == _map.end())
-    {
-        req->observe(0, this);
-        auto pair = std::make_pair(resource, id);
-        _map[pair] = req;
+    shard.map.insert(std::make_pair(key, req));
+    ++_size;
 
-        return true;
-    }
+    processor.request(req);
 
-    return false;
+    return true;
 }
 
 void TileRequestMap::inform(event_type event, Observable* observable)
 {
-    bool empty;
+    auto req = (TileRequest*)observable;
+    auto key = std::make_pair(req->getResource(), req->getId());
+    auto& shard = _getShard(key);
 
     {
-        std::unique_lock<std::mutex> lock(_mapLock);
-        auto req = (TileRequest*)observable;
-        _map.erase(std::make_pair(req->getResource(), req->getId()));
-        delete req;
-
-        empty = _map.empty();
+        std::lock_guard<std::mutex> lock(shard.lock);
+        shard.map.erase(key);
     }
 
-    if(empty)
+    _pool.release(req);
+
+    if(--_size == 0)
     {
+        std::lock_guard<std::mutex> lock(_emptyLock);
         _allRequestsProcessed.notify_all();
     }
 }
 
 bool TileRequestMap::waitUntilEmpty(std::chrono::milliseconds maxTime)
 {
-    std::unique_lock<std::mutex> lock(_mapLock);
+    std::unique_lock<std::mutex> lock(_emptyLock);
 
-    if(_map.empty())
+    if(_size.load() == 0)
     {
         return true;
     }
 
-    return _allRequestsProcessed.wait_until(lock, std::chrono::system_clock::now() + maxTime, [this] { return _map.empty(); });
+    return _allRequestsProcessed.wait_until(lock, std::chrono::system_clock::now() + maxTime, [this] { return _size.load() == 0; });
 }
 } // namespace ooc
-} // namespace vt
\ No newline at end of file
+} // namespace vt
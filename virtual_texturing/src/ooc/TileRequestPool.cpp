@@ -0,0 +1,55 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/vt/ooc/TileRequestPool.h>
+
+namespace vt
+{
+namespace ooc
+{
+TileRequestPool::TileRequestPool(size_t capacity, Observer* observer) : _freeLock()
+{
+    _capacity = capacity;
+    _requests = new TileRequest[capacity];
+    _free.reserve(capacity);
+
+    // handed out from the front of the block first
+    for(size_t i = capacity; i > 0; --i)
+    {
+        _requests[i - 1].observe(0, observer);
+        _free.push_back(&_requests[i - 1]);
+    }
+}
+
+TileRequestPool::~TileRequestPool() { delete[] _requests; }
+
+TileRequest* TileRequestPool::acquire()
+{
+    std::lock_guard<std::mutex> lock(_freeLock);
+
+    if(_free.empty())
+    {
+        return nullptr;
+    }
+
+    auto request = _free.back();
+    _free.pop_back();
+
+    return request;
+}
+
+void TileRequestPool::release(TileRequest* request)
+{
+    request->reset();
+
+    std::lock_guard<std::mutex> lock(_freeLock);
+    _free.push_back(request);
+}
+
+size_t TileRequestPool::getCapacity() { return _capacity; }
+} // namespace ooc
+} // namespace vt
@@ -0,0 +1,146 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/vt/pre/AtlasCompressor.h>
+#include <lamure/vt/pre/PayloadWriter.h>
+#include <lamure/vt/pre/TileCodec.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace vt
+{
+namespace pre
+{
+AtlasCompressor::AtlasCompressor(const char* fileName) : AtlasFile(fileName) {}
+
+void AtlasCompressor::compress(const char* destFileName, size_t threadCount)
+{
+    if(_format != LAYOUT::PACKED)
+    {
+        throw std::runtime_error("Only packed Atlas-Files can be compressed.");
+    }
+
+    threadCount = std::max<size_t>(1, threadCount);
+
+    std::fstream destFile(destFileName, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+
+    if(!destFile.is_open())
+    {
+        throw std::runtime_error("Could not open destination Atlas-File.");
+    }
+
+    // header and both indices, the offset index is overwritten once all tile sizes are known
+    std::vector<char> head(_payloadOffset);
+
+    _file.seekg(0);
+    _file.read(head.data(), head.size());
+
+    if(!_file.good())
+    {
+        throw std::runtime_error("Could not read Atlas-File.");
+    }
+
+    // see Preprocessor::_putFileFormat
+    head[46] = 3;
+
+    destFile.write(head.data(), head.size());
+
+    // tiles keep the descending id order of the packed layout, so the offset index stays contiguous
+    std::vector<uint64_t> ids;
+    ids.reserve(_filledTileCount);
+
+    for(uint64_t id = _totalTileCount; id-- > 0;)
+    {
+        if(_offsetIndex->exists(id))
+        {
+            ids.push_back(id);
+        }
+    }
+
+    OffsetIndex offsetIndex(_totalTileCount, LAYOUT::COMPRESSED);
+    size_t maxEncodedSize = TileCodec::maxEncodedSize(_tileWidth, _tileHeight, _pxFormat);
+    size_t batchSize = threadCount * 64;
+    std::vector<std::vector<uint8_t>> encodedTiles(batchSize);
+    uint64_t payloadByteSize = 0;
+
+    PayloadWriter writer(destFile, _payloadOffset, batchSize * maxEncodedSize);
+
+    for(size_t batchStart = 0; batchStart < ids.size(); batchStart += batchSize)
+    {
+        size_t batchEnd = std::min(ids.size(), batchStart + batchSize);
+        std::atomic<size_t> nextTile(batchStart);
+        std::vector<std::thread> threads;
+        std::mutex errorLock;
+        std::exception_ptr error;
+
+        for(size_t i = 0; i < threadCount; ++i)
+        {
+            threads.emplace_back([&]() {
+                try
+                {
+                    std::vector<uint8_t> tile(_tileByteSize);
+
+                    for(size_t idx = nextTile++; idx < batchEnd; idx = nextTile++)
+                    {
+                        auto& encodedTile = encodedTiles[idx - batchStart];
+
+                        getTile(ids[idx], tile.data());
+
+                        encodedTile.resize(maxEncodedSize);
+                        encodedTile.resize(TileCodec::encode(tile.data(), _tileWidth, _tileHeight, _pxFormat, encodedTile.data()));
+                    }
+                }
+                catch(...)
+                {
+                    std::lock_guard<std::mutex> lock(errorLock);
+                    error = std::current_exception();
+                    nextTile = batchEnd;
+                }
+            });
+        }
+
+        for(auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        if(error)
+        {
+            std::rethrow_exception(error);
+        }
+
+        for(size_t idx = batchStart; idx < batchEnd; ++idx)
+        {
+            auto& encodedTile = encodedTiles[idx - batchStart];
+            size_t byteSize = encodedTile.size();
+
+            offsetIndex.set(ids[idx], payloadByteSize, byteSize);
+            writer.write(payloadByteSize, std::move(encodedTile));
+            payloadByteSize += byteSize;
+
+            encodedTile = std::vector<uint8_t>();
+        }
+    }
+
+    writer.flush();
+
+    destFile.seekp(_offsetIndexOffset);
+    offsetIndex.writeToFile(destFile);
+    destFile.flush();
+
+    if(!destFile.good())
+    {
+        throw std::runtime_error("Could not write destination Atlas-File.");
+    }
+}
+} // namespace pre
+} // namespace vt
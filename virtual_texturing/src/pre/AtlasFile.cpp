@@ -7,6 +7,15 @@
 
 #include <lamure/vt/pre/AtlasFile.h>
 #include <lamure/vt/pre/OffsetIndex.h>
+#include <lamure/vt/pre/TileCodec.h>
+
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace vt
 {
@@ -43,6 +52,8 @@ AtlasFile::LAYOUT AtlasFile::_getFormat(uint8_t* data)
         return LAYOUT::RAW;
     case 2:
         return LAYOUT::PACKED;
+    case 3:
+        return LAYOUT::COMPRESSED;
     default:
         throw std::runtime_error("Trying to load unknown File Format.");
     }
@@ -142,14 +153,38 @@ AtlasFile::AtlasFile(const char* fileName)
         _file.seekg(_offsetIndexOffset);
         _offsetIndex->readFromFile(_file);
     }
+    else if(_format == LAYOUT::COMPRESSED)
+    {
+        _offsetIndex = new OffsetIndex(_totalTileCount, _format);
+        _file.seekg(_offsetIndexOffset);
+        _offsetIndex->readFromFile(_file);
+
+        // the root tile is stored last
+        if(!_offsetIndex->exists(0) || fileLen != _payloadOffset + _offsetIndex->getOffset(0) + _offsetIndex->getLength(0))
+        {
+            throw std::runtime_error("Atlas-File does not have the expected Size.");
+        }
+    }
 
     _cielabIndex = new CielabIndex(_totalTileCount);
     _file.seekg(_cielabIndexOffset);
     _cielabIndex->readFromFile(_file);
+
+#ifndef _WIN32
+    _fileDescriptor = ::open(fileName, O_RDONLY);
+
+    if(_fileDescriptor < 0)
+    {
+        throw std::runtime_error("Could not open Atlas-File.");
+    }
+#endif
 }
 
 AtlasFile::~AtlasFile()
 {
+#ifndef _WIN32
+    ::close(_fileDescriptor);
+#endif
     _file.close();
     delete _offsetIndex;
     delete _cielabIndex;
@@ -193,11 +228,21 @@ uint64_t AtlasFile::_getOffset(uint64_t id)
 
 float AtlasFile::getCielabValue(uint64_t id) { return _cielabIndex->getCielabValue(id); }
 
+uint64_t AtlasFile::getStoredTileByteSize(uint64_t id)
+{
+    if(_format == LAYOUT::COMPRESSED)
+    {
+        return _offsetIndex->exists(id) ? _offsetIndex->getLength(id) : 0;
+    }
+
+    return _tileByteSize;
+}
+
 bool AtlasFile::getTile(uint64_t id, uint8_t* out)
 {
     uint64_t offset = 0;
 
-    if(_format == LAYOUT::PACKED)
+    if(_format == LAYOUT::PACKED || _format == LAYOUT::COMPRESSED)
     {
         if(_offsetIndex->exists(id))
         {
@@ -220,8 +265,57 @@ bool AtlasFile::getTile(uint64_t id, uint8_t* out)
         return false;
     }
 
-    _file.seekg(_payloadOffset + offset);
-    _file.read((char*)out, _tileByteSize);
+    auto data = out;
+    size_t len = _tileByteSize;
+
+    // one buffer per loader thread, a compressed tile is never larger than its raw encoding plus the codec id
+    static thread_local std::vector<uint8_t> encodedTile;
+
+    if(_format == LAYOUT::COMPRESSED)
+    {
+        len = _offsetIndex->getLength(id);
+
+        if(len > TileCodec::maxEncodedSize(_tileWidth, _tileHeight, _pxFormat))
+        {
+            throw std::runtime_error("Could not read Tile from Atlas-File.");
+        }
+
+        encodedTile.resize(len);
+        data = encodedTile.data();
+    }
+
+#ifdef _WIN32
+    {
+        std::lock_guard<std::mutex> lock(_fileLock);
+
+        _file.seekg(_payloadOffset + offset);
+        _file.read((char*)data, len);
+    }
+#else
+    size_t bytesRead = 0;
+
+    while(bytesRead < len)
+    {
+        ssize_t result = ::pread(_fileDescriptor, data + bytesRead, len - bytesRead, (off_t)(_payloadOffset + offset + bytesRead));
+
+        if(result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if(result <= 0)
+        {
+            throw std::runtime_error("Could not read Tile from Atlas-File.");
+        }
+
+        bytesRead += (size_t)result;
+    }
+#endif
+
+    if(_format == LAYOUT::COMPRESSED)
+    {
+        TileCodec::decode(data, len, _tileWidth, _tileHeight, _pxFormat, out);
+    }
 
     return true;
 }
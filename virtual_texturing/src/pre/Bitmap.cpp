@@ -6,303 +6,481 @@
 // http://www.uni-weimar.de/medien/vr
 
 #include <lamure/vt/pre/Bitmap.h>
+#include <array>
 #include <cmath>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
 
 namespace vt
 {
 namespace pre
 {
-inline double cielabF(double t)
+// cube root by an exponent estimate and three Newton steps, branch free so it maps onto SIMD lanes
+inline float cielabCbrt(float t)
 {
-    if(t > Bitmap::CIELAB_E)
+    uint32_t bits;
+    std::memcpy(&bits, &t, sizeof(bits));
+    bits = (uint32_t)((float)bits * (1.0f / 3.0f)) + 709921077u;
+
+    float y;
+    std::memcpy(&y, &bits, sizeof(y));
+
+    for(size_t i = 0; i < 3; ++i)
     {
-        return std::cbrt(t);
+        y = y * (2.0f / 3.0f) + t / (3.0f * y * y);
+    }
+
+    return y;
+}
+
+inline float cielabF(float t)
+{
+    if(t > (float)Bitmap::CIELAB_E)
+    {
+        return cielabCbrt(t);
     }
     else
     {
-        return (7.787 * t) + (16 / 116);
+        return (7.787f * t) + (16 / 116);
     }
 }
 
-inline double cielabNormaliseRGB(double rgb)
+// linear RGB in [0, 100] of all 8 bit sRGB values, evaluated once instead of per channel
+inline const float* cielabLinearRGBTable()
 {
-    rgb /= 255;
+    static const std::array<float, 256> table = []() {
+        std::array<float, 256> values;
+
+        for(size_t i = 0; i < values.size(); ++i)
+        {
+            double rgb = (double)i / 255;
 
-    if(rgb > 0.04045)
+            if(rgb > 0.04045)
+            {
+                rgb = std::pow((rgb + 0.055) / 1.055, 2.4);
+            }
+            else
+            {
+                rgb = rgb / 12.92;
+            }
+
+            values[i] = (float)(rgb * 100);
+        }
+
+        return values;
+    }();
+
+    return table.data();
+}
+
+// row kernels, the formats are template parameters so the per pixel switches fold away
+typedef void (*copy_row_type)(const uint8_t* src, uint8_t* dest, size_t count);
+typedef void (*deflate_row_type)(const uint8_t* src0, const uint8_t* src1, uint8_t* dest, size_t destCount);
+
+constexpr size_t formatSize(Bitmap::PIXEL_FORMAT format) { return format == Bitmap::R8 ? 1 : (format == Bitmap::RGB8 ? 3 : (format == Bitmap::RGBA8 ? 4 : 12)); }
+
+template <Bitmap::PIXEL_FORMAT SRC>
+inline void readPixel(const uint8_t* px, uint32_t& r, uint32_t& g, uint32_t& b, uint32_t& a)
+{
+    r = px[0];
+    g = SRC == Bitmap::R8 ? px[0] : px[1];
+    b = SRC == Bitmap::R8 ? px[0] : px[2];
+    a = SRC == Bitmap::RGBA8 ? px[3] : 0xff;
+}
+
+// channels are sums of count pixels
+template <Bitmap::PIXEL_FORMAT DEST, uint32_t count>
+inline void writePixel(uint8_t* px, uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+{
+    if(DEST == Bitmap::R8)
     {
-        rgb = std::pow((rgb + 0.055) / 1.055, 2.4);
+        px[0] = (uint8_t)((r + g + b) / (3 * count));
     }
     else
     {
-        rgb = rgb / 12.92;
-    }
+        px[0] = (uint8_t)(r / count);
+        px[1] = (uint8_t)(g / count);
+        px[2] = (uint8_t)(b / count);
 
-    return rgb * 100;
+        if(DEST == Bitmap::RGBA8)
+        {
+            px[3] = (uint8_t)(a / count);
+        }
+    }
 }
 
-void Bitmap::_copyPixel(const uint8_t* const srcPx, PIXEL_FORMAT srcFormat, uint8_t* const destPx, PIXEL_FORMAT destFormat)
+template <Bitmap::PIXEL_FORMAT SRC, Bitmap::PIXEL_FORMAT DEST>
+void copyRow(const uint8_t* src, uint8_t* dest, size_t count)
 {
-    switch(srcFormat)
+    uint32_t r, g, b, a;
+
+    for(size_t x = 0; x < count; ++x, src += formatSize(SRC), dest += formatSize(DEST))
     {
-    case PIXEL_FORMAT::R8:
-        switch(destFormat)
-        {
-        case PIXEL_FORMAT::R8:
-            destPx[0] = srcPx[0];
+        readPixel<SRC>(src, r, g, b, a);
+        writePixel<DEST, 1>(dest, r, g, b, a);
+    }
+}
 
-            break;
-        case PIXEL_FORMAT::RGBA8:
-            destPx[3] = 0xff;
-        case PIXEL_FORMAT::RGB8:
-            destPx[0] = srcPx[0];
-            destPx[1] = srcPx[0];
-            destPx[2] = srcPx[0];
+template <Bitmap::PIXEL_FORMAT SRC>
+inline void pixelToLab(const uint8_t* src, const float* linearRGB, float* labDestPx)
+{
+    // 10° D65
+    float varR = linearRGB[src[0]];
+    float varG = SRC == Bitmap::R8 ? varR : linearRGB[src[1]];
+    float varB = SRC == Bitmap::R8 ? varR : linearRGB[src[2]];
 
-            break;
-        case PIXEL_FORMAT::LAB:
-        {
-            // 10° D65
-            double varR = cielabNormaliseRGB(srcPx[0]);
-            double varG = varR;
-            double varB = varR;
+    float x = 0.4124564f * varR + 0.3575761f * varG + 0.1804375f * varB;
+    float y = 0.2126729f * varR + 0.7151522f * varG + 0.0721750f * varB;
+    float z = 0.0193339f * varR + 0.1191920f * varG + 0.9503041f * varB;
 
-            double x = (double)0.4124564 * varR + (double)0.3575761 * varG + (double)0.1804375 * varB;
-            double y = (double)0.2126729 * varR + (double)0.7151522 * varG + (double)0.0721750 * varB;
-            double z = (double)0.0193339 * varR + (double)0.1191920 * varG + (double)0.9503041 * varB;
+    float ye = y * (float)(1 / Bitmap::CIELAB_REF_Y);
 
-            double ye = y / Bitmap::CIELAB_REF_Y;
+    float fx = cielabF(x * (float)(1 / Bitmap::CIELAB_REF_X));
+    float fy = cielabF(ye);
+    float fz = cielabF(z * (float)(1 / Bitmap::CIELAB_REF_Z));
 
-            double fx = cielabF(x / Bitmap::CIELAB_REF_X);
-            double fy = cielabF(ye);
-            double fz = cielabF(z / Bitmap::CIELAB_REF_Z);
+    // RGBA sources always used the cube root branch for L
+    if(SRC == Bitmap::RGBA8 || ye > (float)Bitmap::CIELAB_E)
+    {
+        labDestPx[0] = 116.0f * fy - 16.0f; // L
+    }
+    else
+    {
+        labDestPx[0] = (float)Bitmap::CIELAB_K * ye; // L
+    }
 
-            auto labDestPx = (float*)destPx;
+    labDestPx[1] = 500.0f * (fx - fy); // a
+    labDestPx[2] = 200.0f * (fy - fz); // b
+}
 
-            if(ye > Bitmap::CIELAB_E)
-            {
-                labDestPx[0] = (float)((double)116 * std::cbrt(ye) - 16); // L
-            }
-            else
-            {
-                labDestPx[0] = (float)(Bitmap::CIELAB_K * ye); // L
-            }
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+inline __m128 cielabF(__m128 t)
+{
+    __m128 y = _mm_castsi128_ps(_mm_add_epi32(_mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(_mm_castps_si128(t)), _mm_set1_ps(1.0f / 3.0f))), _mm_set1_epi32(709921077)));
 
-            labDestPx[1] = (float)((double)500 * (fx - fy)); // a
-            labDestPx[2] = (float)((double)200 * (fy - fz)); // b
+    for(size_t i = 0; i < 3; ++i)
+    {
+        y = _mm_add_ps(_mm_mul_ps(y, _mm_set1_ps(2.0f / 3.0f)), _mm_div_ps(t, _mm_mul_ps(_mm_set1_ps(3.0f), _mm_mul_ps(y, y))));
+    }
 
-            break;
-        }
-        default:
-            throw std::runtime_error("No Conversion between given Pixel Formats.");
-        }
+    __m128 cubeRoot = _mm_cmpgt_ps(t, _mm_set1_ps((float)Bitmap::CIELAB_E));
 
-        break;
-    case PIXEL_FORMAT::RGB8:
-        switch(destFormat)
-        {
-        case PIXEL_FORMAT::R8:
-            destPx[0] = (uint8_t)(((uint16_t)srcPx[0] + srcPx[1] + srcPx[2]) / 3);
+    return _mm_or_ps(_mm_and_ps(cubeRoot, y), _mm_andnot_ps(cubeRoot, _mm_mul_ps(t, _mm_set1_ps(7.787f))));
+}
 
-            break;
-        case PIXEL_FORMAT::RGBA8:
-            destPx[3] = 0xff;
-        case PIXEL_FORMAT::RGB8:
-            destPx[0] = srcPx[0];
-            destPx[1] = srcPx[1];
-            destPx[2] = srcPx[2];
+template <Bitmap::PIXEL_FORMAT SRC>
+void copyRowToLab(const uint8_t* src, uint8_t* dest, size_t count)
+{
+    const float* linearRGB = cielabLinearRGBTable();
+    auto labDestPx = (float*)dest;
+    size_t i = 0;
 
-            break;
-        case PIXEL_FORMAT::LAB:
+    // 4 pixels per step, the table lookups stay scalar
+    for(; i + 4 <= count; i += 4, src += 4 * formatSize(SRC), labDestPx += 12)
+    {
+        __m128 varR = _mm_setr_ps(linearRGB[src[0]], linearRGB[src[formatSize(SRC)]], linearRGB[src[2 * formatSize(SRC)]], linearRGB[src[3 * formatSize(SRC)]]);
+        __m128 varG = varR;
+        __m128 varB = varR;
+
+        if(SRC != Bitmap::R8)
         {
-            // 10° D65
-            double varR = cielabNormaliseRGB(srcPx[0]);
-            double varG = cielabNormaliseRGB(srcPx[1]);
-            double varB = cielabNormaliseRGB(srcPx[2]);
+            varG = _mm_setr_ps(linearRGB[src[1]], linearRGB[src[formatSize(SRC) + 1]], linearRGB[src[2 * formatSize(SRC) + 1]], linearRGB[src[3 * formatSize(SRC) + 1]]);
+            varB = _mm_setr_ps(linearRGB[src[2]], linearRGB[src[formatSize(SRC) + 2]], linearRGB[src[2 * formatSize(SRC) + 2]], linearRGB[src[3 * formatSize(SRC) + 2]]);
+        }
 
-            double x = (double)0.4124564 * varR + (double)0.3575761 * varG + (double)0.1804375 * varB;
-            double y = (double)0.2126729 * varR + (double)0.7151522 * varG + (double)0.0721750 * varB;
-            double z = (double)0.0193339 * varR + (double)0.1191920 * varG + (double)0.9503041 * varB;
+        __m128 x = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(0.4124564f), varR), _mm_mul_ps(_mm_set1_ps(0.3575761f), varG)), _mm_mul_ps(_mm_set1_ps(0.1804375f), varB));
+        __m128 y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(0.2126729f), varR), _mm_mul_ps(_mm_set1_ps(0.7151522f), varG)), _mm_mul_ps(_mm_set1_ps(0.0721750f), varB));
+        __m128 z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(0.0193339f), varR), _mm_mul_ps(_mm_set1_ps(0.1191920f), varG)), _mm_mul_ps(_mm_set1_ps(0.9503041f), varB));
 
-            double ye = y / Bitmap::CIELAB_REF_Y;
+        __m128 ye = _mm_mul_ps(y, _mm_set1_ps((float)(1 / Bitmap::CIELAB_REF_Y)));
 
-            double fx = cielabF(x / Bitmap::CIELAB_REF_X);
-            double fy = cielabF(ye);
-            double fz = cielabF(z / Bitmap::CIELAB_REF_Z);
+        __m128 fx = cielabF(_mm_mul_ps(x, _mm_set1_ps((float)(1 / Bitmap::CIELAB_REF_X))));
+        __m128 fy = cielabF(ye);
+        __m128 fz = cielabF(_mm_mul_ps(z, _mm_set1_ps((float)(1 / Bitmap::CIELAB_REF_Z))));
 
-            auto labDestPx = (float*)destPx;
+        __m128 l = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(116.0f), fy), _mm_set1_ps(16.0f));
 
-            if(ye > 0.008856)
-            {
-                labDestPx[0] = (float)((double)116 * std::cbrt(ye) - 16); // L
-            }
-            else
-            {
-                labDestPx[0] = (float)((double)903.3 * ye); // L
-            }
+        if(SRC != Bitmap::RGBA8)
+        {
+            __m128 cubeRoot = _mm_cmpgt_ps(ye, _mm_set1_ps((float)Bitmap::CIELAB_E));
+            l = _mm_or_ps(_mm_and_ps(cubeRoot, l), _mm_andnot_ps(cubeRoot, _mm_mul_ps(ye, _mm_set1_ps((float)Bitmap::CIELAB_K))));
+        }
 
-            labDestPx[1] = (float)((double)500 * (fx - fy)); // a
-            labDestPx[2] = (float)((double)200 * (fy - fz)); // b
+        float lab[3][4];
+        _mm_storeu_ps(lab[0], l);
+        _mm_storeu_ps(lab[1], _mm_mul_ps(_mm_set1_ps(500.0f), _mm_sub_ps(fx, fy)));
+        _mm_storeu_ps(lab[2], _mm_mul_ps(_mm_set1_ps(200.0f), _mm_sub_ps(fy, fz)));
 
-            break;
-        }
-        default:
-            throw std::runtime_error("No Conversion between given Pixel Formats.");
+        for(size_t px = 0; px < 4; ++px)
+        {
+            labDestPx[3 * px] = lab[0][px];
+            labDestPx[3 * px + 1] = lab[1][px];
+            labDestPx[3 * px + 2] = lab[2][px];
         }
+    }
 
-        break;
-    case PIXEL_FORMAT::RGBA8:
-        switch(destFormat)
-        {
-        case PIXEL_FORMAT::R8:
-            destPx[0] = (uint8_t)(((uint16_t)srcPx[0] + srcPx[1] + srcPx[2]) / 3);
+    for(; i < count; ++i, src += formatSize(SRC), labDestPx += 3)
+    {
+        pixelToLab<SRC>(src, linearRGB, labDestPx);
+    }
+}
+#else
+template <Bitmap::PIXEL_FORMAT SRC>
+void copyRowToLab(const uint8_t* src, uint8_t* dest, size_t count)
+{
+    const float* linearRGB = cielabLinearRGBTable();
+    auto labDestPx = (float*)dest;
 
-            break;
-        case PIXEL_FORMAT::RGB8:
-            destPx[0] = srcPx[0];
-            destPx[1] = srcPx[1];
-            destPx[2] = srcPx[2];
+    for(size_t i = 0; i < count; ++i, src += formatSize(SRC), labDestPx += 3)
+    {
+        pixelToLab<SRC>(src, linearRGB, labDestPx);
+    }
+}
+#endif
 
-            break;
-        case PIXEL_FORMAT::RGBA8:
-            destPx[0] = srcPx[0];
-            destPx[1] = srcPx[1];
-            destPx[2] = srcPx[2];
-            destPx[3] = srcPx[3];
+template <Bitmap::PIXEL_FORMAT SRC, Bitmap::PIXEL_FORMAT DEST>
+void deflateRow(const uint8_t* src0, const uint8_t* src1, uint8_t* dest, size_t destCount)
+{
+    uint32_t r0, g0, b0, a0, r1, g1, b1, a1, r2, g2, b2, a2, r3, g3, b3, a3;
 
-            break;
-        case PIXEL_FORMAT::LAB:
-        {
-            // 10° D65
-            double varR = (double)srcPx[0] / 255;
-            double varG = (double)srcPx[1] / 255;
-            double varB = (double)srcPx[2] / 255;
+    for(size_t x = 0; x < destCount; ++x, src0 += 2 * formatSize(SRC), src1 += 2 * formatSize(SRC), dest += formatSize(DEST))
+    {
+        readPixel<SRC>(src0, r0, g0, b0, a0);
+        readPixel<SRC>(src0 + formatSize(SRC), r1, g1, b1, a1);
+        readPixel<SRC>(src1, r2, g2, b2, a2);
+        readPixel<SRC>(src1 + formatSize(SRC), r3, g3, b3, a3);
+        writePixel<DEST, 4>(dest, r0 + r1 + r2 + r3, g0 + g1 + g2 + g3, b0 + b1 + b2 + b3, a0 + a1 + a2 + a3);
+    }
+}
 
-            if(varR > 0.04045)
-            {
-                varR = std::pow((varR + 0.055) / 1.055, 2.4);
-            }
-            else
-            {
-                varR = varR / 12.92;
-            }
+template <Bitmap::PIXEL_FORMAT FORMAT>
+void copyRowIdentical(const uint8_t* src, uint8_t* dest, size_t count)
+{
+    std::memcpy(dest, src, count * formatSize(FORMAT));
+}
 
-            if(varG > 0.04045)
-            {
-                varG = std::pow((varG + 0.055) / 1.055, 2.4);
-            }
-            else
-            {
-                varG = varG / 12.92;
-            }
+#if defined(__AVX2__) || defined(__SSSE3__)
+void copyRowRGB8ToRGBA8(const uint8_t* src, uint8_t* dest, size_t count)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32((int)0xff000000);
+    size_t x = 0;
 
-            if(varB > 0.04045)
-            {
-                varB = std::pow((varB + 0.055) / 1.055, 2.4);
-            }
-            else
-            {
-                varB = varB / 12.92;
-            }
+    // 16 byte loads of 4 pixels, stop while a load would reach past the row
+    for(; x + 6 <= count; x += 4)
+    {
+        __m128i px = _mm_loadu_si128((const __m128i*)(src + 3 * x));
+        _mm_storeu_si128((__m128i*)(dest + 4 * x), _mm_or_si128(_mm_shuffle_epi8(px, shuffle), alpha));
+    }
 
-            varR *= 100;
-            varG *= 100;
-            varB *= 100;
+    copyRow<Bitmap::RGB8, Bitmap::RGBA8>(src + 3 * x, dest + 4 * x, count - x);
+}
 
-            double x = (double)0.4124564 * varR + (double)0.3575761 * varG + (double)0.1804375 * varB;
-            double y = (double)0.2126729 * varR + (double)0.7151522 * varG + (double)0.0721750 * varB;
-            double z = (double)0.0193339 * varR + (double)0.1191920 * varG + (double)0.9503041 * varB;
+void copyRowRGBA8ToRGB8(const uint8_t* src, uint8_t* dest, size_t count)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    size_t x = 0;
 
-            double xe = x / Bitmap::CIELAB_REF_X;
-            double ye = y / Bitmap::CIELAB_REF_Y;
-            double ze = z / Bitmap::CIELAB_REF_Z;
+    for(; x + 4 <= count; x += 4)
+    {
+        __m128i px = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + 4 * x)), shuffle);
+        _mm_storel_epi64((__m128i*)(dest + 3 * x), px);
+        int32_t last = _mm_cvtsi128_si32(_mm_srli_si128(px, 8));
+        std::memcpy(dest + 3 * x + 8, &last, 4);
+    }
 
-            double fx = cielabF(xe);
-            double fy = cielabF(ye);
-            double fz = cielabF(ze);
+    copyRow<Bitmap::RGBA8, Bitmap::RGB8>(src + 4 * x, dest + 3 * x, count - x);
+}
 
-            auto labDestPx = (float*)destPx;
+// src0 and src1 hold 4 consecutive pixels of two rows as RGBA, returns the 2x2 averages of both pixel pairs in the low half
+inline __m128i deflateQuad(__m128i src0, __m128i src1)
+{
+    const __m128i zero = _mm_setzero_si128();
 
-            labDestPx[0] = (float)((double)116 * fy - 16);   // L
-            labDestPx[1] = (float)((double)500 * (fx - fy)); // a
-            labDestPx[2] = (float)((double)200 * (fy - fz)); // b
+    __m128i sumLo = _mm_add_epi16(_mm_unpacklo_epi8(src0, zero), _mm_unpacklo_epi8(src1, zero));
+    __m128i sumHi = _mm_add_epi16(_mm_unpackhi_epi8(src0, zero), _mm_unpackhi_epi8(src1, zero));
+    __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(sumLo, sumHi), _mm_unpackhi_epi64(sumLo, sumHi));
 
-            break;
-        }
-        default:
-            throw std::runtime_error("No Conversion between given Pixel Formats.");
-        }
+    return _mm_srli_epi16(sum, 2);
+}
 
-        break;
-    default:
-        throw std::runtime_error("Unknown Pixel Format.");
+void deflateRowRGB8(const uint8_t* src0, const uint8_t* src1, uint8_t* dest, size_t destCount)
+{
+    const __m128i expandLo = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i expandHi = _mm_setr_epi8(4, 5, 6, -1, 7, 8, 9, -1, 10, 11, 12, -1, 13, 14, 15, -1);
+    const __m128i compact = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    size_t x = 0;
+
+    // 8 source pixels are 24 bytes, read as two overlapping 16 byte loads
+    for(; x + 4 <= destCount; x += 4)
+    {
+        const uint8_t* row0 = src0 + 6 * x;
+        const uint8_t* row1 = src1 + 6 * x;
+
+        __m128i lo = deflateQuad(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)row0), expandLo), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)row1), expandLo));
+        __m128i hi = deflateQuad(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(row0 + 8)), expandHi), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(row1 + 8)), expandHi));
+        __m128i px = _mm_shuffle_epi8(_mm_packus_epi16(lo, hi), compact);
+
+        _mm_storel_epi64((__m128i*)(dest + 3 * x), px);
+        int32_t last = _mm_cvtsi128_si32(_mm_srli_si128(px, 8));
+        std::memcpy(dest + 3 * x + 8, &last, 4);
     }
+
+    deflateRow<Bitmap::RGB8, Bitmap::RGB8>(src0 + 6 * x, src1 + 6 * x, dest + 3 * x, destCount - x);
 }
+#endif
 
-void Bitmap::_deflatePixels(
-    const uint8_t* const srcPx0, const uint8_t* const srcPx1, const uint8_t* const srcPx2, const uint8_t* const srcPx3, PIXEL_FORMAT srcFormat, uint8_t* const destPx, PIXEL_FORMAT destFormat)
+#if defined(__AVX2__)
+void deflateRowRGBA8(const uint8_t* src0, const uint8_t* src1, uint8_t* dest, size_t destCount)
 {
-    switch(srcFormat)
+    const __m256i zero = _mm256_setzero_si256();
+    size_t x = 0;
+
+    for(; x + 8 <= destCount; x += 8)
     {
-    case PIXEL_FORMAT::R8:
-        switch(destFormat)
-        {
-        case PIXEL_FORMAT::R8:
-            destPx[0] = (uint8_t)(((uint16_t)srcPx0[0] + srcPx1[0] + srcPx2[0] + srcPx3[0]) >> 2);
+        const uint8_t* row0 = src0 + 8 * x;
+        const uint8_t* row1 = src1 + 8 * x;
+        __m256i sum[2];
 
-            break;
-        case PIXEL_FORMAT::RGBA8:
-            destPx[3] = 0xff;
-        case PIXEL_FORMAT::RGB8:
-            destPx[0] = (uint8_t)(((uint16_t)srcPx0[0] + srcPx1[0] + srcPx2[0] + srcPx3[0]) >> 2);
-            destPx[1] = (uint8_t)(((uint16_t)srcPx0[0] + srcPx1[0] + srcPx2[0] + srcPx3[0]) >> 2);
-            destPx[2] = (uint8_t)(((uint16_t)srcPx0[0] + srcPx1[0] + srcPx2[0] + srcPx3[0]) >> 2);
+        for(size_t i = 0; i < 2; ++i)
+        {
+            __m256i px0 = _mm256_loadu_si256((const __m256i*)(row0 + 32 * i));
+            __m256i px1 = _mm256_loadu_si256((const __m256i*)(row1 + 32 * i));
 
-            break;
-        default:
-            throw std::runtime_error("No Conversion between given Pixel Formats.");
+            __m256i sumLo = _mm256_add_epi16(_mm256_unpacklo_epi8(px0, zero), _mm256_unpacklo_epi8(px1, zero));
+            __m256i sumHi = _mm256_add_epi16(_mm256_unpackhi_epi8(px0, zero), _mm256_unpackhi_epi8(px1, zero));
+            sum[i] = _mm256_srli_epi16(_mm256_add_epi16(_mm256_unpacklo_epi64(sumLo, sumHi), _mm256_unpackhi_epi64(sumLo, sumHi)), 2);
         }
 
-        break;
-    case PIXEL_FORMAT::RGB8:
-        switch(destFormat)
-        {
-        case PIXEL_FORMAT::R8:
-            destPx[0] = (uint8_t)(((uint32_t)srcPx0[0] + srcPx0[1] + srcPx0[2] + srcPx1[0] + srcPx1[1] + srcPx1[2] + srcPx2[0] + srcPx2[1] + srcPx2[2] + srcPx3[0] + srcPx3[1] + srcPx3[2]) / 12);
+        // packing works per 128 bit lane, restore the pixel order afterwards
+        __m256i px = _mm256_permute4x64_epi64(_mm256_packus_epi16(sum[0], sum[1]), 0xD8);
+        _mm256_storeu_si256((__m256i*)(dest + 4 * x), px);
+    }
 
-            break;
-        case PIXEL_FORMAT::RGBA8:
-            destPx[3] = 0xff;
-        case PIXEL_FORMAT::RGB8:
-            destPx[0] = (uint8_t)(((uint16_t)srcPx0[0] + srcPx1[0] + srcPx2[0] + srcPx3[0]) >> 2);
-            destPx[1] = (uint8_t)(((uint16_t)srcPx0[1] + srcPx1[1] + srcPx2[1] + srcPx3[1]) >> 2);
-            destPx[2] = (uint8_t)(((uint16_t)srcPx0[2] + srcPx1[2] + srcPx2[2] + srcPx3[2]) >> 2);
+    deflateRow<Bitmap::RGBA8, Bitmap::RGBA8>(src0 + 8 * x, src1 + 8 * x, dest + 4 * x, destCount - x);
+}
+#elif defined(__SSE2__) || defined(_M_X64)
+void deflateRowRGBA8(const uint8_t* src0, const uint8_t* src1, uint8_t* dest, size_t destCount)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t x = 0;
 
-            break;
-        default:
-            throw std::runtime_error("No Conversion between given Pixel Formats.");
-        }
+    for(; x + 4 <= destCount; x += 4)
+    {
+        const uint8_t* row0 = src0 + 8 * x;
+        const uint8_t* row1 = src1 + 8 * x;
+        __m128i sum[2];
 
-        break;
-    case PIXEL_FORMAT::RGBA8:
-        switch(destFormat)
+        for(size_t i = 0; i < 2; ++i)
         {
-        case PIXEL_FORMAT::R8:
-            destPx[0] = (uint8_t)(((uint32_t)srcPx0[0] + srcPx0[1] + srcPx0[2] + srcPx1[0] + srcPx1[1] + srcPx1[2] + srcPx2[0] + srcPx2[1] + srcPx2[2] + srcPx3[0] + srcPx3[1] + srcPx3[2]) / 12);
+            __m128i px0 = _mm_loadu_si128((const __m128i*)(row0 + 16 * i));
+            __m128i px1 = _mm_loadu_si128((const __m128i*)(row1 + 16 * i));
 
-            break;
-        case PIXEL_FORMAT::RGBA8:
-            destPx[3] = (uint8_t)(((uint16_t)srcPx0[3] + srcPx1[3] + srcPx2[3] + srcPx3[3]) >> 2);
-        case PIXEL_FORMAT::RGB8:
-            destPx[0] = (uint8_t)(((uint16_t)srcPx0[0] + srcPx1[0] + srcPx2[0] + srcPx3[0]) >> 2);
-            destPx[1] = (uint8_t)(((uint16_t)srcPx0[1] + srcPx1[1] + srcPx2[1] + srcPx3[1]) >> 2);
-            destPx[2] = (uint8_t)(((uint16_t)srcPx0[2] + srcPx1[2] + srcPx2[2] + srcPx3[2]) >> 2);
+            __m128i sumLo = _mm_add_epi16(_mm_unpacklo_epi8(px0, zero), _mm_unpacklo_epi8(px1, zero));
+            __m128i sumHi = _mm_add_epi16(_mm_unpackhi_epi8(px0, zero), _mm_unpackhi_epi8(px1, zero));
+            sum[i] = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(sumLo, sumHi), _mm_unpackhi_epi64(sumLo, sumHi)), 2);
+        }
 
-            break;
-        default:
-            throw std::runtime_error("No Conversion between given Pixel Formats.");
+        _mm_storeu_si128((__m128i*)(dest + 4 * x), _mm_packus_epi16(sum[0], sum[1]));
+    }
+
+    deflateRow<Bitmap::RGBA8, Bitmap::RGBA8>(src0 + 8 * x, src1 + 8 * x, dest + 4 * x, destCount - x);
+}
+#else
+void deflateRowRGBA8(const uint8_t* src0, const uint8_t* src1, uint8_t* dest, size_t destCount) { deflateRow<Bitmap::RGBA8, Bitmap::RGBA8>(src0, src1, dest, destCount); }
+#endif
+
+template <Bitmap::PIXEL_FORMAT SRC>
+copy_row_type selectCopyRow(Bitmap::PIXEL_FORMAT destFormat)
+{
+    switch(destFormat)
+    {
+    case Bitmap::PIXEL_FORMAT::R8:
+        return SRC == Bitmap::R8 ? &copyRowIdentical<Bitmap::R8> : &copyRow<SRC, Bitmap::R8>;
+    case Bitmap::PIXEL_FORMAT::RGB8:
+        return SRC == Bitmap::RGB8 ? &copyRowIdentical<Bitmap::RGB8> : &copyRow<SRC, Bitmap::RGB8>;
+    case Bitmap::PIXEL_FORMAT::RGBA8:
+        return SRC == Bitmap::RGBA8 ? &copyRowIdentical<Bitmap::RGBA8> : &copyRow<SRC, Bitmap::RGBA8>;
+    case Bitmap::PIXEL_FORMAT::LAB:
+        return &copyRowToLab<SRC>;
+    default:
+        throw std::runtime_error("No Conversion between given Pixel Formats.");
+    }
+}
+
+copy_row_type selectCopyRow(Bitmap::PIXEL_FORMAT srcFormat, Bitmap::PIXEL_FORMAT destFormat)
+{
+#if defined(__AVX2__) || defined(__SSSE3__)
+    if(srcFormat == Bitmap::RGB8 && destFormat == Bitmap::RGBA8)
+    {
+        return &copyRowRGB8ToRGBA8;
+    }
+
+    if(srcFormat == Bitmap::RGBA8 && destFormat == Bitmap::RGB8)
+    {
+        return &copyRowRGBA8ToRGB8;
+    }
+#endif
+
+    switch(srcFormat)
+    {
+    case Bitmap::PIXEL_FORMAT::R8:
+        return selectCopyRow<Bitmap::R8>(destFormat);
+    case Bitmap::PIXEL_FORMAT::RGB8:
+        return selectCopyRow<Bitmap::RGB8>(destFormat);
+    case Bitmap::PIXEL_FORMAT::RGBA8:
+        return selectCopyRow<Bitmap::RGBA8>(destFormat);
+    case Bitmap::PIXEL_FORMAT::LAB:
+        if(destFormat == Bitmap::LAB)
+        {
+            return &copyRowIdentical<Bitmap::LAB>;
         }
+    default:
+        throw std::runtime_error("Unknown Pixel Format.");
+    }
+}
 
-        break;
+template <Bitmap::PIXEL_FORMAT SRC>
+deflate_row_type selectDeflateRow(Bitmap::PIXEL_FORMAT destFormat)
+{
+    switch(destFormat)
+    {
+    case Bitmap::PIXEL_FORMAT::R8:
+        return &deflateRow<SRC, Bitmap::R8>;
+    case Bitmap::PIXEL_FORMAT::RGB8:
+        return &deflateRow<SRC, Bitmap::RGB8>;
+    case Bitmap::PIXEL_FORMAT::RGBA8:
+        return &deflateRow<SRC, Bitmap::RGBA8>;
+    default:
+        throw std::runtime_error("No Conversion between given Pixel Formats.");
+    }
+}
+
+deflate_row_type selectDeflateRow(Bitmap::PIXEL_FORMAT srcFormat, Bitmap::PIXEL_FORMAT destFormat)
+{
+    if(srcFormat == Bitmap::RGBA8 && destFormat == Bitmap::RGBA8)
+    {
+        return &deflateRowRGBA8;
+    }
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+    if(srcFormat == Bitmap::RGB8 && destFormat == Bitmap::RGB8)
+    {
+        return &deflateRowRGB8;
+    }
+#endif
+
+    switch(srcFormat)
+    {
+    case Bitmap::PIXEL_FORMAT::R8:
+        return selectDeflateRow<Bitmap::R8>(destFormat);
+    case Bitmap::PIXEL_FORMAT::RGB8:
+        return selectDeflateRow<Bitmap::RGB8>(destFormat);
+    case Bitmap::PIXEL_FORMAT::RGBA8:
+        return selectDeflateRow<Bitmap::RGBA8>(destFormat);
     default:
         throw std::runtime_error("Unknown Pixel Format.");
     }
@@ -512,15 +690,18 @@ void Bitmap::copyRectFrom(const Bitmap& src, size_t srcX, size_t srcY, size_t de
     }
 #endif
 
+    if(cpyWidth == 0 || cpyHeight == 0)
+    {
+        return;
+    }
+
     size_t srcPixelSize = pixelSize(src._format);
     size_t destPixelSize = pixelSize(_format);
+    auto copy = selectCopyRow(src._format, _format);
 
     for(size_t y = 0; y < cpyHeight; ++y)
     {
-        for(size_t x = 0; x < cpyWidth; ++x)
-        {
-            _copyPixel(&src._data[((srcY + y) * src._width + srcX + x) * srcPixelSize], src._format, &_data[((destY + y) * _width + destX + x) * destPixelSize], _format);
-        }
+        copy(&src._data[((srcY + y) * src._width + srcX) * srcPixelSize], &_data[((destY + y) * _width + destX) * destPixelSize], cpyWidth);
     }
 }
 
@@ -538,21 +719,22 @@ void Bitmap::deflateRectFrom(const Bitmap& src, size_t srcX, size_t srcY, size_t
     }
 #endif
 
+    if(cpyWidth == 0 || cpyHeight == 0)
+    {
+        return;
+    }
+
     size_t srcPixelSize = pixelSize(src._format);
     size_t destPixelSize = pixelSize(_format);
+    auto deflate = selectDeflateRow(src._format, _format);
 
+    // odd sizes average with the pixel next to the rect
     for(size_t y = 0; y < cpyHeight; y += 2)
     {
-        for(size_t x = 0; x < cpyWidth; x += 2)
-        {
-            _deflatePixels(&src._data[((srcY + y) * src._width + srcX + x) * srcPixelSize],
-                           &src._data[((srcY + y) * src._width + srcX + x + 1) * srcPixelSize],
-                           &src._data[((srcY + y + 1) * src._width + srcX + x) * srcPixelSize],
-                           &src._data[((srcY + y + 1) * src._width + srcX + x + 1) * srcPixelSize],
-                           src._format,
-                           &_data[((destY + (y >> 1)) * _width + destX + (x >> 1)) * destPixelSize],
-                           _format);
-        }
+        deflate(&src._data[((srcY + y) * src._width + srcX) * srcPixelSize],
+                &src._data[((srcY + y + 1) * src._width + srcX) * srcPixelSize],
+                &_data[((destY + (y >> 1)) * _width + destX) * destPixelSize],
+                (cpyWidth + 1) >> 1);
     }
 }
 
@@ -605,7 +787,7 @@ void Bitmap::smearHorizontal(size_t srcX, size_t srcY, size_t destX, size_t dest
 
         for(size_t x = 0; x < width; ++x)
         {
-            _copyPixel(srcPx, _format, &_data[((destY + y) * _width + destX + x) * pxSize], _format);
+            std::memcpy(&_data[((destY + y) * _width + destX + x) * pxSize], srcPx, pxSize);
         }
     }
 }
@@ -627,7 +809,7 @@ void Bitmap::smearVertical(size_t srcX, size_t srcY, size_t destX, size_t destY,
 
         for(size_t y = 0; y < height; ++y)
         {
-            _copyPixel(srcPx, _format, &_data[((destY + y) * _width + destX + x) * pxSize], _format);
+            std::memcpy(&_data[((destY + y) * _width + destX + x) * pxSize], srcPx, pxSize);
         }
     }
 }
@@ -641,14 +823,25 @@ void Bitmap::fillRect(const uint8_t* const px, PIXEL_FORMAT format, size_t x, si
     }
 #endif
 
+    if(width == 0 || height == 0)
+    {
+        return;
+    }
+
     size_t pxSize = pixelSize(_format);
+    uint8_t* firstRow = &_data[(y * _width + x) * pxSize];
 
-    for(size_t yPos = 0; yPos < height; ++yPos)
+    // convert once, then replicate the first row
+    selectCopyRow(format, _format)(px, firstRow, 1);
+
+    for(size_t xPos = 1; xPos < width; ++xPos)
     {
-        for(size_t xPos = 0; xPos < width; ++xPos)
-        {
-            _copyPixel(px, format, &_data[((y + yPos) * _width + x + xPos) * pxSize], _format);
-        }
+        std::memcpy(&firstRow[xPos * pxSize], firstRow, pxSize);
+    }
+
+    for(size_t yPos = 1; yPos < height; ++yPos)
+    {
+        std::memcpy(&_data[((y + yPos) * _width + x) * pxSize], firstRow, width * pxSize);
     }
 }
 
@@ -7,7 +7,14 @@
 
 #include <lamure/vt/pre/DeltaECalculator.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #define DELTA_E_CALCULATOR_LOG_PROGRESS
 
@@ -15,84 +22,116 @@ namespace vt
 {
 namespace pre
 {
-DeltaECalculator::DeltaECalculator(const char* fileName) : AtlasFile(fileName) {}
+// averages 2x2 pixels of a distance tile into one quadrant of the next coarser distance tile
+inline void averageIntoQuadrant(const double* src, double* dest, uint64_t quadrant, size_t width, size_t height)
+{
+    size_t halfWidth = width >> 1;
+    size_t halfHeight = height >> 1;
+    size_t xOffset = (quadrant & 1) * halfWidth;
+    size_t yOffset = ((quadrant & 2) >> 1) * halfHeight;
+
+    for(size_t y = 0; y < halfHeight; ++y)
+    {
+        const double* row0 = &src[(y << 1) * width];
+        const double* row1 = &src[((y << 1) + 1) * width];
+        double* destRow = &dest[(yOffset + y) * width + xOffset];
+
+        for(size_t x = 0; x < halfWidth; ++x)
+        {
+            destRow[x] = ((row0[x << 1] + row0[(x << 1) + 1]) / 2 + (row1[x << 1] + row1[(x << 1) + 1]) / 2) / 2;
+        }
+    }
+}
 
-void DeltaECalculator::calculate(size_t maxMemory)
+// tiles of a subtree arrive from the last id to the first, so a quadrant is complete once its first tile arrived
+// and is averaged into the next level. after id 0 the whole subtree is found in the last of the depth levels
+inline void propagateDistances(const double* tile, double* levels, size_t pxCount, uint64_t id, size_t depth, size_t width, size_t height)
 {
-    uint64_t actualLevelPxWidth = _imageWidth;
-    uint64_t actualLevelPxHeight = _imageHeight;
-    uint64_t actualLevelTileWidth = _imageTileWidth;
-    uint64_t actualLevelTileHeight = _imageTileHeight;
+    const double* src = tile;
 
-    size_t innerTilePxCount = _innerTileWidth * _innerTileHeight;
-    size_t distBufferByteSize = (_treeDepth + 1) * innerTilePxCount;
-    auto distBuffer = new double[distBufferByteSize];
+    for(size_t level = 0; level < depth; ++level)
+    {
+        double* dest = &levels[level * pxCount];
+        averageIntoQuadrant(src, dest, id & 3, width, height);
 
-    maxMemory -= distBufferByteSize;
+        if((id & 3) != 0)
+        {
+            return;
+        }
 
-    uint64_t leafLevelFirstId = QuadTree::firstIdOfLevel(_treeDepth - 1);
+        id >>= 2;
+        src = dest;
+    }
+}
 
-    auto blackTileBuffer = new uint8_t[_tileByteSize];
-    std::memset(blackTileBuffer, 0, _tileByteSize);
+inline double reduceDistances(double* buffer, size_t pxCount)
+{
+    size_t oldLen = pxCount;
 
-    maxMemory -= _tileByteSize;
+    for(size_t len = (oldLen >> 1); len > 0; len = (oldLen >> 1))
+    {
+        for(size_t i = 0; i < len; ++i)
+        {
+            if(i == (len - 1) && (oldLen & 1) != 0)
+            {
+                buffer[i] = buffer[i << 1] / 3 + buffer[(i << 1) + 1] / 3 + buffer[(i << 1) + 2] / 3;
+            }
+            else
+            {
+                buffer[i] = buffer[i << 1] / 2 + buffer[(i << 1) + 1] / 2;
+            }
+        }
 
-    size_t rootBufferTileSize = (maxMemory >> 1) / _tileByteSize;
-    size_t rootBufferByteSize = rootBufferTileSize * _tileByteSize;
-    uint64_t rootBufferOffset = 0;
-    auto rootBuffer = new uint8_t[rootBufferByteSize];
+        oldLen = len;
+    }
 
-    size_t leafBufferTileSize = (maxMemory >> 1) / _tileByteSize;
-    size_t leafBufferByteSize = leafBufferTileSize * _tileByteSize;
-    uint64_t leafBufferOffset = 0;
-    auto leafBuffer = new uint8_t[leafBufferByteSize];
+    return buffer[0];
+}
 
-    Bitmap rootBitmap(_tileWidth, _tileHeight, _pxFormat, rootBuffer);
-    Bitmap leafBitmap(_tileWidth, _tileHeight, _pxFormat, leafBuffer);
+DeltaECalculator::DeltaECalculator(const char* fileName) : AtlasFile(fileName) {}
 
-    Bitmap rootLab(_innerTileWidth, _innerTileHeight, Bitmap::PIXEL_FORMAT::LAB);
-    Bitmap leafLab(_innerTileWidth, _innerTileHeight, Bitmap::PIXEL_FORMAT::LAB);
+void DeltaECalculator::calculate(size_t maxMemory, size_t threadCount)
+{
+    threadCount = std::max<size_t>(1, threadCount);
 
-    auto rootData = (float*)rootLab.getData();
-    auto leafData = (float*)leafLab.getData();
+    uint64_t actualLevelTileWidth = _imageTileWidth;
+    uint64_t actualLevelTileHeight = _imageTileHeight;
+
+    size_t innerTilePxCount = _innerTileWidth * _innerTileHeight;
+    size_t distTileByteSize = innerTilePxCount * sizeof(double);
+    uint64_t leafLevelFirstId = QuadTree::firstIdOfLevel(_treeDepth - 1);
+
+    // tiles, lab tiles and one distance tile per level of the deepest subtree
+    size_t threadByteSize = 2 * _tileByteSize + 2 * innerTilePxCount * Bitmap::pixelSize(Bitmap::PIXEL_FORMAT::LAB) + _treeDepth * distTileByteSize;
+    size_t subtreeBufferCount = maxMemory > threadCount * threadByteSize ? (maxMemory - threadCount * threadByteSize) / distTileByteSize : 0;
+
+#ifdef DELTA_E_CALCULATOR_LOG_PROGRESS
+    auto totalStart = std::chrono::high_resolution_clock::now();
+    uint64_t totalTilesLoaded = 0;
+
+    std::cout << "Calculating Delta-E with " << threadCount << " Threads" << std::endl;
+#endif
 
     if(_treeDepth > 1)
     {
         for(uint32_t level = _treeDepth - 2;; --level)
         {
-            rootBufferOffset = UINT64_MAX;
-            leafBufferOffset = UINT64_MAX;
-
-            actualLevelPxWidth = (actualLevelPxWidth + 1) >> 1;
-            actualLevelPxHeight = (actualLevelPxHeight + 1) >> 1;
             actualLevelTileWidth = (actualLevelTileWidth + 1) >> 1;
             actualLevelTileHeight = (actualLevelTileHeight + 1) >> 1;
-            uint64_t actualLevelTiles = actualLevelTileWidth * actualLevelTileHeight;
 
             uint64_t levelFirstId = QuadTree::firstIdOfLevel(level);
             uint64_t levelWidth = QuadTree::getWidthOfLevel(level);
             uint64_t levelTiles = levelWidth * levelWidth;
-            uint64_t firstTileInLevelFileOffset = UINT64_MAX;
 
             uint32_t iterTreeDepth = _treeDepth - level;
             uint32_t iterLevel = iterTreeDepth - 1;
             uint64_t iterLevelWidth = QuadTree::getWidthOfLevel(iterLevel);
             uint64_t iterLevelTiles = iterLevelWidth * iterLevelWidth;
 
-#ifdef DELTA_E_CALCULATOR_LOG_PROGRESS
-            auto start = std::chrono::high_resolution_clock::now();
-            uint8_t progress = 0;
-            uint64_t tilesLoaded = 0;
-
-            std::cout << "Calculating Delta-E for " << (actualLevelTiles) << " Tiles in Level " << level << std::endl;
-            std::cout << std::setw(3) << (int)progress << " %";
-            std::cout.flush();
-#endif
+            std::vector<uint64_t> rootRelIds;
 
-            for(uint64_t rootLevelRelId = levelTiles - 1;; --rootLevelRelId)
+            for(uint64_t rootLevelRelId = levelTiles; rootLevelRelId-- > 0;)
             {
-                uint64_t rootLevelAbsId = levelFirstId + rootLevelRelId;
-
                 uint64_t rootXCoord;
                 uint64_t rootYCoord;
 
@@ -100,172 +139,171 @@ void DeltaECalculator::calculate(size_t maxMemory)
 
                 if(rootXCoord < actualLevelTileWidth && rootYCoord < actualLevelTileHeight)
                 {
-                    uint64_t tileOffset = _offsetIndex->getOffset(rootLevelAbsId);
-
-                    if(tileOffset < rootBufferOffset || tileOffset >= (rootBufferOffset + rootBufferByteSize))
-                    {
-                        if(firstTileInLevelFileOffset == UINT64_MAX)
-                        {
-                            firstTileInLevelFileOffset = tileOffset;
-                        }
-
-                        _file.seekg(_payloadOffset + tileOffset);
-                        _file.read((char*)rootBuffer, std::min(rootBufferByteSize, firstTileInLevelFileOffset + (actualLevelTileWidth * actualLevelTileHeight * _tileByteSize) - tileOffset));
+                    rootRelIds.push_back(rootLevelRelId);
+                }
+            }
 
-                        rootBufferOffset = tileOffset;
-                    }
+            // the upper levels have fewer tiles than threads, their subtrees are split into independent
+            // parts of splitDepth levels less, which are averaged into the root tile afterwards
+            uint32_t splitDepth = 0;
 
-                    rootBitmap.setData(&rootBuffer[tileOffset - rootBufferOffset]);
-                    rootLab.copyRectFrom(rootBitmap, _padding, _padding, 0, 0, _innerTileWidth, _innerTileHeight);
+            while(splitDepth < iterLevel && (rootRelIds.size() << (splitDepth << 1)) < 4 * threadCount && ((size_t)4 << (splitDepth << 1)) <= subtreeBufferCount)
+            {
+                ++splitDepth;
+            }
 
-                    for(uint64_t relIterId = iterLevelTiles - 1;; --relIterId)
-                    {
-                        uint64_t leafLevelRelId = rootLevelRelId * iterLevelTiles + relIterId;
-                        uint64_t leafLevelAbsId = leafLevelFirstId + leafLevelRelId;
+            uint32_t partDepth = iterLevel - splitDepth;
+            uint64_t partsPerRoot = (uint64_t)1 << (splitDepth << 1);
+            uint64_t partTiles = (uint64_t)1 << (partDepth << 1);
+            size_t rootsPerBatch = splitDepth == 0 ? rootRelIds.size() : std::max<size_t>(1, subtreeBufferCount / partsPerRoot);
 
-                        if(_offsetIndex->exists(leafLevelAbsId))
-                        {
-                            uint64_t tileOffset = _offsetIndex->getOffset(leafLevelAbsId);
+            std::vector<double> partBuffer(splitDepth == 0 ? 0 : std::min(rootsPerBatch, rootRelIds.size()) * partsPerRoot * innerTilePxCount);
+            std::vector<double> splitLevels(splitDepth * innerTilePxCount);
 
-                            if(tileOffset < leafBufferOffset || tileOffset >= (leafBufferOffset + leafBufferByteSize))
-                            {
-                                _file.seekg(_payloadOffset + tileOffset);
-                                _file.read((char*)leafBuffer, std::min(leafBufferByteSize, (_imageTileWidth * _imageTileHeight * _tileByteSize) - tileOffset));
+#ifdef DELTA_E_CALCULATOR_LOG_PROGRESS
+            auto start = std::chrono::high_resolution_clock::now();
 
-                                leafBufferOffset = tileOffset;
-                            }
+            std::cout << "Calculating Delta-E for " << rootRelIds.size() << " Tiles in Level " << level;
+            std::cout.flush();
+#endif
 
-                            leafBitmap.setData(&leafBuffer[tileOffset - leafBufferOffset]);
-                        }
-                        else
+            for(size_t batchStart = 0; batchStart < rootRelIds.size(); batchStart += rootsPerBatch)
+            {
+                size_t batchEnd = std::min(rootRelIds.size(), batchStart + rootsPerBatch);
+                uint64_t partCount = (batchEnd - batchStart) * partsPerRoot;
+                std::atomic<uint64_t> nextPart(0);
+                std::vector<std::thread> threads;
+                std::mutex errorLock;
+                std::exception_ptr error;
+
+                for(size_t i = 0; i < threadCount; ++i)
+                {
+                    threads.emplace_back([&]() {
+                        try
                         {
-                            leafBitmap.setData(blackTileBuffer);
-                        }
-
-                        leafLab.copyRectFrom(leafBitmap, _padding, _padding, 0, 0, _innerTileWidth, _innerTileHeight);
-
-                        uint64_t leafXCoord;
-                        uint64_t leafYCoord;
+                            std::vector<uint8_t> rootTile(_tileByteSize);
+                            std::vector<uint8_t> leafTile(_tileByteSize);
+                            std::vector<double> distances(innerTilePxCount);
+                            std::vector<double> levels(partDepth * innerTilePxCount);
 
-                        QuadTree::getCoordinatesInLevel(relIterId, iterLevel, leafXCoord, leafYCoord);
+                            Bitmap rootBitmap(_tileWidth, _tileHeight, _pxFormat, rootTile.data());
+                            Bitmap leafBitmap(_tileWidth, _tileHeight, _pxFormat, leafTile.data());
 
-                        size_t xOffsetInRoot = leafXCoord * _innerTileWidth / iterLevelWidth;
-                        size_t yOffsetInRoot = leafYCoord * _innerTileHeight / iterLevelWidth;
+                            Bitmap rootLab(_innerTileWidth, _innerTileHeight, Bitmap::PIXEL_FORMAT::LAB);
+                            Bitmap leafLab(_innerTileWidth, _innerTileHeight, Bitmap::PIXEL_FORMAT::LAB);
 
-                        float* rootPx;
-                        float* leafPx;
-                        float distL;
-                        float distA;
-                        float distB;
+                            auto rootData = (float*)rootLab.getData();
+                            auto leafData = (float*)leafLab.getData();
 
-                        for(size_t y = 0; y < _innerTileHeight; ++y)
-                        {
-                            for(size_t x = 0; x < _innerTileWidth; ++x)
+                            for(uint64_t part = nextPart++; part < partCount; part = nextPart++)
                             {
-                                rootPx = &rootData[((yOffsetInRoot + (y >> iterLevel)) * _innerTileWidth + (xOffsetInRoot + (x >> iterLevel))) * 3];
-                                leafPx = &leafData[(y * _innerTileWidth + x) * 3];
-
-                                distL = rootPx[0] - leafPx[0];
-                                distA = rootPx[1] - leafPx[1];
-                                distB = rootPx[2] - leafPx[2];
-
-                                distBuffer[y * _innerTileWidth + x] = std::sqrt(distL * distL + distA * distA + distB * distB);
-                            }
-                        }
-
-                        size_t currentLevel = 1;
-                        uint64_t currentId = relIterId;
-                        size_t halfTileWidth = (_innerTileWidth >> 1);
-                        size_t halfTileHeight = (_innerTileHeight >> 1);
-                        auto lastLevelBuffer = distBuffer;
-                        double* currentLevelBuffer;
-
-                        do
-                        {
-                            currentLevelBuffer = &distBuffer[currentLevel * innerTilePxCount];
-                            size_t xOffset = (currentId & 1) * halfTileWidth;
-                            size_t yOffset = ((currentId & 2) >> 1) * halfTileHeight;
-                            double avrgDist;
+                                uint64_t rootLevelRelId = rootRelIds[batchStart + part / partsPerRoot];
+                                uint64_t firstRelIterId = (part % partsPerRoot) * partTiles;
 
-                            for(size_t y = 0; y < halfTileHeight; ++y)
-                            {
-                                for(size_t x = 0; x < halfTileWidth; ++x)
+                                if(!getTile(levelFirstId + rootLevelRelId, rootTile.data()))
                                 {
-                                    avrgDist = ((lastLevelBuffer[(y << 1) * _innerTileWidth + (x << 1)] + lastLevelBuffer[(y << 1) * _innerTileWidth + (x << 1) + 1]) / 2 +
-                                                (lastLevelBuffer[((y << 1) + 1) * _innerTileWidth + (x << 1)] + lastLevelBuffer[((y << 1) + 1) * _innerTileWidth + (x << 1) + 1]) / 2) /
-                                               2;
-
-                                    currentLevelBuffer[(yOffset + y) * _innerTileWidth + (xOffset + x)] = avrgDist;
+                                    throw std::runtime_error("Cannot read Tiles from File.");
                                 }
-                            }
 
-                            if(currentId == 0)
-                            {
-                                // iterated up as far as possible
-                                break;
-                            }
+                                rootLab.copyRectFrom(rootBitmap, _padding, _padding, 0, 0, _innerTileWidth, _innerTileHeight);
 
-                            currentId >>= 2;
-                            ++currentLevel;
-                            lastLevelBuffer = currentLevelBuffer;
-                        } while((currentId & 3) == 0);
+                                for(uint64_t partRelId = partTiles - 1;; --partRelId)
+                                {
+                                    uint64_t relIterId = firstRelIterId + partRelId;
 
-#ifdef DELTA_E_CALCULATOR_LOG_PROGRESS
-                        ++tilesLoaded;
+                                    // missing leaves are read as black tiles
+                                    getTile(leafLevelFirstId + rootLevelRelId * iterLevelTiles + relIterId, leafTile.data());
+                                    leafLab.copyRectFrom(leafBitmap, _padding, _padding, 0, 0, _innerTileWidth, _innerTileHeight);
 
-                        auto currentProgress = (uint8_t)(tilesLoaded * 100 / (actualLevelTiles * iterLevelTiles));
+                                    uint64_t leafXCoord;
+                                    uint64_t leafYCoord;
 
-                        if(currentProgress != progress)
-                        {
-                            progress = currentProgress;
-                            std::cout << '\r' << std::setw(3) << (int)progress << " %";
-                            std::cout.flush();
-                        }
-#endif
+                                    QuadTree::getCoordinatesInLevel(relIterId, iterLevel, leafXCoord, leafYCoord);
 
-                        if(relIterId == 0)
-                        {
-                            // whole tile deltas are calculated
-                            size_t oldLen = innerTilePxCount;
+                                    size_t xOffsetInRoot = leafXCoord * _innerTileWidth / iterLevelWidth;
+                                    size_t yOffsetInRoot = leafYCoord * _innerTileHeight / iterLevelWidth;
 
-                            for(size_t len = (oldLen >> 1); len > 0; len = (oldLen >> 1))
-                            {
-                                for(size_t i = 0; i < len; ++i)
-                                {
-                                    if(i == (len - 1))
+                                    for(size_t y = 0; y < _innerTileHeight; ++y)
                                     {
-                                        if((oldLen & 1) == 0)
-                                        {
-                                            currentLevelBuffer[i] = currentLevelBuffer[i << 1] / 2 + currentLevelBuffer[(i << 1) + 1] / 2;
-                                        }
-                                        else
+                                        const float* rootRow = &rootData[(yOffsetInRoot + (y >> iterLevel)) * _innerTileWidth * 3];
+                                        const float* leafPx = &leafData[y * _innerTileWidth * 3];
+                                        double* distRow = &distances[y * _innerTileWidth];
+
+                                        for(size_t x = 0; x < _innerTileWidth; ++x, leafPx += 3)
                                         {
-                                            currentLevelBuffer[i] = currentLevelBuffer[i << 1] / 3 + currentLevelBuffer[(i << 1) + 1] / 3 + currentLevelBuffer[(i << 1) + 2] / 3;
+                                            const float* rootPx = &rootRow[(xOffsetInRoot + (x >> iterLevel)) * 3];
+
+                                            float distL = rootPx[0] - leafPx[0];
+                                            float distA = rootPx[1] - leafPx[1];
+                                            float distB = rootPx[2] - leafPx[2];
+
+                                            distRow[x] = std::sqrt(distL * distL + distA * distA + distB * distB);
                                         }
                                     }
-                                    else
+
+                                    propagateDistances(distances.data(), levels.data(), innerTilePxCount, partRelId, partDepth, _innerTileWidth, _innerTileHeight);
+
+                                    if(partRelId == 0)
                                     {
-                                        currentLevelBuffer[i] = currentLevelBuffer[i << 1] / 2 + currentLevelBuffer[(i << 1) + 1] / 2;
+                                        break;
                                     }
                                 }
 
-                                oldLen = len;
+                                double* partDistances = partDepth == 0 ? distances.data() : &levels[(partDepth - 1) * innerTilePxCount];
+
+                                if(splitDepth == 0)
+                                {
+                                    _cielabIndex->set(levelFirstId + rootLevelRelId, (float)reduceDistances(partDistances, innerTilePxCount));
+                                }
+                                else
+                                {
+                                    std::copy(partDistances, partDistances + innerTilePxCount, &partBuffer[part * innerTilePxCount]);
+                                }
                             }
+                        }
+                        catch(...)
+                        {
+                            std::lock_guard<std::mutex> lock(errorLock);
+                            error = std::current_exception();
+                            nextPart = partCount;
+                        }
+                    });
+                }
+
+                for(auto& thread : threads)
+                {
+                    thread.join();
+                }
 
-                            _cielabIndex->set(rootLevelAbsId, (float)currentLevelBuffer[0]);
+                if(error)
+                {
+                    std::rethrow_exception(error);
+                }
+
+                // the parts continue the averaging of their root where they stopped
+                for(size_t root = 0; splitDepth != 0 && root < batchEnd - batchStart; ++root)
+                {
+                    for(uint64_t partId = partsPerRoot - 1;; --partId)
+                    {
+                        propagateDistances(&partBuffer[(root * partsPerRoot + partId) * innerTilePxCount], splitLevels.data(), innerTilePxCount, partId, splitDepth, _innerTileWidth,
+                                           _innerTileHeight);
+
+                        if(partId == 0)
+                        {
                             break;
                         }
                     }
-                }
 
-                if(rootLevelRelId == 0)
-                {
-                    break;
+                    _cielabIndex->set(levelFirstId + rootRelIds[batchStart + root], (float)reduceDistances(&splitLevels[(splitDepth - 1) * innerTilePxCount], innerTilePxCount));
                 }
             }
 
 #ifdef DELTA_E_CALCULATOR_LOG_PROGRESS
-            std::cout << " (" << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count() << " ms)" << std::endl << std::endl;
+            auto duration = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+            uint64_t tilesLoaded = rootRelIds.size() * iterLevelTiles;
+            totalTilesLoaded += tilesLoaded;
+
+            std::cout << " (" << (uint64_t)(duration * 1000) << " ms, " << (uint64_t)(tilesLoaded / duration) << " Tiles/s)" << std::endl;
 #endif
 
             if(level == 0)
@@ -275,15 +313,16 @@ void DeltaECalculator::calculate(size_t maxMemory)
         }
     }
 
+#ifdef DELTA_E_CALCULATOR_LOG_PROGRESS
+    auto totalDuration = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - totalStart).count();
+
+    std::cout << "Compared " << totalTilesLoaded << " Tiles in " << (uint64_t)(totalDuration * 1000) << " ms, " << (uint64_t)(totalTilesLoaded / totalDuration) << " Tiles/s" << std::endl;
+#endif
+
     std::fstream indexFile(_fileName, std::ios_base::binary | std::ios_base::out | std::ios_base::in);
     indexFile.seekp(_cielabIndexOffset, std::ios_base::beg);
     _cielabIndex->writeToFile(indexFile);
     indexFile.close();
-
-    delete[] distBuffer;
-    delete[] rootBuffer;
-    delete[] leafBuffer;
-    delete[] blackTileBuffer;
 }
 } // namespace pre
 } // namespace vt
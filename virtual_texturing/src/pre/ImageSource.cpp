@@ -0,0 +1,429 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/vt/pre/ImageSource.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace vt
+{
+namespace pre
+{
+ImageSource::ImageSource(const std::string& name, Bitmap::PIXEL_FORMAT pxFormat, size_t width, size_t height)
+{
+    _name = name;
+    _pxFormat = pxFormat;
+    _width = width;
+    _height = height;
+}
+
+const std::string& ImageSource::getName() const { return _name; }
+
+Bitmap::PIXEL_FORMAT ImageSource::getPixelFormat() const { return _pxFormat; }
+
+size_t ImageSource::getWidth() const { return _width; }
+
+size_t ImageSource::getHeight() const { return _height; }
+
+RawImageSource::RawImageSource(const std::string& fileName, Bitmap::PIXEL_FORMAT pxFormat, size_t width, size_t height) : ImageSource(fileName, pxFormat, width, height)
+{
+    auto file = _openFile();
+
+    file->seekg(0, std::ios::end);
+
+    uint64_t expFileSize = (uint64_t)width * height * Bitmap::pixelSize(pxFormat);
+    uint64_t fileSize = (uint64_t)file->tellg();
+
+    if(fileSize != expFileSize)
+    {
+        throw std::runtime_error("File \"" + fileName + "\" expected to be of Size " + std::to_string(expFileSize) + " Bytes, actually has " + std::to_string(fileSize) + " Bytes.");
+    }
+
+    _files.push_back(std::move(file));
+}
+
+std::unique_ptr<std::ifstream> RawImageSource::_openFile()
+{
+    std::unique_ptr<std::ifstream> file(new std::ifstream(_name, std::ios::in | std::ios::binary));
+
+    if(!file->is_open())
+    {
+        throw std::runtime_error("Could not open File \"" + _name + "\".");
+    }
+
+    return file;
+}
+
+void RawImageSource::read(size_t x, size_t y, size_t width, size_t height, uint8_t* out, size_t rowByteSize)
+{
+    std::unique_ptr<std::ifstream> file;
+
+    {
+        std::lock_guard<std::mutex> lock(_filesLock);
+
+        if(!_files.empty())
+        {
+            file = std::move(_files.back());
+            _files.pop_back();
+        }
+    }
+
+    if(!file)
+    {
+        file = _openFile();
+    }
+
+    auto pxSize = Bitmap::pixelSize(_pxFormat);
+    uint64_t fileOffset = ((uint64_t)y * _width + x) * pxSize;
+
+    for(size_t line = 0; line < height; ++line)
+    {
+        file->seekg(fileOffset);
+        file->read((char*)out, width * pxSize);
+
+        if(!file->good())
+        {
+            throw std::runtime_error("Cannot read from File.");
+        }
+
+        fileOffset += _width * pxSize;
+        out = &out[rowByteSize];
+    }
+
+    std::lock_guard<std::mutex> lock(_filesLock);
+    _files.push_back(std::move(file));
+}
+
+TiledImageSource::TiledImageSource(const std::string& name,
+                                   Bitmap::PIXEL_FORMAT pxFormat,
+                                   size_t width,
+                                   size_t height,
+                                   size_t tileWidth,
+                                   size_t tileHeight,
+                                   loader_type loader,
+                                   size_t maxMemory,
+                                   size_t readAheadThreadCount)
+    : ImageSource(name, pxFormat, width, height)
+{
+    if(tileWidth == 0 || tileHeight == 0)
+    {
+        throw std::runtime_error("Source tiles need to be at least 1 Pixel wide and high.");
+    }
+
+    _loader = loader;
+    _tileWidth = tileWidth;
+    _tileHeight = tileHeight;
+    _tilesPerRow = (width + tileWidth - 1) / tileWidth;
+    _tilesPerColumn = (height + tileHeight - 1) / tileHeight;
+    _tileByteSize = tileWidth * tileHeight * Bitmap::pixelSize(pxFormat);
+    _maxTiles = std::max<size_t>(1, maxMemory / _tileByteSize);
+    _useCount = 0;
+    _running = true;
+
+    for(size_t i = 0; i < readAheadThreadCount; ++i)
+    {
+        _readAheadThreads.emplace_back(&TiledImageSource::_readAhead, this);
+    }
+}
+
+TiledImageSource::~TiledImageSource()
+{
+    {
+        std::lock_guard<std::mutex> lock(_tilesLock);
+        _running = false;
+    }
+
+    _queueChanged.notify_all();
+
+    for(auto& thread : _readAheadThreads)
+    {
+        thread.join();
+    }
+}
+
+TiledImageSource* TiledImageSource::openDirectory(const std::string& dirName,
+                                                  const std::string& extension,
+                                                  Bitmap::PIXEL_FORMAT pxFormat,
+                                                  size_t width,
+                                                  size_t height,
+                                                  size_t tileWidth,
+                                                  size_t tileHeight,
+                                                  size_t maxMemory)
+{
+    auto pxSize = Bitmap::pixelSize(pxFormat);
+
+    auto loader = [=](size_t x, size_t y, uint8_t* out) {
+        std::string fileName = dirName + "/" + std::to_string(x) + "_" + std::to_string(y) + extension;
+        std::ifstream file(fileName, std::ios::in | std::ios::binary);
+
+        if(!file.is_open())
+        {
+            throw std::runtime_error("Could not open File \"" + fileName + "\".");
+        }
+
+        size_t tilePxWidth = std::min(tileWidth, width - x * tileWidth);
+        size_t tilePxHeight = std::min(tileHeight, height - y * tileHeight);
+
+        for(size_t line = 0; line < tilePxHeight; ++line)
+        {
+            file.read((char*)&out[line * tileWidth * pxSize], tilePxWidth * pxSize);
+
+            if(!file.good())
+            {
+                throw std::runtime_error("Cannot read from File \"" + fileName + "\".");
+            }
+        }
+    };
+
+    return new TiledImageSource(dirName, pxFormat, width, height, tileWidth, tileHeight, loader, maxMemory);
+}
+
+TiledImageSource*
+TiledImageSource::openContainer(const std::string& fileName, Bitmap::PIXEL_FORMAT pxFormat, size_t width, size_t height, size_t tileWidth, size_t tileHeight, size_t maxMemory)
+{
+    size_t tilesPerRow = (width + tileWidth - 1) / tileWidth;
+    size_t tilesPerColumn = (height + tileHeight - 1) / tileHeight;
+    size_t tileByteSize = tileWidth * tileHeight * Bitmap::pixelSize(pxFormat);
+
+    std::ifstream file(fileName, std::ios::in | std::ios::binary | std::ios::ate);
+
+    if(!file.is_open())
+    {
+        throw std::runtime_error("Could not open File \"" + fileName + "\".");
+    }
+
+    uint64_t expFileSize = (uint64_t)tilesPerRow * tilesPerColumn * tileByteSize;
+    uint64_t fileSize = (uint64_t)file.tellg();
+
+    if(fileSize != expFileSize)
+    {
+        throw std::runtime_error("File \"" + fileName + "\" expected to be of Size " + std::to_string(expFileSize) + " Bytes, actually has " + std::to_string(fileSize) + " Bytes.");
+    }
+
+    auto loader = [=](size_t x, size_t y, uint8_t* out) {
+        std::ifstream file(fileName, std::ios::in | std::ios::binary);
+
+        file.seekg(((uint64_t)y * tilesPerRow + x) * tileByteSize);
+        file.read((char*)out, tileByteSize);
+
+        if(!file.good())
+        {
+            throw std::runtime_error("Cannot read from File \"" + fileName + "\".");
+        }
+    };
+
+    return new TiledImageSource(fileName, pxFormat, width, height, tileWidth, tileHeight, loader, maxMemory);
+}
+
+void TiledImageSource::_makeRoom()
+{
+    while(_tiles.size() >= _maxTiles)
+    {
+        auto oldest = _tiles.end();
+
+        for(auto iter = _tiles.begin(); iter != _tiles.end(); ++iter)
+        {
+            if(iter->second.pins == 0 && !iter->second.loading && (oldest == _tiles.end() || iter->second.lastUse < oldest->second.lastUse))
+            {
+                oldest = iter;
+            }
+        }
+
+        // every cached tile is in use, the cache grows beyond its limit until they are released
+        if(oldest == _tiles.end())
+        {
+            return;
+        }
+
+        _tiles.erase(oldest);
+    }
+}
+
+uint8_t* TiledImageSource::_acquire(uint64_t key)
+{
+    std::unique_lock<std::mutex> lock(_tilesLock);
+
+    auto iter = _tiles.find(key);
+
+    if(iter != _tiles.end())
+    {
+        Tile& tile = iter->second;
+
+        ++tile.pins;
+        tile.lastUse = ++_useCount;
+
+        _tileLoaded.wait(lock, [&tile] { return !tile.loading; });
+
+        if(tile.failed)
+        {
+            if(--tile.pins == 0)
+            {
+                _tiles.erase(key);
+            }
+
+            throw std::runtime_error("Could not load source tile " + std::to_string(key % _tilesPerRow) + "_" + std::to_string(key / _tilesPerRow) + " of \"" + _name + "\".");
+        }
+
+        return tile.data.get();
+    }
+
+    _makeRoom();
+
+    // the entry is pinned, so it stays in place while it is loaded without the lock
+    Tile& tile = _tiles[key];
+    tile.data.reset(new uint8_t[_tileByteSize]);
+    tile.pins = 1;
+    tile.lastUse = ++_useCount;
+
+    lock.unlock();
+
+    try
+    {
+        _loader(key % _tilesPerRow, key / _tilesPerRow, tile.data.get());
+    }
+    catch(...)
+    {
+        lock.lock();
+
+        tile.loading = false;
+        tile.failed = true;
+
+        if(--tile.pins == 0)
+        {
+            _tiles.erase(key);
+        }
+
+        _tileLoaded.notify_all();
+
+        throw;
+    }
+
+    lock.lock();
+    tile.loading = false;
+    _tileLoaded.notify_all();
+
+    return tile.data.get();
+}
+
+void TiledImageSource::_release(uint64_t key)
+{
+    std::lock_guard<std::mutex> lock(_tilesLock);
+
+    auto iter = _tiles.find(key);
+
+    if(iter != _tiles.end() && --iter->second.pins == 0 && iter->second.failed)
+    {
+        _tiles.erase(iter);
+    }
+}
+
+void TiledImageSource::_readAhead()
+{
+    while(true)
+    {
+        uint64_t key;
+
+        {
+            std::unique_lock<std::mutex> lock(_tilesLock);
+
+            _queueChanged.wait(lock, [this] { return !_queue.empty() || !_running; });
+
+            if(!_running)
+            {
+                return;
+            }
+
+            key = _queue.front();
+            _queue.pop_front();
+
+            if(_tiles.find(key) != _tiles.end())
+            {
+                continue;
+            }
+        }
+
+        try
+        {
+            _acquire(key);
+            _release(key);
+        }
+        catch(std::exception&)
+        {
+            // the reader of the tile loads it again and gets the error
+        }
+    }
+}
+
+void TiledImageSource::read(size_t x, size_t y, size_t width, size_t height, uint8_t* out, size_t rowByteSize)
+{
+    if(width == 0 || height == 0)
+    {
+        return;
+    }
+
+    auto pxSize = Bitmap::pixelSize(_pxFormat);
+
+    for(size_t tileY = y / _tileHeight; tileY <= (y + height - 1) / _tileHeight; ++tileY)
+    {
+        for(size_t tileX = x / _tileWidth; tileX <= (x + width - 1) / _tileWidth; ++tileX)
+        {
+            uint64_t key = (uint64_t)tileY * _tilesPerRow + tileX;
+            uint8_t* data = _acquire(key);
+
+            size_t left = std::max(x, tileX * _tileWidth);
+            size_t right = std::min(x + width, (tileX + 1) * _tileWidth);
+            size_t top = std::max(y, tileY * _tileHeight);
+            size_t bottom = std::min(y + height, (tileY + 1) * _tileHeight);
+
+            for(size_t line = top; line < bottom; ++line)
+            {
+                std::memcpy(&out[(line - y) * rowByteSize + (left - x) * pxSize],
+                            &data[((line - tileY * _tileHeight) * _tileWidth + (left - tileX * _tileWidth)) * pxSize],
+                            (right - left) * pxSize);
+            }
+
+            _release(key);
+        }
+    }
+}
+
+void TiledImageSource::prefetch(size_t x, size_t y, size_t width, size_t height)
+{
+    if(width == 0 || height == 0)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_tilesLock);
+
+        for(size_t tileY = y / _tileHeight; tileY <= (y + height - 1) / _tileHeight; ++tileY)
+        {
+            for(size_t tileX = x / _tileWidth; tileX <= (x + width - 1) / _tileWidth; ++tileX)
+            {
+                uint64_t key = (uint64_t)tileY * _tilesPerRow + tileX;
+
+                // tiles read ahead must not push each other out of the cache
+                if(_queue.size() >= _maxTiles)
+                {
+                    break;
+                }
+
+                if(_tiles.find(key) == _tiles.end() && std::find(_queue.begin(), _queue.end(), key) == _queue.end())
+                {
+                    _queue.push_back(key);
+                }
+            }
+        }
+    }
+
+    _queueChanged.notify_all();
+}
+} // namespace pre
+} // namespace vt
@@ -21,6 +21,7 @@ size_t OffsetIndex::_idToIdx(uint64_t id)
         idx = id;
         break;
     case AtlasFile::LAYOUT::PACKED:
+    case AtlasFile::LAYOUT::COMPRESSED:
         idx = id + 1;
         break;
     default:
@@ -49,6 +50,7 @@ size_t OffsetIndex::getLength(uint64_t id)
         nextIdx = idx + 1;
         break;
     case AtlasFile::LAYOUT::PACKED:
+    case AtlasFile::LAYOUT::COMPRESSED:
         nextIdx = idx - 1;
         break;
     default:
@@ -72,6 +74,7 @@ void OffsetIndex::set(uint64_t id, uint64_t offset, size_t byteSize)
         nextIdx = idx + 1;
         break;
     case AtlasFile::LAYOUT::PACKED:
+    case AtlasFile::LAYOUT::COMPRESSED:
         nextIdx = idx - 1;
         break;
     default:
@@ -0,0 +1,109 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/vt/pre/PayloadWriter.h>
+
+#include <stdexcept>
+
+namespace vt
+{
+namespace pre
+{
+PayloadWriter::PayloadWriter(std::fstream& file, uint64_t fileOffset, size_t maxPendingBytes) : _file(file)
+{
+    _fileOffset = fileOffset;
+    _maxPendingBytes = maxPendingBytes;
+    _pendingBytes = 0;
+    _writing = false;
+    _running = true;
+
+    _thread = std::thread(&PayloadWriter::_run, this);
+}
+
+PayloadWriter::~PayloadWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _running = false;
+    }
+
+    _queueChanged.notify_all();
+    _thread.join();
+}
+
+void PayloadWriter::_run()
+{
+    std::unique_lock<std::mutex> lock(_lock);
+
+    while(true)
+    {
+        _queueChanged.wait(lock, [this] { return !_queue.empty() || !_running; });
+
+        if(_queue.empty())
+        {
+            return;
+        }
+
+        auto entry = std::move(_queue.front());
+        _queue.pop_front();
+        _writing = true;
+
+        lock.unlock();
+
+        if(!_error)
+        {
+            try
+            {
+                _file.seekp(_fileOffset + entry.first);
+                _file.write((char*)entry.second.data(), entry.second.size());
+
+                if(!_file.good())
+                {
+                    throw std::runtime_error("Cannot write Tiles to File.");
+                }
+            }
+            catch(...)
+            {
+                _error = std::current_exception();
+            }
+        }
+
+        lock.lock();
+
+        _pendingBytes -= entry.second.size();
+        _writing = false;
+        _queueChanged.notify_all();
+    }
+}
+
+void PayloadWriter::write(uint64_t offset, std::vector<uint8_t>&& data)
+{
+    std::unique_lock<std::mutex> lock(_lock);
+
+    // a single range larger than the limit is still accepted once the queue ran empty
+    _queueChanged.wait(lock, [this, &data] { return _pendingBytes == 0 || _pendingBytes + data.size() <= _maxPendingBytes; });
+
+    _pendingBytes += data.size();
+    _queue.emplace_back(offset, std::move(data));
+    _queueChanged.notify_all();
+}
+
+void PayloadWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(_lock);
+
+    _queueChanged.wait(lock, [this] { return _queue.empty() && !_writing; });
+
+    if(_error)
+    {
+        std::rethrow_exception(_error);
+    }
+
+    _file.flush();
+}
+} // namespace pre
+} // namespace vt
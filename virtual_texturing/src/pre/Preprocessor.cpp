@@ -7,54 +7,80 @@
 
 #include <lamure/vt/pre/Preprocessor.h>
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 namespace vt
 {
 namespace pre
 {
 bool Preprocessor::_isPowerOfTwo(size_t val) { return val != 0 && (val & (val - 1)) == 0; }
 
-void memset_volatile(volatile uint8_t* s, uint8_t val, size_t n)
+void Preprocessor::_runThreads(const std::function<void()>& work)
 {
-    for(size_t i = 0; i < n; ++i)
+    std::vector<std::thread> threads;
+    std::mutex errorLock;
+    std::exception_ptr error;
+
+    for(size_t i = 0; i < _threadCount; ++i)
+    {
+        threads.emplace_back([&]() {
+            try
+            {
+                work();
+            }
+            catch(...)
+            {
+                std::lock_guard<std::mutex> lock(errorLock);
+
+                if(!error)
+                {
+                    error = std::current_exception();
+                }
+            }
+        });
+    }
+
+    for(auto& thread : threads)
     {
-        s[i] = val;
+        thread.join();
+    }
+
+    if(error)
+    {
+        std::rethrow_exception(error);
     }
 }
 
-void Preprocessor::_deflate(size_t writeBufferSize)
+void Preprocessor::_openPayloadForReading(std::ifstream& file)
 {
-    size_t writeBufferTileSize = writeBufferSize / _destTileByteSize;
-    writeBufferSize = writeBufferTileSize * _destTileByteSize;
+    // unbuffered, tiles are read as a whole and may have been rewritten since the last read
+    file.rdbuf()->pubsetbuf(nullptr, 0);
+    file.open(_destPayloadFileName, std::ios::in | std::ios::binary);
 
-    uint64_t writeBufferOffset = 0;
-    uint64_t writeBufferFirstId = 0;
-    uint64_t writeBufferLastId = 0;
-    uint64_t offsetAfterLastTile = QuadTree::firstIdOfLevel(_treeDepth - 1) * _destTileByteSize;
-    uint64_t lastWriteOffset = offsetAfterLastTile;
-    uint64_t* idLookup = nullptr;
-
-    if(_destLayout == AtlasFile::LAYOUT::RAW)
+    if(!file.is_open())
     {
-        writeBufferOffset = offsetAfterLastTile - (QuadTree::firstIdOfLevel(_treeDepth - 1) % writeBufferTileSize) * _destTileByteSize;
-        writeBufferFirstId = writeBufferOffset / _destTileByteSize;
+        throw std::runtime_error("Could not open File \"" + _destPayloadFileName + "\".");
     }
-    else
-    {
-        writeBufferOffset = _imageTileWidth * _imageTileHeight * _destTileByteSize;
-        idLookup = new uint64_t[writeBufferTileSize];
-        writeBufferFirstId = offsetAfterLastTile / _destTileByteSize - 1;
-        writeBufferLastId = writeBufferFirstId;
+}
 
-        for(size_t i = 0; i < writeBufferTileSize; ++i)
-        {
-            idLookup[i] = writeBufferFirstId;
-        }
-    }
+void Preprocessor::_addPhaseTiming(const std::string& name, std::chrono::high_resolution_clock::time_point start)
+{
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+
+    _phaseTimings.push_back({name, duration});
 
-    size_t bufferSize = _destTileByteSize * 12;
-    auto buffer = new uint8_t[bufferSize];
-    auto writeBuffer = new uint8_t[writeBufferSize];
+#ifdef PREPROCESSOR_LOG_PROGRESS
+    std::cout << name << ": " << duration.count() << " ms" << std::endl;
+#endif
+}
 
+void Preprocessor::_deflateTile(std::ifstream& payloadFile, uint64_t relIterationId, size_t iterationLevel, size_t levelTileWidth, size_t levelTileHeight, uint8_t* buffer, uint8_t* out)
+{
     Bitmap bufferBitmap0(_tileWidth, _tileHeight, _destPxFormat, buffer);
     Bitmap bufferBitmap1(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize]);
     Bitmap bufferBitmap2(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 2]);
@@ -64,329 +90,345 @@ void Preprocessor::_deflate(size_t writeBufferSize)
     Bitmap bufferBitmap6(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 6]);
     Bitmap bufferBitmap7(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 7]);
     Bitmap bufferBitmap8(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 8]);
-    Bitmap bufferBitmap9(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 9]);
-    Bitmap bufferBitmap10(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 10]);
-    Bitmap writeBitmap(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 11]);
+    Bitmap writeBitmap(_tileWidth, _tileHeight, _destPxFormat, out);
 
-    auto levelTileWidth = _imageTileWidth;
-    auto levelTileHeight = _imageTileHeight;
-    auto levelPixelWidth = _imageWidth;
-    auto levelPixelHeight = _imageHeight;
+    auto firstIdOfCurrentLevel = QuadTree::firstIdOfLevel(iterationLevel + 1);
 
-    uint64_t currentOffset = 0;
+    // tiles outside of the image, or not needed, are black
+    auto loadTile = [&](bool needed, uint64_t relId, uint8_t* tile) {
+        if(!needed || _loadTileById(payloadFile, firstIdOfCurrentLevel + relId, tile) == 0)
+        {
+            std::memset(tile, 0, _destTileByteSize);
+        }
+    };
 
-    if(_destLayout != AtlasFile::LAYOUT::RAW)
-    {
-        auto firstId = QuadTree::firstIdOfLevel(_treeDepth - 1);
-        currentOffset = _offsetIndex->getOffset(firstId);
-        currentOffset += _destTileByteSize;
-    }
+    size_t bufferOffset = 0;
 
-    if(_treeDepth > 1)
+    for(uint8_t relQuadId = 3;; --relQuadId)
     {
-        for(size_t iterationLevel = _treeDepth - 2; /* iterationLevel > 0 */; --iterationLevel)
-        {
-            levelPixelWidth = (levelPixelWidth + 1) >> 1;
-            levelPixelHeight = (levelPixelHeight + 1) >> 1;
-            auto iterationLevelTileWidth = (levelTileWidth + 1) >> 1;
-            auto iterationLevelTileHeight = (levelTileHeight + 1) >> 1;
-            auto iterLevelFullWidth = QuadTree::getWidthOfLevel(iterationLevel);
-            auto tilesInIterationLevel = iterLevelFullWidth * iterLevelFullWidth;
-            auto firstIdOfIterationLevel = QuadTree::firstIdOfLevel(iterationLevel);
-            auto firstIdOfCurrentLevel = QuadTree::firstIdOfLevel(iterationLevel + 1);
+        uint64_t relId = (relIterationId << 2) + relQuadId;
 
-#ifdef PREPROCESSOR_LOG_PROGRESS
-            auto start = std::chrono::high_resolution_clock::now();
-            uint64_t tilesWritten = 0;
-            uint8_t progress = 0;
+        uint64_t childX;
+        uint64_t childY;
 
-            std::cout << "Deflating " << (levelTileWidth * levelTileHeight) << " Tiles in Level " << (iterationLevel + 1) << std::endl;
-            std::cout << std::setw(3) << (int)progress << " %";
-            std::cout.flush();
-#endif
+        QuadTree::getCoordinatesInLevel(relId, iterationLevel + 1, childX, childY);
 
-            for(uint64_t relIterationId = tilesInIterationLevel - 1; /* relIterationId > 0 */; --relIterationId)
-            {
-                uint64_t x;
-                uint64_t y;
+        loadTile(childX < levelTileWidth && childY < levelTileHeight, relId, &buffer[bufferOffset]);
 
-                QuadTree::getCoordinatesInLevel(relIterationId, iterationLevel, x, y);
+        if(relQuadId == 0)
+        {
+            break;
+        }
 
-                if(x >= iterationLevelTileWidth || y >= iterationLevelTileHeight)
-                {
-                    continue;
-                }
+        bufferOffset += _destTileByteSize;
+    }
 
-                uint64_t absIterationId = firstIdOfIterationLevel + relIterationId;
-                size_t bufferOffset = 0;
+    uint64_t relId = relIterationId << 2;
 
-                for(uint8_t relQuadId = 3;; --relQuadId)
-                {
-                    uint64_t relId = (relIterationId << 2) + relQuadId;
-                    uint64_t absId = firstIdOfCurrentLevel + relId;
+    uint64_t relId1 = QuadTree::getNeighbour(relId, QuadTree::NEIGHBOUR::LEFT);
+    uint64_t relId2 = QuadTree::getNeighbour(relId1, QuadTree::NEIGHBOUR::BOTTOM);
+    uint64_t relId0 = QuadTree::getNeighbour(relId1, QuadTree::NEIGHBOUR::TOP);
 
-                    uint64_t len = 0;
+    loadTile(relId1 != relId, relId2, bufferBitmap4.getData());
+    loadTile(relId1 != relId, relId1, bufferBitmap5.getData());
+    loadTile(relId1 != relId && relId0 != relId1, relId0, bufferBitmap6.getData());
 
-                    uint64_t childX;
-                    uint64_t childY;
+    relId0 = QuadTree::getNeighbour(relId, QuadTree::NEIGHBOUR::TOP);
+    relId1 = QuadTree::getNeighbour(relId0, QuadTree::NEIGHBOUR::RIGHT);
 
-                    QuadTree::getCoordinatesInLevel(relId, iterationLevel + 1, childX, childY);
+    loadTile(relId0 != relId, relId1, bufferBitmap7.getData());
+    loadTile(relId0 != relId, relId0, bufferBitmap8.getData());
 
-                    if(childX < levelTileWidth && childY < levelTileHeight)
-                    {
-                        len = _getTileById(absId, writeBuffer, writeBufferFirstId, writeBufferLastId, idLookup, writeBufferTileSize, &buffer[bufferOffset]);
-                    }
+    size_t halfTileWidthInner = _innerTileWidth >> 1;
+    size_t halfTileHeightInner = _innerTileHeight >> 1;
 
-                    if(len == 0)
-                    {
-                        std::memset(&buffer[bufferOffset], 0, _destTileByteSize);
-                    }
+    uint64_t x;
+    uint64_t y;
 
-                    if(relQuadId == 0)
-                    {
-                        break;
-                    }
+    QuadTree::getCoordinatesInLevel(relIterationId, iterationLevel, x, y);
 
-                    bufferOffset += _destTileByteSize;
-                }
+    std::memset(out, 0, _destTileByteSize);
+
+    writeBitmap.deflateRectFrom(bufferBitmap0, _padding, _padding, _padding + halfTileWidthInner, _padding + (_innerTileHeight >> 1), _innerTileWidth, _innerTileHeight);
 
-                uint64_t relId = relIterationId << 2;
+    writeBitmap.deflateRectFrom(bufferBitmap1, _padding, _padding, _padding, _padding + halfTileHeightInner, _innerTileWidth, _innerTileHeight);
 
-                uint64_t relId1 = QuadTree::getNeighbour(relId, QuadTree::NEIGHBOUR::LEFT);
-                uint64_t relId2 = QuadTree::getNeighbour(relId1, QuadTree::NEIGHBOUR::BOTTOM);
-                uint64_t relId0 = QuadTree::getNeighbour(relId1, QuadTree::NEIGHBOUR::TOP);
+    writeBitmap.deflateRectFrom(bufferBitmap2, _padding, _padding, _padding + halfTileWidthInner, _padding, _innerTileWidth, _innerTileHeight);
 
-                uint64_t len = 0;
+    writeBitmap.deflateRectFrom(bufferBitmap3, _padding, _padding, _padding, _padding, _innerTileWidth, _innerTileHeight);
 
-                bufferOffset += _destTileByteSize;
-                if(relId1 != relId)
-                    len = _getTileById(firstIdOfCurrentLevel + relId2, writeBuffer, writeBufferFirstId, writeBufferLastId, idLookup, writeBufferTileSize, &buffer[bufferOffset]);
-                if(len == 0)
-                    memset_volatile(&buffer[bufferOffset], 0, _destTileByteSize);
+    if(x == 0)
+    {
+        writeBitmap.smearHorizontal(_padding, _padding, 0, _padding, _padding, _innerTileHeight);
+    }
+    else
+    {
+        // pad lower left side
+        writeBitmap.deflateRectFrom(bufferBitmap4, _padding + _innerTileWidth - (_padding << 1), _padding, 0, _padding + halfTileHeightInner, _padding << 1, _innerTileHeight);
 
-                bufferOffset += _destTileByteSize;
-                if(relId1 != relId)
-                    len = _getTileById(firstIdOfCurrentLevel + relId1, writeBuffer, writeBufferFirstId, writeBufferLastId, idLookup, writeBufferTileSize, &buffer[bufferOffset]);
-                if(len == 0)
-                    memset_volatile(&buffer[bufferOffset], 0, _destTileByteSize);
+        // pad upper left side
+        writeBitmap.deflateRectFrom(bufferBitmap5, _padding + _innerTileWidth - (_padding << 1), _padding, 0, _padding, _padding << 1, _innerTileHeight);
 
-                len = 0;
+        if(y > 0)
+        {
+            // pad upper left corner
+            writeBitmap.deflateRectFrom(bufferBitmap6, _padding + _innerTileWidth - (_padding << 1), _padding + _innerTileHeight - (_padding << 1), 0, 0, _padding << 1, _padding << 1);
+        }
+    }
 
-                bufferOffset += _destTileByteSize;
-                if(relId1 != relId && relId0 != relId1)
-                    len = _getTileById(firstIdOfCurrentLevel + relId0, writeBuffer, writeBufferFirstId, writeBufferLastId, idLookup, writeBufferTileSize, &buffer[bufferOffset]);
-                if(len == 0)
-                    memset_volatile(&buffer[bufferOffset], 0, _destTileByteSize);
+    if(y == 0)
+    {
+        // pad top side
+        writeBitmap.smearVertical(0, _padding, 0, 0, _padding + _innerTileWidth, _padding);
+    }
+    else
+    {
+        // pad right top side
+        writeBitmap.deflateRectFrom(bufferBitmap7, _padding, _padding + _innerTileHeight - (_padding << 1), _padding + halfTileWidthInner, 0, _innerTileWidth, _padding << 1);
 
-                relId0 = QuadTree::getNeighbour(relId, QuadTree::NEIGHBOUR::TOP);
-                relId1 = QuadTree::getNeighbour(relId0, QuadTree::NEIGHBOUR::RIGHT);
+        // pad left top side
+        writeBitmap.deflateRectFrom(bufferBitmap8, _padding, _padding + _innerTileHeight - (_padding << 1), _padding, 0, _innerTileWidth, _padding << 1);
 
-                len = 0;
+        if(x == 0)
+        {
+            // pad upper left corner
+            writeBitmap.smearHorizontal(_padding, 0, 0, 0, _padding, _padding);
+        }
+    }
+}
 
-                QuadTree::getCoordinatesInLevel(relId2, iterationLevel + 1, x, y);
+void Preprocessor::_padTile(Bitmap& tile, uint64_t x, uint64_t y, size_t levelTileWidth, size_t levelTileHeight, size_t levelPixelWidth, size_t levelPixelHeight, const Bitmap* bottom, const Bitmap* right)
+{
+    bool xIsLast = x == (levelTileWidth - 1);
+    bool yIsLast = y == (levelTileHeight - 1);
 
-                bufferOffset += _destTileByteSize;
-                if(relId0 != relId)
-                    len = _getTileById(firstIdOfCurrentLevel + relId1, writeBuffer, writeBufferFirstId, writeBufferLastId, idLookup, writeBufferTileSize, &buffer[bufferOffset]);
-                if(len == 0)
-                    memset_volatile(&buffer[bufferOffset], 0, _destTileByteSize);
+    size_t padWidth = _padding;
+    size_t padHeight = _padding;
 
-                bufferOffset += _destTileByteSize;
-                if(relId0 != relId)
-                    len = _getTileById(firstIdOfCurrentLevel + relId0, writeBuffer, writeBufferFirstId, writeBufferLastId, idLookup, writeBufferTileSize, &buffer[bufferOffset]);
-                if(len == 0)
-                    memset_volatile(&buffer[bufferOffset], 0, _destTileByteSize);
+    if(xIsLast)
+    {
+        padWidth += ((levelPixelWidth - 1) % _innerTileWidth) + 1;
+    }
+    else
+    {
+        padWidth += _innerTileWidth;
+    }
 
-                relId0 = relIterationId;
-                relId1 = QuadTree::getNeighbour(relId0, QuadTree::NEIGHBOUR::RIGHT);
-                relId2 = QuadTree::getNeighbour(relId0, QuadTree::NEIGHBOUR::BOTTOM);
+    if(yIsLast)
+    {
+        padHeight += ((levelPixelHeight - 1) % _innerTileHeight) + 1;
+    }
+    else
+    {
+        padHeight += _innerTileHeight;
+    }
 
-                bufferOffset += _destTileByteSize;
-                len = _getTileById(firstIdOfIterationLevel + relId2, writeBuffer, writeBufferFirstId, writeBufferLastId, idLookup, writeBufferTileSize, &buffer[bufferOffset]);
-                if(len == 0)
-                    memset_volatile(&buffer[bufferOffset], 0, _destTileByteSize);
+    if(yIsLast)
+    {
+        // pad bottom side
+        tile.smearVertical(0, padHeight - 1, 0, padHeight, padWidth, _padding);
 
-                bufferOffset += _destTileByteSize;
-                len = _getTileById(firstIdOfIterationLevel + relId1, writeBuffer, writeBufferFirstId, writeBufferLastId, idLookup, writeBufferTileSize, &buffer[bufferOffset]);
-                if(len == 0)
-                    memset_volatile(&buffer[bufferOffset], 0, _destTileByteSize);
+        uint8_t transPx[4] = {0x00, 0x00, 0x00, 0x00};
 
-                bufferOffset += _destTileByteSize;
+        tile.fillRect(transPx, Bitmap::PIXEL_FORMAT::RGBA8, 0, padHeight + _padding, padWidth + _padding, _tileHeight - padHeight - _padding);
+    }
+    else if(bottom != nullptr)
+    {
+        // pad bottom side
+        tile.copyRectFrom(*bottom, 0, _padding, 0, _padding + _innerTileHeight, padWidth + _padding, _padding);
+    }
 
-                size_t halfTileWidthInner = _innerTileWidth >> 1;
-                size_t halfTileHeightInner = _innerTileHeight >> 1;
+    if(xIsLast)
+    {
+        // pad right side
+        tile.smearHorizontal(padWidth - 1, 0, padWidth, 0, _padding, padHeight + _padding);
 
-                QuadTree::getCoordinatesInLevel(relIterationId, iterationLevel, x, y);
+        uint8_t transPx[4] = {0x00, 0x00, 0x00, 0x00};
 
-                std::memset((void*)&buffer[bufferOffset], 0, _destTileByteSize);
+        tile.fillRect(transPx, Bitmap::PIXEL_FORMAT::RGBA8, padWidth + _padding, 0, _tileWidth - padWidth - _padding, _tileHeight);
+    }
+    else if(right != nullptr)
+    {
+        // pad right side
+        tile.copyRectFrom(*right, _padding, 0, _padding + _innerTileWidth, 0, _padding, padHeight + _padding);
+    }
+}
 
-                writeBitmap.deflateRectFrom(bufferBitmap0, _padding, _padding, _padding + halfTileWidthInner, _padding + (_innerTileHeight >> 1), _innerTileWidth, _innerTileHeight);
+void Preprocessor::_deflate(size_t maxMemory)
+{
+    // a worker holds the 9 tiles a tile is deflated from and the tile itself
+    size_t workerBufferSize = _destTileByteSize * 10;
+    size_t maxPendingBytes = _destTileByteSize;
 
-                writeBitmap.deflateRectFrom(bufferBitmap1, _padding, _padding, _padding, _padding + halfTileHeightInner, _innerTileWidth, _innerTileHeight);
+    if(maxMemory > _threadCount * workerBufferSize + maxPendingBytes)
+    {
+        maxPendingBytes = maxMemory - _threadCount * workerBufferSize;
+    }
 
-                writeBitmap.deflateRectFrom(bufferBitmap2, _padding, _padding, _padding + halfTileWidthInner, _padding, _innerTileWidth, _innerTileHeight);
+    PayloadWriter writer(_destPayloadFile, _destPayloadOffset, maxPendingBytes);
 
-                writeBitmap.deflateRectFrom(bufferBitmap3, _padding, _padding, _padding, _padding, _innerTileWidth, _innerTileHeight);
+    auto levelTileWidth = _imageTileWidth;
+    auto levelTileHeight = _imageTileHeight;
+    auto levelPixelWidth = _imageWidth;
+    auto levelPixelHeight = _imageHeight;
 
-                if(x == 0)
-                {
-                    writeBitmap.smearHorizontal(_padding, _padding, 0, _padding, _padding, _innerTileHeight);
-                }
-                else
-                {
-                    // pad lower left side
-                    writeBitmap.deflateRectFrom(bufferBitmap4, _padding + _innerTileWidth - (_padding << 1), _padding, 0, _padding + halfTileHeightInner, _padding << 1, _innerTileHeight);
+    auto firstId = QuadTree::firstIdOfLevel(_treeDepth - 1);
+    uint64_t currentOffset = _offsetIndex->getOffset(firstId);
+    currentOffset += _destTileByteSize;
 
-                    // pad upper left side
-                    writeBitmap.deflateRectFrom(bufferBitmap5, _padding + _innerTileWidth - (_padding << 1), _padding, 0, _padding, _padding << 1, _innerTileHeight);
+    // the padding of a tile is copied from the inner area of its bottom and right neighbours, which is
+    // final as soon as the neighbours are deflated. so a level is deflated in parallel first and padded
+    // in parallel afterwards. with an inner area smaller than the padding this does not hold, those
+    // tiles are padded one after another like they are deflated
+    bool padInParallel = _innerTileWidth >= _padding && _innerTileHeight >= _padding;
 
-                    if(y > 0)
-                    {
-                        // pad upper left corner
-                        writeBitmap.deflateRectFrom(bufferBitmap6, _padding + _innerTileWidth - (_padding << 1), _padding + _innerTileHeight - (_padding << 1), 0, 0, _padding << 1, _padding << 1);
-                    }
-                }
+    if(_treeDepth > 1)
+    {
+        for(size_t iterationLevel = _treeDepth - 2; /* iterationLevel > 0 */; --iterationLevel)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
 
-                if(y == 0)
-                {
-                    // pad top side
-                    writeBitmap.smearVertical(0, _padding, 0, 0, _padding + _innerTileWidth, _padding);
-                }
-                else
-                {
-                    // pad right top side
-                    writeBitmap.deflateRectFrom(bufferBitmap7, _padding, _padding + _innerTileHeight - (_padding << 1), _padding + halfTileWidthInner, 0, _innerTileWidth, _padding << 1);
+            levelPixelWidth = (levelPixelWidth + 1) >> 1;
+            levelPixelHeight = (levelPixelHeight + 1) >> 1;
+            auto iterationLevelTileWidth = (levelTileWidth + 1) >> 1;
+            auto iterationLevelTileHeight = (levelTileHeight + 1) >> 1;
+            auto iterLevelFullWidth = QuadTree::getWidthOfLevel(iterationLevel);
+            auto tilesInIterationLevel = iterLevelFullWidth * iterLevelFullWidth;
+            auto firstIdOfIterationLevel = QuadTree::firstIdOfLevel(iterationLevel);
 
-                    // pad left top side
-                    writeBitmap.deflateRectFrom(bufferBitmap8, _padding, _padding + _innerTileHeight - (_padding << 1), _padding, 0, _innerTileWidth, _padding << 1);
+#ifdef PREPROCESSOR_LOG_PROGRESS
+            std::cout << "Deflating " << (levelTileWidth * levelTileHeight) << " Tiles in Level " << (iterationLevel + 1) << std::endl;
+#endif
 
-                    if(x == 0)
-                    {
-                        // pad upper left corner
-                        writeBitmap.smearHorizontal(_padding, 0, 0, 0, _padding, _padding);
-                    }
-                }
+            // tiles are stored in descending order of their ids, so their offsets are known up front
+            std::vector<uint64_t> relIterationIds;
 
-                bool xIsLast = x == (iterationLevelTileWidth - 1);
-                bool yIsLast = y == (iterationLevelTileHeight - 1);
+            for(uint64_t relIterationId = tilesInIterationLevel - 1; /* relIterationId > 0 */; --relIterationId)
+            {
+                uint64_t x;
+                uint64_t y;
 
-                size_t padWidth = _padding;
-                size_t padHeight = _padding;
+                QuadTree::getCoordinatesInLevel(relIterationId, iterationLevel, x, y);
 
-                if(xIsLast)
-                {
-                    padWidth += ((levelPixelWidth - 1) % _innerTileWidth) + 1;
-                }
-                else
+                if(x < iterationLevelTileWidth && y < iterationLevelTileHeight)
                 {
-                    padWidth += _innerTileWidth;
-                }
+                    _offsetIndex->set(firstIdOfIterationLevel + relIterationId, currentOffset, _destTileByteSize);
+                    currentOffset += _destTileByteSize;
 
-                if(yIsLast)
-                {
-                    padHeight += ((levelPixelHeight - 1) % _innerTileHeight) + 1;
+                    relIterationIds.push_back(relIterationId);
                 }
-                else
+
+                if(relIterationId == 0)
                 {
-                    padHeight += _innerTileHeight;
+                    break;
                 }
+            }
 
-                if(yIsLast)
-                {
-                    // pad bottom side
-                    writeBitmap.smearVertical(0, padHeight - 1, 0, padHeight, padWidth, _padding);
+            std::atomic<size_t> nextTile(0);
 
-                    uint8_t transPx[4] = {0x00, 0x00, 0x00, 0x00};
+            _runThreads([&]() {
+                std::ifstream payloadFile;
+                _openPayloadForReading(payloadFile);
 
-                    writeBitmap.fillRect(transPx, Bitmap::PIXEL_FORMAT::RGBA8, 0, padHeight + _padding, padWidth + _padding, _tileHeight - padHeight - _padding);
-                }
-                else
-                {
-                    // pad bottom side
-                    writeBitmap.copyRectFrom(bufferBitmap9, 0, _padding, 0, _padding + _innerTileHeight, padWidth + _padding, _padding);
-                }
+                std::vector<uint8_t> buffer(workerBufferSize);
 
-                if(xIsLast)
+                for(size_t i = nextTile++; i < relIterationIds.size(); i = nextTile++)
                 {
-                    // pad right side
-                    writeBitmap.smearHorizontal(padWidth - 1, 0, padWidth, 0, _padding, padHeight + _padding);
+                    std::vector<uint8_t> tile(_destTileByteSize);
 
-                    uint8_t transPx[4] = {0x00, 0x00, 0x00, 0x00};
+                    _deflateTile(payloadFile, relIterationIds[i], iterationLevel, levelTileWidth, levelTileHeight, buffer.data(), tile.data());
 
-                    writeBitmap.fillRect(transPx, Bitmap::PIXEL_FORMAT::RGBA8, padWidth + _padding, 0, _tileWidth - padWidth - _padding, _tileHeight);
-                }
-                else
-                {
-                    // pad right side
-                    writeBitmap.copyRectFrom(bufferBitmap10, _padding, 0, _padding + _innerTileWidth, 0, _padding, padHeight + _padding);
+                    writer.write(_offsetIndex->getOffset(firstIdOfIterationLevel + relIterationIds[i]), std::move(tile));
                 }
+            });
+
+            writer.flush();
+
+            // a neighbour is read while it may be padded itself. its padding is reapplied from its own
+            // neighbours, every other pixel needed from it is the same before and after padding
+            auto padTiles = [&]() {
+                std::ifstream payloadFile;
+                _openPayloadForReading(payloadFile);
 
-                if(_destLayout == AtlasFile::LAYOUT::RAW)
+                std::vector<uint8_t> buffer(_destTileByteSize * 3);
+
+                Bitmap bottomBitmap(_tileWidth, _tileHeight, _destPxFormat, buffer.data());
+                Bitmap rightBitmap(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize]);
+                Bitmap bottomRightBitmap(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 2]);
+
+                for(size_t i = nextTile++; i < relIterationIds.size(); i = nextTile++)
                 {
-                    currentOffset = absIterationId * _destTileByteSize;
-                    _offsetIndex->set(absIterationId, currentOffset, _destTileByteSize);
+                    uint64_t x;
+                    uint64_t y;
+
+                    QuadTree::getCoordinatesInLevel(relIterationIds[i], iterationLevel, x, y);
 
-                    while(currentOffset < writeBufferOffset)
+                    bool xIsLast = x == (iterationLevelTileWidth - 1);
+                    bool yIsLast = y == (iterationLevelTileHeight - 1);
+
+                    uint64_t relId = relIterationIds[i];
+                    uint64_t relIdRight = QuadTree::getNeighbour(relId, QuadTree::NEIGHBOUR::RIGHT);
+                    uint64_t relIdBottom = QuadTree::getNeighbour(relId, QuadTree::NEIGHBOUR::BOTTOM);
+
+                    if(padInParallel && !xIsLast && !yIsLast)
                     {
-                        std::memset(writeBuffer, 0x00, lastWriteOffset - writeBufferOffset);
+                        _loadTileById(payloadFile, firstIdOfIterationLevel + QuadTree::getNeighbour(relIdRight, QuadTree::NEIGHBOUR::BOTTOM), bottomRightBitmap.getData());
+                        _padTile(bottomRightBitmap, x + 1, y + 1, iterationLevelTileWidth, iterationLevelTileHeight, levelPixelWidth, levelPixelHeight, nullptr, nullptr);
+                    }
 
-                        _destPayloadFile.seekp(_destPayloadOffset + writeBufferOffset);
-                        _destPayloadFile.write((char*)writeBuffer, std::min(writeBufferSize, offsetAfterLastTile - writeBufferOffset));
+                    if(!yIsLast)
+                    {
+                        _loadTileById(payloadFile, firstIdOfIterationLevel + relIdBottom, bottomBitmap.getData());
 
-                        lastWriteOffset = writeBufferOffset;
-                        writeBufferOffset -= writeBufferSize;
-                        writeBufferFirstId -= writeBufferTileSize;
+                        if(padInParallel)
+                        {
+                            _padTile(bottomBitmap, x, y + 1, iterationLevelTileWidth, iterationLevelTileHeight, levelPixelWidth, levelPixelHeight, nullptr, xIsLast ? nullptr : &bottomRightBitmap);
+                        }
                     }
 
-                    std::memset(&writeBuffer[currentOffset - writeBufferOffset + _destTileByteSize], 0x00, lastWriteOffset - currentOffset - _destTileByteSize);
-                    std::memcpy(&writeBuffer[currentOffset - writeBufferOffset], (char*)&buffer[bufferOffset], _destTileByteSize);
-                    lastWriteOffset = currentOffset;
-                }
-                else
-                {
-                    if((currentOffset + _destTileByteSize) > (writeBufferOffset + writeBufferSize))
+                    if(!xIsLast)
                     {
-                        _destPayloadFile.seekp(_destPayloadOffset + writeBufferOffset);
-                        _destPayloadFile.write((char*)writeBuffer, writeBufferSize);
+                        _loadTileById(payloadFile, firstIdOfIterationLevel + relIdRight, rightBitmap.getData());
 
-                        writeBufferOffset += writeBufferSize;
+                        if(padInParallel)
+                        {
+                            _padTile(rightBitmap, x + 1, y, iterationLevelTileWidth, iterationLevelTileHeight, levelPixelWidth, levelPixelHeight, yIsLast ? nullptr : &bottomRightBitmap, nullptr);
+                        }
                     }
 
-                    // std::cout << currentOffset << std::endl;
-                    _offsetIndex->set(absIterationId, currentOffset, _destTileByteSize);
+                    uint64_t absId = firstIdOfIterationLevel + relId;
+                    std::vector<uint8_t> tile(_destTileByteSize);
+                    Bitmap tileBitmap(_tileWidth, _tileHeight, _destPxFormat, tile.data());
 
-                    std::memcpy(&writeBuffer[currentOffset - writeBufferOffset], (char*)&buffer[bufferOffset], _destTileByteSize);
-                    writeBufferLastId = idLookup[(((currentOffset - writeBufferOffset) / _destTileByteSize) + 1) % writeBufferTileSize];
-                    writeBufferFirstId = absIterationId;
-                    idLookup[(currentOffset - writeBufferOffset) / _destTileByteSize] = absIterationId;
-                    currentOffset += _destTileByteSize;
-                }
+                    _loadTileById(payloadFile, absId, tile.data());
+                    _padTile(tileBitmap, x, y, iterationLevelTileWidth, iterationLevelTileHeight, levelPixelWidth, levelPixelHeight, &bottomBitmap, &rightBitmap);
 
-#ifdef PREPROCESSOR_LOG_PROGRESS
-                ++tilesWritten;
-                auto currentProgress = (uint8_t)(tilesWritten * 100 / iterationLevelTileWidth / iterationLevelTileHeight);
+                    writer.write(_offsetIndex->getOffset(absId), std::move(tile));
 
-                if(currentProgress != progress)
-                {
-                    progress = currentProgress;
-                    std::cout << '\r' << std::setw(3) << (int)progress << " %";
-                    std::cout.flush();
+                    if(!padInParallel)
+                    {
+                        writer.flush();
+                    }
                 }
-#endif
+            };
 
-                if(relIterationId == 0)
-                {
-                    break;
-                }
+            nextTile = 0;
+
+            if(padInParallel)
+            {
+                _runThreads(padTiles);
             }
+            else
+            {
+                padTiles();
+            }
+
+            writer.flush();
 
             levelTileWidth = iterationLevelTileWidth;
             levelTileHeight = iterationLevelTileHeight;
 
-#ifdef PREPROCESSOR_LOG_PROGRESS
-            std::cout << " (" << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count() << " ms)" << std::endl << std::endl;
-            std::cout.flush();
-#endif
+            _addPhaseTiming("deflate level " + std::to_string(iterationLevel), start);
 
             if(iterationLevel == 0)
             {
@@ -395,65 +437,26 @@ void Preprocessor::_deflate(size_t writeBufferSize)
         }
     }
 
-    _destPayloadFile.seekp(_destPayloadOffset + writeBufferOffset);
-
-    if(_destLayout == AtlasFile::RAW)
-    {
-        _destPayloadFile.write((char*)writeBuffer, std::min(writeBufferSize, offsetAfterLastTile - writeBufferOffset));
-    }
-    else if(_destLayout == AtlasFile::PACKED)
-    {
-        _destPayloadFile.write((char*)writeBuffer, (currentOffset - writeBufferOffset));
-    }
-
-    _destPayloadFile.flush();
-
     _destIndexFile->seekp(_destOffsetIndexOffset);
     _offsetIndex->writeToFile(*_destIndexFile);
     _destIndexFile->seekp(_destCielabIndexOffset);
     _cielabIndex->writeToFile(*_destIndexFile);
-
-    delete[] buffer;
-    delete[] writeBuffer;
-    delete[] idLookup;
 }
 
-size_t Preprocessor::_getTileById(uint64_t id, const uint8_t* buffer, uint64_t firstIdInBuffer, uint64_t lastIdInBuffer, const uint64_t* idLookup, size_t bufferTileLen, uint8_t* out)
+size_t Preprocessor::_loadTileById(std::ifstream& file, uint64_t id, uint8_t* out)
 {
-    size_t len = _getBufferedTileById(id, buffer, firstIdInBuffer, lastIdInBuffer, idLookup, bufferTileLen, out);
-
-    if(len == 0)
-    {
-        len = _loadTileById(id, out);
-    }
-
-    return len;
-}
-
-size_t Preprocessor::_loadTileById(uint64_t id, uint8_t* out)
-{
-    uint64_t offset;
     uint64_t len = _destTileByteSize;
 
-    if(_destLayout == AtlasFile::LAYOUT::RAW)
-    {
-        offset = id * len;
-    }
-    else
+    if(!_offsetIndex->exists(id))
     {
-        if(!_offsetIndex->exists(id))
-        {
-            return 0;
-        }
-
-        offset = _offsetIndex->getOffset(id);
+        return 0;
     }
 
-    _destPayloadFile.clear();
-    _destPayloadFile.seekg(_destPayloadOffset + offset, std::ios_base::beg);
-    _destPayloadFile.read((char*)out, len);
+    file.clear();
+    file.seekg(_destPayloadOffset + _offsetIndex->getOffset(id), std::ios_base::beg);
+    file.read((char*)out, len);
 
-    if(!_destPayloadFile.good())
+    if(!file.good())
     {
         throw std::runtime_error("Cannot read Tiles from File.");
     }
@@ -461,81 +464,32 @@ size_t Preprocessor::_loadTileById(uint64_t id, uint8_t* out)
     return (size_t)len;
 }
 
-size_t Preprocessor::_getBufferedTileById(uint64_t id, const uint8_t* buffer, uint64_t firstIdInBuffer, uint64_t lastIdInBuffer, const uint64_t* idLookup, size_t bufferTileLen, uint8_t* out)
+Preprocessor::Preprocessor(const std::string& srcFileName, Bitmap::PIXEL_FORMAT srcPxFormat, size_t imageWidth, size_t imageHeight)
+    : Preprocessor(new RawImageSource(srcFileName, srcPxFormat, imageWidth, imageHeight))
 {
-    size_t len = 0;
-
-    if(_destLayout == AtlasFile::LAYOUT::RAW)
-    {
-        if(id >= firstIdInBuffer && id < firstIdInBuffer + bufferTileLen)
-        {
-            len = _destTileByteSize;
-            std::memcpy(out, (char*)&buffer[(id - firstIdInBuffer) * _destTileByteSize], _destTileByteSize);
-        }
-    }
-    else
-    {
-        size_t offset = bufferTileLen;
-
-        if(id >= firstIdInBuffer && id <= lastIdInBuffer)
-        {
-            for(size_t i = 0; i < bufferTileLen; ++i)
-            {
-                if(idLookup[i] == id)
-                {
-                    offset = i;
-                    break;
-                }
-            }
-        }
-
-        if(offset != bufferTileLen)
-        {
-            len = _destTileByteSize;
-            std::memcpy(out, (char*)&buffer[offset * _destTileByteSize], _destTileByteSize);
-        }
-    }
-
-    return len;
 }
 
-Preprocessor::Preprocessor(const std::string& srcFileName, Bitmap::PIXEL_FORMAT srcPxFormat, size_t imageWidth, size_t imageHeight)
+Preprocessor::Preprocessor(ImageSource* src)
 {
     _destHeaderFile = nullptr;
     _destIndexFile = nullptr;
     _destCombined = DEST_COMBINED::NONE;
+    _threadCount = std::max(1u, std::thread::hardware_concurrency());
 
-    _srcFileName = srcFileName;
-    _srcPxFormat = srcPxFormat;
-    _imageWidth = imageWidth;
-    _imageHeight = imageHeight;
-
-    //_srcFile.rdbuf()->pubsetbuf(nullptr, 0);
-    _srcFile.open(srcFileName, std::ios::in | std::ios::out | std::ios::binary | std::ios::ate);
-
-    if(!_srcFile.is_open())
-    {
-        throw std::runtime_error("Could not open File \"" + srcFileName + "\".");
-    }
-
-    size_t pxSize = Bitmap::pixelSize(srcPxFormat);
-    uint64_t expSrcFileSize = imageWidth * imageHeight * pxSize;
-    _srcFileSize = (uint64_t)_srcFile.tellg();
+    _src = src;
+    _srcPxFormat = src->getPixelFormat();
+    _imageWidth = src->getWidth();
+    _imageHeight = src->getHeight();
 
     _offsetIndex = nullptr;
     _cielabIndex = nullptr;
-
-    if(_srcFileSize != expSrcFileSize)
-    {
-        throw std::runtime_error("File \"" + srcFileName + "\" expected to be of Size " + std::to_string(expSrcFileSize) + " Bytes, actually has " + std::to_string(_srcFileSize) + " Bytes.");
-    }
 }
 
 Preprocessor::~Preprocessor()
 {
-    _srcFile.close();
     _destPayloadFile.close();
 
+    delete _src;
     delete _offsetIndex;
     delete _cielabIndex;
 
@@ -586,6 +540,9 @@ void Preprocessor::_putFileFormat(AtlasFile::LAYOUT fileFormat, uint8_t* out)
     case AtlasFile::LAYOUT::PACKED:
         out[0] = 2;
         break;
+    case AtlasFile::LAYOUT::COMPRESSED:
+        out[0] = 3;
+        break;
     default:
         throw std::runtime_error("Trying to save unknown file format.");
     }
@@ -678,7 +635,8 @@ void Preprocessor::setOutput(const std::string& destFileName, Bitmap::PIXEL_FORM
     if(combine)
     {
         _destCombined = DEST_COMBINED::COMBINED;
-        _destPayloadFile.open(destFileName + ".atlas", std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        _destPayloadFileName = destFileName + ".atlas";
+        _destPayloadFile.open(_destPayloadFileName, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
         //_destPayloadFile.rdbuf()->pubsetbuf(nullptr, 0);
 
         if(!_destPayloadFile.is_open())
@@ -709,7 +667,8 @@ void Preprocessor::setOutput(const std::string& destFileName, Bitmap::PIXEL_FORM
     {
         _destCombined = DEST_COMBINED::NOT_COMBINED;
         //_destPayloadFile.rdbuf()->pubsetbuf(nullptr, 0);
-        _destPayloadFile.open(destFileName + ".atlas.data", std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        _destPayloadFileName = destFileName + ".atlas.data";
+        _destPayloadFile.open(_destPayloadFileName, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
 
         if(!_destPayloadFile.is_open())
         {
@@ -743,21 +702,17 @@ void Preprocessor::setOutput(const std::string& destFileName, Bitmap::PIXEL_FORM
     }
 }
 
-void Preprocessor::_extract(size_t bufferTileWidth, size_t writeBufferSize)
+void Preprocessor::_extract(size_t bufferTileWidth, size_t maxPendingBytes)
 {
     if(!_isPowerOfTwo(bufferTileWidth))
     {
         throw std::runtime_error("Cache Width needs to be a Power of 2.");
     }
 
-#ifdef PREPROCESSOR_LOG_PROGRESS
     auto start = std::chrono::high_resolution_clock::now();
-    uint64_t tilesWritten = 0;
-    uint8_t progress = 0;
 
-    std::cout << "Extracting " << (_imageTileWidth * _imageTileHeight) << " Tiles: " << std::endl;
-    std::cout << std::setw(3) << (int)progress << " %";
-    std::cout.flush();
+#ifdef PREPROCESSOR_LOG_PROGRESS
+    std::cout << "Extracting " << (_imageTileWidth * _imageTileHeight) << " Tiles" << std::endl;
 #endif
 
     auto srcPxSize = Bitmap::pixelSize(_srcPxFormat);
@@ -767,6 +722,12 @@ void Preprocessor::_extract(size_t bufferTileWidth, size_t writeBufferSize)
         bufferTileWidth = QuadTree::getWidthOfLevel(_treeDepth - 1);
     }
 
+    // every thread needs a block of source rows of its own
+    while(bufferTileWidth > 1 && ((_imageTileWidth + bufferTileWidth - 1) / bufferTileWidth) * ((_imageTileHeight + bufferTileWidth - 1) / bufferTileWidth) < _threadCount)
+    {
+        bufferTileWidth >>= 1;
+    }
+
     auto bufferTileHeight = bufferTileWidth;
 
     auto bufferPxWidthInner = bufferTileWidth * _innerTileWidth;
@@ -775,25 +736,6 @@ void Preprocessor::_extract(size_t bufferTileWidth, size_t writeBufferSize)
     auto bufferPxHeight = bufferPxHeightInner + (_padding << 1);
 
     auto bufferSize = bufferPxWidth * bufferPxHeight * srcPxSize;
-    auto buffer = new uint8_t[bufferSize];
-
-    size_t writeBufferTileSize = writeBufferSize / _destTileByteSize;
-    writeBufferSize = writeBufferTileSize * _destTileByteSize;
-
-    auto outTile = new uint8_t[_destTileByteSize];
-    auto writeBuffer = new uint8_t[writeBufferSize];
-    uint64_t writeBufferOffset = 0;
-    uint64_t offsetAfterLastTile = QuadTree::firstIdOfLevel(_treeDepth) * _destTileByteSize;
-    uint64_t lastWriteOffset = offsetAfterLastTile;
-
-    if(_destLayout == AtlasFile::LAYOUT::RAW)
-    {
-        uint64_t tilesInFinestLevel = QuadTree::getWidthOfLevel(_treeDepth - 1) * QuadTree::getWidthOfLevel(_treeDepth - 1);
-        writeBufferOffset = offsetAfterLastTile - (tilesInFinestLevel % writeBufferTileSize) * _destTileByteSize;
-    }
-
-    Bitmap bufferBitmap(bufferPxWidth, bufferPxHeight, _srcPxFormat, buffer);
-    Bitmap writeBitmap(_tileWidth, _tileHeight, _destPxFormat, outTile);
 
     size_t finestLevel = _treeDepth - 1;
     size_t bufferLevel = QuadTree::getDepth(bufferTileWidth, bufferTileHeight) - 1;
@@ -811,6 +753,11 @@ void Preprocessor::_extract(size_t bufferTileWidth, size_t writeBufferSize)
 
     auto firstId = QuadTree::firstIdOfLevel(finestLevel);
 
+    // tiles are stored in descending order of their ids, which makes every block a contiguous range
+    // of the payload. offsets are assigned up front, so blocks can be extracted in any order
+    std::vector<uint64_t> blocks;
+    std::vector<uint64_t> blockOffsets;
+
     for(uint64_t relIterationId = tilesToIterate - 1; /*relIterationId >= 0*/; --relIterationId)
     {
         uint64_t x;
@@ -818,33 +765,54 @@ void Preprocessor::_extract(size_t bufferTileWidth, size_t writeBufferSize)
 
         QuadTree::getCoordinatesInLevel(relIterationId, iterationLevel, x, y);
 
-        if(x >= iterTileWidth || y >= iterTileHeight)
+        if(x < iterTileWidth && y < iterTileHeight)
         {
-            if(_destLayout == AtlasFile::LAYOUT::RAW)
+            blocks.push_back(relIterationId);
+            blockOffsets.push_back(currentOffset);
+
+            for(auto relBufferId = (size_t)(tilesInBuffer - 1); /*relBufferId >= tilesInBuffer*/; --relBufferId)
             {
-                currentOffset = (firstId + relIterationId * tilesInBuffer) * _destTileByteSize;
-                auto dataLen = (uint64_t)bufferTileWidth * bufferTileHeight * _destTileByteSize;
-                auto data = new uint8_t[dataLen];
+                uint64_t bufferTileX;
+                uint64_t bufferTileY;
 
-                std::memset(data, 0x00, dataLen);
+                QuadTree::getCoordinatesInLevel(relBufferId, bufferLevel, bufferTileX, bufferTileY);
 
-                _destPayloadFile.seekp(_destPayloadOffset + currentOffset);
-                _destPayloadFile.write((char*)data, dataLen);
+                if(x * bufferTileWidth + bufferTileX < _imageTileWidth && y * bufferTileHeight + bufferTileY < _imageTileHeight)
+                {
+                    _offsetIndex->set(firstId + relIterationId * tilesInBuffer + relBufferId, currentOffset, _destTileByteSize);
+                    currentOffset += _destTileByteSize;
+                }
 
-                delete data;
+                if(relBufferId == 0)
+                {
+                    break;
+                }
             }
+        }
 
-            continue;
+        if(relIterationId == 0)
+        {
+            break;
         }
+    }
+
+    blockOffsets.push_back(currentOffset);
+
+    // part of the image read for a block and its position in the buffer, the rest of the buffer is padded
+    auto blockRect = [&](size_t block, size_t& offsetX, size_t& offsetY, size_t& readWidth, size_t& readHeight, size_t& offsetBufferX, size_t& offsetBufferY) {
+        uint64_t x;
+        uint64_t y;
+
+        QuadTree::getCoordinatesInLevel(blocks[block], iterationLevel, x, y);
 
-        size_t offsetX = (size_t)x * bufferPxWidthInner;
-        size_t offsetY = (size_t)y * bufferPxHeightInner;
+        offsetX = (size_t)x * bufferPxWidthInner;
+        offsetY = (size_t)y * bufferPxHeightInner;
 
-        size_t readWidth = bufferPxWidth;
-        size_t readHeight = bufferPxHeight;
+        readWidth = bufferPxWidth;
+        readHeight = bufferPxHeight;
 
-        size_t offsetBufferX = 0;
-        size_t offsetBufferY = 0;
+        offsetBufferX = 0;
+        offsetBufferY = 0;
 
         if(offsetX < _padding)
         {
@@ -877,175 +845,134 @@ void Preprocessor::_extract(size_t bufferTileWidth, size_t writeBufferSize)
         {
             readHeight = _imageHeight - offsetY;
         }
+    };
 
-        auto cachePtr = &buffer[offsetBufferY * bufferPxWidth * srcPxSize + offsetBufferX * srcPxSize];
-        uint64_t fileOffset = offsetY * _imageWidth * srcPxSize + offsetX * srcPxSize;
+    PayloadWriter writer(_destPayloadFile, _destPayloadOffset, maxPendingBytes);
+    std::atomic<size_t> nextBlock(0);
 
-        for(size_t line = 0; line < readHeight; ++line)
-        {
-            _srcFile.seekg(fileOffset);
-            _srcFile.read((char*)cachePtr, readWidth * srcPxSize);
+    _runThreads([&]() {
+        // not initialized, only the part of the buffer covered by the image is touched
+        std::unique_ptr<uint8_t[]> buffer(new uint8_t[bufferSize]);
+        Bitmap bufferBitmap(bufferPxWidth, bufferPxHeight, _srcPxFormat, buffer.get());
 
-            if(!_srcFile.good())
+        size_t offsetX;
+        size_t offsetY;
+        size_t readWidth;
+        size_t readHeight;
+        size_t offsetBufferX;
+        size_t offsetBufferY;
+
+        for(size_t block = nextBlock++; block < blocks.size(); block = nextBlock++)
+        {
+            // the block this thread probably extracts next, once every thread took one
+            if(block + _threadCount < blocks.size())
             {
-                throw std::runtime_error("Cannot read from File.");
+                blockRect(block + _threadCount, offsetX, offsetY, readWidth, readHeight, offsetBufferX, offsetBufferY);
+                _src->prefetch(offsetX, offsetY, readWidth, readHeight);
             }
 
-            fileOffset += _imageWidth * srcPxSize;
-            cachePtr = &cachePtr[bufferPxWidth * srcPxSize];
-        }
-
-        // pad left side
-        bufferBitmap.smearHorizontal(offsetBufferX, offsetBufferY, 0, offsetBufferY, offsetBufferX, readHeight);
+            uint64_t relIterationId = blocks[block];
+            uint64_t x;
+            uint64_t y;
 
-        // pad right side
-        bufferBitmap.smearHorizontal(
-            offsetBufferX + readWidth - 1, offsetBufferY, offsetBufferX + readWidth, offsetBufferY, std::min<size_t>(_padding, bufferPxWidth - offsetBufferX - readWidth), readHeight);
+            QuadTree::getCoordinatesInLevel(relIterationId, iterationLevel, x, y);
 
-        // pad top side
-        bufferBitmap.smearVertical(0, offsetBufferY, 0, 0, bufferPxWidth, offsetBufferY);
+            blockRect(block, offsetX, offsetY, readWidth, readHeight, offsetBufferX, offsetBufferY);
+            _src->read(offsetX, offsetY, readWidth, readHeight, &buffer[offsetBufferY * bufferPxWidth * srcPxSize + offsetBufferX * srcPxSize], bufferPxWidth * srcPxSize);
 
-        // pad bottom side
-        bufferBitmap.smearVertical(0, offsetBufferY + readHeight - 1, 0, offsetBufferY + readHeight, bufferPxWidth, std::min<size_t>(_padding, bufferPxHeight - offsetBufferY - readHeight));
+            // pad left side
+            bufferBitmap.smearHorizontal(offsetBufferX, offsetBufferY, 0, offsetBufferY, offsetBufferX, readHeight);
 
-        for(auto relBufferId = (size_t)(tilesInBuffer - 1); /*relBufferId >= tilesInBuffer*/; --relBufferId)
-        {
-            auto relId = relIterationId * tilesInBuffer + relBufferId;
-            auto absId = firstId + relId;
+            // pad right side
+            bufferBitmap.smearHorizontal(
+                offsetBufferX + readWidth - 1, offsetBufferY, offsetBufferX + readWidth, offsetBufferY, std::min<size_t>(_padding, bufferPxWidth - offsetBufferX - readWidth), readHeight);
 
-            uint64_t bufferTileX;
-            uint64_t bufferTileY;
+            // pad top side
+            bufferBitmap.smearVertical(0, offsetBufferY, 0, 0, bufferPxWidth, offsetBufferY);
 
-            QuadTree::getCoordinatesInLevel(relBufferId, bufferLevel, bufferTileX, bufferTileY);
+            // pad bottom side
+            bufferBitmap.smearVertical(0, offsetBufferY + readHeight - 1, 0, offsetBufferY + readHeight, bufferPxWidth, std::min<size_t>(_padding, bufferPxHeight - offsetBufferY - readHeight));
 
-            auto absTileX = x * bufferTileWidth + bufferTileX;
-            auto absTileY = y * bufferTileHeight + bufferTileY;
+            std::vector<uint8_t> blockData(blockOffsets[block + 1] - blockOffsets[block]);
 
-            if(absTileX >= _imageTileWidth || absTileY >= _imageTileHeight)
+            for(auto relBufferId = (size_t)(tilesInBuffer - 1); /*relBufferId >= tilesInBuffer*/; --relBufferId)
             {
-                continue;
-            }
+                auto relId = relIterationId * tilesInBuffer + relBufferId;
+                auto absId = firstId + relId;
 
-            writeBitmap.copyRectFrom(bufferBitmap, (size_t)bufferTileX * _innerTileWidth, (size_t)bufferTileY * _innerTileHeight, 0, 0, _tileWidth, _tileHeight);
+                uint64_t bufferTileX;
+                uint64_t bufferTileY;
 
-            size_t padWidth = _tileWidth;
+                QuadTree::getCoordinatesInLevel(relBufferId, bufferLevel, bufferTileX, bufferTileY);
 
-            if(absTileX == (_imageTileWidth - 1))
-            {
-                padWidth = ((_imageWidth - 1) % _innerTileWidth) + 1 + (_padding << 1);
-            }
-
-            if(absTileY == (_imageTileHeight - 1))
-            {
-                uint8_t transPx[] = {0x00, 0x00, 0x00, 0x00};
-
-                writeBitmap.fillRect(transPx,
-                                     Bitmap::PIXEL_FORMAT::RGBA8,
-                                     0,
-                                     ((_imageHeight - 1) % _innerTileHeight) + 1 + (_padding << 1),
-                                     padWidth,
-                                     _tileHeight - ((_imageHeight - 1) % _innerTileHeight) - 1 - (_padding << 1));
-            }
+                auto absTileX = x * bufferTileWidth + bufferTileX;
+                auto absTileY = y * bufferTileHeight + bufferTileY;
 
-            if(absTileX == (_imageTileWidth - 1))
-            {
-                uint8_t transPx[] = {0x00, 0x00, 0x00, 0x00};
+                if(absTileX < _imageTileWidth && absTileY < _imageTileHeight)
+                {
+                    Bitmap writeBitmap(_tileWidth, _tileHeight, _destPxFormat, &blockData[_offsetIndex->getOffset(absId) - blockOffsets[block]]);
 
-                writeBitmap.fillRect(transPx, Bitmap::PIXEL_FORMAT::RGBA8, padWidth, 0, _tileWidth - padWidth, _tileHeight);
-            }
+                    writeBitmap.copyRectFrom(bufferBitmap, (size_t)bufferTileX * _innerTileWidth, (size_t)bufferTileY * _innerTileHeight, 0, 0, _tileWidth, _tileHeight);
 
-            _offsetIndex->set(absId, currentOffset, _destTileByteSize);
+                    size_t padWidth = _tileWidth;
 
-            if(_destLayout == AtlasFile::LAYOUT::RAW)
-            {
-                currentOffset = _destTileByteSize * absId;
+                    if(absTileX == (_imageTileWidth - 1))
+                    {
+                        padWidth = ((_imageWidth - 1) % _innerTileWidth) + 1 + (_padding << 1);
+                    }
 
-                while(currentOffset < writeBufferOffset)
-                {
-                    std::memset(writeBuffer, 0x00, lastWriteOffset - writeBufferOffset);
+                    if(absTileY == (_imageTileHeight - 1))
+                    {
+                        uint8_t transPx[] = {0x00, 0x00, 0x00, 0x00};
+
+                        writeBitmap.fillRect(transPx,
+                                             Bitmap::PIXEL_FORMAT::RGBA8,
+                                             0,
+                                             ((_imageHeight - 1) % _innerTileHeight) + 1 + (_padding << 1),
+                                             padWidth,
+                                             _tileHeight - ((_imageHeight - 1) % _innerTileHeight) - 1 - (_padding << 1));
+                    }
 
-                    _destPayloadFile.seekp(_destPayloadOffset + writeBufferOffset);
-                    _destPayloadFile.write((char*)writeBuffer, std::min(writeBufferSize, offsetAfterLastTile - writeBufferOffset));
+                    if(absTileX == (_imageTileWidth - 1))
+                    {
+                        uint8_t transPx[] = {0x00, 0x00, 0x00, 0x00};
 
-                    lastWriteOffset = writeBufferOffset;
-                    writeBufferOffset -= writeBufferSize;
+                        writeBitmap.fillRect(transPx, Bitmap::PIXEL_FORMAT::RGBA8, padWidth, 0, _tileWidth - padWidth, _tileHeight);
+                    }
                 }
 
-                std::memset(&writeBuffer[currentOffset - writeBufferOffset + _destTileByteSize], 0x00, lastWriteOffset - currentOffset - _destTileByteSize);
-                std::memcpy(&writeBuffer[currentOffset - writeBufferOffset], outTile, _destTileByteSize);
-                lastWriteOffset = currentOffset;
-            }
-            else
-            {
-                if((currentOffset + _destTileByteSize) > (writeBufferOffset + writeBufferSize))
+                if(relBufferId == 0)
                 {
-                    _destPayloadFile.seekp(_destPayloadOffset + writeBufferOffset);
-                    _destPayloadFile.write((char*)writeBuffer, (currentOffset - writeBufferOffset));
-                    _destPayloadFile.flush();
-
-                    writeBufferOffset = currentOffset;
+                    break;
                 }
-
-                std::memcpy(&writeBuffer[currentOffset - writeBufferOffset], outTile, _destTileByteSize);
-                currentOffset += _destTileByteSize;
-            }
-
-#ifdef PREPROCESSOR_LOG_PROGRESS
-            ++tilesWritten;
-            auto currentProgress = (uint8_t)(tilesWritten * 100 / _imageTileWidth / _imageTileHeight);
-
-            if(currentProgress != progress)
-            {
-                progress = currentProgress;
-                std::cout << '\r' << std::setw(3) << (int)progress << " %";
-                std::cout.flush();
-            }
-#endif
-
-            if(relBufferId == 0)
-            {
-                break;
             }
-        }
 
-        if(relIterationId == 0)
-        {
-            break;
+            writer.write(blockOffsets[block], std::move(blockData));
         }
-    }
-
-#ifdef PREPROCESSOR_LOG_PROGRESS
-    std::cout << " (" << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count() << " ms)" << std::endl << std::endl;
-#endif
-
-    _destPayloadFile.seekp(_destPayloadOffset + writeBufferOffset);
+    });
 
-    if(_destLayout == AtlasFile::RAW)
-    {
-        _destPayloadFile.write((char*)writeBuffer, std::min(writeBufferSize, offsetAfterLastTile - writeBufferOffset));
-    }
-    else if(_destLayout == AtlasFile::PACKED)
-    {
-        _destPayloadFile.write((char*)writeBuffer, (currentOffset - writeBufferOffset));
-    }
+    writer.flush();
 
-    _destPayloadFile.flush();
     _destIndexFile->seekp(_destOffsetIndexOffset);
     _offsetIndex->writeToFile(*_destIndexFile);
     _destIndexFile->seekp(_destCielabIndexOffset);
     _cielabIndex->writeToFile(*_destIndexFile);
 
-    delete[] buffer;
-    delete[] outTile;
-    delete[] writeBuffer;
+    _addPhaseTiming("extract", start);
 }
 
+void Preprocessor::setThreadCount(size_t threadCount) { _threadCount = std::max<size_t>(1, threadCount); }
+
+const std::vector<Preprocessor::PhaseTiming>& Preprocessor::getPhaseTimings() const { return _phaseTimings; }
+
 void Preprocessor::run(size_t maxMemory)
 {
-#ifdef PREPROCESSOR_LOG_PROGRESS
     auto start = std::chrono::high_resolution_clock::now();
 
-    std::cout << "Preprocessing \"" << _srcFileName << "\"" << std::endl;
+    _phaseTimings.clear();
+
+#ifdef PREPROCESSOR_LOG_PROGRESS
+    std::cout << "Preprocessing \"" << _src->getName() << "\" with " << _threadCount << " Threads" << std::endl;
 
     if(_destCombined == DEST_COMBINED::COMBINED)
     {
@@ -1059,96 +986,26 @@ void Preprocessor::run(size_t maxMemory)
     }
 
     std::cout << std::endl;
-
-    std::cout << "Writing Header ... ";
 #endif
-    _writeHeader();
 
-#ifdef PREPROCESSOR_LOG_PROGRESS
-    std::cout << "Done" << std::endl << std::endl;
-#endif
+    _writeHeader();
 
     size_t srcTileSize = _tileWidth * _tileHeight * Bitmap::pixelSize(_srcPxFormat);
 
-    auto bufferSideLen = (size_t)std::sqrt(maxMemory / srcTileSize);
-    bufferSideLen = (size_t)1 << ((size_t)std::log2(bufferSideLen));
+    // a thread extracts a block of source tiles into the same count of destination tiles, while the
+    // previous block of that thread may still wait to be written
+    auto bufferSideLen = (size_t)std::sqrt(maxMemory / _threadCount / (srcTileSize + 2 * _destTileByteSize));
+    bufferSideLen = bufferSideLen == 0 ? 1 : (size_t)1 << ((size_t)std::log2(bufferSideLen));
 
 #ifdef PREPROCESSOR_LOG_PROGRESS
-    std::cout << "Readbuffer Size: " << bufferSideLen << "x" << bufferSideLen << " Tiles\n";
-    std::cout << "Writebuffer Size: " << (maxMemory - bufferSideLen * bufferSideLen * srcTileSize) << " Bytes\n" << std::endl;
+    std::cout << "Readbuffer Size: " << bufferSideLen << "x" << bufferSideLen << " Tiles per Thread\n" << std::endl;
 #endif
 
-    _extract(bufferSideLen, maxMemory - bufferSideLen * bufferSideLen * srcTileSize);
+    _extract(bufferSideLen, _threadCount * bufferSideLen * bufferSideLen * _destTileByteSize);
     _deflate(maxMemory);
     //_calcDeltaE(maxMemory);
 
-#ifdef PREPROCESSOR_LOG_PROGRESS
-    std::cout << "Done in " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count() << " ms." << std::endl << std::endl;
-#endif
-}
-
-void Preprocessor::_loadToSeqBuffer(uint8_t* buffer, uint64_t id, size_t count)
-{
-    switch(_destLayout)
-    {
-    case AtlasFile::LAYOUT::RAW:
-        break;
-    case AtlasFile::LAYOUT::PACKED:
-        uint64_t destId = 0;
-
-        if(id > count)
-        {
-            destId = id + 1 - count;
-        }
-
-        uint64_t firstAvailableId = UINT64_MAX;
-        uint64_t lastAvailableId = UINT64_MAX;
-        uint64_t countAvailableIds = 0;
-
-        for(uint64_t i = id;; --i)
-        {
-            if(_offsetIndex->exists(i))
-            {
-                if(firstAvailableId == UINT64_MAX)
-                {
-                    firstAvailableId = i;
-                }
-
-                lastAvailableId = i;
-                ++countAvailableIds;
-            }
-
-            if(i == destId)
-            {
-                break;
-            }
-        }
-
-        uint64_t offset = _offsetIndex->getOffset(firstAvailableId);
-
-        _destPayloadFile.seekg(_destPayloadOffset + offset);
-        _destPayloadFile.read((char*)buffer, countAvailableIds * _destTileByteSize);
-
-        auto tile = &buffer[(countAvailableIds - 1) * _destPayloadOffset];
-
-        for(uint64_t i = 0; i < count; ++i)
-        {
-            auto slot = count - i - 1;
-            auto absId = id - slot;
-
-            if(slot > id || absId > firstAvailableId || absId < lastAvailableId || !_offsetIndex->exists(absId))
-            {
-                std::memset(&buffer[slot * _destTileByteSize], 0, _destTileByteSize);
-            }
-            else
-            {
-                std::memcpy(&buffer[slot * _destTileByteSize], tile, _destTileByteSize);
-                tile = (uint8_t*)((size_t)tile - _destTileByteSize);
-            }
-        }
-
-        break;
-    }
+    _addPhaseTiming("total", start);
 }
 } // namespace pre
 } // namespace vt
\ No newline at end of file
@@ -101,6 +101,18 @@ size_t QuadTree::getDepth(size_t width, size_t height)
     return 0;
 }
 
+size_t QuadTree::getLevelOfId(uint64_t id)
+{
+    size_t level = 0;
+
+    while(id >= firstIdOfLevel(level + 1))
+    {
+        ++level;
+    }
+
+    return level;
+}
+
 uint64_t QuadTree::getNeighbour(uint64_t relId, NEIGHBOUR neighbour)
 {
     switch(neighbour)
@@ -0,0 +1,549 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/vt/pre/TileCodec.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace vt
+{
+namespace pre
+{
+inline uint32_t expand565(uint16_t color, uint32_t* rgb)
+{
+    uint32_t r = (color >> 11) & 0x1f;
+    uint32_t g = (color >> 5) & 0x3f;
+    uint32_t b = color & 0x1f;
+
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+
+    return color;
+}
+
+inline uint16_t quantize565(float r, float g, float b)
+{
+    auto quantize = [](float value, float max) -> uint32_t {
+        float q = std::round(value * max / 255.0f);
+
+        return (uint32_t)(q < 0.0f ? 0.0f : (q > max ? max : q));
+    };
+
+    return (uint16_t)((quantize(r, 31.0f) << 11) | (quantize(g, 63.0f) << 5) | quantize(b, 31.0f));
+}
+
+// the four colors of a block, the 3-color mode is only used by BC1
+inline void colorPalette(uint16_t color0, uint16_t color1, bool allowThreeColors, uint32_t palette[4][3])
+{
+    expand565(color0, palette[0]);
+    expand565(color1, palette[1]);
+
+    for(size_t c = 0; c < 3; ++c)
+    {
+        if(color0 > color1 || !allowThreeColors)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        else
+        {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+}
+
+inline void alphaPalette(uint8_t alpha0, uint8_t alpha1, uint32_t palette[8])
+{
+    palette[0] = alpha0;
+    palette[1] = alpha1;
+
+    if(alpha0 > alpha1)
+    {
+        for(uint32_t i = 2; i < 8; ++i)
+        {
+            palette[i] = ((8 - i) * alpha0 + (i - 1) * alpha1) / 7;
+        }
+    }
+    else
+    {
+        for(uint32_t i = 2; i < 6; ++i)
+        {
+            palette[i] = ((6 - i) * alpha0 + (i - 1) * alpha1) / 5;
+        }
+
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+inline void writeLE16(uint16_t value, uint8_t* out)
+{
+    out[0] = (uint8_t)(value & 0xff);
+    out[1] = (uint8_t)(value >> 8);
+}
+
+inline uint16_t readLE16(const uint8_t* data) { return (uint16_t)(data[0] | (data[1] << 8)); }
+
+// color endpoints along the principal axis of the block, refined by a least squares fit to the chosen indices
+void encodeColorBlock(const uint8_t rgb[16][3], uint8_t* out)
+{
+    float mean[3] = {0.0f, 0.0f, 0.0f};
+
+    for(size_t i = 0; i < 16; ++i)
+    {
+        for(size_t c = 0; c < 3; ++c)
+        {
+            mean[c] += rgb[i][c];
+        }
+    }
+
+    for(size_t c = 0; c < 3; ++c)
+    {
+        mean[c] /= 16.0f;
+    }
+
+    float cov[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+
+    for(size_t i = 0; i < 16; ++i)
+    {
+        float r = rgb[i][0] - mean[0];
+        float g = rgb[i][1] - mean[1];
+        float b = rgb[i][2] - mean[2];
+
+        cov[0] += r * r;
+        cov[1] += r * g;
+        cov[2] += r * b;
+        cov[3] += g * g;
+        cov[4] += g * b;
+        cov[5] += b * b;
+    }
+
+    float axis[3] = {1.0f, 1.0f, 1.0f};
+
+    for(size_t iteration = 0; iteration < 8; ++iteration)
+    {
+        float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        float len = std::max(std::abs(x), std::max(std::abs(y), std::abs(z)));
+
+        if(len == 0.0f)
+        {
+            break;
+        }
+
+        axis[0] = x / len;
+        axis[1] = y / len;
+        axis[2] = z / len;
+    }
+
+    float axisLenSq = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    float minT = 0.0f;
+    float maxT = 0.0f;
+
+    for(size_t i = 0; i < 16; ++i)
+    {
+        float t = ((rgb[i][0] - mean[0]) * axis[0] + (rgb[i][1] - mean[1]) * axis[1] + (rgb[i][2] - mean[2]) * axis[2]) / axisLenSq;
+
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+
+    float end0[3];
+    float end1[3];
+
+    for(size_t c = 0; c < 3; ++c)
+    {
+        end0[c] = mean[c] + maxT * axis[c];
+        end1[c] = mean[c] + minT * axis[c];
+    }
+
+    uint16_t bestColor0 = 0;
+    uint16_t bestColor1 = 0;
+    uint32_t bestIndices = 0;
+    uint32_t bestError = UINT32_MAX;
+
+    for(size_t pass = 0; pass < 2; ++pass)
+    {
+        uint16_t color0 = quantize565(end0[0], end0[1], end0[2]);
+        uint16_t color1 = quantize565(end1[0], end1[1], end1[2]);
+
+        if(color0 < color1)
+        {
+            std::swap(color0, color1);
+            std::swap(end0, end1);
+        }
+
+        if(color0 == color1)
+        {
+            if(pass == 0)
+            {
+                bestColor0 = color0;
+                bestColor1 = color1;
+            }
+
+            break;
+        }
+
+        uint32_t palette[4][3];
+        colorPalette(color0, color1, false, palette);
+
+        // weights of end0 of the palette entries, for the refinement
+        static const float weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+
+        uint32_t indices = 0;
+        uint32_t error = 0;
+        float aa = 0.0f;
+        float ab = 0.0f;
+        float bb = 0.0f;
+        float ax[3] = {0.0f, 0.0f, 0.0f};
+        float bx[3] = {0.0f, 0.0f, 0.0f};
+
+        for(size_t i = 0; i < 16; ++i)
+        {
+            uint32_t best = 0;
+            uint32_t bestDist = UINT32_MAX;
+
+            for(uint32_t p = 0; p < 4; ++p)
+            {
+                int32_t dr = (int32_t)rgb[i][0] - (int32_t)palette[p][0];
+                int32_t dg = (int32_t)rgb[i][1] - (int32_t)palette[p][1];
+                int32_t db = (int32_t)rgb[i][2] - (int32_t)palette[p][2];
+                auto dist = (uint32_t)(dr * dr + dg * dg + db * db);
+
+                if(dist < bestDist)
+                {
+                    best = p;
+                    bestDist = dist;
+                }
+            }
+
+            indices |= best << (i << 1);
+            error += bestDist;
+
+            float w = weights[best];
+
+            aa += w * w;
+            ab += w * (1.0f - w);
+            bb += (1.0f - w) * (1.0f - w);
+
+            for(size_t c = 0; c < 3; ++c)
+            {
+                ax[c] += w * rgb[i][c];
+                bx[c] += (1.0f - w) * rgb[i][c];
+            }
+        }
+
+        if(error < bestError)
+        {
+            bestColor0 = color0;
+            bestColor1 = color1;
+            bestIndices = indices;
+            bestError = error;
+        }
+
+        float det = aa * bb - ab * ab;
+
+        if(std::abs(det) < 1e-6f)
+        {
+            break;
+        }
+
+        for(size_t c = 0; c < 3; ++c)
+        {
+            end0[c] = (ax[c] * bb - bx[c] * ab) / det;
+            end1[c] = (bx[c] * aa - ax[c] * ab) / det;
+        }
+    }
+
+    writeLE16(bestColor0, out);
+    writeLE16(bestColor1, &out[2]);
+    out[4] = (uint8_t)(bestIndices & 0xff);
+    out[5] = (uint8_t)((bestIndices >> 8) & 0xff);
+    out[6] = (uint8_t)((bestIndices >> 16) & 0xff);
+    out[7] = (uint8_t)(bestIndices >> 24);
+}
+
+void encodeAlphaBlock(const uint8_t alpha[16], uint8_t* out)
+{
+    uint8_t alpha0 = 0;
+    uint8_t alpha1 = 255;
+
+    for(size_t i = 0; i < 16; ++i)
+    {
+        alpha0 = std::max(alpha0, alpha[i]);
+        alpha1 = std::min(alpha1, alpha[i]);
+    }
+
+    uint32_t palette[8];
+    alphaPalette(alpha0, alpha1, palette);
+
+    uint64_t indices = 0;
+
+    if(alpha0 != alpha1)
+    {
+        for(size_t i = 0; i < 16; ++i)
+        {
+            uint64_t best = 0;
+            uint32_t bestDist = UINT32_MAX;
+
+            for(uint32_t p = 0; p < 8; ++p)
+            {
+                auto dist = (uint32_t)std::abs((int32_t)alpha[i] - (int32_t)palette[p]);
+
+                if(dist < bestDist)
+                {
+                    best = p;
+                    bestDist = dist;
+                }
+            }
+
+            indices |= best << (i * 3);
+        }
+    }
+
+    out[0] = alpha0;
+    out[1] = alpha1;
+
+    for(size_t i = 0; i < 6; ++i)
+    {
+        out[2 + i] = (uint8_t)((indices >> (i << 3)) & 0xff);
+    }
+}
+
+void decodeColorBlock(const uint8_t* data, bool allowThreeColors, uint8_t rgb[16][3])
+{
+    uint32_t palette[4][3];
+    colorPalette(readLE16(data), readLE16(&data[2]), allowThreeColors, palette);
+
+    uint32_t indices = (uint32_t)data[4] | ((uint32_t)data[5] << 8) | ((uint32_t)data[6] << 16) | ((uint32_t)data[7] << 24);
+
+    for(size_t i = 0; i < 16; ++i)
+    {
+        auto entry = palette[(indices >> (i << 1)) & 0x3];
+
+        rgb[i][0] = (uint8_t)entry[0];
+        rgb[i][1] = (uint8_t)entry[1];
+        rgb[i][2] = (uint8_t)entry[2];
+    }
+}
+
+void decodeAlphaBlock(const uint8_t* data, uint8_t alpha[16])
+{
+    uint32_t palette[8];
+    alphaPalette(data[0], data[1], palette);
+
+    uint64_t indices = 0;
+
+    for(size_t i = 0; i < 6; ++i)
+    {
+        indices |= (uint64_t)data[2 + i] << (i << 3);
+    }
+
+    for(size_t i = 0; i < 16; ++i)
+    {
+        alpha[i] = (uint8_t)palette[(indices >> (i * 3)) & 0x7];
+    }
+}
+
+inline TileCodec::CODEC blockCodec(Bitmap::PIXEL_FORMAT format)
+{
+    switch(format)
+    {
+    case Bitmap::PIXEL_FORMAT::R8:
+        return TileCodec::CODEC::BC4;
+    case Bitmap::PIXEL_FORMAT::RGB8:
+        return TileCodec::CODEC::BC1;
+    case Bitmap::PIXEL_FORMAT::RGBA8:
+        return TileCodec::CODEC::BC3;
+    default:
+        throw std::runtime_error("Tiles of this pixel format can not be encoded.");
+    }
+}
+
+inline size_t blockByteSize(TileCodec::CODEC codec) { return codec == TileCodec::CODEC::BC3 ? 16 : 8; }
+
+size_t TileCodec::maxEncodedSize(size_t width, size_t height, Bitmap::PIXEL_FORMAT format) { return 1 + width * height * Bitmap::pixelSize(format); }
+
+size_t TileCodec::encode(const uint8_t* tile, size_t width, size_t height, Bitmap::PIXEL_FORMAT format, uint8_t* out)
+{
+    size_t pxSize = Bitmap::pixelSize(format);
+    size_t byteSize = width * height * pxSize;
+    auto codec = blockCodec(format);
+
+    bool isSolid = true;
+
+    for(size_t i = pxSize; i < byteSize && isSolid; i += pxSize)
+    {
+        isSolid = std::memcmp(tile, &tile[i], pxSize) == 0;
+    }
+
+    if(isSolid)
+    {
+        out[0] = CODEC::SOLID;
+        std::memcpy(&out[1], tile, pxSize);
+
+        return 1 + pxSize;
+    }
+
+    if((width & 3) != 0 || (height & 3) != 0)
+    {
+        out[0] = CODEC::RAW;
+        std::memcpy(&out[1], tile, byteSize);
+
+        return 1 + byteSize;
+    }
+
+    out[0] = (uint8_t)codec;
+
+    auto block = &out[1];
+    uint8_t rgb[16][3];
+    uint8_t alpha[16];
+
+    for(size_t blockY = 0; blockY < height; blockY += 4)
+    {
+        for(size_t blockX = 0; blockX < width; blockX += 4)
+        {
+            for(size_t i = 0; i < 16; ++i)
+            {
+                auto px = &tile[((blockY + (i >> 2)) * width + blockX + (i & 3)) * pxSize];
+
+                if(codec == CODEC::BC4)
+                {
+                    alpha[i] = px[0];
+                }
+                else
+                {
+                    rgb[i][0] = px[0];
+                    rgb[i][1] = px[1];
+                    rgb[i][2] = px[2];
+                    alpha[i] = codec == CODEC::BC3 ? px[3] : 0xff;
+                }
+            }
+
+            switch(codec)
+            {
+            case CODEC::BC1:
+                encodeColorBlock(rgb, block);
+                break;
+            case CODEC::BC3:
+                encodeAlphaBlock(alpha, block);
+                encodeColorBlock(rgb, &block[8]);
+                break;
+            default:
+                encodeAlphaBlock(alpha, block);
+                break;
+            }
+
+            block = &block[blockByteSize(codec)];
+        }
+    }
+
+    return (size_t)(block - out);
+}
+
+void TileCodec::decode(const uint8_t* data, size_t len, size_t width, size_t height, Bitmap::PIXEL_FORMAT format, uint8_t* out)
+{
+    size_t pxSize = Bitmap::pixelSize(format);
+    size_t byteSize = width * height * pxSize;
+
+    if(len == 0)
+    {
+        throw std::runtime_error("Encoded Tile is empty.");
+    }
+
+    switch(data[0])
+    {
+    case CODEC::RAW:
+        if(len != 1 + byteSize)
+        {
+            throw std::runtime_error("Encoded Tile has the wrong Size.");
+        }
+
+        std::memcpy(out, &data[1], byteSize);
+        return;
+    case CODEC::SOLID:
+        if(len != 1 + pxSize)
+        {
+            throw std::runtime_error("Encoded Tile has the wrong Size.");
+        }
+
+        for(size_t i = 0; i < byteSize; i += pxSize)
+        {
+            std::memcpy(&out[i], &data[1], pxSize);
+        }
+
+        return;
+    case CODEC::BC1:
+    case CODEC::BC3:
+    case CODEC::BC4:
+        break;
+    default:
+        throw std::runtime_error("Encoded Tile has an unknown Codec.");
+    }
+
+    auto codec = (CODEC)data[0];
+
+    if(codec != blockCodec(format) || (width & 3) != 0 || (height & 3) != 0 || len != 1 + (width >> 2) * (height >> 2) * blockByteSize(codec))
+    {
+        throw std::runtime_error("Encoded Tile does not match the Atlas.");
+    }
+
+    auto block = &data[1];
+    uint8_t rgb[16][3];
+    uint8_t alpha[16];
+
+    for(size_t blockY = 0; blockY < height; blockY += 4)
+    {
+        for(size_t blockX = 0; blockX < width; blockX += 4)
+        {
+            switch(codec)
+            {
+            case CODEC::BC1:
+                decodeColorBlock(block, true, rgb);
+                break;
+            case CODEC::BC3:
+                decodeAlphaBlock(block, alpha);
+                decodeColorBlock(&block[8], false, rgb);
+                break;
+            default:
+                decodeAlphaBlock(block, alpha);
+                break;
+            }
+
+            for(size_t i = 0; i < 16; ++i)
+            {
+                auto px = &out[((blockY + (i >> 2)) * width + blockX + (i & 3)) * pxSize];
+
+                if(codec == CODEC::BC4)
+                {
+                    px[0] = alpha[i];
+                }
+                else
+                {
+                    px[0] = rgb[i][0];
+                    px[1] = rgb[i][1];
+                    px[2] = rgb[i][2];
+
+                    if(codec == CODEC::BC3)
+                    {
+                        px[3] = alpha[i];
+                    }
+                }
+            }
+
+            block = &block[blockByteSize(codec)];
+        }
+    }
+}
+} // namespace pre
+} // namespace vt
@@ -38,7 +38,8 @@ CutDatabase::~CutDatabase()
 }
 void CutDatabase::warm_up_cache()
 {
-    _tile_provider->start((size_t)VTConfig::get_instance().get_size_ram_cache() * 1024 * 1024);
+    _tile_provider->start((size_t)VTConfig::get_instance().get_size_ram_cache() * 1024 * 1024, VTConfig::get_instance().get_num_loader_threads(),
+                          VTConfig::get_instance().get_cache_policy());
 
     for(auto cut_entry : _cut_map)
     {
@@ -80,12 +81,25 @@ size_t CutDatabase::get_available_memory(uint16_t context_id)
 }
 mem_slot_type* CutDatabase::get_free_mem_slot(uint16_t context_id)
 {
-    for(auto mem_iter = _context_state_map[context_id]->get_back()->begin(); mem_iter != _context_state_map[context_id]->get_back()->end(); mem_iter++) // NOLINT
+    StateStructure* state = _context_state_map[context_id];
+    mem_slots_type* mem_slots = state->get_back();
+    size_t position = state->_free_slot_cursor;
+
+    // next fit, the slots in front of the cursor were taken by the previous calls
+    for(size_t i = 0; i < mem_slots->size(); i++)
     {
-        if(!(*mem_iter).locked)
+        if(position >= mem_slots->size())
         {
-            return &(*mem_iter);
+            position = 0;
         }
+
+        if(!(*mem_slots)[position].locked)
+        {
+            state->_free_slot_cursor = position + 1;
+            return &(*mem_slots)[position];
+        }
+
+        position++;
     }
 
     throw std::runtime_error("out of mem slots");
@@ -8,8 +8,17 @@
 #include <lamure/vt/ren/CutDatabase.h>
 #include <lamure/vt/ren/CutUpdate.h>
 
+#include <algorithm>
+#include <iterator>
+
 namespace vt
 {
+inline void sort_unique(id_list_type& ids)
+{
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+}
+
 CutUpdate::CutUpdate() : _dispatch_time(), _context_feedbacks(), _cut_decisions()
 {
     _freeze_dispatch.store(false);
@@ -82,15 +91,14 @@ void CutUpdate::dispatch_context(uint16_t context_id)
     }
 
     // std::cout << "\ndispatch() BEGIN" << std::endl;
-#ifndef NDEBUG
     auto start = std::chrono::high_resolution_clock::now();
-#endif
+
+    ContextFeedback* context_feedback = _context_feedbacks[context_id];
 
     uint32_t split_budget_available = (uint32_t)_cut_db->get_available_memory(context_id) / 4;
     uint32_t split_budget = std::min(_precomputed_split_budget_throughput, split_budget_available);
 
-    auto comp = [](const prioritized_tile_from_cut& lhs, const prioritized_tile_from_cut& rhs) { return lhs.second.second < rhs.second.second; };
-    std::priority_queue<prioritized_tile_from_cut, std::vector<prioritized_tile_from_cut>, decltype(comp)> split_queue(comp);
+    std::vector<prioritized_tile_from_cut> split_candidates;
 
     // std::cout << "split budget: " << split_budget << std::endl;
 
@@ -147,8 +155,8 @@ void CutUpdate::dispatch_context(uint16_t context_id)
 
                         // else check fb of all siblings < current_level
                         mem_slot_type* sibling_mem_slot = write_mem_slot_for_id(cut, sibling_id, context_id);
-                        uint32_t compact_position = _context_feedbacks[context_id]->get_compact_position((uint32_t)sibling_mem_slot->position);
-                        if(_context_feedbacks[context_id]->_feedback_lod_buffer[compact_position] >= tile_depth)
+                        uint32_t compact_position = context_feedback->get_compact_position((uint32_t)sibling_mem_slot->position);
+                        if(context_feedback->_feedback_lod_buffer[compact_position] >= tile_depth)
                         {
                             allow_collapse = false;
                             break;
@@ -158,25 +166,25 @@ void CutUpdate::dispatch_context(uint16_t context_id)
                     if(allow_collapse)
                     {
                         // collapse 1, skip others
-                        _cut_decisions[cut_entry.first]->collapse_to.insert(parent_id);
+                        _cut_decisions[cut_entry.first]->collapse_to.push_back(parent_id);
                         std::advance(iter, 4);
                         continue;
                     }
                 }
 
                 mem_slot_type* mem_slot = write_mem_slot_for_id(cut, *iter, context_id);
-                uint32_t compact_position = _context_feedbacks[context_id]->get_compact_position((uint32_t)mem_slot->position);
-                if(_context_feedbacks[context_id]->_feedback_lod_buffer[compact_position] > tile_depth && tile_depth < max_depth)
+                uint32_t compact_position = context_feedback->get_compact_position((uint32_t)mem_slot->position);
+                if(context_feedback->_feedback_lod_buffer[compact_position] > tile_depth && tile_depth < max_depth)
                 {
                     prioritized_tile_from_cut tile;
                     tile.first = cut_entry.first;
                     tile.second.first = *iter;
-                    tile.second.second = (_context_feedbacks[context_id]->_feedback_lod_buffer[compact_position] - tile_depth) * cut->get_atlas()->getCielabValue(*iter);
-                    split_queue.push(tile);
+                    tile.second.second = (context_feedback->_feedback_lod_buffer[compact_position] - tile_depth) * cut->get_atlas()->getCielabValue(*iter);
+                    split_candidates.push_back(tile);
                 }
                 else
                 {
-                    _cut_decisions[cut_entry.first]->keep.insert(*iter);
+                    _cut_decisions[cut_entry.first]->keep.push_back(*iter);
                 }
 
                 iter++;
@@ -190,18 +198,18 @@ void CutUpdate::dispatch_context(uint16_t context_id)
                     throw std::runtime_error("Node " + std::to_string(tile_id) + " not found in memory slots");
                 }
 
-                uint32_t compact_position = _context_feedbacks[context_id]->get_compact_position((uint32_t)mem_slot->position);
-                if(_context_feedbacks[context_id]->_feedback_lod_buffer[compact_position] > tile_depth && tile_depth < max_depth)
+                uint32_t compact_position = context_feedback->get_compact_position((uint32_t)mem_slot->position);
+                if(context_feedback->_feedback_lod_buffer[compact_position] > tile_depth && tile_depth < max_depth)
                 {
                     prioritized_tile_from_cut tile;
                     tile.first = cut_entry.first;
                     tile.second.first = tile_id;
-                    tile.second.second = (_context_feedbacks[context_id]->_feedback_lod_buffer[compact_position] - tile_depth) * cut->get_atlas()->getCielabValue(tile_id);
-                    split_queue.push(tile);
+                    tile.second.second = (context_feedback->_feedback_lod_buffer[compact_position] - tile_depth) * cut->get_atlas()->getCielabValue(tile_id);
+                    split_candidates.push_back(tile);
                 }
                 else
                 {
-                    _cut_decisions[cut_entry.first]->keep.insert(tile_id);
+                    _cut_decisions[cut_entry.first]->keep.push_back(tile_id);
                 }
 
                 iter++;
@@ -213,22 +221,25 @@ void CutUpdate::dispatch_context(uint16_t context_id)
         _cut_db->stop_writing_cut(cut_entry.first);
     }
 
-    int split_counter = 0;
-    while(!split_queue.empty())
+    // only the split_budget tiles of highest priority are split, their order among each other does not matter
+    size_t split_count = std::min<size_t>(split_budget, split_candidates.size());
+
+    if(split_count < split_candidates.size())
     {
-        prioritized_tile_from_cut tile = split_queue.top();
+        std::nth_element(split_candidates.begin(), split_candidates.begin() + split_count, split_candidates.end(),
+                         [](const prioritized_tile_from_cut& lhs, const prioritized_tile_from_cut& rhs) { return lhs.second.second > rhs.second.second; });
+    }
 
-        if(split_counter < split_budget)
+    for(size_t i = 0; i < split_candidates.size(); ++i)
+    {
+        if(i < split_count)
         {
-            _cut_decisions[tile.first]->split.insert(tile.second);
+            _cut_decisions[split_candidates[i].first]->split.push_back(split_candidates[i].second);
         }
         else
         {
-            _cut_decisions[tile.first]->keep.insert(tile.second.first);
+            _cut_decisions[split_candidates[i].first]->keep.push_back(split_candidates[i].second.first);
         }
-
-        split_queue.pop();
-        split_counter++;
     }
 
     for(cut_map_entry_type cut_entry : (*_cut_db->get_cut_map()))
@@ -264,12 +275,7 @@ void CutUpdate::dispatch_context(uint16_t context_id)
 
             cut->set_drawn(true);
 
-            auto allocated_slot_index = &_context_feedbacks[context_id]->get_allocated_slot_index();
-
-            for(auto position_slot_locked : cut->get_back()->get_mem_slots_locked())
-            {
-                allocated_slot_index->insert((uint32_t)position_slot_locked.second);
-            }
+            update_allocated_slots(cut, context_id);
 
             _cut_db->stop_writing_cut(cut_entry.first);
 
@@ -281,9 +287,13 @@ void CutUpdate::dispatch_context(uint16_t context_id)
         cut->get_back()->get_mem_slots_updated().clear();
         cut->get_back()->get_mem_slots_cleared().clear();
 
-        cut_type cut_desired;
+        CutDecision* cut_decision = _cut_decisions[cut_entry.first];
+        id_list_type cut_desired;
+
+        sort_unique(cut_decision->collapse_to);
+        std::sort(cut_decision->split.begin(), cut_decision->split.end());
 
-        for(id_type tile_id : _cut_decisions[cut_entry.first]->collapse_to)
+        for(id_type tile_id : cut_decision->collapse_to)
         {
             // std::cout << "action: collapse to " << tile_id << std::endl;
             if(!collapse_to_id(cut, tile_id, context_id))
@@ -292,37 +302,39 @@ void CutUpdate::dispatch_context(uint16_t context_id)
                 {
                     id_type child_id = QuadTree::get_child_id(tile_id, i);
 
-                    _cut_decisions[cut_entry.first]->keep.insert(child_id);
+                    cut_decision->keep.push_back(child_id);
                 }
             }
             else
             {
-                cut_desired.insert(tile_id);
+                cut_desired.push_back(tile_id);
             }
         }
 
-        for(auto tile : _cut_decisions[cut_entry.first]->split)
+        for(auto tile : cut_decision->split)
         {
             // std::cout << "action: split " << tile.first << std::endl;
             if(!split_id(cut, tile, context_id))
             {
-                _cut_decisions[cut_entry.first]->keep.insert(tile.first);
+                cut_decision->keep.push_back(tile.first);
             }
             else
             {
                 for(uint8_t i = 0; i < 4; i++)
                 {
-                    cut_desired.insert(QuadTree::get_child_id(tile.first, i));
+                    cut_desired.push_back(QuadTree::get_child_id(tile.first, i));
                 }
             }
         }
 
-        for(id_type tile_id : _cut_decisions[cut_entry.first]->keep)
+        sort_unique(cut_decision->keep);
+
+        for(id_type tile_id : cut_decision->keep)
         {
             // std::cout << "action: keep " << tile_id << std::endl;
             if(keep_id(cut, tile_id, context_id))
             {
-                cut_desired.insert(tile_id);
+                cut_desired.push_back(tile_id);
             }
             else
             {
@@ -330,27 +342,19 @@ void CutUpdate::dispatch_context(uint16_t context_id)
             }
         }
 
-        cut->get_back()->get_cut().swap(cut_desired);
-
-        auto allocated_slot_index = &_context_feedbacks[context_id]->get_allocated_slot_index();
+        // sorted input is inserted in linear time
+        sort_unique(cut_desired);
+        cut_type(cut_desired.begin(), cut_desired.end()).swap(cut->get_back()->get_cut());
 
-        for(auto position_slot_locked : cut->get_back()->get_mem_slots_locked())
-        {
-            allocated_slot_index->insert((uint32_t)position_slot_locked.second);
-        }
-
-        for(auto position_slot_cleared : cut->get_back()->get_mem_slots_cleared())
-        {
-            allocated_slot_index->erase((uint32_t)position_slot_cleared.second);
-        }
+        update_allocated_slots(cut, context_id);
 
         _cut_db->stop_writing_cut(cut_entry.first);
     }
 
-#ifndef NDEBUG
+    context_feedback->update_slot_index();
+
     auto end = std::chrono::high_resolution_clock::now();
     _dispatch_time = std::chrono::duration<float, std::milli>(end - start).count();
-#endif
 
     // std::cout << "dispatch() END" << std::endl;
 }
@@ -500,7 +504,7 @@ mem_slot_type* CutUpdate::write_mem_slot_for_id(Cut* cut, id_type tile_id, uint1
     return _cut_db->write_mem_slot_at((*mem_slot_iter).second, context_id);
 }
 bool CutUpdate::can_accept_feedback(uint32_t context_id) { return !_context_feedbacks[context_id]->_feedback_new.load() && !_should_stop.load(); }
-void CutUpdate::feedback(uint32_t context_id, int32_t* buf_lod, uint32_t* buf_count)
+bool CutUpdate::feedback(uint32_t context_id, int32_t* buf_lod, uint32_t* buf_count)
 {
     if(_context_feedbacks[context_id]->_feedback_dispatch_lock.try_lock())
     {
@@ -511,7 +515,11 @@ void CutUpdate::feedback(uint32_t context_id, int32_t* buf_lod, uint32_t* buf_co
         _context_feedbacks[context_id]->_feedback_new.store(true);
         _context_feedbacks[context_id]->_feedback_dispatch_lock.unlock();
         _context_feedbacks[context_id]->_feedback_cv.notify_one();
+
+        return true;
     }
+
+    return false;
 }
 
 void CutUpdate::stop()
@@ -583,4 +591,80 @@ void CutUpdate::remove_from_indexed_memory(Cut* cut, id_type tile_id, uint16_t c
     cut->get_back()->get_mem_slots_cleared()[tile_id] = mem_slot->position;
 }
 ContextFeedback* CutUpdate::get_context_feedback(uint16_t context_id) { return _context_feedbacks[context_id]; }
+void CutUpdate::update_allocated_slots(Cut* cut, uint16_t context_id)
+{
+    ContextFeedback* context_feedback = _context_feedbacks[context_id];
+
+    // cleared slots first, a slot cleared and locked again within the dispatch stays allocated
+    for(auto position_slot_cleared : cut->get_back()->get_mem_slots_cleared())
+    {
+        context_feedback->free_slot((uint32_t)position_slot_cleared.second);
+    }
+
+    for(auto position_slot_locked : cut->get_back()->get_mem_slots_locked())
+    {
+        context_feedback->allocate_slot((uint32_t)position_slot_locked.second);
+    }
+}
+void ContextFeedback::update_slot_index()
+{
+    if(_slots_allocated.empty() && _slots_freed.empty())
+    {
+        return;
+    }
+
+    uint32_t first_changed = UINT32_MAX;
+
+    for(uint32_t position : _slots_allocated)
+    {
+        first_changed = std::min(first_changed, position);
+    }
+
+    for(uint32_t position : _slots_freed)
+    {
+        first_changed = std::min(first_changed, position);
+
+        if(!_slot_allocated[position])
+        {
+            _compact_positions[position] = 0;
+        }
+    }
+
+    // compact positions below the first changed slot stay valid, the rest is merged again
+    size_t first_rank = (size_t)(std::lower_bound(_allocated_slot_index.begin(), _allocated_slot_index.end(), first_changed) - _allocated_slot_index.begin());
+
+    std::vector<uint32_t> added;
+    added.reserve(_slots_allocated.size());
+
+    for(uint32_t position : _slots_allocated)
+    {
+        if(_slot_allocated[position])
+        {
+            added.push_back(position);
+        }
+    }
+
+    std::sort(added.begin(), added.end());
+
+    std::vector<uint32_t> tail;
+    tail.reserve(_allocated_slot_index.size() - first_rank + added.size());
+
+    std::copy_if(_allocated_slot_index.begin() + first_rank, _allocated_slot_index.end(), std::back_inserter(tail), [this](uint32_t position) { return (bool)_slot_allocated[position]; });
+
+    size_t kept_count = tail.size();
+    tail.insert(tail.end(), added.begin(), added.end());
+    std::inplace_merge(tail.begin(), tail.begin() + kept_count, tail.end());
+    tail.erase(std::unique(tail.begin(), tail.end()), tail.end());
+
+    _allocated_slot_index.resize(first_rank);
+    _allocated_slot_index.insert(_allocated_slot_index.end(), tail.begin(), tail.end());
+
+    for(size_t rank = first_rank; rank < _allocated_slot_index.size(); ++rank)
+    {
+        _compact_positions[_allocated_slot_index[rank]] = (uint32_t)rank;
+    }
+
+    _slots_allocated.clear();
+    _slots_freed.clear();
+}
 } // namespace vt